@@ -0,0 +1,468 @@
+#include "asset_store.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QNetworkDiskCache>
+#include <QNetworkProxyFactory>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QPointer>
+#include <QSaveFile>
+#include <QWebEngineProfile>
+#include <QWebEngineUrlRequestJob>
+#include <QtGlobal>
+
+namespace {
+constexpr int kSaveDelayMs = 2000;
+constexpr int kMinHexRun = 8;
+// where WeRead serves its bundles and fonts
+const char *const kCdnHosts[] = {"weread.qq.com", "cdn.weread.qq.com",
+                                 "res.weread.qq.com"};
+
+qint64 nowMs() { return QDateTime::currentMSecsSinceEpoch(); }
+
+QString extensionOf(const QString &path) {
+  const qsizetype slash = path.lastIndexOf(QLatin1Char('/'));
+  const qsizetype dot = path.lastIndexOf(QLatin1Char('.'));
+  return dot > slash ? path.mid(dot + 1).toLower() : QString();
+}
+
+bool isFontExt(const QString &ext) {
+  return ext == QLatin1String("woff2") || ext == QLatin1String("woff") ||
+         ext == QLatin1String("ttf") || ext == QLatin1String("otf");
+}
+
+QByteArray contentTypeFor(const QString &ext) {
+  if (ext == QLatin1String("js") || ext == QLatin1String("mjs"))
+    return QByteArrayLiteral("application/javascript");
+  if (ext == QLatin1String("css"))
+    return QByteArrayLiteral("text/css");
+  if (isFontExt(ext))
+    return QByteArrayLiteral("font/") + ext.toLatin1();
+  return QByteArrayLiteral("application/octet-stream");
+}
+
+// "35.43e6aa07.js", "app~main.3f2a1c09.css": a run of hex digits long
+// enough to be a build hash
+bool hasHashRun(const QString &fileName) {
+  int run = 0;
+  for (const QChar ch : fileName) {
+    const char c = ch.toLatin1();
+    const bool hex =
+        (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') ||
+        (c >= 'A' && c <= 'F');
+    run = hex ? run + 1 : 0;
+    if (run >= kMinHexRun)
+      return true;
+  }
+  return false;
+}
+
+qint64 mtimeOf(const QFileInfo &fi) {
+  return fi.lastModified().toMSecsSinceEpoch();
+}
+
+// Chromium's rule: the application proxy when one is set, else the system
+// proxy (http_proxy/https_proxy/no_proxy on Linux)
+class ProfileProxyFactory : public QNetworkProxyFactory {
+public:
+  QList<QNetworkProxy> queryProxy(const QNetworkProxyQuery &query) override {
+    const QNetworkProxy app = QNetworkProxy::applicationProxy();
+    if (app.type() != QNetworkProxy::NoProxy &&
+        app.type() != QNetworkProxy::DefaultProxy)
+      return {app};
+    return systemProxyForQuery(query);
+  }
+};
+} // namespace
+
+AssetStore::AssetStore(const QString &dir, qint64 budgetBytes,
+                       QObject *parent)
+    : QObject(parent), m_dir(dir),
+      m_budget(budgetBytes > 0 ? budgetBytes : kDefaultBudgetBytes) {
+  QDir().mkpath(m_dir + QStringLiteral("/blobs"));
+  m_saveTimer.setSingleShot(true);
+  m_saveTimer.setInterval(kSaveDelayMs);
+  connect(&m_saveTimer, &QTimer::timeout, this, &AssetStore::save);
+  load();
+}
+
+AssetStore::~AssetStore() {
+  if (m_saveTimer.isActive())
+    save();
+}
+
+bool AssetStore::isImmutable(const QUrl &url) {
+  if (url.scheme() != QLatin1String("https"))
+    return false;
+  const QString path = url.path();
+  const QString ext = extensionOf(path);
+  if (isFontExt(ext))
+    return true;
+  if (ext != QLatin1String("js") && ext != QLatin1String("mjs") &&
+      ext != QLatin1String("css"))
+    return false;
+  return hasHashRun(path.mid(path.lastIndexOf(QLatin1Char('/')) + 1));
+}
+
+bool AssetStore::isCdnHost(const QUrl &url) {
+  const QString host = url.host();
+  for (const char *cdn : kCdnHosts)
+    if (host == QLatin1String(cdn))
+      return true;
+  return false;
+}
+
+QUrl AssetStore::toScheme(const QUrl &url) {
+  QUrl out(url);
+  out.setScheme(QLatin1String(kScheme));
+  return out;
+}
+
+QUrl AssetStore::fromScheme(const QUrl &url) {
+  QUrl out(url);
+  out.setScheme(QStringLiteral("https"));
+  return out;
+}
+
+QByteArray AssetStore::hashOf(const QByteArray &body) {
+  return QCryptographicHash::hash(body, QCryptographicHash::Sha256).toHex();
+}
+
+QString AssetStore::keyOf(const QUrl &url) {
+  return url.toString(QUrl::RemoveFragment | QUrl::RemoveUserInfo);
+}
+
+QString AssetStore::blobPath(const QByteArray &hash) const {
+  return m_dir + QStringLiteral("/blobs/") +
+         QString::fromLatin1(hash.left(2)) + QLatin1Char('/') +
+         QString::fromLatin1(hash);
+}
+
+bool AssetStore::contains(const QUrl &url) const {
+  return m_index.contains(keyOf(url));
+}
+
+const AssetStore::Entry *AssetStore::entry(const QUrl &url) const {
+  const auto it = m_index.constFind(keyOf(url));
+  return it == m_index.cend() ? nullptr : &it.value();
+}
+
+bool AssetStore::read(const QUrl &url, QByteArray *body,
+                      QByteArray *contentType) {
+  const QString key = keyOf(url);
+  auto it = m_index.find(key);
+  if (it == m_index.end()) {
+    ++m_misses;
+    return false;
+  }
+  const QString path = blobPath(it->hash);
+  const QFileInfo fi(path);
+  const qint64 mtime = mtimeOf(fi);
+  QByteArray data;
+  QFile f(path);
+  if (fi.size() == it->size && f.open(QIODevice::ReadOnly))
+    data = f.readAll();
+  // hash once per session, again only if the file changed since
+  const bool checked = it->verifiedMtimeMs == mtime;
+  if (data.size() != it->size || (!checked && hashOf(data) != it->hash)) {
+    // flash corruption or a torn write: never serve it
+    qWarning() << "[ASSETS] corrupt blob for" << key << "-> dropped";
+    ++m_corrupt;
+    ++m_misses;
+    remove(url);
+    return false;
+  }
+  ++m_hits;
+  it->verifiedMtimeMs = mtime;
+  it->lastUsedMs = nowMs();
+  m_saveTimer.start();
+  *body = data;
+  if (contentType)
+    *contentType = it->contentType;
+  return true;
+}
+
+QByteArray AssetStore::put(const QUrl &url, const QByteArray &contentType,
+                           const QByteArray &body) {
+  const QByteArray hash = hashOf(body);
+  const QString key = keyOf(url);
+  auto it = m_index.find(key);
+  if (it != m_index.end() && it->hash == hash) {
+    it->lastUsedMs = nowMs();
+    m_saveTimer.start();
+    return hash;
+  }
+  if (body.size() > m_budget / 2) // one asset must not flush the store
+    return QByteArray();
+  qint64 verifiedMtime = -1; // an existing shared blob is checked on read
+  if (!m_refs.contains(hash)) {
+    const QString path = blobPath(hash);
+    QDir().mkpath(QFileInfo(path).path());
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly) || f.write(body) != body.size() ||
+        !f.commit()) {
+      qWarning() << "[ASSETS] cannot write" << path;
+      return QByteArray();
+    }
+    m_bytes += body.size();
+    verifiedMtime = mtimeOf(QFileInfo(path));
+  }
+  if (it != m_index.end())
+    release(it->hash);
+  Entry e;
+  e.hash = hash;
+  e.size = body.size();
+  e.contentType = contentType;
+  e.lastUsedMs = nowMs();
+  e.verifiedMtimeMs = verifiedMtime;
+  m_index.insert(key, e);
+  ++m_refs[hash];
+  ++m_stored;
+  evict();
+  m_saveTimer.start();
+  return hash;
+}
+
+void AssetStore::remove(const QUrl &url) {
+  auto it = m_index.find(keyOf(url));
+  if (it == m_index.end())
+    return;
+  const QByteArray hash = it->hash;
+  m_index.erase(it);
+  release(hash);
+  m_saveTimer.start();
+}
+
+void AssetStore::release(const QByteArray &hash) {
+  auto ref = m_refs.find(hash);
+  if (ref == m_refs.end())
+    return;
+  if (--ref.value() > 0)
+    return;
+  m_refs.erase(ref);
+  const QString path = blobPath(hash);
+  m_bytes -= QFileInfo(path).size();
+  QFile::remove(path);
+}
+
+void AssetStore::evict() {
+  while (m_bytes > m_budget && !m_index.isEmpty()) {
+    auto oldest = m_index.begin();
+    for (auto it = m_index.begin(); it != m_index.end(); ++it)
+      if (it->lastUsedMs < oldest->lastUsedMs)
+        oldest = it;
+    qInfo() << "[ASSETS] evict" << oldest.key() << oldest->size;
+    const QByteArray hash = oldest->hash;
+    m_index.erase(oldest);
+    release(hash);
+    ++m_evicted;
+  }
+}
+
+void AssetStore::load() {
+  QFile f(m_dir + QStringLiteral("/index.json"));
+  if (f.open(QIODevice::ReadOnly)) {
+    const QJsonObject entries =
+        QJsonDocument::fromJson(f.readAll()).object().value(
+            QStringLiteral("entries")).toObject();
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+      const QJsonObject o = it.value().toObject();
+      Entry e;
+      e.hash = o.value(QStringLiteral("h")).toString().toLatin1();
+      e.size = o.value(QStringLiteral("s")).toInteger();
+      e.contentType = o.value(QStringLiteral("t")).toString().toLatin1();
+      e.lastUsedMs = o.value(QStringLiteral("u")).toInteger();
+      if (e.hash.isEmpty() || QFileInfo(blobPath(e.hash)).size() != e.size)
+        continue; // blob lost (partial copy, manual cleanup)
+      m_index.insert(it.key(), e);
+      if (m_refs[e.hash]++ == 0)
+        m_bytes += e.size;
+    }
+  }
+  // blobs no entry points to: index saved before a crash-time write
+  QDirIterator blobs(m_dir + QStringLiteral("/blobs"), QDir::Files,
+                     QDirIterator::Subdirectories);
+  while (blobs.hasNext()) {
+    const QString path = blobs.next();
+    if (!m_refs.contains(QFileInfo(path).fileName().toLatin1()))
+      QFile::remove(path);
+  }
+  evict();
+  qInfo() << "[ASSETS] store" << m_dir << "entries" << m_index.size()
+          << "bytes" << m_bytes << "budget" << m_budget;
+}
+
+void AssetStore::save() {
+  m_saveTimer.stop();
+  QJsonObject entries;
+  for (auto it = m_index.cbegin(); it != m_index.cend(); ++it) {
+    QJsonObject o;
+    o.insert(QStringLiteral("h"), QString::fromLatin1(it->hash));
+    o.insert(QStringLiteral("s"), it->size);
+    o.insert(QStringLiteral("t"), QString::fromLatin1(it->contentType));
+    o.insert(QStringLiteral("u"), it->lastUsedMs);
+    entries.insert(it.key(), o);
+  }
+  QJsonObject root;
+  root.insert(QStringLiteral("v"), 1);
+  root.insert(QStringLiteral("entries"), entries);
+  QSaveFile f(m_dir + QStringLiteral("/index.json"));
+  if (!f.open(QIODevice::WriteOnly) ||
+      f.write(QJsonDocument(root).toJson(QJsonDocument::Compact)) < 0 ||
+      !f.commit())
+    qWarning() << "[ASSETS] cannot save index in" << m_dir;
+}
+
+QJsonObject AssetStore::snapshot() const {
+  QJsonObject o;
+  o.insert(QStringLiteral("dir"), m_dir);
+  o.insert(QStringLiteral("entries"), count());
+  o.insert(QStringLiteral("blobs"), int(m_refs.size()));
+  o.insert(QStringLiteral("bytes"), m_bytes);
+  o.insert(QStringLiteral("budget"), m_budget);
+  o.insert(QStringLiteral("hits"), qint64(m_hits));
+  o.insert(QStringLiteral("misses"), qint64(m_misses));
+  o.insert(QStringLiteral("stored"), qint64(m_stored));
+  o.insert(QStringLiteral("evicted"), qint64(m_evicted));
+  o.insert(QStringLiteral("corrupt"), qint64(m_corrupt));
+  o.insert(QStringLiteral("truncated"), qint64(m_truncated));
+  return o;
+}
+
+AssetSchemeHandler::AssetSchemeHandler(AssetStore *store, QObject *parent)
+    : QWebEngineUrlSchemeHandler(parent), m_store(store) {}
+
+void AssetSchemeHandler::useProfileNetwork(const QWebEngineProfile *profile) {
+  m_nam.setProxyFactory(new ProfileProxyFactory);
+  if (profile->httpCacheType() == QWebEngineProfile::NoCache)
+    return;
+  auto *cache = new QNetworkDiskCache(&m_nam);
+  cache->setCacheDirectory(profile->cachePath() + QStringLiteral("/wrasset"));
+  if (profile->httpCacheMaximumSize() > 0)
+    cache->setMaximumCacheSize(profile->httpCacheMaximumSize());
+  m_nam.setCache(cache);
+}
+
+void AssetSchemeHandler::reply(QWebEngineUrlRequestJob *job,
+                               const QByteArray &contentType,
+                               const QByteArray &body, bool verified) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 7, 0)
+  // fonts and crossorigin scripts are CORS requests from the reader page
+  if (verified) {
+    QMultiMap<QByteArray, QByteArray> headers;
+    headers.insert(QByteArrayLiteral("Access-Control-Allow-Origin"),
+                   QByteArray(kPageOrigin));
+    headers.insert(QByteArrayLiteral("Cache-Control"),
+                   QByteArrayLiteral("max-age=31536000, immutable"));
+    job->setAdditionalResponseHeaders(headers);
+  }
+#else
+  Q_UNUSED(verified);
+#endif
+  auto *buffer = new QBuffer(job);
+  buffer->setData(body);
+  buffer->open(QIODevice::ReadOnly);
+  job->reply(contentType, buffer);
+}
+
+void AssetSchemeHandler::requestStarted(QWebEngineUrlRequestJob *job) {
+  const QUrl url = AssetStore::fromScheme(job->requestUrl());
+  if (job->requestMethod() != QByteArrayLiteral("GET")) {
+    job->fail(QWebEngineUrlRequestJob::RequestDenied);
+    return;
+  }
+  QByteArray body;
+  QByteArray contentType;
+  if (m_store->read(url, &body, &contentType)) {
+    qInfo() << "[ASSETS] hit" << url.toString(QUrl::RemoveQuery)
+            << body.size();
+    reply(job, contentType, body, true);
+    return;
+  }
+  // the scheme is reachable from any page: never act as a fetch proxy
+  if (!AssetStore::isStorable(url)) {
+    qWarning() << "[ASSETS] miss for unstorable URL denied"
+               << url.toString(QUrl::RemoveQuery);
+    job->fail(QWebEngineUrlRequestJob::RequestDenied);
+    return;
+  }
+
+  const QUrl initiator = job->initiator();
+  fetch(QPointer<QWebEngineUrlRequestJob>(job), url,
+        initiator.isValid() && initiator.scheme() == QLatin1String("https")
+            ? initiator.toEncoded() + '/'
+            : QByteArray(),
+        1);
+}
+
+void AssetSchemeHandler::fetch(QPointer<QWebEngineUrlRequestJob> job,
+                               const QUrl &url, const QByteArray &referer,
+                               int attempt) {
+  QNetworkRequest req(url);
+  // same as the browser: no HTTP/2 (see --disable-http2 in main.cpp)
+  req.setAttribute(QNetworkRequest::Http2AllowedAttribute, false);
+  if (!m_userAgent.isEmpty())
+    req.setHeader(QNetworkRequest::UserAgentHeader, m_userAgent);
+  if (!referer.isEmpty())
+    req.setRawHeader(QByteArrayLiteral("Referer"), referer);
+  QNetworkReply *netReply = m_nam.get(req);
+  const qint64 startMs = QDateTime::currentMSecsSinceEpoch();
+  // job turns null if the page cancels the request
+  connect(netReply, &QNetworkReply::finished, this,
+          [this, netReply, job, url, referer, attempt, startMs]() {
+    netReply->deleteLater();
+    const int status =
+        netReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const QByteArray data = netReply->readAll();
+    QByteArray type = netReply->header(QNetworkRequest::ContentTypeHeader)
+                          .toString()
+                          .toLatin1();
+    if (type.isEmpty())
+      type = contentTypeFor(extensionOf(url.path()));
+    const bool ok = netReply->error() == QNetworkReply::NoError &&
+                    status == 200;
+    // A body shorter than Content-Length is the truncation that shows up
+    // as "Unexpected end of input"; only comparable when not compressed.
+    bool hasLength = false;
+    const qint64 expected =
+        netReply->header(QNetworkRequest::ContentLengthHeader)
+            .toLongLong(&hasLength);
+    const QByteArray encoding =
+        netReply->rawHeader(QByteArrayLiteral("Content-Encoding"));
+    const bool truncated =
+        ok && hasLength &&
+        (encoding.isEmpty() || encoding == QByteArrayLiteral("identity")) &&
+        data.size() != expected;
+    qInfo() << "[ASSETS] fetch" << url.toString(QUrl::RemoveQuery) << "status"
+            << status << "bytes" << data.size() << "expected"
+            << (hasLength ? expected : -1) << "attempt" << attempt << "ms"
+            << QDateTime::currentMSecsSinceEpoch() - startMs;
+    if (truncated) {
+      m_store->noteTruncated();
+      if (attempt < kMaxFetchAttempts) {
+        qWarning() << "[ASSETS] truncated body, refetch" << url;
+        fetch(job, url, referer, attempt + 1);
+        return;
+      }
+    }
+    const bool valid = ok && !truncated;
+    // put() refuses bodies over half the budget or a failed write
+    const bool stored = valid && !m_store->put(url, type, data).isEmpty();
+    if (!job)
+      return;
+    if (!valid) {
+      job->fail(status == 404 ? QWebEngineUrlRequestJob::UrlNotFound
+                              : QWebEngineUrlRequestJob::RequestFailed);
+      return;
+    }
+    reply(job, type, data, stored);
+  });
+}
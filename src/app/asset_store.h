@@ -0,0 +1,137 @@
+#ifndef ASSET_STORE_H
+#define ASSET_STORE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+#include <QUrl>
+#include <QWebEngineUrlSchemeHandler>
+
+class QWebEngineProfile;
+class QWebEngineUrlRequestJob;
+
+// Local store for immutable, versioned assets (hashed JS/CSS bundles and
+// fonts). Bodies are stored once per SHA-256 under <dir>/blobs and the
+// index maps request URLs to them, so two URLs serving the same bytes
+// share a blob. Least recently used URLs are evicted when the blobs exceed
+// the byte budget. The directory is separate from the HTTP cache, so
+// clearing that cache (first-run cache_cleared.v1, WEREAD_CLEAR_CACHE_ON_START)
+// leaves the store intact. A blob is hashed when it is written and on its
+// first read in a session; later reads only compare its size and mtime and
+// hash again if either changed. A mismatch drops the entry and reads as a
+// miss.
+class AssetStore : public QObject {
+  Q_OBJECT
+public:
+  static constexpr const char *kScheme = "wrasset";
+  static constexpr qint64 kDefaultBudgetBytes = 64LL * 1024 * 1024;
+
+  struct Entry {
+    QByteArray hash; // hex SHA-256 of the body
+    qint64 size = 0;
+    QByteArray contentType;
+    qint64 lastUsedMs = 0;
+    qint64 verifiedMtimeMs = -1; // blob mtime at the last hash check; not saved
+  };
+
+  AssetStore(const QString &dir, qint64 budgetBytes,
+             QObject *parent = nullptr);
+  ~AssetStore() override;
+
+  // https URL whose body never changes: a script, stylesheet or font with
+  // a content hash in its file name, or any font file.
+  static bool isImmutable(const QUrl &url);
+  // host is one of the WeRead CDN hosts the store fetches from
+  static bool isCdnHost(const QUrl &url);
+  // immutable and on a CDN host: the only URLs fetched, stored and served
+  static bool isStorable(const QUrl &url) {
+    return isImmutable(url) && isCdnHost(url);
+  }
+  // https://host/path <-> wrasset://host/path
+  static QUrl toScheme(const QUrl &url);
+  static QUrl fromScheme(const QUrl &url);
+  static QByteArray hashOf(const QByteArray &body);
+
+  bool contains(const QUrl &url) const;
+  const Entry *entry(const QUrl &url) const;
+  bool read(const QUrl &url, QByteArray *body, QByteArray *contentType);
+  // Stores body for url and returns its hash; evicts down to the budget.
+  QByteArray put(const QUrl &url, const QByteArray &contentType,
+                 const QByteArray &body);
+  void remove(const QUrl &url);
+  // a fetched body came back shorter than its Content-Length
+  void noteTruncated() { ++m_truncated; }
+
+  QString dir() const { return m_dir; }
+  qint64 bytes() const { return m_bytes; }
+  int count() const { return int(m_index.size()); }
+  QJsonObject snapshot() const;
+
+private:
+  static QString keyOf(const QUrl &url);
+  QString blobPath(const QByteArray &hash) const;
+  void release(const QByteArray &hash);
+  void evict();
+  void load();
+  void save();
+
+  QString m_dir;
+  qint64 m_budget;
+  qint64 m_bytes = 0; // unique blob bytes
+  QHash<QString, Entry> m_index;
+  QHash<QByteArray, int> m_refs; // blob hash -> URLs using it
+  QTimer m_saveTimer;
+  quint64 m_hits = 0;
+  quint64 m_misses = 0;
+  quint64 m_stored = 0;
+  quint64 m_evicted = 0;
+  quint64 m_corrupt = 0;
+  quint64 m_truncated = 0;
+};
+
+// Serves wrasset:// requests: from the store when it has the asset,
+// otherwise fetched over https with QNetworkAccessManager, stored, and
+// answered. The interceptor redirects storable asset requests here;
+// relative URLs inside a served stylesheet resolve to wrasset:// and
+// arrive directly, so a miss is fetched only for a storable URL and fails
+// otherwise. A fetched body shorter than its Content-Length is refetched
+// (kMaxFetchAttempts in all) and never stored. Only bodies that passed
+// the hash check or were just stored get the immutable Cache-Control and
+// the CORS header for the reader's origin (kPageOrigin).
+// A scheme handler cannot hand a request back to the profile's network
+// stack, so misses need a stack of their own. They only fetch public,
+// cookieless CDN files, so the profile's cookies are not needed.
+// useProfileNetwork() applies the profile's proxy and HTTP cache settings.
+class AssetSchemeHandler : public QWebEngineUrlSchemeHandler {
+  Q_OBJECT
+public:
+  AssetSchemeHandler(AssetStore *store, QObject *parent = nullptr);
+
+  static constexpr int kMaxFetchAttempts = 2;
+  static constexpr const char *kPageOrigin = "https://weread.qq.com";
+
+  void setUserAgent(const QByteArray &ua) { m_userAgent = ua; }
+  // Use the proxy the profile resolves: the application proxy if set,
+  // otherwise the system proxy. Add a disk cache under the profile's
+  // cache path unless the profile has caching turned off.
+  void useProfileNetwork(const QWebEngineProfile *profile);
+  void requestStarted(QWebEngineUrlRequestJob *job) override;
+
+private:
+  void fetch(QPointer<QWebEngineUrlRequestJob> job, const QUrl &url,
+             const QByteArray &referer, int attempt);
+  // verified: body came from the store or was just stored
+  void reply(QWebEngineUrlRequestJob *job, const QByteArray &contentType,
+             const QByteArray &body, bool verified);
+
+  AssetStore *m_store = nullptr;
+  QNetworkAccessManager m_nam;
+  QByteArray m_userAgent;
+};
+
+#endif // ASSET_STORE_H
@@ -0,0 +1,197 @@
+#include "connection_warmer.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QVariantMap>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace {
+constexpr int kMaxPendingResults = 64;
+
+QString ms(qint64 v) {
+  return v < 0 ? QStringLiteral("-") : QString::number(v);
+}
+} // namespace
+
+QString ConnectionWarmer::warmScript(quint64 round, int timeoutMs,
+                                     const QStringList &extraOrigins) {
+  // __wr_warm= marks the probes: the interceptor does not count them and
+  // NetAccounting::entriesScript filters their resource timing entries
+  return QStringLiteral(
+             "((round, timeoutMs, extra) => {"
+             "  try {"
+             "    const w = window.__WR_WARM = window.__WR_WARM || {results: []};"
+             "    const origins = new Set([location.origin].concat(extra));"
+             "    const pf = window.__WR_PREFETCH;"
+             "    if (pf && pf.templates) Object.keys(pf.templates).forEach(ep => {"
+             "      try { origins.add(new URL(ep.slice(ep.indexOf(' ') + 1)).origin); }"
+             "      catch (e) {}"
+             "    });"
+             "    const ref = window.__wr_fetch_ref;"
+             "    const rawFetch = (ref && ref.__wr_orig) || window.fetch;"
+             "    const list = Array.from(origins)"
+             "      .filter(o => typeof o === 'string' && o.startsWith('https://'));"
+             "    list.forEach(origin => {"
+             "      const url = origin + '/?__wr_warm=' + round + '.' + Date.now();"
+             "      const ctl = typeof AbortController === 'function'"
+             "        ? new AbortController() : null;"
+             "      const timer = ctl ? setTimeout(() => ctl.abort(), timeoutMs) : 0;"
+             "      const t0 = performance.now();"
+             "      const init = {method: 'HEAD', cache: 'no-store', credentials: 'include',"
+             "        mode: origin === location.origin ? 'same-origin' : 'no-cors'};"
+             "      if (ctl) init.signal = ctl.signal;"
+             "      rawFetch.call(window, url, init)"
+             "        .then(r => ({ok: true, status: r.status}),"
+             "              e => ({ok: false, status: 0, error: String((e && e.name) || e)}))"
+             "        .then(o => {"
+             "          clearTimeout(timer);"
+             "          o.round = round;"
+             "          o.origin = origin;"
+             "          o.ms = Math.round(performance.now() - t0);"
+             "          const e = performance.getEntriesByName(url).pop();"
+             "          if (e && e.requestStart > 0) {"
+             "            o.ttfb = Math.round(e.responseStart - e.requestStart);"
+             "            o.reused = e.connectEnd === e.connectStart;"
+             "            o.connect = Math.round(e.connectEnd - e.connectStart);"
+             "            o.tls = e.secureConnectionStart > 0"
+             "              ? Math.round(e.connectEnd - e.secureConnectionStart) : 0;"
+             "          }"
+             "          w.results.push(o);"
+             "          if (w.results.length > %4) w.results.shift();"
+             "        });"
+             "    });"
+             "    return {ok: true, round, origins: list};"
+             "  } catch (e) { return {ok: false, error: String(e)}; }"
+             "})(%1, %2, %3)")
+      .arg(round)
+      .arg(timeoutMs)
+      .arg(QString::fromUtf8(
+          QJsonDocument(QJsonArray::fromStringList(extraOrigins))
+              .toJson(QJsonDocument::Compact)))
+      .arg(kMaxPendingResults);
+}
+
+QString ConnectionWarmer::resultsScript() {
+  return QStringLiteral(
+      "(() => {"
+      "  const w = window.__WR_WARM;"
+      "  return w ? w.results.splice(0) : [];"
+      "})()");
+}
+
+void ConnectionWarmer::Series::add(qint64 value) {
+  if (value < 0)
+    return;
+  m_values[m_next] = static_cast<qint32>(
+      std::min<qint64>(value, std::numeric_limits<qint32>::max()));
+  m_next = (m_next + 1) % kWindow;
+  if (m_filled < kWindow)
+    ++m_filled;
+}
+
+qint64 ConnectionWarmer::Series::percentile(int pct) const {
+  if (m_filled == 0)
+    return -1;
+  std::vector<qint32> sorted(m_values.begin(), m_values.begin() + m_filled);
+  std::sort(sorted.begin(), sorted.end());
+  // nearest-rank percentile
+  const size_t idx = (sorted.size() * pct + 99) / 100;
+  return sorted[idx == 0 ? 0 : idx - 1];
+}
+
+void ConnectionWarmer::begin(const QString &reason, qint64 nowMs) {
+  ++m_rounds;
+  m_lastReason = reason;
+  m_lastWarmMs = nowMs;
+}
+
+ConnectionWarmer::RoundResult
+ConnectionWarmer::addResults(const QVariantList &results, quint64 round) {
+  RoundResult r;
+  for (const QVariant &v : results) {
+    const QVariantMap m = v.toMap();
+    const QString key = m.value(QStringLiteral("origin")).toString();
+    if (key.isEmpty())
+      continue;
+    Origin &o = m_origins[key];
+    const bool ok = m.value(QStringLiteral("ok")).toBool();
+    o.lastStatus = m.value(QStringLiteral("status")).toInt();
+    o.lastError = m.value(QStringLiteral("error")).toString();
+    o.total.add(m.value(QStringLiteral("ms")).toLongLong());
+    if (ok) {
+      ++o.ok;
+      if (m.contains(QStringLiteral("ttfb"))) {
+        o.ttfb.add(m.value(QStringLiteral("ttfb")).toLongLong());
+        if (m.value(QStringLiteral("reused")).toBool()) {
+          ++o.reused;
+        } else {
+          o.connect.add(m.value(QStringLiteral("connect")).toLongLong());
+          o.tls.add(m.value(QStringLiteral("tls")).toLongLong());
+        }
+      }
+    } else {
+      ++o.failed;
+    }
+    if (m.value(QStringLiteral("round")).toULongLong() != round)
+      continue; // late result of an earlier round
+    if (ok)
+      ++r.ok;
+    else
+      ++r.failed;
+  }
+  return r;
+}
+
+QJsonObject ConnectionWarmer::toJson(const Series &s) {
+  QJsonObject o;
+  o.insert(QStringLiteral("n"), s.count());
+  o.insert(QStringLiteral("p50"), s.percentile(50));
+  o.insert(QStringLiteral("p95"), s.percentile(95));
+  return o;
+}
+
+QJsonObject ConnectionWarmer::snapshot() const {
+  QJsonObject origins;
+  for (auto it = m_origins.cbegin(); it != m_origins.cend(); ++it) {
+    const Origin &o = it.value();
+    QJsonObject obj;
+    obj.insert(QStringLiteral("ok"), qint64(o.ok));
+    obj.insert(QStringLiteral("failed"), qint64(o.failed));
+    obj.insert(QStringLiteral("reused"), qint64(o.reused));
+    obj.insert(QStringLiteral("ttfb"), toJson(o.ttfb));
+    obj.insert(QStringLiteral("connect"), toJson(o.connect));
+    obj.insert(QStringLiteral("tls"), toJson(o.tls));
+    obj.insert(QStringLiteral("total"), toJson(o.total));
+    obj.insert(QStringLiteral("lastStatus"), o.lastStatus);
+    if (!o.lastError.isEmpty())
+      obj.insert(QStringLiteral("lastError"), o.lastError);
+    origins.insert(it.key(), obj);
+  }
+  QJsonObject root;
+  root.insert(QStringLiteral("rounds"), qint64(m_rounds));
+  root.insert(QStringLiteral("lastReason"), m_lastReason);
+  root.insert(QStringLiteral("lastWarmMs"), m_lastWarmMs);
+  root.insert(QStringLiteral("origins"), origins);
+  return root;
+}
+
+QStringList ConnectionWarmer::summaryLines() const {
+  QStringList lines;
+  for (auto it = m_origins.cbegin(); it != m_origins.cend(); ++it) {
+    const Origin &o = it.value();
+    lines << QStringLiteral("%1 ok=%2 failed=%3 reused=%4 ttfb=%5/%6 "
+                            "connect=%7/%8 tls=%9/%10 total=%11/%12")
+                 .arg(it.key())
+                 .arg(o.ok)
+                 .arg(o.failed)
+                 .arg(o.reused)
+                 .arg(ms(o.ttfb.percentile(50)), ms(o.ttfb.percentile(95)),
+                      ms(o.connect.percentile(50)),
+                      ms(o.connect.percentile(95)), ms(o.tls.percentile(50)),
+                      ms(o.tls.percentile(95)), ms(o.total.percentile(50)),
+                      ms(o.total.percentile(95)));
+  }
+  return lines;
+}
@@ -0,0 +1,82 @@
+#ifndef CONNECTION_WARMER_H
+#define CONNECTION_WARMER_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <array>
+
+// Keeps the reader's HTTPS connections warm and measures them. A warm
+// round runs in the page: one HEAD request per origin the reader talks to
+// (the page origin, the origins of the recorded chapter content endpoints
+// and the busiest XHR hosts), through the page's own fetch so it uses and
+// refreshes the same socket pool the chapter fetches will use. The
+// requests carry credentials: Chromium pools credentialed and anonymous
+// sockets separately. Each result is read back from the request's resource
+// timing entry: time to first byte, TCP connect and TLS handshake, and
+// whether an idle connection was reused. Cross-origin hosts without
+// Timing-Allow-Origin only report the total.
+// Results are pulled from the page after the round's timeout, like the
+// resource timing entries in NetAccounting. GUI thread only.
+class ConnectionWarmer {
+public:
+  struct RoundResult {
+    int ok = 0;
+    int failed = 0;
+  };
+
+  // Starts round `round`; returns {ok, round, origins}.
+  static QString warmScript(quint64 round, int timeoutMs,
+                            const QStringList &extraOrigins);
+  // Returns and clears the results collected in the page so far.
+  static QString resultsScript();
+
+  void begin(const QString &reason, qint64 nowMs);
+  // Records every result; counts only those belonging to round.
+  RoundResult addResults(const QVariantList &results, quint64 round);
+  qint64 lastWarmMs() const { return m_lastWarmMs; }
+
+  // {rounds, lastReason, origins:{origin:{ok, failed, reused, ttfb:{..},
+  //  connect:{..}, tls:{..}, total:{..}, lastStatus, lastError}}}
+  QJsonObject snapshot() const;
+  // one line per origin, p50/p95 in ms
+  QStringList summaryLines() const;
+
+private:
+  static constexpr int kWindow = 32;
+
+  class Series {
+  public:
+    void add(qint64 value);
+    int count() const { return m_filled; }
+    qint64 percentile(int pct) const;
+
+  private:
+    std::array<qint32, kWindow> m_values{};
+    int m_next = 0;
+    int m_filled = 0;
+  };
+
+  struct Origin {
+    quint64 ok = 0;
+    quint64 failed = 0;
+    quint64 reused = 0; // no connect phase: an idle connection was reused
+    Series ttfb;        // requestStart -> responseStart
+    Series connect;     // connectStart -> connectEnd, new connections only
+    Series tls;         // secureConnectionStart -> connectEnd
+    Series total;       // fetch() call -> settled
+    int lastStatus = 0;
+    QString lastError;
+  };
+
+  static QJsonObject toJson(const Series &s);
+
+  QHash<QString, Origin> m_origins;
+  quint64 m_rounds = 0;
+  QString m_lastReason;
+  qint64 m_lastWarmMs = 0;
+};
+
+#endif // CONNECTION_WARMER_H
@@ -0,0 +1,141 @@
+#include "eink_quantize.h"
+
+#include <QtGlobal>
+
+namespace {
+// 4x4 Bayer matrix, values 0..15
+constexpr uint8_t kBayer4[16] = {0, 8,  2, 10, 12, 4, 14, 6,
+                                 3, 11, 1, 9,  15, 7, 13, 5};
+
+inline uint8_t luma(QRgb p) {
+  // BT.601 fixed point, exact for gray input (77 + 150 + 29 = 256)
+  return static_cast<uint8_t>(
+      (qRed(p) * 77 + qGreen(p) * 150 + qBlue(p) * 29 + 128) >> 8);
+}
+
+inline bool isRgb32Like(QImage::Format format) {
+  return format == QImage::Format_RGB32 || format == QImage::Format_ARGB32 ||
+         format == QImage::Format_ARGB32_Premultiplied;
+}
+} // namespace
+
+EinkQuantizer::Options EinkQuantizer::optionsFromEnv() {
+  Options options;
+  options.enabled = qEnvironmentVariableIntValue("WEREAD_EINK_QUANTIZE") != 0;
+  if (qEnvironmentVariableIsSet("WEREAD_EINK_DITHER"))
+    options.dither = qEnvironmentVariableIntValue("WEREAD_EINK_DITHER") != 0;
+  bool ok = false;
+  const int snap = qEnvironmentVariableIntValue("WEREAD_EINK_SNAP", &ok);
+  if (ok)
+    options.snapMargin = qBound(0, snap, 96);
+  return options;
+}
+
+EinkQuantizer::EinkQuantizer(const Options &options) : m_options(options) {
+  buildTables();
+}
+
+void EinkQuantizer::buildTables() {
+  const int margin = m_options.snapMargin;
+  for (int g = 0; g < 256; ++g) {
+    const int level = (g * (kLevels - 1) + 127) / 255;
+    m_levelLut[g] = static_cast<uint8_t>(level);
+    int value = level * 17;
+    if (margin > 0) {
+      if (g <= margin)
+        value = 0;
+      else if (g >= 255 - margin)
+        value = 255;
+    }
+    m_snapLut[g] = static_cast<uint8_t>(value);
+  }
+  for (int cell = 0; cell < 16; ++cell) {
+    // threshold inside one 17-wide quantization step, centred per Bayer cell
+    const int threshold = ((kBayer4[cell] * 2 + 1) * 17) / 32;
+    for (int g = 0; g < 256; ++g) {
+      int level = g / 17;
+      if (g % 17 > threshold)
+        ++level;
+      level = qMin(level, kLevels - 1);
+      m_ditherLut[cell][g] = static_cast<uint8_t>(level * 17);
+    }
+  }
+}
+
+EinkQuantizer::Result EinkQuantizer::process(QImage &img,
+                                             const QRect &damage) {
+  Result result;
+  if (img.isNull())
+    return result;
+  if (!isRgb32Like(img.format()))
+    img = img.convertToFormat(QImage::Format_RGB32);
+
+  const int w = img.width();
+  const int h = img.height();
+  const QRect area =
+      damage.isNull() ? img.rect() : damage.intersected(img.rect());
+  m_gray.resize(static_cast<size_t>(w) * h);
+
+  for (int y = 0; y < h; ++y) {
+    const QRgb *src = reinterpret_cast<const QRgb *>(img.constScanLine(y));
+    uint8_t *gray = m_gray.data() + static_cast<size_t>(y) * w;
+    for (int x = 0; x < w; ++x)
+      gray[x] = luma(src[x]);
+  }
+
+  for (int ty = 0; ty < h; ty += kTile) {
+    const int th = qMin(kTile, h - ty);
+    for (int tx = 0; tx < w; tx += kTile) {
+      const int tw = qMin(kTile, w - tx);
+      // Photo-like tile: more than a quarter of pixels are mid-tones.
+      // Anti-aliased glyph edges stay well below that.
+      int midTones = 0;
+      for (int y = ty; y < ty + th; ++y) {
+        const uint8_t *gray = m_gray.data() + static_cast<size_t>(y) * w;
+        for (int x = tx; x < tx + tw; ++x) {
+          const uint8_t level = m_levelLut[gray[x]];
+          midTones += (level != 0 && level != kLevels - 1) ? 1 : 0;
+        }
+      }
+      const bool dither = m_options.dither && midTones * 4 > tw * th;
+      if (dither)
+        ++result.ditheredTiles;
+
+      for (int y = ty; y < ty + th; ++y) {
+        const uint8_t *gray = m_gray.data() + static_cast<size_t>(y) * w;
+        QRgb *dst = reinterpret_cast<QRgb *>(img.scanLine(y));
+        const bool rowInArea = y >= area.top() && y <= area.bottom();
+        const uint8_t *lut = dither ? nullptr : m_snapLut.data();
+        for (int x = tx; x < tx + tw; ++x) {
+          const uint8_t v =
+              lut ? lut[gray[x]]
+                  : m_ditherLut[((y & 3) << 2) | (x & 3)][gray[x]];
+          dst[x] = 0xff000000u | (static_cast<uint32_t>(v) * 0x010101u);
+          if (rowInArea && v != 0 && v != 255 && x >= area.left() &&
+              x <= area.right())
+            ++result.grayPixels;
+        }
+      }
+    }
+  }
+
+  result.contentClass = result.grayPixels == 0 ? ClassBilevel : ClassGray16;
+  return result;
+}
+
+EinkQuantizer::ContentClass EinkQuantizer::classify(const QImage &img,
+                                                    const QRect &damage) {
+  if (img.isNull() || !isRgb32Like(img.format()))
+    return ClassUnknown;
+  const QRect area =
+      damage.isNull() ? img.rect() : damage.intersected(img.rect());
+  for (int y = area.top(); y <= area.bottom(); ++y) {
+    const QRgb *row = reinterpret_cast<const QRgb *>(img.constScanLine(y));
+    for (int x = area.left(); x <= area.right(); ++x) {
+      const uint32_t rgb = row[x] & 0x00ffffffu;
+      if (rgb != 0 && rgb != 0x00ffffffu)
+        return ClassGray16;
+    }
+  }
+  return ClassBilevel;
+}
@@ -0,0 +1,63 @@
+#ifndef EINK_QUANTIZE_H
+#define EINK_QUANTIZE_H
+
+#include <QImage>
+#include <QRect>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// E-ink pre-quantization for the published frame.
+// Maps output to the panel's 16 gray levels so the waveform sees exactly what
+// it can display: text tiles are snapped (near-white -> 255, near-black -> 0),
+// photo-like tiles get 4x4 ordered dithering. All per-pixel work is table
+// lookups; the damage area is then classified so a consumer can pick DU/A2
+// for purely bilevel updates instead of GL16/GC16.
+class EinkQuantizer {
+public:
+  enum ContentClass : uint32_t {
+    ClassUnknown = 0,
+    ClassBilevel = 1, // only 0/255 in the damage area: DU/A2 safe
+    ClassGray16 = 2   // contains intermediate levels: needs GL16/GC16
+  };
+
+  struct Options {
+    bool enabled = false;
+    bool dither = true;   // ordered dithering on photo-like tiles
+    int snapMargin = 24;  // 0 disables near-white/near-black snapping
+  };
+
+  struct Result {
+    ContentClass contentClass = ClassUnknown;
+    int ditheredTiles = 0;
+    int grayPixels = 0; // non-bilevel pixels inside the damage area
+  };
+
+  // WEREAD_EINK_QUANTIZE=1 enables, WEREAD_EINK_DITHER=0 disables dithering,
+  // WEREAD_EINK_SNAP=<margin> adjusts snapping (0 = off)
+  static Options optionsFromEnv();
+
+  explicit EinkQuantizer(const Options &options = Options());
+
+  const Options &options() const { return m_options; }
+
+  // In place on an RGB32/ARGB32 image; damage null = whole image.
+  Result process(QImage &img, const QRect &damage = QRect());
+
+  // Classification only (no pixel changes), used by benchmarks/diagnostics
+  static ContentClass classify(const QImage &img, const QRect &damage);
+
+private:
+  static constexpr int kTile = 16;
+  static constexpr int kLevels = 16;
+
+  void buildTables();
+
+  Options m_options;
+  std::array<uint8_t, 256> m_snapLut{};              // text tiles
+  std::array<std::array<uint8_t, 256>, 16> m_ditherLut{}; // per Bayer cell
+  std::array<uint8_t, 256> m_levelLut{};             // gray -> level 0..15
+  std::vector<uint8_t> m_gray;                       // reused luma plane
+};
+
+#endif // EINK_QUANTIZE_H
@@ -1,4 +1,5 @@
 #include "eink_refresh.h"
+#include "ink_latency_tracer.h"
 #include <cerrno>
 
 EinkRefreshHelper::EinkRefreshHelper() {
@@ -13,6 +14,15 @@ EinkRefreshHelper::EinkRefreshHelper() {
 }
 
 EinkRefreshHelper::~EinkRefreshHelper() {
+  if (m_inkWaiter.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(m_inkMutex);
+      m_inkStop = true;
+      m_inkMarkers.clear();
+    }
+    m_inkCond.notify_one();
+    m_inkWaiter.join();
+  }
   if (m_fd >= 0)
     ::close(m_fd);
 }
@@ -33,6 +43,14 @@ void EinkRefreshHelper::refreshPartial(int x, int y, int w, int h) {
   m_partialCount++;
 }
 
+void EinkRefreshHelper::refreshPartialGC16(int x, int y, int w, int h) {
+  if (qEnvironmentVariableIsSet("WEREAD_EINK_DEBUG")) {
+    qInfo() << "[EINK] Partial refresh (GC16)" << x << y << w << h;
+  }
+  triggerRegion(x, y, w, h, WAVE_GC16, MODE_PARTIAL, false);
+  m_partialCount++;
+}
+
 void EinkRefreshHelper::refreshUI(int x, int y, int w, int h) {
   if (qEnvironmentVariableIsSet("WEREAD_EINK_DEBUG")) {
     qInfo() << "[EINK] UI refresh (DU)" << x << y << w << h;
@@ -120,6 +138,8 @@ void EinkRefreshHelper::triggerRegion(int x, int y, int w, int h, int wave,
     qWarning() << "[EINK] send failed" << strerror(errno);
     return;
   }
+  InkLatencyTracer &tracer = InkLatencyTracer::instance();
+  const bool traced = tracer.noteIoctl(upd.update_marker);
 
   if (waitComplete) {
     mxcfb_update_marker_data md{};
@@ -127,7 +147,13 @@ void EinkRefreshHelper::triggerRegion(int x, int y, int w, int h, int wave,
     md.collision_test = 0;
     if (::ioctl(m_fd, MXCFB_WAIT_FOR_UPDATE_COMPLETE, &md) != 0) {
       qWarning() << "[EINK] wait failed" << strerror(errno);
+    } else if (traced) {
+      tracer.markInkDone(upd.update_marker);
     }
+  } else if (traced && tracer.wantsInkDone()) {
+    // 只为被追踪的翻页刷新排队等待，不阻塞 GUI 线程；
+    // shim 不支持该 ioctl 时失败即放弃，trace 以 ioctl 为终点
+    queueInkWait(upd.update_marker);
   }
 
   if (qEnvironmentVariableIsSet("WEREAD_EINK_DEBUG")) {
@@ -137,6 +163,36 @@ void EinkRefreshHelper::triggerRegion(int x, int y, int w, int h, int wave,
   }
 }
 
+void EinkRefreshHelper::queueInkWait(uint32_t marker) {
+  {
+    std::lock_guard<std::mutex> lock(m_inkMutex);
+    m_inkMarkers.push_back(marker);
+  }
+  if (!m_inkWaiter.joinable())
+    m_inkWaiter = std::thread(&EinkRefreshHelper::inkWaitLoop, this);
+  else
+    m_inkCond.notify_one();
+}
+
+void EinkRefreshHelper::inkWaitLoop() {
+  for (;;) {
+    uint32_t marker = 0;
+    {
+      std::unique_lock<std::mutex> lock(m_inkMutex);
+      m_inkCond.wait(lock,
+                     [this] { return m_inkStop || !m_inkMarkers.empty(); });
+      if (m_inkStop)
+        return;
+      marker = m_inkMarkers.front();
+      m_inkMarkers.pop_front();
+    }
+    mxcfb_update_marker_data md{};
+    md.update_marker = marker;
+    if (::ioctl(m_fd, MXCFB_WAIT_FOR_UPDATE_COMPLETE, &md) == 0)
+      InkLatencyTracer::instance().markInkDone(marker);
+  }
+}
+
 void EinkRefreshHelper::resetCounters() {
   m_partialCount = 0;
   m_a2Count = 0;
@@ -3,12 +3,16 @@
 
 #include <QDebug>
 #include <QElapsedTimer>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <fcntl.h>
+#include <mutex>
 #include <stdint.h>
 #include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/sysmacros.h>
+#include <thread>
 #include <unistd.h>
 
 // Smart E-ink refresh helper with waveform selection (KOReader-style).
@@ -38,6 +42,7 @@ public:
   // === 高层 API：根据场景自动选择波形 ===
   void refreshFull(int w, int h);
   void refreshPartial(int x, int y, int w, int h);
+  void refreshPartialGC16(int x, int y, int w, int h);
   void refreshUI(int x, int y, int w, int h);
   void refreshA2(int x, int y, int w, int h);
   void refreshScroll(int w, int h);
@@ -82,12 +87,22 @@ private:
   void triggerRegion(int x, int y, int w, int h, int wave, int mode,
                      bool waitComplete);
   void resetCounters();
+  void queueInkWait(uint32_t marker);
+  void inkWaitLoop();
 
   int m_fd = -1;
   uint32_t m_marker = 0;
   int m_partialCount = 0;
   int m_a2Count = 0;
   QElapsedTimer m_lastRefreshTime;
+
+  // 被追踪翻页的 WAIT_FOR_UPDATE_COMPLETE 交给单个等待线程串行处理；
+  // 析构时先 join 再关 m_fd，等待中的 ioctl 不会碰到已关闭的 fd
+  std::thread m_inkWaiter;
+  std::mutex m_inkMutex;
+  std::condition_variable m_inkCond;
+  std::deque<uint32_t> m_inkMarkers;
+  bool m_inkStop = false;
 };
 
 // 保留旧名称兼容性
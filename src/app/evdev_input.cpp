@@ -0,0 +1,478 @@
+#include "evdev_input.h"
+
+#include <QDebug>
+#include <QStringList>
+#include <QtMath>
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr int kMaxSlots = 16;
+constexpr int kReadBatch = 64;
+
+qint64 eventTimeMs(const input_event &ev) {
+  return static_cast<qint64>(ev.input_event_sec) * 1000 +
+         ev.input_event_usec / 1000;
+}
+} // namespace
+
+const char *InputGesture::kindName(Kind kind) {
+  switch (kind) {
+  case Tap:
+    return "tap";
+  case Hold:
+    return "hold";
+  case HoldDrag:
+    return "hold_drag";
+  case PanMove:
+    return "pan_move";
+  case Swipe:
+    return "swipe";
+  case PanRelease:
+    return "pan_release";
+  case HoldRelease:
+    return "hold_release";
+  }
+  return "?";
+}
+
+// ==================== TouchGestureRecognizer ====================
+
+void TouchGestureRecognizer::down(const QPointF &pos, qint64 tMs) {
+  m_state = Tapping;
+  m_start = pos;
+  m_current = pos;
+  m_lastStep = pos;
+  m_downMs = tMs;
+}
+
+void TouchGestureRecognizer::tick(qint64 tMs) {
+  if (m_state == Tapping && tMs - m_downMs >= kHoldMs) {
+    m_state = Holding;
+    m_lastStep = m_current;
+    emitGesture(InputGesture::Hold, m_current, m_downMs + kHoldMs);
+  }
+}
+
+qint64 TouchGestureRecognizer::holdDeadline() const {
+  return m_state == Tapping ? m_downMs + kHoldMs : -1;
+}
+
+void TouchGestureRecognizer::move(const QPointF &pos, qint64 tMs) {
+  if (m_state == Idle)
+    return;
+  tick(tMs);
+  m_current = pos;
+  const qreal dx = pos.x() - m_start.x();
+  const qreal dy = pos.y() - m_start.y();
+  if (m_state == Tapping &&
+      (qAbs(dx) >= kPanThreshold || qAbs(dy) >= kPanThreshold)) {
+    m_state = Panning;
+    m_lastStep = m_start;
+  }
+  if (m_state == Panning) {
+    // same dominant-axis rule as GestureFilter::getDirection
+    if (qAbs(dy) >= qAbs(dx)) {
+      const qreal step = pos.y() - m_lastStep.y();
+      if (qAbs(step) > kMinStep) {
+        m_lastStep = pos;
+        emitGesture(InputGesture::PanMove, pos, tMs, step);
+      }
+    }
+  } else if (m_state == Holding) {
+    if (qAbs(pos.x() - m_lastStep.x()) >= kMinStep) {
+      m_lastStep = pos;
+      emitGesture(InputGesture::HoldDrag, pos, tMs);
+    }
+  }
+}
+
+void TouchGestureRecognizer::up(const QPointF &pos, qint64 tMs) {
+  if (m_state == Idle)
+    return;
+  tick(tMs);
+  m_current = pos;
+  const qreal dx = pos.x() - m_start.x();
+  const qreal dy = pos.y() - m_start.y();
+  const State state = m_state;
+  m_state = Idle;
+  switch (state) {
+  case Tapping:
+    // movement past the bounce but short of a pan is neither: drop it,
+    // as GestureFilter does
+    if (qAbs(dx) < kTapBounce && qAbs(dy) < kTapBounce)
+      emitGesture(InputGesture::Tap, pos, tMs);
+    break;
+  case Panning: {
+    const bool fast = tMs - m_downMs < kSwipeIntervalMs &&
+                      qSqrt(dx * dx + dy * dy) >= kSwipeMinDistance;
+    emitGesture(fast ? InputGesture::Swipe : InputGesture::PanRelease, pos,
+                tMs);
+    break;
+  }
+  case Holding:
+    emitGesture(InputGesture::HoldRelease, pos, tMs);
+    break;
+  case Idle:
+    break;
+  }
+}
+
+void TouchGestureRecognizer::emitGesture(InputGesture::Kind kind,
+                                         const QPointF &pos, qint64 tMs,
+                                         qreal delta) {
+  if (!m_sink)
+    return;
+  InputGesture g;
+  g.kind = kind;
+  g.start = m_start;
+  g.pos = pos;
+  g.delta = delta;
+  g.durationMs = tMs - m_downMs;
+  g.eventMs = tMs;
+  m_sink(g);
+}
+
+// ==================== EvdevInputThread ====================
+
+EvdevInputThread::EvdevInputThread(const QString &path, int width, int height,
+                                   QObject *parent)
+    : QObject(parent), m_path(path), m_width(width), m_height(height) {
+  const QStringList transform =
+      QString::fromLatin1(qgetenv("WEREAD_EVDEV_TRANSFORM"))
+          .split(QLatin1Char(','), Qt::SkipEmptyParts);
+  m_swapXY = transform.contains(QStringLiteral("swapxy"));
+  m_invX = transform.contains(QStringLiteral("invx"));
+  m_invY = transform.contains(QStringLiteral("invy"));
+}
+
+EvdevInputThread::~EvdevInputThread() {
+  stop();
+  if (m_fd >= 0)
+    ::close(m_fd);
+  if (m_wakeFd >= 0)
+    ::close(m_wakeFd);
+  if (m_stopFd >= 0)
+    ::close(m_stopFd);
+}
+
+qint64 EvdevInputThread::monotonicMs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<qint64>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+bool EvdevInputThread::start() {
+  if (running())
+    return true;
+  const QByteArray native = m_path.toLocal8Bit();
+  struct stat st;
+  if (::stat(native.constData(), &st) != 0) {
+    qWarning() << "[EVDEV] cannot stat" << m_path << strerror(errno);
+    return false;
+  }
+  m_device = S_ISCHR(st.st_mode);
+  m_regularFile = S_ISREG(st.st_mode);
+  m_fd = ::open(native.constData(),
+                O_RDONLY | O_CLOEXEC | (m_regularFile ? 0 : O_NONBLOCK));
+  if (m_fd < 0) {
+    qWarning() << "[EVDEV] cannot open" << m_path << strerror(errno);
+    return false;
+  }
+
+  m_minX = m_minY = 0;
+  m_maxX = m_width;
+  m_maxY = m_height;
+  if (m_device) {
+    input_absinfo ax{}, ay{};
+    if ((ioctl(m_fd, EVIOCGABS(ABS_MT_POSITION_X), &ax) == 0 &&
+         ioctl(m_fd, EVIOCGABS(ABS_MT_POSITION_Y), &ay) == 0 &&
+         ax.maximum > ax.minimum) ||
+        (ioctl(m_fd, EVIOCGABS(ABS_X), &ax) == 0 &&
+         ioctl(m_fd, EVIOCGABS(ABS_Y), &ay) == 0 && ax.maximum > ax.minimum)) {
+      m_minX = ax.minimum;
+      m_maxX = ax.maximum;
+      m_minY = ay.minimum;
+      m_maxY = ay.maximum;
+    }
+    // event timestamps on the same clock as monotonicMs()
+    int clockId = CLOCK_MONOTONIC;
+    ioctl(m_fd, EVIOCSCLOCKID, &clockId);
+  } else {
+    const QList<QByteArray> range = qgetenv("WEREAD_EVDEV_RANGE").split(',');
+    if (range.size() == 2 && range[0].toInt() > 0 && range[1].toInt() > 0) {
+      m_maxX = range[0].toInt();
+      m_maxY = range[1].toInt();
+    }
+  }
+
+  m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  m_stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_wakeFd < 0 || m_stopFd < 0) {
+    qWarning() << "[EVDEV] eventfd failed" << strerror(errno);
+    return false;
+  }
+  m_notifier = new QSocketNotifier(m_wakeFd, QSocketNotifier::Read, this);
+  connect(m_notifier, &QSocketNotifier::activated, this,
+          &EvdevInputThread::drain);
+
+  qInfo() << "[EVDEV] reading" << m_path
+          << (m_device        ? "device"
+              : m_regularFile ? "file"
+                              : "stream")
+          << "range" << m_minX << m_maxX << m_minY << m_maxY << "transform"
+          << (m_swapXY ? "swapxy" : "") << (m_invX ? "invx" : "")
+          << (m_invY ? "invy" : "") << "paced" << m_paced;
+  m_thread = std::thread([this]() { run(); });
+  return true;
+}
+
+void EvdevInputThread::stop() {
+  if (!m_thread.joinable())
+    return;
+  const quint64 one = 1;
+  if (::write(m_stopFd, &one, sizeof(one)) < 0)
+    qWarning() << "[EVDEV] stop signal failed" << strerror(errno);
+  m_thread.join();
+  drain();
+  const Stats s = stats();
+  qInfo() << "[EVDEV] stopped events" << s.events << "gestures" << s.gestures
+          << "dropped" << s.dropped << "maxDepth" << s.maxDepth << "maxRingMs"
+          << s.maxRingMs;
+}
+
+EvdevInputThread::Stats EvdevInputThread::stats() const {
+  Stats s;
+  s.events = m_events.load(std::memory_order_relaxed);
+  s.gestures = m_pushed.load(std::memory_order_relaxed);
+  s.dropped = m_dropped.load(std::memory_order_relaxed);
+  s.maxDepth = m_maxDepth;
+  s.maxRingMs = m_maxRingMs;
+  return s;
+}
+
+QPointF EvdevInputThread::map(int rawX, int rawY) const {
+  qreal nx = m_maxX > m_minX ? qreal(rawX - m_minX) / (m_maxX - m_minX) : 0;
+  qreal ny = m_maxY > m_minY ? qreal(rawY - m_minY) / (m_maxY - m_minY) : 0;
+  if (m_swapXY)
+    std::swap(nx, ny);
+  if (m_invX)
+    nx = 1.0 - nx;
+  if (m_invY)
+    ny = 1.0 - ny;
+  return QPointF(qBound<qreal>(0, nx, 1) * m_width,
+                 qBound<qreal>(0, ny, 1) * m_height);
+}
+
+int EvdevInputThread::waitFor(qint64 deadlineMs, bool watchSource) {
+  pollfd fds[2] = {{m_stopFd, POLLIN, 0}, {m_fd, POLLIN, 0}};
+  for (;;) {
+    int timeout = -1;
+    if (deadlineMs >= 0)
+      timeout = int(qMax<qint64>(0, deadlineMs - monotonicMs()));
+    const int rc = ::poll(fds, watchSource ? 2 : 1, timeout);
+    if (rc < 0) {
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+    if (fds[0].revents)
+      return -1;
+    if (rc == 0)
+      return 0;
+    if (fds[1].revents & (POLLERR | POLLNVAL))
+      return -1;
+    return 1;
+  }
+}
+
+void EvdevInputThread::post(const InputGesture &g) {
+  InputGesture out = g;
+  out.postedMs = monotonicMs();
+  if (!m_ring.push(out)) {
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  m_pushed.fetch_add(1, std::memory_order_relaxed);
+  wake();
+}
+
+void EvdevInputThread::wake() {
+  // one eventfd write per drain: the GUI clears the flag before popping
+  if (m_wakePending.exchange(true, std::memory_order_acq_rel))
+    return;
+  const quint64 one = 1;
+  if (::write(m_wakeFd, &one, sizeof(one)) < 0)
+    m_wakePending.store(false, std::memory_order_release);
+}
+
+void EvdevInputThread::drain() {
+  quint64 counter = 0;
+  if (m_wakeFd >= 0 && ::read(m_wakeFd, &counter, sizeof(counter)) < 0 &&
+      errno != EAGAIN) {
+    qWarning() << "[EVDEV] wake read failed" << strerror(errno);
+  }
+  m_wakePending.store(false, std::memory_order_release);
+  m_maxDepth = qMax<quint64>(m_maxDepth, m_ring.size());
+  InputGesture g;
+  while (m_ring.pop(g)) {
+    m_maxRingMs = qMax(m_maxRingMs, monotonicMs() - g.postedMs);
+    emit gesture(g);
+  }
+}
+
+void EvdevInputThread::run() {
+  TouchGestureRecognizer recognizer(
+      [this](const InputGesture &g) { post(g); });
+
+  int slotX[kMaxSlots] = {};
+  int slotY[kMaxSlots] = {};
+  int slot = 0;
+  int tracked = -1; // slot of the contact being recognized
+  bool sawMt = false;
+  bool contact = false;
+  bool pendingDown = false, pendingUp = false, moved = false;
+  qint64 fileBaseMs = -1;
+  qint64 monoBaseMs = 0;
+
+  bool stopping = false;
+  input_event batch[kReadBatch];
+  while (!stopping) {
+    if (!m_regularFile) {
+      const int w = waitFor(recognizer.holdDeadline(), true);
+      if (w < 0)
+        break;
+      if (w == 0) {
+        recognizer.tick(monotonicMs());
+        continue;
+      }
+    }
+    const ssize_t n = ::read(m_fd, batch, sizeof(batch));
+    if (n < 0) {
+      if (errno == EAGAIN || errno == EINTR)
+        continue;
+      qWarning() << "[EVDEV] read failed" << strerror(errno);
+      break;
+    }
+    if (n == 0) {
+      if (!m_regularFile) {
+        // writer closed the FIFO
+        waitFor(-1, false);
+      }
+      break;
+    }
+    const int count = int(n / sizeof(input_event));
+    m_events.fetch_add(count, std::memory_order_relaxed);
+    for (int i = 0; i < count && !stopping; ++i) {
+      const input_event &ev = batch[i];
+      if (ev.type == EV_ABS) {
+        switch (ev.code) {
+        case ABS_MT_SLOT:
+          slot = ev.value;
+          break;
+        case ABS_MT_TRACKING_ID:
+          sawMt = true;
+          if (ev.value >= 0 && tracked < 0 && slot >= 0 && slot < kMaxSlots) {
+            tracked = slot;
+            pendingDown = true;
+          } else if (ev.value < 0 && slot == tracked) {
+            pendingUp = true;
+          }
+          break;
+        case ABS_MT_POSITION_X:
+        case ABS_MT_POSITION_Y:
+          sawMt = true;
+          if (slot >= 0 && slot < kMaxSlots) {
+            (ev.code == ABS_MT_POSITION_X ? slotX : slotY)[slot] = ev.value;
+            moved |= slot == tracked;
+          }
+          break;
+        case ABS_X:
+        case ABS_Y:
+          // MT devices mirror the first contact here; the slots win
+          if (!sawMt) {
+            (ev.code == ABS_X ? slotX : slotY)[0] = ev.value;
+            moved = true;
+          }
+          break;
+        default:
+          break;
+        }
+      } else if (ev.type == EV_KEY && ev.code == BTN_TOUCH && !sawMt) {
+        if (ev.value && tracked < 0) {
+          tracked = 0;
+          pendingDown = true;
+        } else if (!ev.value && tracked == 0) {
+          pendingUp = true;
+        }
+      } else if (ev.type == EV_SYN && ev.code == SYN_DROPPED) {
+        // the kernel buffer overflowed: the contact's state is unknown
+        recognizer.cancel();
+        contact = false;
+        tracked = -1;
+        pendingDown = pendingUp = moved = false;
+      } else if (ev.type == EV_SYN && ev.code == SYN_REPORT) {
+        qint64 tMs;
+        if (m_regularFile) {
+          // replay on the monotonic clock, keeping the recorded spacing
+          if (fileBaseMs < 0) {
+            fileBaseMs = eventTimeMs(ev);
+            monoBaseMs = monotonicMs();
+          }
+          tMs = monoBaseMs + (eventTimeMs(ev) - fileBaseMs);
+          while (m_paced) {
+            const qint64 hold = recognizer.holdDeadline();
+            const bool holdFirst = hold >= 0 && hold < tMs;
+            const int w = waitFor(holdFirst ? hold : tMs, false);
+            if (w < 0) {
+              stopping = true;
+              break;
+            }
+            if (!holdFirst)
+              break;
+            recognizer.tick(hold);
+          }
+          if (stopping)
+            break;
+        } else {
+          tMs = m_device ? eventTimeMs(ev) : monotonicMs();
+        }
+        if (tracked >= 0) {
+          const QPointF pos = map(slotX[tracked], slotY[tracked]);
+          if (pendingDown) {
+            recognizer.down(pos, tMs);
+            contact = true;
+          } else if (moved && contact) {
+            recognizer.move(pos, tMs);
+          }
+          if (pendingUp) {
+            if (contact)
+              recognizer.up(pos, tMs);
+            contact = false;
+            tracked = -1;
+          }
+        }
+        pendingDown = pendingUp = moved = false;
+      }
+    }
+  }
+  if (m_regularFile) {
+    m_finished.store(true, std::memory_order_release);
+    QMetaObject::invokeMethod(
+        this,
+        [this]() {
+          drain();
+          emit sourceFinished();
+        },
+        Qt::QueuedConnection);
+  }
+}
@@ -0,0 +1,164 @@
+#ifndef EVDEV_INPUT_H
+#define EVDEV_INPUT_H
+
+#include <QObject>
+#include <QPointF>
+#include <QSocketNotifier>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include "spsc_ring.h"
+
+// One recognized gesture, in window coordinates. Times are CLOCK_MONOTONIC
+// milliseconds so the GUI can tell how long a gesture spent in recognition
+// (postedMs - eventMs) and in the ring (drain time - postedMs).
+struct InputGesture {
+  enum Kind : quint8 {
+    Tap,         // lift within the tap bounce, before the hold threshold
+    Hold,        // contact held still for kHoldMs (finger still down)
+    HoldDrag,    // movement after Hold; pos is the current point
+    PanMove,     // vertical pan step; delta is y moved since the last step
+    Swipe,       // fast pan lift: under kSwipeIntervalMs and kSwipeMinDistance
+    PanRelease,  // slow pan lift
+    HoldRelease, // lift after Hold
+  };
+  Kind kind = Tap;
+  QPointF start;
+  QPointF pos;
+  qreal delta = 0;
+  qint64 durationMs = 0; // contact down -> the event that produced this
+  qint64 eventMs = 0;
+  qint64 postedMs = 0;
+
+  static const char *kindName(Kind kind);
+};
+
+// Tap/pan/swipe/hold classification for a single contact. Thresholds mirror
+// GestureFilter's KOReader values so both backends classify alike. Time is
+// whatever the caller feeds in (event timestamps), so the same code runs on
+// the input thread and in offline replays. Not thread-safe; owned by one
+// thread.
+class TouchGestureRecognizer {
+public:
+  static constexpr qreal kPanThreshold = 50.0;
+  static constexpr qreal kTapBounce = 40.0;
+  static constexpr qreal kSwipeMinDistance = 100.0;
+  static constexpr qint64 kSwipeIntervalMs = 900;
+  static constexpr qint64 kHoldMs = 500;
+  // pan/hold-drag steps smaller than this are coalesced into the next one
+  static constexpr qreal kMinStep = 5.0;
+
+  using Sink = std::function<void(const InputGesture &)>;
+
+  explicit TouchGestureRecognizer(Sink sink) : m_sink(std::move(sink)) {}
+
+  void down(const QPointF &pos, qint64 tMs);
+  void move(const QPointF &pos, qint64 tMs);
+  void up(const QPointF &pos, qint64 tMs);
+  // Fire the hold transition once tMs reaches holdDeadline().
+  void tick(qint64 tMs);
+  // Forget the current contact without emitting anything (SYN_DROPPED).
+  void cancel() { m_state = Idle; }
+  // Time at which tick() would emit Hold, or -1 when no hold is pending.
+  qint64 holdDeadline() const;
+  bool active() const { return m_state != Idle; }
+
+private:
+  enum State { Idle, Tapping, Panning, Holding };
+
+  void emitGesture(InputGesture::Kind kind, const QPointF &pos, qint64 tMs,
+                   qreal delta = 0);
+
+  Sink m_sink;
+  State m_state = Idle;
+  QPointF m_start;
+  QPointF m_current;
+  QPointF m_lastStep;
+  qint64 m_downMs = 0;
+};
+
+// Optional touch backend: reads a Linux evdev stream on its own thread, runs
+// TouchGestureRecognizer there and hands only the recognized gestures to the
+// GUI thread through a lock-free SPSC ring, waking it with an eventfd.
+//
+// The source may be an evdev node (/dev/input/eventN; absolute ranges are
+// read with EVIOCGABS and mapped onto the window), a FIFO that another
+// process writes raw struct input_event records into, or a regular file of
+// such records (a capture made with `cat /dev/input/eventN > file`). FIFOs
+// and files carry window coordinates unless WEREAD_EVDEV_RANGE=maxX,maxY is
+// set. Files are replayed at their recorded pace unless setPaced(false).
+// WEREAD_EVDEV_TRANSFORM takes a comma list of swapxy, invx, invy, applied
+// in that order after normalisation.
+//
+// Only the first contact (multitouch slot or single-touch BTN_TOUCH) is
+// tracked; further fingers are ignored until it lifts.
+class EvdevInputThread : public QObject {
+  Q_OBJECT
+public:
+  struct Stats {
+    quint64 events = 0;   // raw input_event records read
+    quint64 gestures = 0; // pushed into the ring
+    quint64 dropped = 0;  // ring full
+    quint64 maxDepth = 0; // deepest ring seen at drain time
+    qint64 maxRingMs = 0; // worst posted -> drained
+  };
+
+  EvdevInputThread(const QString &path, int width, int height,
+                   QObject *parent = nullptr);
+  ~EvdevInputThread() override;
+
+  void setPaced(bool paced) { m_paced = paced; }
+  bool start();
+  void stop();
+  bool running() const { return m_thread.joinable(); }
+  // True once the reader hit end of file (regular files only).
+  bool finished() const { return m_finished.load(std::memory_order_acquire); }
+  Stats stats() const;
+  QString path() const { return m_path; }
+
+  static qint64 monotonicMs();
+
+signals:
+  void gesture(const InputGesture &g);
+  void sourceFinished();
+
+private:
+  static constexpr std::size_t kRingSize = 256;
+
+  void run();
+  void drain();
+  void post(const InputGesture &g);
+  void wake();
+  // -1: stop requested, 0: deadline reached, 1: source readable
+  int waitFor(qint64 deadlineMs, bool watchSource);
+  QPointF map(int rawX, int rawY) const;
+
+  QString m_path;
+  int m_width;
+  int m_height;
+  bool m_paced = true;
+  int m_fd = -1;
+  int m_wakeFd = -1;
+  int m_stopFd = -1;
+  bool m_device = false;      // character device: EVIOCG* ranges, event clock
+  bool m_regularFile = false; // capture file: replayed by timestamp
+  // raw axis ranges: [min, max] per axis, mapped onto the window
+  int m_minX = 0, m_maxX = 0, m_minY = 0, m_maxY = 0;
+  bool m_swapXY = false, m_invX = false, m_invY = false;
+
+  std::thread m_thread;
+  SpscRing<InputGesture, kRingSize> m_ring;
+  std::atomic<bool> m_wakePending{false};
+  std::atomic<bool> m_finished{false};
+  std::atomic<quint64> m_events{0};
+  std::atomic<quint64> m_pushed{0};
+  std::atomic<quint64> m_dropped{0};
+  quint64 m_maxDepth = 0; // GUI side only
+  qint64 m_maxRingMs = 0; // GUI side only
+  QSocketNotifier *m_notifier = nullptr;
+};
+
+#endif // EVDEV_INPUT_H
@@ -0,0 +1,205 @@
+#include "frame_capture.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QMutexLocker>
+#include <QPainter>
+#include <utility>
+
+#include "common.h"
+
+namespace {
+// Null rect means "full frame"; merging anything with full stays full.
+QRect mergeDamage(const QRect &a, const QRect &b) {
+  if (a.isNull() || b.isNull())
+    return QRect();
+  return a.united(b);
+}
+} // namespace
+
+void FrameTripleBuffer::reset(int width, int height, QImage::Format format) {
+  QMutexLocker lock(&m_mutex);
+  for (Slot &slot : m_slots) {
+    slot.image = QImage(width, height, format);
+    slot.image.fill(Qt::white);
+    slot.damage = QRect();
+  }
+  m_back = 0;
+  m_ready = 1;
+  m_front = 2;
+  m_fresh = false;
+  m_dropped = 0;
+}
+
+void FrameTripleBuffer::commitBack() {
+  QMutexLocker lock(&m_mutex);
+  if (m_fresh) {
+    // Consumer has not picked up the previous frame: drop it but keep its
+    // damage so the published frame still covers every changed area.
+    ++m_dropped;
+    m_slots[m_back].damage =
+        mergeDamage(m_slots[m_back].damage, m_slots[m_ready].damage);
+  }
+  std::swap(m_back, m_ready);
+  m_fresh = true;
+}
+
+bool FrameTripleBuffer::acquireFront() {
+  QMutexLocker lock(&m_mutex);
+  if (!m_fresh)
+    return false;
+  std::swap(m_front, m_ready);
+  m_fresh = false;
+  return true;
+}
+
+quint64 FrameTripleBuffer::droppedFrames() const {
+  QMutexLocker lock(&m_mutex);
+  return m_dropped;
+}
+
+FramePublishWorker::FramePublishWorker(FrameTripleBuffer *buffer,
+                                       QObject *parent)
+    : QObject(parent), m_buffer(buffer),
+      m_quantizer(EinkQuantizer::optionsFromEnv()) {
+  if (m_quantizer.options().enabled) {
+    qInfo() << "[FRAME] eink quantize enabled dither"
+            << m_quantizer.options().dither << "snap"
+            << m_quantizer.options().snapMargin;
+  }
+}
+
+bool FramePublishWorker::init(const QString &path) {
+  return m_writer.init(path);
+}
+
+QSize FramePublishWorker::frameSize() const {
+  return QSize(m_writer.width(), m_writer.height());
+}
+
+void FramePublishWorker::drain() {
+  while (m_buffer && m_buffer->acquireFront()) {
+    FrameTripleBuffer::Slot &slot = m_buffer->front();
+    QElapsedTimer timer;
+    timer.start();
+    // front slot is owned by this thread until the next acquire, so the
+    // quantizer may rewrite it in place
+    EinkQuantizer::Result quant;
+    if (m_quantizer.options().enabled)
+      quant = m_quantizer.process(slot.image, slot.damage);
+    m_writer.publish(slot.image, slot.damage, quant.contentClass);
+    ++m_published;
+    if (logLevelAtLeast(LogLevel::Info)) {
+      qInfo() << "[FRAME] published" << m_published << "damage"
+              << (slot.damage.isNull() ? QStringLiteral("full")
+                                       : QStringLiteral("%1,%2 %3x%4")
+                                             .arg(slot.damage.x())
+                                             .arg(slot.damage.y())
+                                             .arg(slot.damage.width())
+                                             .arg(slot.damage.height()))
+              << "class" << quant.contentClass << "dithered"
+              << quant.ditheredTiles << "ms" << timer.elapsed() << "dropped"
+              << m_buffer->droppedFrames();
+    }
+  }
+}
+
+FrameCapturePipeline::FrameCapturePipeline(QWidget *source, QObject *parent)
+    : QObject(parent), m_source(source) {
+  m_captureTimer.setSingleShot(true);
+  connect(&m_captureTimer, &QTimer::timeout, this,
+          &FrameCapturePipeline::captureNow);
+}
+
+FrameCapturePipeline::~FrameCapturePipeline() {
+  m_active = false;
+  m_captureTimer.stop();
+  if (m_thread.isRunning()) {
+    m_thread.quit();
+    m_thread.wait();
+  }
+}
+
+bool FrameCapturePipeline::enabledForPlatform() {
+  if (qEnvironmentVariableIsSet("WEREAD_FRAME_CAPTURE"))
+    return qEnvironmentVariableIntValue("WEREAD_FRAME_CAPTURE") != 0;
+  return QGuiApplication::platformName().startsWith(
+      QLatin1String("offscreen"));
+}
+
+bool FrameCapturePipeline::start(const QString &path) {
+  if (m_active)
+    return true;
+  m_worker = new FramePublishWorker(&m_buffer);
+  if (!m_worker->init(path)) {
+    qWarning() << "[FRAME] capture disabled: shm init failed" << path;
+    delete m_worker;
+    m_worker = nullptr;
+    return false;
+  }
+  const QSize size = m_worker->frameSize();
+  // RGB32 shares ARGB32's byte layout, so the worker copies without converting
+  m_buffer.reset(size.width(), size.height(), QImage::Format_RGB32);
+  m_worker->moveToThread(&m_thread);
+  connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+  connect(this, &FrameCapturePipeline::frameQueued, m_worker,
+          &FramePublishWorker::drain, Qt::QueuedConnection);
+  m_thread.setObjectName(QStringLiteral("FramePublish"));
+  m_thread.start(QThread::LowPriority);
+  m_active = true;
+  qInfo() << "[FRAME] capture pipeline started" << path << "size" << size;
+  return true;
+}
+
+void FrameCapturePipeline::noteDamage(const QRect &region, int delayMs) {
+  if (!m_active)
+    return;
+  if (region.isNull())
+    m_pendingFull = true;
+  else
+    m_pendingDamage = m_pendingDamage.united(region);
+  const int delay = qMax(0, delayMs);
+  // Keep an earlier deadline; a burst of refreshes collapses into one grab
+  if (m_captureTimer.isActive() && m_captureTimer.remainingTime() <= delay)
+    return;
+  m_captureTimer.start(delay);
+}
+
+void FrameCapturePipeline::cancel() {
+  m_captureTimer.stop();
+  m_pendingDamage = QRect();
+  m_pendingFull = false;
+}
+
+void FrameCapturePipeline::captureNow() {
+  m_captureTimer.stop();
+  if (!m_active || !m_source)
+    return;
+  QElapsedTimer timer;
+  timer.start();
+  FrameTripleBuffer::Slot &slot = m_buffer.back();
+  const QSize target = slot.image.size();
+  const QSize sourceSize = m_source->size();
+  const bool scaled = !sourceSize.isEmpty() && sourceSize != target;
+  {
+    QPainter painter(&slot.image);
+    if (scaled) {
+      painter.scale(static_cast<qreal>(target.width()) / sourceSize.width(),
+                    static_cast<qreal>(target.height()) / sourceSize.height());
+    }
+    m_source->render(&painter);
+  }
+  const bool full = m_pendingFull || m_pendingDamage.isNull() || scaled;
+  slot.damage = full ? QRect()
+                     : m_pendingDamage.intersected(QRect(QPoint(0, 0), target));
+  m_pendingDamage = QRect();
+  m_pendingFull = false;
+  m_buffer.commitBack();
+  ++m_captured;
+  if (logLevelAtLeast(LogLevel::Info)) {
+    qInfo() << "[FRAME] captured" << m_captured << "full" << full
+            << "renderMs" << timer.elapsed();
+  }
+  emit frameQueued();
+}
@@ -0,0 +1,111 @@
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QPointer>
+#include <QRect>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+#include <QWidget>
+
+#include "eink_quantize.h"
+#include "shm_writer.h"
+
+// ============================================================================
+// Offscreen frame capture (QT_QPA_PLATFORM=offscreen fallback path)
+// GUI thread renders the window into a pre-allocated slot only when a refresh
+// signals damage; the publish worker converts and copies into /dev/shm.
+// ============================================================================
+
+// Triple buffer between one producer (GUI) and one consumer (worker).
+// Producer owns `back`, consumer owns `front`, `ready` holds the newest
+// completed frame. Neither side ever waits for the other; an unconsumed
+// frame is overwritten and its damage merged into the newer one.
+class FrameTripleBuffer {
+public:
+  struct Slot {
+    QImage image;
+    QRect damage; // null = full frame
+  };
+
+  void reset(int width, int height, QImage::Format format);
+
+  // Producer side (GUI thread)
+  Slot &back() { return m_slots[m_back]; }
+  void commitBack();
+
+  // Consumer side (worker thread)
+  bool acquireFront();
+  Slot &front() { return m_slots[m_front]; }
+
+  quint64 droppedFrames() const;
+
+private:
+  Slot m_slots[3];
+  int m_back = 0;
+  int m_ready = 1;
+  int m_front = 2;
+  bool m_fresh = false;
+  quint64 m_dropped = 0;
+  mutable QMutex m_mutex;
+};
+
+class FramePublishWorker : public QObject {
+  Q_OBJECT
+public:
+  explicit FramePublishWorker(FrameTripleBuffer *buffer,
+                              QObject *parent = nullptr);
+
+  bool init(const QString &path);
+  QSize frameSize() const;
+
+public slots:
+  void drain();
+
+private:
+  FrameTripleBuffer *m_buffer = nullptr;
+  ShmFrameWriter m_writer;
+  EinkQuantizer m_quantizer; // optional 16-level pre-quantization
+  quint64 m_published = 0;
+};
+
+class FrameCapturePipeline : public QObject {
+  Q_OBJECT
+public:
+  explicit FrameCapturePipeline(QWidget *source, QObject *parent = nullptr);
+  ~FrameCapturePipeline() override;
+
+  // offscreen platform, or forced via WEREAD_FRAME_CAPTURE=1 (0 disables)
+  static bool enabledForPlatform();
+
+  bool start(const QString &path = QStringLiteral("/dev/shm/weread_frame"));
+  bool isActive() const { return m_active; }
+
+  // Damage from a refresh decision; coalesced into one grab after delayMs.
+  void noteDamage(const QRect &region, int delayMs = kDamageSettleMs);
+  void cancel();
+  void captureNow();
+
+  quint64 capturedFrames() const { return m_captured; }
+
+signals:
+  void frameQueued();
+
+private:
+  static constexpr int kDamageSettleMs = 60;
+
+  QPointer<QWidget> m_source;
+  FrameTripleBuffer m_buffer;
+  QThread m_thread;
+  FramePublishWorker *m_worker = nullptr;
+  QTimer m_captureTimer;
+  QRect m_pendingDamage;
+  bool m_pendingFull = false;
+  bool m_active = false;
+  quint64 m_captured = 0;
+};
+
+#endif // FRAME_CAPTURE_H
@@ -1,6 +1,10 @@
 #include "gesture_filter.h"
+#include "common.h"
+#include "ink_latency_tracer.h"
+#include "page_turn_controller.h"
 #include <QCoreApplication>
 #include <QDateTime>
+#include <QtMath>
 
 namespace {
 const char *eventTypeName(QEvent::Type type) {
@@ -36,49 +40,112 @@ bool isMouseEventType(QEvent::Type type) {
 bool isPointerEventType(QEvent::Type type) {
   return isTouchEventType(type) || isMouseEventType(type);
 }
-
-bool extractEventPos(QEvent *ev, QPointF *pos) {
-  if (!ev || !pos)
-    return false;
-  switch (ev->type()) {
-  case QEvent::MouseButtonPress:
-  case QEvent::MouseButtonRelease:
-  case QEvent::MouseMove:
-  case QEvent::MouseButtonDblClick: {
-    auto *me = static_cast<QMouseEvent *>(ev);
-    *pos = me->position();
-    return true;
-  }
-  case QEvent::TouchBegin:
-  case QEvent::TouchUpdate:
-  case QEvent::TouchEnd: {
-    auto *te = static_cast<QTouchEvent *>(ev);
-    if (te->points().isEmpty())
-      return false;
-    *pos = te->points().first().position();
-    return true;
-  }
-  default:
-    return false;
-  }
-}
 } // namespace
 
-GestureFilter::GestureFilter(WereadBrowser *browser, QObject *parent)
+GestureFilter::GestureFilter(GestureTarget *browser, QObject *parent)
     : QObject(parent), m_browser(browser), m_windowHeight(1696) {
   // Hold 定时器：500ms 后触发长按 (参考 KOReader HOLD_INTERVAL_MS = 500)
   m_holdTimer.setSingleShot(true);
   m_holdTimer.setInterval(HOLD_INTERVAL_MS);
   connect(&m_holdTimer, &QTimer::timeout, this, &GestureFilter::onHoldTimeout);
   m_verboseLogs = logLevelAtLeast(LogLevel::Info);
+  m_speculativeTurns =
+      qEnvironmentVariableIntValue("WEREAD_SPECULATIVE_TURN") == 1;
   m_eventClock.start();
 }
 
+GestureFilter::~GestureFilter() { stopTouchTrace(); }
+
 void GestureFilter::setWindowHeight(int height) {
   m_windowHeight = height;
   qInfo() << "[GESTURE] Window height set to" << m_windowHeight;
 }
 
+void GestureFilter::setClock(Clock clock) {
+  m_clock = std::move(clock);
+  m_holdTimer.stop();
+}
+
+void GestureFilter::pollHoldTimer() {
+  if (m_holdDeadlineMs >= 0 && clockMs() >= m_holdDeadlineMs)
+    onHoldTimeout();
+}
+
+qint64 GestureFilter::clockMs() const {
+  if (m_clock)
+    return m_clock();
+  return m_eventClock.isValid() ? m_eventClock.elapsed() : 0;
+}
+
+qint64 GestureFilter::contactElapsedMs() const {
+  return m_contactDownMs >= 0 ? clockMs() - m_contactDownMs : 0;
+}
+
+void GestureFilter::startHoldTimer() {
+  m_holdDeadlineMs = clockMs() + HOLD_INTERVAL_MS;
+  // 虚拟时钟下由 pollHoldTimer() 驱动
+  if (!m_clock)
+    m_holdTimer.start();
+}
+
+void GestureFilter::stopHoldTimer() {
+  m_holdDeadlineMs = -1;
+  m_holdTimer.stop();
+}
+
+bool GestureFilter::startTouchTrace(const QString &path) {
+  stopTouchTrace();
+  auto writer = std::make_unique<TouchTraceWriter>();
+  if (!writer->open(path)) {
+    qWarning() << "[TOUCH_TRACE] cannot open" << path;
+    return false;
+  }
+  m_trace = std::move(writer);
+  m_traceStartMs = clockMs();
+  qInfo() << "[TOUCH_TRACE] recording to" << path;
+  return true;
+}
+
+void GestureFilter::stopTouchTrace() {
+  if (!m_trace)
+    return;
+  m_trace->close();
+  qInfo() << "[TOUCH_TRACE] stopped," << m_trace->count() << "events";
+  m_trace.reset();
+}
+
+void GestureFilter::recordTraceState(TouchTraceEvent *sample,
+                                     qint64 nowMs) const {
+  // 页面状态和浏览器侧判定一并记下，回放时由桩浏览器原样回答
+  const qint64 nowWallMs =
+      m_clock ? nowMs : QDateTime::currentMSecsSinceEpoch();
+  const QPointF pos = sample->pos();
+  quint16 flags = 0;
+  if (m_browser->isWeReadBook())
+    flags |= TouchTraceEvent::WeReadBook;
+  if (m_browser->isDedaoBook())
+    flags |= TouchTraceEvent::DedaoBook;
+  if (m_browser->isWeReadKindleMode())
+    flags |= TouchTraceEvent::WeReadKindle;
+  if (m_browser->isKindleUA())
+    flags |= TouchTraceEvent::KindleUA;
+  if (m_browser->catalogRect().contains(pos.toPoint()))
+    flags |= TouchTraceEvent::CatalogHit;
+  if (m_browser->menuRect().contains(sample->globalPos().toPoint()))
+    flags |= TouchTraceEvent::MenuHit;
+  const QEvent::Type type = static_cast<QEvent::Type>(sample->type);
+  if (isTouchEventType(type)) {
+    if (m_browser->shouldBypassGestureForInjectedTouch(pos, nowWallMs))
+      flags |= TouchTraceEvent::InjectedBypass;
+  } else {
+    if (m_browser->shouldBypassGestureForInjectedMouse(pos, nowWallMs))
+      flags |= TouchTraceEvent::InjectedBypass;
+    if (m_browser->shouldReplayInjectedMouse(pos, nowWallMs))
+      flags |= TouchTraceEvent::InjectedReplay;
+  }
+  sample->flags |= flags;
+}
+
 bool GestureFilter::eventFilter(QObject *obj, QEvent *ev) {
   if (!m_browser) {
     qWarning() << "[GESTURE_DEBUG] eventFilter: m_browser is null, event type"
@@ -103,471 +170,256 @@ bool GestureFilter::eventFilter(QObject *obj, QEvent *ev) {
     // QQuickWidget）
     return false;
   }
+  if (!isPointerEventType(type))
+    return false;
 
-  const qint64 nowMs = m_eventClock.isValid() ? m_eventClock.elapsed() : 0;
-  const qint64 nowWallMs = QDateTime::currentMSecsSinceEpoch();
-
+  // 先把事件解码成 TouchTraceEvent：手势判定只看这些字段，录制/回放也以此为准
+  TouchTraceEvent sample;
+  sample.type = static_cast<quint8>(type);
   if (isTouchEventType(type)) {
     auto *te = static_cast<QTouchEvent *>(ev);
-    if (!te->points().isEmpty()) {
-      const QPointF pos = te->points().first().position();
-      if (m_browser &&
-          m_browser->shouldBypassGestureForInjectedTouch(pos, nowWallMs)) {
-        if (m_verboseLogs) {
-          qInfo() << "[GESTURE] pass injected touch event type" << ev->type()
-                  << "pos" << pos;
-        }
-        return false;
+    if (te->points().isEmpty()) {
+      sample.flags |= TouchTraceEvent::NoPoints;
+    } else {
+      const auto &pt = te->points().first();
+      sample.setPos(pt.position(), pt.globalPosition());
+    }
+  } else {
+    auto *me = static_cast<QMouseEvent *>(ev);
+    sample.setPos(me->position(), me->globalPosition());
+    sample.source = static_cast<quint8>(me->source());
+  }
+  if (QWidget *widget = qobject_cast<QWidget *>(obj)) {
+    sample.flags |= TouchTraceEvent::TargetWidget;
+    // 菜单设置了 objectName="weread_menu_overlay"，或者是 CatalogWidget
+    for (QWidget *check = widget; check; check = check->parentWidget()) {
+      if (check->objectName() == QStringLiteral("weread_menu_overlay") ||
+          check->objectName() == QStringLiteral("CatalogWidget")) {
+        sample.flags |= TouchTraceEvent::TargetOverlay;
+        break;
       }
     }
   }
+  const qint64 nowMs = clockMs();
+  if (m_trace) {
+    sample.tMs = static_cast<quint32>(nowMs - m_traceStartMs);
+    recordTraceState(&sample, nowMs);
+    m_trace->append(sample);
+  }
+  return processPointer(sample, nowMs, obj, ev);
+}
 
-  // 忽略我们自己注入的鼠标事件，避免被手势逻辑再次处理
-  if (isMouseEventType(type)) {
-    auto *me = static_cast<QMouseEvent *>(ev);
-    if (me->source() == Qt::MouseEventSynthesizedByApplication) {
-      if (m_browser &&
-          m_browser->shouldReplayInjectedMouse(me->position(), nowWallMs)) {
-        if (m_verboseLogs) {
-          qInfo() << "[GESTURE] replay injected mouse event type" << ev->type()
-                  << "pos" << me->position();
-        }
-        m_browser->noteInjectedMouseReplayed(me->position(), nowWallMs);
-        if (obj) {
-          auto *replay =
-              new QMouseEvent(ev->type(), me->position(), me->position(),
-                              me->globalPosition(), me->button(), me->buttons(),
-                              me->modifiers(), Qt::MouseEventNotSynthesized);
-          QCoreApplication::postEvent(obj, replay);
-        }
-        return true;
-      }
-      if (m_verboseLogs) {
-        qInfo() << "[GESTURE] skip injected mouse event type" << ev->type()
-                << "pos" << me->position();
-      }
-      return false;
+bool GestureFilter::replayEvent(const TouchTraceEvent &sample) {
+  return processPointer(sample, clockMs(), nullptr, nullptr);
+}
+
+bool GestureFilter::processPointer(const TouchTraceEvent &sample, qint64 nowMs,
+                                   QObject *obj, QEvent *ev) {
+  const QEvent::Type type = static_cast<QEvent::Type>(sample.type);
+  const bool hasPos = !(sample.flags & TouchTraceEvent::NoPoints);
+  const QPointF pos = sample.pos();
+  const Qt::MouseEventSource source =
+      static_cast<Qt::MouseEventSource>(sample.source);
+  const qint64 nowWallMs =
+      m_clock ? nowMs : QDateTime::currentMSecsSinceEpoch();
+  m_inputTraceMs = InkLatencyTracer::nowMs();
+
+  if (isTouchEventType(type) && hasPos &&
+      m_browser->shouldBypassGestureForInjectedTouch(pos, nowWallMs)) {
+    if (m_verboseLogs) {
+      qInfo() << "[GESTURE] pass injected touch event type" << type << "pos"
+              << pos;
     }
+    return false;
   }
 
-  if (isMouseEventType(type)) {
-    auto *me = static_cast<QMouseEvent *>(ev);
-    if (m_browser && m_browser->shouldBypassGestureForInjectedMouse(
-                         me->position(), nowWallMs)) {
+  // 忽略我们自己注入的鼠标事件，避免被手势逻辑再次处理
+  if (isMouseEventType(type) &&
+      source == Qt::MouseEventSynthesizedByApplication) {
+    if (m_browser->shouldReplayInjectedMouse(pos, nowWallMs)) {
       if (m_verboseLogs) {
-        qInfo() << "[GESTURE] pass injected mouse event type" << ev->type()
-                << "pos" << me->position();
+        qInfo() << "[GESTURE] replay injected mouse event type" << type
+                << "pos" << pos;
       }
-      return false;
+      m_browser->noteInjectedMouseReplayed(pos, nowWallMs);
+      if (obj && ev) {
+        auto *me = static_cast<QMouseEvent *>(ev);
+        auto *replay =
+            new QMouseEvent(type, me->position(), me->position(),
+                            me->globalPosition(), me->button(), me->buttons(),
+                            me->modifiers(), Qt::MouseEventNotSynthesized);
+        QCoreApplication::postEvent(obj, replay);
+      }
+      return true;
+    }
+    if (m_verboseLogs) {
+      qInfo() << "[GESTURE] skip injected mouse event type" << type << "pos"
+              << pos;
     }
+    return false;
   }
 
-  if (isTouchEventType(type)) {
-    auto *te = static_cast<QTouchEvent *>(ev);
-    if (!te->points().isEmpty()) {
-      noteTouchEvent(te->points().first().position(), nowMs);
+  if (isMouseEventType(type) &&
+      m_browser->shouldBypassGestureForInjectedMouse(pos, nowWallMs)) {
+    if (m_verboseLogs) {
+      qInfo() << "[GESTURE] pass injected mouse event type" << type << "pos"
+              << pos;
     }
+    return false;
   }
 
-  // 检查事件目标是否是菜单或菜单的子控件 - 如果是，拦截事件，防止传递到页面
-  QWidget *widget = qobject_cast<QWidget *>(obj);
-  if (widget) {
-    // 通过对象名检查：菜单设置了 objectName="weread_menu_overlay"
-    // 或者是 CatalogWidget
-    QWidget *check = widget;
-    while (check) {
-      if (check->objectName() == QStringLiteral("weread_menu_overlay") ||
-          check->objectName() == QStringLiteral("CatalogWidget")) {
-        // 对于触摸和鼠标事件，拦截它们，防止传递到页面导致翻页
-        // 注意：返回 false
-        // 让事件正常传递给按钮，但不会传递到页面（因为控件在页面上层）
-        if (isPointerEventType(type)) {
-          qInfo() << "[GESTURE] Event on overlay widget, allowing to widget"
-                     " (not to page), obj="
-                  << obj->metaObject()->className()
-                  << "widgetName=" << check->objectName()
-                  << "type=" << ev->type();
-          // 返回 false 让事件传递给控件
-          return false;
-        }
-        return false;
-      }
-      check = check->parentWidget();
-    }
+  if (isTouchEventType(type) && hasPos) {
+    noteTouchEvent(pos, nowMs);
   }
 
-  // 额外检查：如果 CatalogWidget 可见，且触摸位置在其区域内，拦截事件
-  if (m_browser && m_browser->catalogWidget() &&
-      m_browser->catalogWidget()->isVisible()) {
-    QPointF touchPos;
-    bool hasPos = false;
-    if (isTouchEventType(type)) {
-      auto *te = static_cast<QTouchEvent *>(ev);
-      if (!te->points().isEmpty()) {
-        touchPos = te->points().first().position();
-        hasPos = true;
-      }
-    } else if (isMouseEventType(type)) {
-      auto *me = static_cast<QMouseEvent *>(ev);
-      touchPos = me->position();
-      hasPos = true;
-    }
+  // 检查事件目标是否是菜单或菜单的子控件 - 如果是，让事件正常传递给按钮，
+  // 但不会传递到页面（因为控件在页面上层）
+  if (sample.flags & TouchTraceEvent::TargetOverlay) {
+    qInfo() << "[GESTURE] Event on overlay widget, allowing to widget"
+               " (not to page), obj="
+            << (obj ? obj->metaObject()->className() : "replay")
+            << "type=" << type;
+    return false;
+  }
 
-    if (hasPos) {
-      QRect catalogRect = m_browser->catalogWidget()->geometry();
-      if (catalogRect.contains(touchPos.toPoint())) {
-        qInfo()
-            << "[GESTURE] Touch in CatalogWidget area, forwarding to catalog"
-            << "pos=" << touchPos << "catalogRect=" << catalogRect;
-        // 让事件传递给 CatalogWidget
-        return false;
-      }
-    }
+  // 额外检查：如果 CatalogWidget 可见，且触摸位置在其区域内，放行给目录
+  const QRect catalogRect = m_browser->catalogRect();
+  if (hasPos && !catalogRect.isEmpty() &&
+      catalogRect.contains(pos.toPoint())) {
+    qInfo() << "[GESTURE] Touch in CatalogWidget area, forwarding to catalog"
+            << "pos=" << pos << "catalogRect=" << catalogRect;
+    return false;
   }
 
-  if (m_browser &&
-      (type == QEvent::TouchEnd || type == QEvent::MouseButtonRelease)) {
-    QPointF globalPos;
-    QPointF localPos;
-    bool hasPos = false;
-    if (type == QEvent::TouchEnd) {
-      auto *te = static_cast<QTouchEvent *>(ev);
-      if (!te->points().isEmpty()) {
-        const auto &pt = te->points().first();
-        globalPos = pt.globalPosition();
-        localPos = pt.position();
-        hasPos = true;
-      }
-    } else {
-      auto *me = static_cast<QMouseEvent *>(ev);
-      globalPos = me->globalPosition();
-      localPos = me->position();
-      hasPos = true;
-    }
-    if (hasPos && m_browser->handleMenuTap(globalPos)) {
-      qInfo() << "[MENU] fallback tap handled pos" << localPos;
-      if (m_verboseLogs) {
-        qInfo() << "[GESTURE_DECISION] menu tap handled" << localPos << "type"
-                << eventTypeName(type);
-      }
-      return true;
+  if (hasPos &&
+      (type == QEvent::TouchEnd || type == QEvent::MouseButtonRelease) &&
+      m_browser->handleMenuTap(sample.globalPos())) {
+    qInfo() << "[MENU] fallback tap handled pos" << pos;
+    if (m_verboseLogs) {
+      qInfo() << "[GESTURE_DECISION] menu tap handled" << pos << "type"
+              << eventTypeName(type);
     }
+    return true;
   }
 
   // 检查是否在书籍页面
   const bool isWeReadBook = m_browser->isWeReadBook();
   const bool isDedaoBook = m_browser->isDedaoBook();
-  const bool isDedaoSite = m_browser->isDedaoSite();
   const bool isBookPage = isWeReadBook || isDedaoBook;
 
   // All pages: skip synthesized mouse events when a recent touch exists
-  if (isMouseEventType(type)) {
-    auto *me = static_cast<QMouseEvent *>(ev);
-    if (me->source() == Qt::MouseEventSynthesizedBySystem ||
-        me->source() == Qt::MouseEventSynthesizedByQt) {
-      if (hasRecentTouch(me->position(), nowMs)) {
-        if (m_verboseLogs) {
-          qInfo() << "[GESTURE] skip synthesized mouse event type" << ev->type()
-                  << "pos" << me->position();
-        }
-        return true;
+  if (isMouseEventType(type) && (source == Qt::MouseEventSynthesizedBySystem ||
+                                 source == Qt::MouseEventSynthesizedByQt)) {
+    if (hasRecentTouch(pos, nowMs)) {
+      if (m_verboseLogs) {
+        qInfo() << "[GESTURE] skip synthesized mouse event type" << type
+                << "pos" << pos;
       }
+      return true;
     }
   }
 
   // 如果事件不是发生在菜单控件上，但在书籍页面，检查事件位置是否在菜单区域内
-  // 如果位置在菜单区域内且菜单可见，让事件传递给菜单（不拦截）
-  // 如果位置在菜单区域内但菜单不可见，拦截事件防止页面翻页
-  if (isBookPage && !widget &&
+  // 菜单在 y=70, height=100；位置在菜单区域内时不拦截，让 Qt 事件系统正常处理
+  // （菜单在页面上层，可见时会优先接收）
+  if (isBookPage && !(sample.flags & TouchTraceEvent::TargetWidget) &&
+      hasPos &&
       (type == QEvent::TouchBegin || type == QEvent::TouchEnd ||
        type == QEvent::MouseButtonPress ||
-       type == QEvent::MouseButtonRelease)) {
-    QPointF pos;
-    bool hasPos = false;
-    if (type == QEvent::TouchBegin || type == QEvent::TouchEnd) {
-      auto *te = static_cast<QTouchEvent *>(ev);
-      if (!te->points().isEmpty()) {
-        pos = te->points().first().position();
-        hasPos = true;
-      }
-    } else {
-      auto *me = static_cast<QMouseEvent *>(ev);
-      pos = me->position();
-      hasPos = true;
-    }
+       type == QEvent::MouseButtonRelease) &&
+      pos.y() >= 70 && pos.y() <= 170) {
+    qInfo() << "[GESTURE] Touch/click in menu area, allowing event to pass "
+               "(menu will receive if visible), pos="
+            << pos;
+    return false;
+  }
 
-    // 检查点击位置是否在菜单区域内（菜单在 y=70, height=100）
-    if (hasPos && pos.y() >= 70 && pos.y() <= 170) {
-      // 如果位置在菜单区域内，不拦截事件，让 Qt 事件系统正常处理
-      // 如果菜单可见，事件会被菜单接收；如果菜单不可见，事件可能会传递到页面
-      // 但由于菜单在页面上层（通过
-      // raise()），如果菜单可见，事件应该会被菜单接收
-      qInfo() << "[GESTURE] Touch/click in menu area, allowing event to pass "
-                 "(menu will receive if visible), pos="
-              << pos;
-      return false; // 不拦截，让事件正常传递（菜单在页面上层，会优先接收）
-    }
+  // evdev 后端接管微信读书书籍页：手势由输入线程识别后经环形队列送达，
+  // Qt 的触摸/合成鼠标事件在这里直接吞掉，不再走去重逻辑
+  if (m_evdev && isWeReadBook) {
+    return true;
   }
 
   // 底部向上滑动退出手势在所有页面都生效，其他手势只在书籍页面生效
   // 对于非书籍页面，我们需要处理触摸事件以检测底部向上滑动，但其他手势不拦截
-
-  // 调试日志：记录所有触摸/鼠标事件
-  if (m_verboseLogs && isPointerEventType(type)) {
-    QString eventTypeStr;
-    QPointF pos;
-    if (isMouseEventType(type)) {
-      auto *me = static_cast<QMouseEvent *>(ev);
-      eventTypeStr = (type == QEvent::MouseButtonPress     ? "MousePress"
-                      : type == QEvent::MouseButtonRelease ? "MouseRelease"
-                                                           : "MouseMove");
-      pos = me->position();
-    } else {
-      auto *te = static_cast<QTouchEvent *>(ev);
-      eventTypeStr = (type == QEvent::TouchBegin    ? "TouchBegin"
-                      : type == QEvent::TouchUpdate ? "TouchUpdate"
-                                                    : "TouchEnd");
-      if (!te->points().isEmpty()) {
-        pos = te->points().first().position();
-      }
-    }
-    qInfo() << "[GESTURE_DEBUG] eventFilter received" << eventTypeStr << "pos"
-            << pos << "obj" << (obj ? obj->metaObject()->className() : "null")
-            << "isWeReadKindleMode"
-            << (m_browser ? m_browser->isWeReadKindleMode() : false)
+  if (m_verboseLogs) {
+    qInfo() << "[GESTURE_DEBUG] eventFilter received" << eventTypeName(type)
+            << "pos" << pos << "obj"
+            << (obj ? obj->metaObject()->className() : "replay")
+            << "isWeReadKindleMode" << m_browser->isWeReadKindleMode()
             << "isBookPage" << isBookPage;
   }
 
-  // 处理触摸/鼠标事件 - 根据平台分发
-  bool handled = false;
-  switch (type) {
-  case QEvent::MouseButtonPress: {
-    auto *me = static_cast<QMouseEvent *>(ev);
-    if (isWeReadBook) {
-      // 微信读书专用处理
-      if (isDuplicatePointerEvent(QEvent::MouseButtonPress, me->position(),
-                                  nowMs)) {
-        if (m_verboseLogs) {
-          qInfo() << "[GESTURE_DEBUG] drop duplicate mouse press pos"
-                  << me->position();
-        }
-        return true;
-      }
-      recordPointerEvent(QEvent::MouseButtonPress, me->position(), nowMs);
-      handled = handleWeReadContactDown(me->position());
-    } else if (isDedaoBook) {
-      // 得到专用处理
-      if (isDuplicatePointerEvent(QEvent::MouseButtonPress, me->position(),
-                                  nowMs)) {
-        if (m_verboseLogs) {
-          qInfo() << "[GESTURE_DEBUG] drop duplicate mouse press pos"
-                  << me->position();
-        }
-        return true;
-      }
-      recordPointerEvent(QEvent::MouseButtonPress, me->position(), nowMs);
-      handled = handleDedaoContactDown(me->position());
-    } else {
-      // 非书籍页面：初始化手势以检测全局手势
-      handled = handleContactDown(me->position());
-      handled = false; // 让事件继续传递
-    }
-    break;
-  }
-  case QEvent::MouseMove: {
-    auto *me = static_cast<QMouseEvent *>(ev);
-    if (isWeReadBook) {
-      handled = handleWeReadContactMove(me->position());
-    } else if (isDedaoBook) {
-      handled = handleDedaoContactMove(me->position());
-    } else {
-      handled = handleContactMove(me->position(), false);
-      handled = false; // 让事件继续传递
-    }
-    break;
-  }
-  case QEvent::MouseButtonRelease: {
-    auto *me = static_cast<QMouseEvent *>(ev);
-    if (isWeReadBook) {
-      if (isDuplicatePointerEvent(QEvent::MouseButtonRelease, me->position(),
-                                  nowMs)) {
-        if (m_verboseLogs) {
-          qInfo() << "[GESTURE_DEBUG] drop duplicate mouse release pos"
-                  << me->position();
-        }
-        return true;
-      }
-      recordPointerEvent(QEvent::MouseButtonRelease, me->position(), nowMs);
-      // 先检查全局手势
-      const qint64 ms = m_timer.isValid() ? m_timer.elapsed() : 0;
-      if (handleGlobalGestures(m_startPos, me->position(), ms, m_state)) {
-        m_state = StateIdle;
-        return true;
-      }
-      handled = handleWeReadContactUp(me->position());
-    } else if (isDedaoBook) {
-      if (isDuplicatePointerEvent(QEvent::MouseButtonRelease, me->position(),
-                                  nowMs)) {
-        if (m_verboseLogs) {
-          qInfo() << "[GESTURE_DEBUG] drop duplicate mouse release pos"
-                  << me->position();
-        }
-        return true;
-      }
-      recordPointerEvent(QEvent::MouseButtonRelease, me->position(), nowMs);
-      // 先检查全局手势
-      const qint64 ms = m_timer.isValid() ? m_timer.elapsed() : 0;
-      if (handleGlobalGestures(m_startPos, me->position(), ms, m_state)) {
-        m_state = StateIdle;
-        return true;
-      }
-      handled = handleDedaoContactUp(me->position());
-    } else {
-      // 非书籍页面：检查全局手势
-      const qint64 ms = m_timer.isValid() ? m_timer.elapsed() : 0;
-      if (handleGlobalGestures(m_startPos, me->position(), ms, m_state)) {
-        m_state = StateIdle;
-        return true;
-      }
-      handled = handleContactUp(me->position(), false);
-      handled = false; // 让事件继续传递
+  if (isTouchEventType(type) && !hasPos) {
+    if (m_verboseLogs) {
+      qInfo() << "[GESTURE_DECISION] touch event with no points"
+              << eventTypeName(type) << "isWeReadBook" << isWeReadBook
+              << "isDedaoBook" << isDedaoBook;
     }
-    break;
+    return isBookPage;
   }
-  case QEvent::TouchBegin: {
-    auto *te = static_cast<QTouchEvent *>(ev);
-    if (te->points().isEmpty()) {
+
+  // 按下/松开做重复事件过滤（同一次触摸的 Touch 与合成 Mouse 各到一次）
+  const bool isDown =
+      type == QEvent::TouchBegin || type == QEvent::MouseButtonPress;
+  const bool isUp =
+      type == QEvent::TouchEnd || type == QEvent::MouseButtonRelease;
+  if (isBookPage && (isDown || isUp)) {
+    if (isDuplicatePointerEvent(type, pos, nowMs)) {
       if (m_verboseLogs) {
-        qInfo() << "[GESTURE_DECISION] touch begin with no points"
-                << "isWeReadBook" << isWeReadBook << "isDedaoBook"
-                << isDedaoBook;
+        qInfo() << "[GESTURE_DEBUG] drop duplicate" << eventTypeName(type)
+                << "pos" << pos;
       }
-      return isBookPage;
+      return true;
     }
-    const QPointF pos = te->points().first().position();
+    recordPointerEvent(type, pos, nowMs);
+  }
 
+  bool handled = false;
+  if (isDown) {
     if (isWeReadBook) {
-      // 微信读书专用处理
-      if (isDuplicatePointerEvent(QEvent::TouchBegin, pos, nowMs)) {
-        if (m_verboseLogs) {
-          qInfo() << "[GESTURE_DEBUG] drop duplicate touch begin pos" << pos;
-        }
-        return true;
-      }
-      recordPointerEvent(QEvent::TouchBegin, pos, nowMs);
       handled = handleWeReadContactDown(pos);
     } else if (isDedaoBook) {
-      // 得到专用处理
-      if (isDuplicatePointerEvent(QEvent::TouchBegin, pos, nowMs)) {
-        if (m_verboseLogs) {
-          qInfo() << "[GESTURE_DEBUG] drop duplicate touch begin pos" << pos;
-        }
-        return true;
-      }
-      recordPointerEvent(QEvent::TouchBegin, pos, nowMs);
       handled = handleDedaoContactDown(pos);
     } else {
-      // 非书籍页面：初始化手势以检测全局手势
-      handled = handleContactDown(pos);
-      handled = false; // 让事件继续传递给 WebEngine
+      // 非书籍页面：初始化手势以检测全局手势，事件继续传递给 WebEngine
+      handleContactDown(pos);
+      handled = false;
     }
-    break;
-  }
-  case QEvent::TouchUpdate: {
-    auto *te = static_cast<QTouchEvent *>(ev);
-    if (te->points().isEmpty()) {
-      if (m_verboseLogs) {
-        qInfo() << "[GESTURE_DECISION] touch update with no points"
-                << "isWeReadBook" << isWeReadBook << "isDedaoBook"
-                << isDedaoBook;
-      }
-      return isBookPage;
+  } else if (isUp) {
+    // 松手即结束拖动滚动（含被全局手势接管的情况）
+    endWeReadPan();
+    // 先检查全局手势
+    if (handleGlobalGestures(m_startPos, pos, contactElapsedMs(), m_state)) {
+      m_state = StateIdle;
+      return true;
     }
-    const QPointF pos = te->points().first().position();
-
     if (isWeReadBook) {
-      handled = handleWeReadContactMove(pos);
+      handled = handleWeReadContactUp(pos);
+      // 松手没有确认为翻页 tap（抖动过大等）：翻回去
+      revertSpeculativeTurn("lift");
     } else if (isDedaoBook) {
-      handled = handleDedaoContactMove(pos);
+      handled = handleDedaoContactUp(pos);
     } else {
-      // 非书籍页面：更新手势状态以检测全局手势
-      handled = handleContactMove(pos, false);
-      handled = false; // 让事件继续传递给 WebEngine
-    }
-    break;
-  }
-  case QEvent::TouchEnd: {
-    auto *te = static_cast<QTouchEvent *>(ev);
-    if (te->points().isEmpty()) {
-      if (m_verboseLogs) {
-        qInfo() << "[GESTURE_DECISION] touch end with no points"
-                << "isWeReadBook" << isWeReadBook << "isDedaoBook"
-                << isDedaoBook;
-      }
-      return isBookPage;
+      handleContactUp(pos, false);
+      handled = false; // 让事件继续传递
     }
-    const QPointF pos = te->points().first().position();
-
+  } else if (type == QEvent::TouchUpdate || type == QEvent::MouseMove) {
     if (isWeReadBook) {
-      // 微信读书专用处理
-      if (isDuplicatePointerEvent(QEvent::TouchEnd, pos, nowMs)) {
-        if (m_verboseLogs) {
-          qInfo() << "[GESTURE_DEBUG] drop duplicate touch end pos" << pos;
-        }
-        return true;
-      }
-      recordPointerEvent(QEvent::TouchEnd, pos, nowMs);
-      // 先检查全局手势
-      const qint64 ms = m_timer.isValid() ? m_timer.elapsed() : 0;
-      if (handleGlobalGestures(m_startPos, pos, ms, m_state)) {
-        m_state = StateIdle;
-        return true;
-      }
-      handled = handleWeReadContactUp(pos);
+      handled = handleWeReadContactMove(pos);
     } else if (isDedaoBook) {
-      // 得到专用处理
-      if (isDuplicatePointerEvent(QEvent::TouchEnd, pos, nowMs)) {
-        if (m_verboseLogs) {
-          qInfo() << "[GESTURE_DEBUG] drop duplicate touch end pos" << pos;
-        }
-        return true;
-      }
-      recordPointerEvent(QEvent::TouchEnd, pos, nowMs);
-      // 先检查全局手势
-      const qint64 ms = m_timer.isValid() ? m_timer.elapsed() : 0;
-      if (handleGlobalGestures(m_startPos, pos, ms, m_state)) {
-        m_state = StateIdle;
-        return true;
-      }
-      handled = handleDedaoContactUp(pos);
+      handled = handleDedaoContactMove(pos);
     } else {
-      // 非书籍页面：检查全局手势
-      const qint64 ms = m_timer.isValid() ? m_timer.elapsed() : 0;
-      if (handleGlobalGestures(m_startPos, pos, ms, m_state)) {
-        m_state = StateIdle;
-        return true;
-      }
-      handled = handleContactUp(pos, false);
-      handled = false; // 让事件继续传递
+      // 非书籍页面：更新手势状态以检测全局手势
+      handleContactMove(pos, false);
+      handled = false; // 让事件继续传递给 WebEngine
     }
-    break;
-  }
-  default:
-    break;
   }
 
-  if (m_verboseLogs && isPointerEventType(type)) {
-    QPointF pos;
-    const bool hasPos = extractEventPos(ev, &pos);
-    if (hasPos) {
-      qInfo() << "[GESTURE_DECISION] return" << handled << "type"
-              << eventTypeName(type) << "pos" << pos << "isBookPage"
-              << isBookPage;
-    } else {
-      qInfo() << "[GESTURE_DECISION] return" << handled << "type"
-              << eventTypeName(type) << "pos" << QStringLiteral("n/a")
-              << "isBookPage" << isBookPage;
-    }
+  if (m_verboseLogs) {
+    qInfo() << "[GESTURE_DECISION] return" << handled << "type"
+            << eventTypeName(type) << "pos" << pos << "isBookPage"
+            << isBookPage;
   }
 
   // 对于非书籍页面，如果 handled 为
@@ -579,9 +431,11 @@ bool GestureFilter::eventFilter(QObject *obj, QEvent *ev) {
 }
 
 void GestureFilter::onHoldTimeout() {
+  m_holdDeadlineMs = -1;
   if (m_state == StateTap) {
     // 从 tap 状态转换到 hold 状态 (参考 KOReader holdState)
     m_state = StateHold;
+    revertSpeculativeTurn("hold");
     qInfo() << "[GESTURE] hold detected @" << m_startPos;
     if (m_holdPassThroughCandidate && m_browser && m_browser->isDedaoBook()) {
       m_holdPassThroughActive = true;
@@ -611,9 +465,8 @@ bool GestureFilter::handleContactDown(const QPointF &pos) {
   m_holdPassThroughCandidate = false;
   m_holdPassThroughActive = false;
   m_holdPassThroughInjected = false;
-  m_timer.restart();
-  m_timer.start();
-  m_holdTimer.start(); // 开始计时长按
+  m_contactDownMs = clockMs();
+  startHoldTimer(); // 开始计时长按
   qInfo() << "[GESTURE] contact down @" << pos << "state -> StateTap";
   return true;
 }
@@ -632,7 +485,7 @@ bool GestureFilter::handleContactMove(const QPointF &pos, bool isBookPage) {
   if (m_state == StateTap) {
     if (absDx >= PAN_THRESHOLD || absDy >= PAN_THRESHOLD) {
       // 停止长按定时器，切换到 pan 状态
-      m_holdTimer.stop();
+      stopHoldTimer();
       m_state = StatePan;
       m_panStartPos = m_startPos; // 记录 pan 起始点
       qInfo() << "[GESTURE] state -> StatePan, moved" << absDx << absDy;
@@ -680,7 +533,7 @@ bool GestureFilter::handleContactMove(const QPointF &pos, bool isBookPage) {
 }
 
 bool GestureFilter::handleContactUp(const QPointF &pos, bool isBookPage) {
-  m_holdTimer.stop();
+  stopHoldTimer();
 
   // 如果触摸位置在菜单区域内（y=70-170），不处理，让事件传递给菜单
   if (pos.y() >= 70 && pos.y() <= 170) {
@@ -699,7 +552,7 @@ bool GestureFilter::handleContactUp(const QPointF &pos, bool isBookPage) {
   const qreal dy = pos.y() - m_startPos.y();
   const qreal absDx = qAbs(dx);
   const qreal absDy = qAbs(dy);
-  const qint64 ms = m_timer.isValid() ? m_timer.elapsed() : 0;
+  const qint64 ms = contactElapsedMs();
   const qreal distance = qSqrt(dx * dx + dy * dy);
   Direction dir = getDirection(dx, dy);
 
@@ -800,6 +653,7 @@ bool GestureFilter::handleContactUp(const QPointF &pos, bool isBookPage) {
         const qint64 tapTime = QDateTime::currentMSecsSinceEpoch();
         qInfo() << "[GESTURE] tap -> next (weRead kindle mode) timestamp"
                 << tapTime;
+        InkLatencyTracer::instance().begin(m_inputTraceMs);
         m_browser->goNextPage(pos);
         return true;
       } else {
@@ -823,6 +677,7 @@ bool GestureFilter::handleContactUp(const QPointF &pos, bool isBookPage) {
       if (dir == DirWest) {
         // 左滑 -> 下一页
         qInfo() << "[GESTURE] swipe west -> next page";
+        InkLatencyTracer::instance().begin(m_inputTraceMs);
         m_browser->goNextPage();
         return true;
       } else if (dir == DirEast) {
@@ -834,6 +689,7 @@ bool GestureFilter::handleContactUp(const QPointF &pos, bool isBookPage) {
           return true;
         } else {
           qInfo() << "[GESTURE] swipe east -> prev page";
+          InkLatencyTracer::instance().begin(m_inputTraceMs);
           m_browser->goPrevPage();
           return true;
         }
@@ -957,7 +813,7 @@ bool GestureFilter::hasRecentTouch(const QPointF &pos, qint64 nowMs) const {
 }
 
 bool GestureFilter::isCenterZone(const QPointF &pos) const {
-  qreal width = m_browser ? static_cast<qreal>(m_browser->width()) : 954.0;
+  qreal width = m_browser ? static_cast<qreal>(m_browser->viewWidth()) : 954.0;
   if (width <= 0.0)
     width = 954.0;
   qreal height =
@@ -967,6 +823,20 @@ bool GestureFilter::isCenterZone(const QPointF &pos) const {
   return rx >= 0.4 && rx <= 0.6 && ry >= 0.4 && ry <= 0.6;
 }
 
+int GestureFilter::swipePages(qreal absDx) {
+  if (absDx < LONG_SWIPE_MIN_DISTANCE)
+    return 1;
+  const int extra =
+      static_cast<int>((absDx - LONG_SWIPE_MIN_DISTANCE) / LONG_SWIPE_PX_PER_PAGE);
+  return qMin(LONG_SWIPE_MAX_PAGES, 2 + extra);
+}
+
+int GestureFilter::holdDragPages(qreal dx) {
+  const int pages = static_cast<int>(-dx / HOLD_DRAG_PX_PER_PAGE);
+  return qBound(-PageTurnController::kMaxPagesPerJump, pages,
+                PageTurnController::kMaxPagesPerJump);
+}
+
 // ==================== 微信读书专用手势处理 ====================
 
 bool GestureFilter::handleWeReadContactDown(const QPointF &pos) {
@@ -977,6 +847,11 @@ bool GestureFilter::handleWeReadContactDown(const QPointF &pos) {
     return false;
   }
 
+  if (m_jumpPreviewPages != 0 && m_browser) {
+    // 上一次按住拖动没有走到松手（被全局手势截走），收掉预览
+    m_browser->cancelPageJump();
+  }
+  m_jumpPreviewPages = 0;
   m_state = StateTap;
   m_startPos = pos;
   m_currentPos = pos;
@@ -984,10 +859,17 @@ bool GestureFilter::handleWeReadContactDown(const QPointF &pos) {
   m_holdPassThroughCandidate = false;
   m_holdPassThroughActive = false;
   m_holdPassThroughInjected = false;
-  m_timer.restart();
-  m_timer.start();
-  m_holdTimer.start();
+  m_contactDownMs = clockMs();
+  startHoldTimer();
   qInfo() << "[WEREAD_GESTURE] contact down @" << pos << "state -> StateTap";
+  // 预翻页：Kindle 模式下翻页区内的按下几乎必然是翻页 tap，先把滚动发出去，
+  // 刷新压到松手；变成 pan/hold 时翻回去
+  revertSpeculativeTurn("stale"); // 上一次的松手丢了
+  if (m_speculativeTurns && isSpeculativeTurnZone(pos) &&
+      m_browser->beginSpeculativeTurn()) {
+    m_speculating = true;
+    qInfo() << "[WEREAD_GESTURE] speculative next on contact down";
+  }
   return true;
 }
 
@@ -1004,7 +886,8 @@ bool GestureFilter::handleWeReadContactMove(const QPointF &pos) {
   // StateTap -> StatePan 转换
   if (m_state == StateTap) {
     if (absDx >= PAN_THRESHOLD || absDy >= PAN_THRESHOLD) {
-      m_holdTimer.stop();
+      stopHoldTimer();
+      revertSpeculativeTurn("pan");
       m_state = StatePan;
       m_panStartPos = m_startPos;
       m_lastPanPos = m_startPos; // 初始化 lastPanPos
@@ -1018,7 +901,9 @@ bool GestureFilter::handleWeReadContactMove(const QPointF &pos) {
     if (dir == DirNorth || dir == DirSouth) {
       const qreal deltaY = pos.y() - m_lastPanPos.y();
       if (qAbs(deltaY) > 5.0) {
-        m_browser->scrollByJs(static_cast<int>(deltaY));
+        // 浏览器按帧节拍合并下发，这里只交位移
+        m_browser->panScrollBy(static_cast<int>(deltaY));
+        m_weReadPanScrolling = true;
         m_panAccumulated.ry() += deltaY;
         m_lastPanPos = pos;
         qInfo() << "[WEREAD_GESTURE] pan scroll deltaY" << deltaY << "total"
@@ -1027,19 +912,16 @@ bool GestureFilter::handleWeReadContactMove(const QPointF &pos) {
     }
   }
 
-  // StateHold: 检测 hold_pan
+  // StateHold: hold_pan 横向拖动 -> 跳页预览（只在页数变化时刷预览框）
   if (m_state == StateHold) {
-    if (absDx >= PAN_THRESHOLD || absDy >= PAN_THRESHOLD) {
-      qInfo() << "[WEREAD_GESTURE] hold_pan detected";
-      // TODO: 实现 hold_pan 操作
-    }
+    weReadHoldDrag(pos);
   }
 
   return true;
 }
 
 bool GestureFilter::handleWeReadContactUp(const QPointF &pos) {
-  m_holdTimer.stop();
+  stopHoldTimer();
 
   // 菜单区域检查
   if (pos.y() >= 70 && pos.y() <= 170) {
@@ -1057,8 +939,7 @@ bool GestureFilter::handleWeReadContactUp(const QPointF &pos) {
   const qreal dy = pos.y() - m_startPos.y();
   const qreal absDx = qAbs(dx);
   const qreal absDy = qAbs(dy);
-  const qint64 ms = m_timer.isValid() ? m_timer.elapsed() : 0;
-  const qreal distance = qSqrt(dx * dx + dy * dy);
+  const qint64 ms = contactElapsedMs();
   Direction dir = getDirection(dx, dy);
 
   qInfo() << "[WEREAD_GESTURE] contact up @" << pos << "state" << m_state
@@ -1067,123 +948,197 @@ bool GestureFilter::handleWeReadContactUp(const QPointF &pos) {
 
   // Tap 手势
   if (m_state == StateTap) {
+    m_state = StateIdle;
     if (absDx < TAP_BOUNCE_DISTANCE && absDy < TAP_BOUNCE_DISTANCE) {
-      const bool isKindleMode =
-          m_browser ? m_browser->isWeReadKindleMode() : false;
-      const bool isCenterTap = isCenterZone(pos);
+      return weReadTap(pos);
+    }
+    if (m_verboseLogs) {
+      qInfo() << "[WEREAD_GESTURE] tap rejected: movement too large";
+    }
+    return false;
+  }
 
-      if (m_verboseLogs) {
-        qInfo() << "[WEREAD_GESTURE] tap check: isWeReadKindleMode"
-                << isKindleMode << "centerTap" << isCenterTap;
-      }
+  // Pan 手势
+  if (m_state == StatePan) {
+    m_state = StateIdle;
+    return weReadPanRelease(m_startPos, pos, ms);
+  }
 
-      // 中心区域点击：注入鼠标
-      if (m_browser && isCenterTap) {
-        qInfo() << "[WEREAD_GESTURE] tap in center zone -> inject mouse click";
-        m_browser->injectMouse(Qt::LeftButton, QEvent::MouseButtonPress, pos);
-        m_browser->injectMouse(Qt::LeftButton, QEvent::MouseButtonRelease, pos);
-        m_state = StateIdle;
-        return true;
-      }
+  // Hold 状态：拖出了跳页预览则松手执行，拖回原点则取消
+  if (m_state == StateHold) {
+    weReadHoldRelease(pos);
+  }
 
-      // Kindle 模式：tap 触发翻页
-      if (m_browser && isKindleMode) {
-        const qint64 tapTime = QDateTime::currentMSecsSinceEpoch();
-        qInfo() << "[WEREAD_GESTURE] tap -> next (kindle mode) timestamp"
-                << tapTime;
-        m_browser->goNextPage(pos);
-        m_state = StateIdle;
-        return true;
-      }
+  m_state = StateIdle;
+  m_lastPanPos = m_startPos;
+  return true;
+}
 
-      // 其他模式：注入鼠标点击
-      qInfo() << "[WEREAD_GESTURE] tap detected -> inject mouse click";
-      m_browser->injectMouse(Qt::LeftButton, QEvent::MouseButtonPress, pos);
-      m_browser->injectMouse(Qt::LeftButton, QEvent::MouseButtonRelease, pos);
-      m_state = StateIdle;
-      return true;
-    } else {
-      if (m_verboseLogs) {
-        qInfo() << "[WEREAD_GESTURE] tap rejected: movement too large";
-      }
-      m_state = StateIdle;
-      return false;
-    }
+void GestureFilter::endWeReadPan() {
+  if (!m_weReadPanScrolling)
+    return;
+  m_weReadPanScrolling = false;
+  m_browser->endPanScroll();
+}
+
+bool GestureFilter::isSpeculativeTurnZone(const QPointF &pos) const {
+  if (!m_browser->isWeReadKindleMode() || isCenterZone(pos))
+    return false;
+  // 避开顶部下拉菜单、左缘回首页、底部上滑退出、右缘全刷的起点
+  const qreal width = m_browser->viewWidth() > 0 ? m_browser->viewWidth() : 954;
+  return pos.y() >= 180.0 && pos.y() < m_windowHeight - 20.0 &&
+         pos.x() >= 60.0 && pos.x() < width - 20.0;
+}
+
+void GestureFilter::revertSpeculativeTurn(const char *reason) {
+  if (!m_speculating)
+    return;
+  m_speculating = false;
+  qInfo() << "[WEREAD_GESTURE] revert speculative next:" << reason;
+  m_browser->revertSpeculativeTurn();
+}
+
+bool GestureFilter::weReadTap(const QPointF &pos) {
+  const bool isKindleMode = m_browser ? m_browser->isWeReadKindleMode() : false;
+  const bool isCenterTap = isCenterZone(pos);
+
+  if (m_verboseLogs) {
+    qInfo() << "[WEREAD_GESTURE] tap check: isWeReadKindleMode" << isKindleMode
+            << "centerTap" << isCenterTap;
   }
 
-  // Pan 手势
-  if (m_state == StatePan) {
-    // 快速滑动 -> Swipe
-    if (ms < SWIPE_INTERVAL_MS && distance >= SWIPE_MIN_DISTANCE) {
-      if (dir == DirWest) {
+  // 中心区域点击：注入鼠标
+  if (m_browser && isCenterTap) {
+    qInfo() << "[WEREAD_GESTURE] tap in center zone -> inject mouse click";
+    m_browser->injectMouse(Qt::LeftButton, QEvent::MouseButtonPress, pos);
+    m_browser->injectMouse(Qt::LeftButton, QEvent::MouseButtonRelease, pos);
+    return true;
+  }
+
+  // 按下时已预翻页：滚动早已完成，这里只放行刷新
+  if (m_speculating && isKindleMode) {
+    m_speculating = false;
+    qInfo() << "[WEREAD_GESTURE] tap -> commit speculative next";
+    m_browser->commitSpeculativeTurn();
+    return true;
+  }
+
+  // Kindle 模式：tap 触发翻页
+  if (m_browser && isKindleMode) {
+    const qint64 tapTime = QDateTime::currentMSecsSinceEpoch();
+    qInfo() << "[WEREAD_GESTURE] tap -> next (kindle mode) timestamp"
+            << tapTime;
+    InkLatencyTracer::instance().begin(m_inputTraceMs);
+    m_browser->goNextPage(pos);
+    return true;
+  }
+
+  // 其他模式：注入鼠标点击
+  qInfo() << "[WEREAD_GESTURE] tap detected -> inject mouse click";
+  m_browser->injectMouse(Qt::LeftButton, QEvent::MouseButtonPress, pos);
+  m_browser->injectMouse(Qt::LeftButton, QEvent::MouseButtonRelease, pos);
+  return true;
+}
+
+bool GestureFilter::weReadPanRelease(const QPointF &startPos,
+                                     const QPointF &pos, qint64 ms) {
+  const qreal dx = pos.x() - startPos.x();
+  const qreal dy = pos.y() - startPos.y();
+  const qreal absDx = qAbs(dx);
+  const qreal distance = qSqrt(dx * dx + dy * dy);
+  const Direction dir = getDirection(dx, dy);
+  const bool fromTop = startPos.y() < 180.0;
+
+  // 快速滑动 -> Swipe
+  if (ms < SWIPE_INTERVAL_MS && distance >= SWIPE_MIN_DISTANCE) {
+    if (dir == DirWest) {
+      const int pages = swipePages(absDx);
+      InkLatencyTracer::instance().begin(m_inputTraceMs);
+      if (pages > 1) {
+        qInfo() << "[WEREAD_GESTURE] long swipe west -> jump" << pages;
+        m_browser->jumpPages(pages);
+      } else {
         qInfo() << "[WEREAD_GESTURE] swipe west -> next page";
         m_browser->goNextPage();
-        m_state = StateIdle;
-        return true;
-      } else if (dir == DirEast) {
-        const bool edgeSwipe = m_startPos.x() < 60.0;
-        if (edgeSwipe && m_browser && m_browser->isWeReadBook()) {
-          qInfo() << "[WEREAD_GESTURE] edge swipe east -> weread home";
-          m_browser->goWeReadHome();
-        } else {
-          qInfo() << "[WEREAD_GESTURE] swipe east -> prev page";
-          m_browser->goPrevPage();
-        }
-        m_state = StateIdle;
-        return true;
-      } else if (dir == DirSouth) {
-        // 顶部下滑 -> 呼出菜单
-        const bool fromTop = m_startPos.y() < 180.0;
-        if (fromTop && dy > 80.0 && ms < 1500) {
-          qInfo() << "[WEREAD_GESTURE] top pull-down -> show menu";
-          if (m_browser) {
-            m_browser->showMenu();
-            m_browser->scheduleBookCaptures();
-          }
-          m_state = StateIdle;
-          return true;
-        }
-        // 非顶部：滚动已处理
-        qInfo() << "[WEREAD_GESTURE] swipe south -> pan handled, total"
-                << m_panAccumulated.y();
-        m_state = StateIdle;
-        return true;
-      } else if (dir == DirNorth) {
-        qInfo() << "[WEREAD_GESTURE] swipe north -> pan handled, total"
-                << m_panAccumulated.y();
-        m_state = StateIdle;
-        return true;
       }
-    } else {
-      // 慢速移动 -> pan_release
-      const bool fromTop = m_startPos.y() < 180.0;
-      if (fromTop && dir == DirSouth && dy > 80.0 && ms < 1500) {
-        qInfo() << "[WEREAD_GESTURE] slow top pull-down -> show menu";
+      return true;
+    } else if (dir == DirEast) {
+      const bool edgeSwipe = startPos.x() < 60.0;
+      const int pages = swipePages(absDx);
+      if (edgeSwipe && m_browser && m_browser->isWeReadBook()) {
+        qInfo() << "[WEREAD_GESTURE] edge swipe east -> weread home";
+        m_browser->goWeReadHome();
+      } else if (pages > 1) {
+        qInfo() << "[WEREAD_GESTURE] long swipe east -> jump" << -pages;
+        InkLatencyTracer::instance().begin(m_inputTraceMs);
+        m_browser->jumpPages(-pages);
+      } else {
+        qInfo() << "[WEREAD_GESTURE] swipe east -> prev page";
+        InkLatencyTracer::instance().begin(m_inputTraceMs);
+        m_browser->goPrevPage();
+      }
+      return true;
+    } else if (dir == DirSouth) {
+      // 顶部下滑 -> 呼出菜单
+      if (fromTop && dy > 80.0 && ms < 1500) {
+        qInfo() << "[WEREAD_GESTURE] top pull-down -> show menu";
         if (m_browser) {
           m_browser->showMenu();
           m_browser->scheduleBookCaptures();
         }
-        m_state = StateIdle;
         return true;
       }
-      qInfo() << "[WEREAD_GESTURE] pan_release, total scroll"
+      // 非顶部：滚动已处理
+      qInfo() << "[WEREAD_GESTURE] swipe south -> pan handled, total"
+              << m_panAccumulated.y();
+      return true;
+    } else if (dir == DirNorth) {
+      qInfo() << "[WEREAD_GESTURE] swipe north -> pan handled, total"
               << m_panAccumulated.y();
-      m_state = StateIdle;
       return true;
     }
+    return true;
   }
 
-  // Hold 状态
-  if (m_state == StateHold) {
-    qInfo() << "[WEREAD_GESTURE] hold_release @" << pos;
-    // TODO: 处理长按释放
+  // 慢速移动 -> pan_release
+  if (fromTop && dir == DirSouth && dy > 80.0 && ms < 1500) {
+    qInfo() << "[WEREAD_GESTURE] slow top pull-down -> show menu";
+    if (m_browser) {
+      m_browser->showMenu();
+      m_browser->scheduleBookCaptures();
+    }
+    return true;
   }
-
-  m_state = StateIdle;
-  m_lastPanPos = m_startPos;
+  qInfo() << "[WEREAD_GESTURE] pan_release, total scroll"
+          << m_panAccumulated.y();
   return true;
 }
 
+void GestureFilter::weReadHoldRelease(const QPointF &pos) {
+  qInfo() << "[WEREAD_GESTURE] hold_release @" << pos << "jump"
+          << m_jumpPreviewPages;
+  if (m_jumpPreviewPages != 0) {
+    InkLatencyTracer::instance().begin(m_inputTraceMs);
+    m_browser->jumpPages(m_jumpPreviewPages);
+  } else {
+    m_browser->cancelPageJump();
+  }
+  m_jumpPreviewPages = 0;
+}
+
+void GestureFilter::weReadHoldDrag(const QPointF &pos) {
+  const qreal dx = pos.x() - m_startPos.x();
+  const qreal dy = pos.y() - m_startPos.y();
+  if (qAbs(dx) < PAN_THRESHOLD || qAbs(dx) <= qAbs(dy))
+    return;
+  const int pages = holdDragPages(dx);
+  if (pages != m_jumpPreviewPages) {
+    qInfo() << "[WEREAD_GESTURE] hold_pan jump preview" << pages;
+    m_jumpPreviewPages = pages;
+    m_browser->previewPageJump(pages);
+  }
+}
+
 // ==================== 得到专用手势处理 ====================
 
 bool GestureFilter::handleDedaoContactDown(const QPointF &pos) {
@@ -1203,9 +1158,8 @@ bool GestureFilter::handleDedaoContactDown(const QPointF &pos) {
   m_holdPassThroughActive = false;
   m_holdPassThroughInjected = false;
   m_holdPassThroughPos = pos;
-  m_timer.restart();
-  m_timer.start();
-  m_holdTimer.start();
+  m_contactDownMs = clockMs();
+  startHoldTimer();
   qInfo() << "[DEDAO_GESTURE] contact down @" << pos << "state -> StateTap";
   return true;
 }
@@ -1231,7 +1185,7 @@ bool GestureFilter::handleDedaoContactMove(const QPointF &pos) {
   // StateTap -> StatePan 转换
   if (m_state == StateTap) {
     if (absDx >= PAN_THRESHOLD || absDy >= PAN_THRESHOLD) {
-      m_holdTimer.stop();
+      stopHoldTimer();
       m_state = StatePan;
       m_panStartPos = m_startPos;
       m_lastPanPos = m_startPos;
@@ -1273,7 +1227,7 @@ bool GestureFilter::handleDedaoContactMove(const QPointF &pos) {
 }
 
 bool GestureFilter::handleDedaoContactUp(const QPointF &pos) {
-  m_holdTimer.stop();
+  stopHoldTimer();
 
   if (m_state == StateIdle)
     return true;
@@ -1304,7 +1258,7 @@ bool GestureFilter::handleDedaoContactUp(const QPointF &pos) {
   const qreal dy = pos.y() - m_startPos.y();
   const qreal absDx = qAbs(dx);
   const qreal absDy = qAbs(dy);
-  const qint64 ms = m_timer.isValid() ? m_timer.elapsed() : 0;
+  const qint64 ms = contactElapsedMs();
   const qreal distance = qSqrt(dx * dx + dy * dy);
   Direction dir = getDirection(dx, dy);
 
@@ -1315,6 +1269,7 @@ bool GestureFilter::handleDedaoContactUp(const QPointF &pos) {
   if (m_state == StateTap) {
     if (absDx < TAP_BOUNCE_DISTANCE && absDy < TAP_BOUNCE_DISTANCE) {
       qInfo() << "[DEDAO_GESTURE] tap -> next page (dedaoScroll)";
+      InkLatencyTracer::instance().begin(m_inputTraceMs);
       m_browser->goNextPage(pos);
       m_state = StateIdle;
       return true;
@@ -1337,7 +1292,8 @@ bool GestureFilter::handleDedaoContactUp(const QPointF &pos) {
         const bool fromInner = m_startPos.x() < innerSwipeThreshold;
         if (fromInner) {
           qInfo() << "[DEDAO_GESTURE] swipe west -> next page (dedaoScroll)";
-          m_browser->goNextPage(); // 实际会调用 dedaoScroll(true)
+          InkLatencyTracer::instance().begin(m_inputTraceMs);
+          m_browser->goNextPage(); // 经 PageTurnController 执行 dedaoScroll
         } else {
           qInfo() << "[DEDAO_GESTURE] swipe west ignored (near edge)";
         }
@@ -1350,7 +1306,8 @@ bool GestureFilter::handleDedaoContactUp(const QPointF &pos) {
           m_browser->goBack();
         } else {
           qInfo() << "[DEDAO_GESTURE] swipe east -> prev page (dedaoScroll)";
-          m_browser->goPrevPage(); // 实际会调用 dedaoScroll(false)
+          InkLatencyTracer::instance().begin(m_inputTraceMs);
+          m_browser->goPrevPage(); // 经 PageTurnController 执行 dedaoScroll
         }
         m_state = StateIdle;
         return true;
@@ -1456,3 +1413,76 @@ bool GestureFilter::handleGlobalGestures(const QPointF &startPos,
 
   return false;
 }
+
+// ==================== evdev 输入后端 ====================
+
+bool GestureFilter::enableEvdevInput(const QString &path) {
+  if (m_evdev)
+    return true;
+  const int width = m_browser ? m_browser->viewWidth() : 954;
+  auto *reader = new EvdevInputThread(path, width > 0 ? width : 954,
+                                      m_windowHeight, this);
+  connect(reader, &EvdevInputThread::gesture, this,
+          &GestureFilter::onInputGesture);
+  if (!reader->start()) {
+    delete reader;
+    qWarning() << "[EVDEV] backend unavailable, staying on Qt touch events";
+    return false;
+  }
+  m_evdev = reader;
+  qInfo() << "[EVDEV] backend active for weread book pages:" << path;
+  return true;
+}
+
+void GestureFilter::onInputGesture(const InputGesture &g) {
+  // 只接管微信读书书籍页；其他页面（含得到）继续走 Qt 触摸事件
+  if (!m_browser || !m_browser->isWeReadBook())
+    return;
+  // 手势起点在菜单带或可见目录内：这些区域的 Qt 事件照常放行给控件
+  if (g.start.y() >= 70 && g.start.y() <= 170)
+    return;
+  if (m_browser->catalogRect().contains(g.start.toPoint()))
+    return;
+
+  const qint64 nowMono = EvdevInputThread::monotonicMs();
+  // 墨水延迟从触摸事件本身算起，而不是从 GUI 取出手势算起
+  m_inputTraceMs = InkLatencyTracer::nowMs() - (nowMono - g.eventMs);
+  if (m_verboseLogs) {
+    qInfo() << "[EVDEV]" << InputGesture::kindName(g.kind) << "start"
+            << g.start << "pos" << g.pos << "ms" << g.durationMs
+            << "recognize" << (g.postedMs - g.eventMs) << "ring"
+            << (nowMono - g.postedMs);
+  }
+
+  switch (g.kind) {
+  case InputGesture::Tap:
+    weReadTap(g.pos);
+    break;
+  case InputGesture::Hold:
+    if (m_jumpPreviewPages != 0)
+      m_browser->cancelPageJump();
+    m_jumpPreviewPages = 0;
+    m_startPos = g.start;
+    qInfo() << "[WEREAD_GESTURE] hold detected @" << g.start;
+    break;
+  case InputGesture::HoldDrag:
+    m_startPos = g.start;
+    weReadHoldDrag(g.pos);
+    break;
+  case InputGesture::HoldRelease:
+    weReadHoldRelease(g.pos);
+    break;
+  case InputGesture::PanMove:
+    m_browser->panScrollBy(static_cast<int>(g.delta));
+    m_weReadPanScrolling = true;
+    m_panAccumulated.ry() += g.delta;
+    break;
+  case InputGesture::Swipe:
+  case InputGesture::PanRelease:
+    endWeReadPan();
+    if (!handleGlobalGestures(g.start, g.pos, g.durationMs, StatePan))
+      weReadPanRelease(g.start, g.pos, g.durationMs);
+    m_panAccumulated = QPointF(0, 0);
+    break;
+  }
+}
@@ -9,8 +9,12 @@
 #include <QTimer>
 #include <QTouchEvent>
 #include <QWidget>
+#include <functional>
+#include <memory>
 
-#include "weread_browser.h"
+#include "evdev_input.h"
+#include "gesture_target.h"
+#include "touch_trace.h"
 
 // KOReader 风格手势检测器：状态机驱动，区分 tap/pan/swipe/hold
 // 参考: weread-test/koreader/frontend/device/gesturedetector.lua
@@ -34,17 +38,48 @@ public:
     DirWest   // 左
   };
 
-  explicit GestureFilter(WereadBrowser *browser, QObject *parent = nullptr);
+  explicit GestureFilter(GestureTarget *browser, QObject *parent = nullptr);
+  ~GestureFilter() override;
 
   void setWindowHeight(int height);
 
+  // 时钟（ms）：默认 QElapsedTimer；回放时换成虚拟时钟，此后长按由
+  // pollHoldTimer() 在时钟推进后触发，不再用 QTimer
+  using Clock = std::function<qint64()>;
+  void setClock(Clock clock);
+  void pollHoldTimer();
+
+  // 触摸录制（WEREAD_TOUCH_TRACE）：eventFilter 收到的每个触摸/鼠标事件
+  // 连同页面状态写入 TouchTraceWriter 格式的二进制文件
+  bool startTouchTrace(const QString &path);
+  void stopTouchTrace();
+  // 回放一条录制事件，返回值即 eventFilter 当时是否拦截
+  bool replayEvent(const TouchTraceEvent &sample);
+
+  // 启用 evdev 输入后端（WEREAD_EVDEV_INPUT）：微信读书书籍页的手势改由
+  // 输入线程识别，失败时保持 Qt 触摸事件路径
+  bool enableEvdevInput(const QString &path);
+
+  // 预翻页开关（默认读 WEREAD_SPECULATIVE_TURN），回放基准用
+  void setSpeculativeTurns(bool enabled) { m_speculativeTurns = enabled; }
+
 protected:
   bool eventFilter(QObject *obj, QEvent *ev) override;
 
 private slots:
   void onHoldTimeout();
+  void onInputGesture(const InputGesture &g);
 
 private:
+  // 解码后的事件处理；obj/ev 仅用于重放注入鼠标，回放时为空
+  bool processPointer(const TouchTraceEvent &sample, qint64 nowMs,
+                      QObject *obj, QEvent *ev);
+  void recordTraceState(TouchTraceEvent *sample, qint64 nowMs) const;
+  qint64 clockMs() const;
+  qint64 contactElapsedMs() const; // 本次触摸按下至今
+  void startHoldTimer();
+  void stopHoldTimer();
+
   // ==================== KOReader 风格参数 ====================
   // 时间参数 (ms) - 参考 gesturedetector.lua
   static constexpr qint64 TAP_INTERVAL_MS = 0; // tap 防抖（我们不需要）
@@ -64,6 +99,13 @@ private:
   static constexpr qreal DUPLICATE_POS_TOL = 12.0;   // 重复事件位置容差
   static constexpr qreal SYNTH_MOUSE_POS_TOL = 20.0; // 合成鼠标匹配触摸位置容差
 
+  // 跳页参数：长滑超过 LONG_SWIPE_MIN_DISTANCE 后每 LONG_SWIPE_PX_PER_PAGE
+  // 多翻一页；按住后横向拖动每 HOLD_DRAG_PX_PER_PAGE 计一页
+  static constexpr qreal LONG_SWIPE_MIN_DISTANCE = 600.0;
+  static constexpr qreal LONG_SWIPE_PX_PER_PAGE = 100.0;
+  static constexpr int LONG_SWIPE_MAX_PAGES = 5;
+  static constexpr qreal HOLD_DRAG_PX_PER_PAGE = 60.0;
+
   // ==================== 状态机核心处理 ====================
 
   // 触摸开始 (参考 KOReader Contact:initialState -> tapState)
@@ -85,6 +127,19 @@ private:
   bool handleWeReadContactMove(const QPointF &pos);
   bool handleWeReadContactUp(const QPointF &pos);
 
+  // 松手/识别后的动作，Qt 事件路径和 evdev 后端共用
+  bool weReadTap(const QPointF &pos);
+  bool weReadPanRelease(const QPointF &startPos, const QPointF &pos,
+                        qint64 ms);
+  void weReadHoldRelease(const QPointF &pos);
+  // 按住后横向拖动：按 m_startPos 计算跳页数并刷新预览
+  void weReadHoldDrag(const QPointF &pos);
+  // 本次触摸发过拖动滚动时通知浏览器收尾（一次落定刷新）
+  void endWeReadPan();
+  // 预翻页（WEREAD_SPECULATIVE_TURN=1）：按下落在无歧义翻页区时
+  bool isSpeculativeTurnZone(const QPointF &pos) const;
+  void revertSpeculativeTurn(const char *reason);
+
   // ==================== 得到专用手势处理 ====================
 
   // Dedao-specific gesture handlers
@@ -115,11 +170,16 @@ private:
 
   void noteTouchEvent(const QPointF &pos, qint64 nowMs);
 
+  // 横向快速滑动的翻页数（普通滑动为 1）
+  static int swipePages(qreal absDx);
+  // 按住拖动的目标页数：向左拖为向后翻
+  static int holdDragPages(qreal dx);
+
   bool hasRecentTouch(const QPointF &pos, qint64 nowMs) const;
   bool isCenterZone(const QPointF &pos) const;
 
   // ==================== 成员变量 ====================
-  WereadBrowser *m_browser = nullptr;
+  GestureTarget *m_browser = nullptr;
   int m_windowHeight = 1696; // 窗口高度（用于判断底部区域）
 
   // 状态机
@@ -133,15 +193,25 @@ private:
   QPointF m_panAccumulated; // pan 累计位移
 
   // 定时器
-  QElapsedTimer m_timer; // 手势时长计时
-  QTimer m_holdTimer;    // 长按定时器
+  qint64 m_contactDownMs = -1;  // 按下时刻（clockMs），用于手势时长
+  QTimer m_holdTimer;           // 长按定时器
+  qint64 m_holdDeadlineMs = -1; // 长按到期时刻（clockMs），-1 表示未计时
   bool m_verboseLogs = false;
   QElapsedTimer m_eventClock;
+  Clock m_clock;
+  std::unique_ptr<TouchTraceWriter> m_trace;
+  qint64 m_traceStartMs = 0;
+  qint64 m_inputTraceMs = 0; // 当前事件到达时刻（InkLatencyTracer 时钟）
   qint64 m_lastTouchMs = -1;
   QPointF m_lastTouchPos;
   QEvent::Type m_lastPointerType = QEvent::None;
   QPointF m_lastPointerPos;
   qint64 m_lastPointerMs = -1;
+  int m_jumpPreviewPages = 0; // 按住拖动中当前预览的跳页数
+  bool m_weReadPanScrolling = false; // 本次触摸已有 panScrollBy 未收尾
+  bool m_speculativeTurns = false;    // 预翻页开关
+  bool m_speculating = false;         // 本次触摸已预翻页，待松手确认
+  EvdevInputThread *m_evdev = nullptr; // 非空时接管微信读书书籍页手势
   bool m_dedaoPanSuppressScroll = false;
   bool m_holdPassThroughCandidate = false;
   bool m_holdPassThroughActive = false;
@@ -0,0 +1,71 @@
+#ifndef GESTURE_TARGET_H
+#define GESTURE_TARGET_H
+
+#include <QEvent>
+#include <QPointF>
+#include <QRect>
+#include <QString>
+#include <QtGlobal>
+
+// What GestureFilter needs from the browser: page state queries, the
+// injected-input bookkeeping it consults for dedup, and the actions a
+// recognized gesture triggers. WereadBrowser implements it; the replay
+// benchmark substitutes a recording stub.
+class GestureTarget {
+public:
+  virtual ~GestureTarget() = default;
+
+  // page state
+  virtual bool isWeReadBook() const = 0;
+  virtual bool isKindleUA() const = 0;
+  virtual bool isWeReadKindleMode() const = 0;
+  virtual bool isDedaoBook() const = 0;
+  virtual int viewWidth() const = 0;
+  // geometry of the visible overlay, empty when hidden
+  virtual QRect catalogRect() const = 0;
+  virtual QRect menuRect() const = 0;
+
+  // input the browser injected itself
+  virtual void injectMouse(Qt::MouseButton btn, QEvent::Type type,
+                           const QPointF &pos) = 0;
+  virtual void injectTouch(QEvent::Type type, const QPointF &pos,
+                           int id = 0) = 0;
+  virtual void armInjectedTouchPassThrough(const QPointF &pos,
+                                           int durationMs = 600) = 0;
+  virtual bool shouldReplayInjectedMouse(const QPointF &pos,
+                                         qint64 nowMs) const = 0;
+  virtual void noteInjectedMouseReplayed(const QPointF &pos,
+                                         qint64 nowMs) = 0;
+  virtual bool shouldBypassGestureForInjectedMouse(const QPointF &pos,
+                                                   qint64 nowMs) const = 0;
+  virtual bool shouldBypassGestureForInjectedTouch(const QPointF &pos,
+                                                   qint64 nowMs) const = 0;
+
+  // gesture actions
+  virtual void scrollByJs(int dy) = 0;
+  // drag scrolling: deltas are coalesced by the target, endPanScroll() at
+  // lift lets it settle the display once
+  virtual void panScrollBy(int dy) = 0;
+  virtual void endPanScroll() = 0;
+  virtual void goNextPage(const QPointF &inputPos = QPointF()) = 0;
+  virtual void goPrevPage(const QPointF &inputPos = QPointF()) = 0;
+  virtual void previewPageJump(int pages) = 0;
+  virtual void jumpPages(int pages) = 0;
+  virtual void cancelPageJump() = 0;
+  // next-page turn started at touch-down with its refresh held back;
+  // false when one cannot start now. Commit shows it, revert turns back.
+  virtual bool beginSpeculativeTurn() = 0;
+  virtual void commitSpeculativeTurn() = 0;
+  virtual void revertSpeculativeTurn() = 0;
+  virtual bool handleMenuTap(const QPointF &globalPos) = 0;
+  virtual void goBack() = 0;
+  virtual void goWeReadHome() = 0;
+  virtual void showMenu() = 0;
+  virtual void scheduleBookCaptures(bool force = false) = 0;
+  virtual void saveSessionState() const = 0;
+  virtual void
+  exitToXochitl(const QString &exitReason = QStringLiteral("unknown")) = 0;
+  virtual void triggerFullRefresh() = 0;
+};
+
+#endif // GESTURE_TARGET_H
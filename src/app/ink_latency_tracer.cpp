@@ -0,0 +1,231 @@
+#include "ink_latency_tracer.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutexLocker>
+#include <algorithm>
+#include <vector>
+
+#include "common.h"
+
+namespace {
+const char *const kStageNames[InkLatencyTracer::StageCount] = {
+    "touch", "dispatch", "js_sent", "js_done",
+    "first_dom", "decision", "ioctl", "ink_done"};
+
+QJsonObject percentiles(std::vector<qint64> values) {
+  QJsonObject obj;
+  obj.insert(QStringLiteral("n"), static_cast<int>(values.size()));
+  if (values.empty())
+    return obj;
+  std::sort(values.begin(), values.end());
+  // nearest-rank percentile
+  auto rank = [&values](int pct) {
+    const size_t idx = (values.size() * pct + 99) / 100;
+    return values[idx == 0 ? 0 : idx - 1];
+  };
+  obj.insert(QStringLiteral("p50"), rank(50));
+  obj.insert(QStringLiteral("p95"), rank(95));
+  obj.insert(QStringLiteral("p99"), rank(99));
+  obj.insert(QStringLiteral("max"), values.back());
+  return obj;
+}
+
+QString percentilesText(const QJsonObject &p) {
+  if (p.value(QStringLiteral("n")).toInt() == 0)
+    return QStringLiteral("-");
+  return QStringLiteral("%1/%2/%3/%4")
+      .arg(p.value(QStringLiteral("p50")).toInteger())
+      .arg(p.value(QStringLiteral("p95")).toInteger())
+      .arg(p.value(QStringLiteral("p99")).toInteger())
+      .arg(p.value(QStringLiteral("max")).toInteger());
+}
+} // namespace
+
+InkLatencyTracer &InkLatencyTracer::instance() {
+  static InkLatencyTracer tracer;
+  return tracer;
+}
+
+qint64 InkLatencyTracer::nowMs() {
+  static const QElapsedTimer clock = [] {
+    QElapsedTimer t;
+    t.start();
+    return t;
+  }();
+  return clock.elapsed();
+}
+
+const char *InkLatencyTracer::stageName(int stage) {
+  return (stage >= 0 && stage < StageCount) ? kStageNames[stage] : "?";
+}
+
+InkLatencyTracer::InkLatencyTracer()
+    : m_waitInk(qEnvironmentVariableIntValue("WEREAD_INK_TRACE_WAIT") != 0) {
+}
+
+InkLatencyTracer::Trace *InkLatencyTracer::openTraceLocked(qint64 ts,
+                                                           int firstStage) {
+  Trace *slot = nullptr;
+  Trace *oldest = nullptr;
+  for (Trace &t : m_open) {
+    if (t.id == 0) {
+      slot = &t;
+      break;
+    }
+    if (!oldest || t.id < oldest->id)
+      oldest = &t;
+  }
+  if (!slot) {
+    finishLocked(*oldest, false);
+    slot = oldest;
+  }
+  slot->id = ++m_nextId;
+  slot->fbMarker = 0;
+  slot->ts.fill(-1);
+  slot->ts[firstStage] = ts;
+  return slot;
+}
+
+quint32 InkLatencyTracer::begin(qint64 touchMs) {
+  QMutexLocker lock(&m_mutex);
+  expireLocked(touchMs);
+  return openTraceLocked(touchMs, Touch)->id;
+}
+
+void InkLatencyTracer::mark(Stage stage, qint64 tsMs) {
+  const qint64 ts = tsMs >= 0 ? tsMs : nowMs();
+  QMutexLocker lock(&m_mutex);
+  expireLocked(ts);
+  bool any = false;
+  for (Trace &t : m_open) {
+    if (t.id == 0 || t.ts[stage] >= 0)
+      continue;
+    // Stages after the turn started only count for traces whose turn ran;
+    // page activity before that is not caused by this input.
+    if (stage > JsSent && t.ts[JsSent] < 0)
+      continue;
+    if (stage > Dispatch && t.ts[Dispatch] < 0)
+      continue;
+    t.ts[stage] = ts;
+    any = true;
+  }
+  if (!any && stage == Dispatch)
+    openTraceLocked(ts, Dispatch);
+}
+
+bool InkLatencyTracer::noteIoctl(quint32 fbMarker, qint64 tsMs) {
+  const qint64 ts = tsMs >= 0 ? tsMs : nowMs();
+  QMutexLocker lock(&m_mutex);
+  bool taken = false;
+  for (Trace &t : m_open) {
+    if (t.id == 0 || t.ts[Ioctl] >= 0 || t.ts[JsSent] < 0)
+      continue;
+    t.ts[Ioctl] = ts;
+    t.fbMarker = fbMarker;
+    taken = true;
+    if (!m_waitInk)
+      finishLocked(t, true);
+  }
+  return taken;
+}
+
+void InkLatencyTracer::markInkDone(quint32 fbMarker, qint64 tsMs) {
+  const qint64 ts = tsMs >= 0 ? tsMs : nowMs();
+  QMutexLocker lock(&m_mutex);
+  for (Trace &t : m_open) {
+    if (t.id == 0 || t.fbMarker != fbMarker || t.ts[Ioctl] < 0)
+      continue;
+    t.ts[InkDone] = ts;
+    finishLocked(t, true);
+  }
+}
+
+void InkLatencyTracer::expireLocked(qint64 now) {
+  for (Trace &t : m_open) {
+    if (t.id == 0)
+      continue;
+    const qint64 start = t.ts[Touch] >= 0 ? t.ts[Touch] : t.ts[Dispatch];
+    if (now - start > kExpireMs)
+      finishLocked(t, t.ts[Ioctl] >= 0);
+  }
+}
+
+void InkLatencyTracer::finishLocked(Trace &trace, bool complete) {
+  trace.complete = complete;
+  m_done[m_doneNext] = trace;
+  m_doneNext = (m_doneNext + 1) % kRing;
+  if (m_doneFilled < kRing)
+    ++m_doneFilled;
+  if (logLevelAtLeast(LogLevel::Info)) {
+    QStringList parts;
+    qint64 prev = -1;
+    for (int s = 0; s < StageCount; ++s) {
+      if (trace.ts[s] < 0)
+        continue;
+      if (prev >= 0)
+        parts << QStringLiteral("%1=%2").arg(QLatin1String(kStageNames[s]))
+                     .arg(qMax<qint64>(0, trace.ts[s] - prev));
+      prev = trace.ts[s];
+    }
+    qInfo().noquote() << "[INK_TRACE] id" << trace.id
+                      << (complete ? "done" : "incomplete")
+                      << parts.join(QLatin1Char(' '));
+  }
+  trace.id = 0;
+}
+
+QJsonObject InkLatencyTracer::snapshot() const {
+  QMutexLocker lock(&m_mutex);
+  QHash<QString, std::vector<qint64>> segments;
+  std::vector<qint64> totals;
+  int completed = 0;
+  for (int i = 0; i < m_doneFilled; ++i) {
+    const Trace &t = m_done[i];
+    int prevStage = -1;
+    for (int s = 0; s < StageCount; ++s) {
+      if (t.ts[s] < 0)
+        continue;
+      if (prevStage >= 0) {
+        const QString key = QStringLiteral("%1_%2").arg(
+            QLatin1String(kStageNames[prevStage]),
+            QLatin1String(kStageNames[s]));
+        segments[key].push_back(qMax<qint64>(0, t.ts[s] - t.ts[prevStage]));
+      }
+      prevStage = s;
+    }
+    if (!t.complete)
+      continue;
+    ++completed;
+    const qint64 start = t.ts[Touch] >= 0 ? t.ts[Touch] : t.ts[Dispatch];
+    const qint64 end = t.ts[InkDone] >= 0 ? t.ts[InkDone] : t.ts[Ioctl];
+    totals.push_back(qMax<qint64>(0, end - start));
+  }
+  QJsonObject stages;
+  for (auto it = segments.begin(); it != segments.end(); ++it)
+    stages.insert(it.key(), percentiles(std::move(it.value())));
+  QJsonObject obj;
+  obj.insert(QStringLiteral("count"), m_doneFilled);
+  obj.insert(QStringLiteral("completed"), completed);
+  obj.insert(QStringLiteral("waitInk"), m_waitInk);
+  obj.insert(QStringLiteral("stages"), stages);
+  obj.insert(QStringLiteral("total"), percentiles(std::move(totals)));
+  return obj;
+}
+
+QStringList InkLatencyTracer::summaryLines() const {
+  const QJsonObject snap = snapshot();
+  QStringList lines;
+  lines << QStringLiteral("traces=%1 completed=%2 total p50/p95/p99/max=%3")
+               .arg(snap.value(QStringLiteral("count")).toInt())
+               .arg(snap.value(QStringLiteral("completed")).toInt())
+               .arg(percentilesText(
+                   snap.value(QStringLiteral("total")).toObject()));
+  const QJsonObject stages = snap.value(QStringLiteral("stages")).toObject();
+  for (auto it = stages.begin(); it != stages.end(); ++it) {
+    lines << QStringLiteral("%1 %2").arg(
+        it.key(), percentilesText(it.value().toObject()));
+  }
+  return lines;
+}
@@ -0,0 +1,78 @@
+#ifndef INK_LATENCY_TRACER_H
+#define INK_LATENCY_TRACER_H
+
+#include <QJsonObject>
+#include <QMutex>
+#include <QStringList>
+#include <array>
+
+// Input-to-ink latency of page turns. A trace opens at the touch event and
+// is stamped as the turn passes each stage; marks apply to every open trace
+// that has not reached that stage yet, so taps folded into one turn all
+// finish on the same ink update. Finished traces go into a ring buffer and
+// per-stage percentiles are computed on query.
+//
+// Stamps come from several layers (gesture filter, browser, smart refresh,
+// fb ioctl) that do not share an owner, so there is one process-wide
+// instance. InkDone may be marked from a waiter thread.
+class InkLatencyTracer {
+public:
+  enum Stage {
+    Touch = 0,   // gesture filter saw the input event
+    Dispatch,    // goNextPage/goPrevPage accepted it
+    JsSent,      // page-turn controller executed the turn
+    JsDone,      // JS callback / key injection finished
+    FirstDom,    // first DOM change report from the page
+    Decision,    // SmartRefreshManager picked a waveform
+    Ioctl,       // MXCFB_SEND_UPDATE returned
+    InkDone,     // MXCFB_WAIT_FOR_UPDATE_COMPLETE returned (optional)
+    StageCount
+  };
+
+  static InkLatencyTracer &instance();
+  static qint64 nowMs();
+  static const char *stageName(int stage);
+
+  // Open a trace stamped at stage Touch; returns its id.
+  quint32 begin(qint64 touchMs);
+  // Stamp stage on open traces; opens a trace if none is open and stage is
+  // Dispatch (turns started from keys or UDP have no touch stamp).
+  void mark(Stage stage, qint64 tsMs = -1);
+  // True when a completion waiter should report InkDone for this update.
+  bool wantsInkDone() const { return m_waitInk; }
+  // Stamp Ioctl; returns true if an open trace took this update.
+  bool noteIoctl(quint32 fbMarker, qint64 tsMs = -1);
+  void markInkDone(quint32 fbMarker, qint64 tsMs = -1);
+
+  // {count, stages:{touch_dispatch:{n,p50,p95,p99,max}, ...}, total:{..}}
+  QJsonObject snapshot() const;
+  QStringList summaryLines() const;
+
+private:
+  InkLatencyTracer();
+
+  struct Trace {
+    quint32 id = 0;
+    quint32 fbMarker = 0;
+    std::array<qint64, StageCount> ts{};
+    bool complete = false;
+  };
+
+  static constexpr int kMaxOpen = 8;
+  static constexpr int kRing = 256;
+  static constexpr qint64 kExpireMs = 5000;
+
+  void finishLocked(Trace &trace, bool complete);
+  void expireLocked(qint64 nowMs);
+  Trace *openTraceLocked(qint64 touchMs, int firstStage);
+
+  mutable QMutex m_mutex;
+  bool m_waitInk = false;
+  quint32 m_nextId = 0;
+  std::array<Trace, kMaxOpen> m_open{};
+  std::array<Trace, kRing> m_done{};
+  int m_doneNext = 0;
+  int m_doneFilled = 0;
+};
+
+#endif // INK_LATENCY_TRACER_H
@@ -0,0 +1,136 @@
+#include "js_profiler.h"
+
+#include <QJsonDocument>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace {
+QJsonObject toJson(const JsCallProfiler::Percentiles &p) {
+  QJsonObject obj;
+  obj.insert(QStringLiteral("n"), p.samples);
+  obj.insert(QStringLiteral("p50"), p.p50);
+  obj.insert(QStringLiteral("p95"), p.p95);
+  obj.insert(QStringLiteral("p99"), p.p99);
+  obj.insert(QStringLiteral("max"), p.max);
+  return obj;
+}
+
+QString toText(const JsCallProfiler::Percentiles &p) {
+  if (p.samples == 0)
+    return QStringLiteral("-");
+  return QStringLiteral("%1/%2/%3/%4")
+      .arg(p.p50)
+      .arg(p.p95)
+      .arg(p.p99)
+      .arg(p.max);
+}
+} // namespace
+
+QString JsCallProfiler::compileCostScript(const QJsonObject &sources,
+                                          int rounds) {
+  // single-pass arg(): the sources may contain %N themselves
+  return QStringLiteral(
+             "((sources, rounds) => {"
+             "  const r3 = (v) => Math.round(v * 1000) / 1000;"
+             "  const out = {};"
+             "  Object.keys(sources).forEach(name => {"
+             "    const src = sources[name];"
+             "    const times = [];"
+             "    let error = '';"
+             "    for (let i = 0; i < rounds && !error; ++i) {"
+             "      const text = src + '\n//' + i + '.' + Math.random();"
+             "      const t0 = performance.now();"
+             "      try { new Function(text); } catch (e) { error = String(e); }"
+             "      times.push(performance.now() - t0);"
+             "    }"
+             "    times.sort((a, b) => a - b);"
+             "    out[name] = {bytes: src.length, rounds: times.length,"
+             "      p50: r3(times[times.length >> 1]),"
+             "      max: r3(times[times.length - 1]), error};"
+             "  });"
+             "  out.installMs = window.__wr && window.__wr.installMs >= 0"
+             "    ? window.__wr.installMs : -1;"
+             "  return out;"
+             "})(%1, %2)")
+      .arg(QString::fromUtf8(
+               QJsonDocument(sources).toJson(QJsonDocument::Compact)),
+           QString::number(rounds));
+}
+
+void JsCallProfiler::Series::add(qint64 value) {
+  if (value < 0)
+    return;
+  m_values[m_next] = static_cast<qint32>(
+      std::min<qint64>(value, std::numeric_limits<qint32>::max()));
+  m_next = (m_next + 1) % kWindow;
+  if (m_filled < kWindow)
+    ++m_filled;
+}
+
+JsCallProfiler::Percentiles JsCallProfiler::Series::percentiles() const {
+  Percentiles p;
+  p.samples = m_filled;
+  if (m_filled == 0)
+    return p;
+  std::vector<qint32> sorted(m_values.begin(), m_values.begin() + m_filled);
+  std::sort(sorted.begin(), sorted.end());
+  // nearest-rank percentile
+  auto rank = [&sorted](int pct) {
+    const size_t idx = (sorted.size() * pct + 99) / 100;
+    return static_cast<qint64>(sorted[idx == 0 ? 0 : idx - 1]);
+  };
+  p.p50 = rank(50);
+  p.p95 = rank(95);
+  p.p99 = rank(99);
+  p.max = sorted.back();
+  return p;
+}
+
+void JsCallProfiler::record(const QString &site, const Sample &sample) {
+  SiteStats &stats = m_sites[site];
+  ++stats.calls;
+  stats.total.add(sample.totalMs);
+  stats.queue.add(sample.queueMs);
+  stats.exec.add(sample.execMs);
+  stats.ipc.add(sample.ipcMs);
+}
+
+QJsonObject JsCallProfiler::snapshot() const {
+  QJsonObject sites;
+  for (auto it = m_sites.cbegin(); it != m_sites.cend(); ++it) {
+    const SiteStats &stats = it.value();
+    QJsonObject obj;
+    obj.insert(QStringLiteral("calls"), static_cast<qint64>(stats.calls));
+    obj.insert(QStringLiteral("total"), toJson(stats.total.percentiles()));
+    obj.insert(QStringLiteral("queue"), toJson(stats.queue.percentiles()));
+    obj.insert(QStringLiteral("exec"), toJson(stats.exec.percentiles()));
+    obj.insert(QStringLiteral("ipc"), toJson(stats.ipc.percentiles()));
+    sites.insert(it.key(), obj);
+  }
+  return sites;
+}
+
+QStringList JsCallProfiler::summaryLines() const {
+  std::vector<std::pair<qint64, QString>> rows;
+  rows.reserve(m_sites.size());
+  for (auto it = m_sites.cbegin(); it != m_sites.cend(); ++it) {
+    const SiteStats &stats = it.value();
+    const Percentiles total = stats.total.percentiles();
+    rows.emplace_back(
+        total.p95,
+        QStringLiteral("%1 calls=%2 total=%3 queue=%4 exec=%5 ipc=%6")
+            .arg(it.key())
+            .arg(stats.calls)
+            .arg(toText(total), toText(stats.queue.percentiles()),
+                 toText(stats.exec.percentiles()),
+                 toText(stats.ipc.percentiles())));
+  }
+  std::sort(rows.begin(), rows.end(),
+            [](const auto &a, const auto &b) { return a.first > b.first; });
+  QStringList lines;
+  for (const auto &row : rows)
+    lines << row.second;
+  return lines;
+}
@@ -0,0 +1,71 @@
+#ifndef JS_PROFILER_H
+#define JS_PROFILER_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <array>
+
+// Per-call-site latency of QWebEnginePage::runJavaScript round trips.
+// Every sample splits into queue (enqueue -> JS start), exec (JS start ->
+// JS end) and ipc (JS end -> callback) when the script reports in-page
+// timestamps; otherwise only the total is known. Each site keeps a rolling
+// window of recent samples, percentiles are computed on query.
+class JsCallProfiler {
+public:
+  struct Sample {
+    qint64 totalMs = 0;
+    qint64 queueMs = -1; // -1 = not reported by the script
+    qint64 execMs = -1;
+    qint64 ipcMs = -1;
+  };
+
+  struct Percentiles {
+    int samples = 0;
+    qint64 p50 = -1;
+    qint64 p95 = -1;
+    qint64 p99 = -1;
+    qint64 max = -1;
+  };
+
+  void record(const QString &site, const Sample &sample);
+
+  // Page script that times parse + top-level compile of each source (name ->
+  // JS text) with new Function(), `rounds` times, each copy made unique so
+  // V8's compilation cache cannot answer. Returns {name: {bytes, rounds,
+  // p50, max, error}, installMs}; times in ms, installMs is how long the
+  // page runtime took to install in this document.
+  static QString compileCostScript(const QJsonObject &sources, int rounds);
+
+  // {site: {calls, total:{n,p50,p95,p99,max}, queue:{..}, exec:{..}, ipc:{..}}}
+  QJsonObject snapshot() const;
+  // one line per site, ordered by p95 of total (slowest first)
+  QStringList summaryLines() const;
+
+private:
+  static constexpr int kWindow = 256;
+
+  class Series {
+  public:
+    void add(qint64 value);
+    Percentiles percentiles() const;
+
+  private:
+    std::array<qint32, kWindow> m_values{};
+    int m_next = 0;
+    int m_filled = 0;
+  };
+
+  struct SiteStats {
+    quint64 calls = 0;
+    Series total;
+    Series queue;
+    Series exec;
+    Series ipc;
+  };
+
+  QHash<QString, SiteStats> m_sites;
+};
+
+#endif // JS_PROFILER_H
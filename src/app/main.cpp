@@ -38,6 +38,7 @@
 #include <QWebEngineSettings>
 #include <QWebEngineUrlRequestInfo>
 #include <QWebEngineUrlRequestInterceptor>
+#include <QWebEngineUrlScheme>
 #include <QWebEngineView>
 #include <QWheelEvent>
 #include <QtGlobal>
@@ -161,12 +162,27 @@ int main(int argc, char *argv[]) {
   qputenv("QTWEBENGINE_CHROMIUM_FLAGS", chromiumFlags);
   qInfo() << "[ENV] QTWEBENGINE_CHROMIUM_FLAGS"
           << qgetenv("QTWEBENGINE_CHROMIUM_FLAGS");
+  // wrasset://（本地资源存储，见 asset_store.h）与 wrbook://（离线书籍，
+  // 见 offline_archive.h）必须在 QApplication 之前注册；
+  // 视为安全来源，允许 CORS/fetch；仍受页面 CSP 约束
+  for (const char *name : {AssetStore::kScheme, OfflineArchive::kScheme}) {
+    QWebEngineUrlScheme scheme(name);
+    scheme.setSyntax(QWebEngineUrlScheme::Syntax::Host);
+    QWebEngineUrlScheme::Flags flags =
+        QWebEngineUrlScheme::SecureScheme | QWebEngineUrlScheme::CorsEnabled;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 6, 0)
+    flags |= QWebEngineUrlScheme::FetchApiAllowed;
+#endif
+    scheme.setFlags(flags);
+    QWebEngineUrlScheme::registerScheme(scheme);
+  }
   QCoreApplication::setAttribute(Qt::AA_SynthesizeTouchForUnhandledMouseEvents);
   QApplication app(argc, argv);
   QCoreApplication::setOrganizationName("weread-lab");
   QCoreApplication::setApplicationName("weread-browser");
-  // 整合方案：移除 ShmFrameWriter，不再写共享内存
-  // 显示由 epaper 平台直接输出到 fb0，由 appload shim 拦截并刷新
+  // 整合方案：显示由 epaper 平台直接输出到 fb0，由 appload shim 拦截并刷新
+  // offscreen 回退模式下由 FrameCapturePipeline 按刷新损伤抓帧写入
+  // /dev/shm/weread_frame（见 WereadBrowser::initFrameCapture）
   FbRefreshHelper fbRef; // 简单刷新帮助器：启动后做一次全屏刷新
   // Resolve start URL: 根据退出方式决定是否恢复会话
   const QByteArray envUrl = qgetenv("WEREAD_URL");
@@ -228,6 +244,16 @@ int main(int argc, char *argv[]) {
   app.installEventFilter(appGestureFilter);
   qInfo() << "[GESTURE] KOReader-style GestureFilter installed at application "
              "level";
+  // 可选 evdev 输入后端：WEREAD_EVDEV_INPUT=/dev/input/eventN（或录制文件/FIFO）
+  const QByteArray evdevInput = qgetenv("WEREAD_EVDEV_INPUT");
+  if (!evdevInput.isEmpty()) {
+    appGestureFilter->enableEvdevInput(QString::fromLocal8Bit(evdevInput));
+  }
+  // 触摸录制：WEREAD_TOUCH_TRACE=/path/trace.wrtt，供 WereadGestureReplay 回放
+  const QByteArray touchTrace = qgetenv("WEREAD_TOUCH_TRACE");
+  if (!touchTrace.isEmpty()) {
+    appGestureFilter->startTouchTrace(QString::fromLocal8Bit(touchTrace));
+  }
 
   // 移除视图级别的事件过滤器，避免事件被重复处理导致状态混乱
   // 应用级别的事件过滤器已经能够捕获所有事件，包括菜单和手势事件
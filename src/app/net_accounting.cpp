@@ -0,0 +1,300 @@
+#include "net_accounting.h"
+
+#include <QJsonArray>
+#include <QVariantMap>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace {
+constexpr int kSummaryBuckets = 4;
+
+QString kb(qint64 bytes) {
+  return QString::number(double(bytes) / 1024.0, 'f', 1) +
+         QStringLiteral("KB");
+}
+} // namespace
+
+QString NetAccounting::entriesScript() {
+  // __wrNetSeen: entries already reported for this document, __wrNetLast
+  // the last of them. clearResourceTimings() (or a full buffer the page
+  // cleared) restarts the list, so the cursor restarts with it when the
+  // entry under it is gone or different. Connection warmer probes
+  // (__wr_warm=) are not page traffic.
+  return QStringLiteral(
+      "(() => {"
+      "  try {"
+      "    const all = performance.getEntriesByType('resource') || [];"
+      "    let from = window.__wrNetSeen || 0;"
+      "    const last = from > 0 && from <= all.length ? all[from - 1] : null;"
+      "    const mark = last ? last.name + '@' + last.startTime : '';"
+      "    if (mark !== window.__wrNetLast) from = 0;"
+      "    window.__wrNetSeen = all.length;"
+      "    const tail = all.length ? all[all.length - 1] : null;"
+      "    window.__wrNetLast = tail ? tail.name + '@' + tail.startTime : '';"
+      "    return all.slice(from)"
+      "      .filter(e => e.name.indexOf('__wr_warm=') < 0)"
+      "      .map(e => ({n: e.name, i: e.initiatorType,"
+      " t: e.transferSize, e: e.encodedBodySize, d: e.decodedBodySize,"
+      " ms: Math.round(e.duration)}));"
+      "  } catch (err) { return []; }"
+      "})()");
+}
+
+NetAccounting::Load &NetAccounting::current() {
+  if (m_loads.isEmpty())
+    beginLoad(QUrl(), 0); // requests before the first main-frame load
+  return m_loads.last();
+}
+
+void NetAccounting::beginLoad(const QUrl &url, qint64 nowMs) {
+  Load load;
+  load.url = url;
+  load.startMs = nowMs;
+  m_loads.append(load);
+  while (m_loads.size() > kMaxLoads)
+    m_loads.removeFirst();
+}
+
+void NetAccounting::finishLoad(const QUrl &url, const char *status,
+                               int errorCode, const QString &error,
+                               qint64 nowMs) {
+  Load &load = current();
+  if (load.url.isEmpty())
+    load.url = url;
+  load.endMs = nowMs;
+  load.status = QString::fromLatin1(status);
+  load.errorCode = errorCode;
+  load.error = error;
+}
+
+void NetAccounting::noteRequest(UrlRuleSet::Kind kind,
+                                const QByteArray &host, bool blocked) {
+  Load &load = current();
+  BucketKey key{kind, host};
+  auto it = load.buckets.find(key);
+  if (it == load.buckets.end()) {
+    // host may point into the caller's buffer: own a copy before storing
+    key.host = QByteArray(host.constData(), host.size());
+    it = load.buckets.insert(key, Bucket());
+  }
+  ++it->requests;
+  if (blocked)
+    ++it->blocked;
+}
+
+QStringList NetAccounting::busiestHosts(UrlRuleSet::Kind kind,
+                                        int max) const {
+  std::vector<std::pair<int, QString>> hosts;
+  if (!m_loads.isEmpty()) {
+    const Load &load = m_loads.last();
+    for (auto b = load.buckets.cbegin(); b != load.buckets.cend(); ++b) {
+      // blocked requests never reached the host
+      const int traffic = qMax(b->requests - b->blocked, b->entries);
+      if (b.key().kind == kind && !b.key().host.isEmpty() && traffic > 0)
+        hosts.emplace_back(traffic, QString::fromLatin1(b.key().host));
+    }
+  }
+  std::sort(hosts.begin(), hosts.end(),
+            [](const auto &a, const auto &b) { return a.first > b.first; });
+  QStringList out;
+  for (size_t i = 0; i < hosts.size() && int(i) < max; ++i)
+    out << hosts[i].second;
+  return out;
+}
+
+QString NetAccounting::keyName(const BucketKey &key) {
+  return QLatin1String(UrlRuleSet::kindName(key.kind)) + QLatin1Char(' ') +
+         QString::fromLatin1(key.host);
+}
+
+UrlRuleSet::Kind NetAccounting::kindOfEntry(const QString &name,
+                                            const QString &initiator) {
+  // the extension says more than initiatorType ("css" covers fonts and
+  // images referenced from stylesheets)
+  const QString path = QUrl(name).path();
+  const qsizetype dot = path.lastIndexOf(QLatin1Char('.'));
+  const QString ext = dot >= 0 ? path.mid(dot + 1).toLower() : QString();
+  if (ext == QLatin1String("js") || ext == QLatin1String("mjs"))
+    return UrlRuleSet::KindScript;
+  if (ext == QLatin1String("css"))
+    return UrlRuleSet::KindStylesheet;
+  if (ext == QLatin1String("woff2") || ext == QLatin1String("woff") ||
+      ext == QLatin1String("ttf") || ext == QLatin1String("otf"))
+    return UrlRuleSet::KindFont;
+  if (ext == QLatin1String("png") || ext == QLatin1String("jpg") ||
+      ext == QLatin1String("jpeg") || ext == QLatin1String("gif") ||
+      ext == QLatin1String("webp") || ext == QLatin1String("svg"))
+    return UrlRuleSet::KindImage;
+  if (initiator == QLatin1String("xmlhttprequest") ||
+      initiator == QLatin1String("fetch") ||
+      initiator == QLatin1String("beacon"))
+    return UrlRuleSet::KindXhr;
+  if (initiator == QLatin1String("script"))
+    return UrlRuleSet::KindScript;
+  if (initiator == QLatin1String("img"))
+    return UrlRuleSet::KindImage;
+  if (initiator == QLatin1String("iframe"))
+    return UrlRuleSet::KindSubFrame;
+  return UrlRuleSet::KindOther;
+}
+
+void NetAccounting::addEntries(const QVariantList &entries) {
+  if (entries.isEmpty())
+    return;
+  Load &load = current();
+  for (const QVariant &v : entries) {
+    const QVariantMap e = v.toMap();
+    const QString name = e.value(QStringLiteral("n")).toString();
+    if (name.isEmpty())
+      continue;
+    const BucketKey key{
+        kindOfEntry(name, e.value(QStringLiteral("i")).toString()),
+        QUrl(name).host().toLatin1()};
+    const qint64 transfer = e.value(QStringLiteral("t")).toLongLong();
+    const qint64 encoded = e.value(QStringLiteral("e")).toLongLong();
+    const double ms = e.value(QStringLiteral("ms")).toDouble();
+    Bucket &b = load.buckets[key];
+    ++b.entries;
+    b.transferBytes += transfer;
+    b.encodedBytes += encoded;
+    b.decodedBytes += e.value(QStringLiteral("d")).toLongLong();
+    b.durationMs += ms;
+    b.maxDurationMs = qMax(b.maxDurationMs, ms);
+    if (transfer == 0 && encoded == 0)
+      ++b.opaque;
+    else if (transfer == 0)
+      ++b.cacheHits;
+    else if (transfer < encoded)
+      ++b.revalidated;
+    else
+      ++b.network;
+
+    if (load.slowest.size() < kSlowest ||
+        ms > load.slowest.last().durationMs) {
+      Resource r{name, ms, transfer};
+      auto pos = std::upper_bound(
+          load.slowest.begin(), load.slowest.end(), r,
+          [](const Resource &a, const Resource &b) {
+            return a.durationMs > b.durationMs;
+          });
+      load.slowest.insert(pos, r);
+      if (load.slowest.size() > kSlowest)
+        load.slowest.removeLast();
+    }
+  }
+}
+
+NetAccounting::Bucket NetAccounting::total(const Load &load) {
+  Bucket t;
+  for (const Bucket &b : load.buckets) {
+    t.requests += b.requests;
+    t.blocked += b.blocked;
+    t.entries += b.entries;
+    t.transferBytes += b.transferBytes;
+    t.encodedBytes += b.encodedBytes;
+    t.decodedBytes += b.decodedBytes;
+    t.durationMs += b.durationMs;
+    t.maxDurationMs = qMax(t.maxDurationMs, b.maxDurationMs);
+    t.cacheHits += b.cacheHits;
+    t.revalidated += b.revalidated;
+    t.network += b.network;
+    t.opaque += b.opaque;
+  }
+  return t;
+}
+
+QJsonObject NetAccounting::toJson(const QString &key, const Bucket &b) {
+  QJsonObject o;
+  if (!key.isEmpty())
+    o.insert(QStringLiteral("key"), key);
+  o.insert(QStringLiteral("requests"), b.requests);
+  o.insert(QStringLiteral("blocked"), b.blocked);
+  o.insert(QStringLiteral("entries"), b.entries);
+  o.insert(QStringLiteral("transfer"), b.transferBytes);
+  o.insert(QStringLiteral("encoded"), b.encodedBytes);
+  o.insert(QStringLiteral("decoded"), b.decodedBytes);
+  o.insert(QStringLiteral("durMs"), qRound64(b.durationMs));
+  o.insert(QStringLiteral("maxMs"), qRound64(b.maxDurationMs));
+  o.insert(QStringLiteral("cache"), b.cacheHits);
+  o.insert(QStringLiteral("revalidated"), b.revalidated);
+  o.insert(QStringLiteral("network"), b.network);
+  o.insert(QStringLiteral("opaque"), b.opaque);
+  return o;
+}
+
+QJsonObject NetAccounting::snapshot() const {
+  QJsonArray loads;
+  for (auto it = m_loads.crbegin(); it != m_loads.crend(); ++it) {
+    const Load &load = *it;
+    QJsonObject o;
+    o.insert(QStringLiteral("url"), load.url.toString());
+    o.insert(QStringLiteral("status"), load.status);
+    o.insert(QStringLiteral("startMs"), load.startMs);
+    o.insert(QStringLiteral("ms"),
+             load.endMs >= 0 ? load.endMs - load.startMs : qint64(-1));
+    if (load.errorCode != 0 || !load.error.isEmpty()) {
+      o.insert(QStringLiteral("errorCode"), load.errorCode);
+      o.insert(QStringLiteral("error"), load.error);
+    }
+    o.insert(QStringLiteral("total"), toJson(QString(), total(load)));
+    QJsonArray buckets;
+    for (auto b = load.buckets.cbegin(); b != load.buckets.cend(); ++b)
+      buckets.append(toJson(keyName(b.key()), b.value()));
+    o.insert(QStringLiteral("buckets"), buckets);
+    QJsonArray slowest;
+    for (const Resource &r : load.slowest) {
+      QJsonObject s;
+      s.insert(QStringLiteral("name"), r.name);
+      s.insert(QStringLiteral("ms"), qRound64(r.durationMs));
+      s.insert(QStringLiteral("transfer"), r.transferBytes);
+      slowest.append(s);
+    }
+    o.insert(QStringLiteral("slowest"), slowest);
+    loads.append(o);
+  }
+  QJsonObject root;
+  root.insert(QStringLiteral("loads"), loads);
+  return root;
+}
+
+QStringList NetAccounting::summaryLines() const {
+  QStringList lines;
+  for (auto it = m_loads.crbegin(); it != m_loads.crend(); ++it) {
+    const Load &load = *it;
+    const Bucket t = total(load);
+    lines << QStringLiteral("%1 %2 ms=%3 req=%4 blocked=%5 entries=%6 "
+                            "transfer=%7 cache/reval/net/opaque=%8/%9/%10/%11")
+                 .arg(load.status, load.url.toString(QUrl::RemoveQuery))
+                 .arg(load.endMs >= 0 ? load.endMs - load.startMs : -1)
+                 .arg(t.requests)
+                 .arg(t.blocked)
+                 .arg(t.entries)
+                 .arg(kb(t.transferBytes))
+                 .arg(t.cacheHits)
+                 .arg(t.revalidated)
+                 .arg(t.network)
+                 .arg(t.opaque);
+    // heaviest buckets by time spent, the thing a slow open is made of
+    std::vector<std::pair<double, QString>> rows;
+    for (auto b = load.buckets.cbegin(); b != load.buckets.cend(); ++b) {
+      const Bucket &v = b.value();
+      rows.emplace_back(
+          v.durationMs,
+          QStringLiteral("  %1 n=%2 transfer=%3 dur=%4ms max=%5ms "
+                         "cache=%6/%7")
+              .arg(keyName(b.key()))
+              .arg(qMax(v.requests, v.entries))
+              .arg(kb(v.transferBytes))
+              .arg(qRound64(v.durationMs))
+              .arg(qRound64(v.maxDurationMs))
+              .arg(v.cacheHits)
+              .arg(v.entries));
+    }
+    std::sort(rows.begin(), rows.end(),
+              [](const auto &a, const auto &b) { return a.first > b.first; });
+    for (size_t i = 0; i < rows.size() && i < size_t(kSummaryBuckets); ++i)
+      lines << rows[i].second;
+  }
+  return lines;
+}
@@ -0,0 +1,108 @@
+#ifndef NET_ACCOUNTING_H
+#define NET_ACCOUNTING_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+#include <QVariantList>
+
+#include "url_rules.h"
+
+// Per page-load network accounting. A load runs from one main-frame
+// LoadStarted to the next; three sources feed it:
+//  - the request interceptor: every request by resource type and host,
+//    and whether a rule blocked it;
+//  - QWebEngineLoadingInfo: the load's URL, outcome and error;
+//  - the page's resource timing entries: bytes on the wire / encoded /
+//    decoded, duration, and from those whether the response came from the
+//    HTTP cache, was revalidated, or went to the network.
+// Resource entries are pulled incrementally (the page keeps a cursor), so
+// the same load can be sampled several times while a book opens.
+// Stats are bucketed by (type, host) and the last kMaxLoads loads are kept.
+// noteRequest runs for every request, so a bucket is found without
+// building a key string: the host is looked up as raw bytes and only
+// copied the first time it is seen in a load.
+// GUI thread only; Qt 6 runs the request interceptor there too.
+class NetAccounting {
+public:
+  static constexpr int kMaxLoads = 8;
+  static constexpr int kSlowest = 5; // slowest resources kept per load
+
+  // Script returning the resource entries added since its last call.
+  static QString entriesScript();
+
+  void beginLoad(const QUrl &url, qint64 nowMs);
+  // status: succeeded / failed / stopped
+  void finishLoad(const QUrl &url, const char *status, int errorCode,
+                  const QString &error, qint64 nowMs);
+  // host may be a QByteArray::fromRawData view; it is not retained
+  void noteRequest(UrlRuleSet::Kind kind, const QByteArray &host,
+                   bool blocked);
+  void addEntries(const QVariantList &entries);
+
+  int loadCount() const { return int(m_loads.size()); }
+  // hosts of the newest load's buckets of this type, most requests that
+  // went out first (blocked requests do not count)
+  QStringList busiestHosts(UrlRuleSet::Kind kind, int max) const;
+  // {loads:[{url, status, ms, requests, blocked, entries, bytes:{..},
+  //  cache:{..}, buckets:[..], slowest:[..]}]}, newest first
+  QJsonObject snapshot() const;
+  // one line per load plus its heaviest buckets, newest first
+  QStringList summaryLines() const;
+
+private:
+  struct Bucket {
+    int requests = 0; // seen by the interceptor
+    int blocked = 0;
+    int entries = 0;  // resource timing entries
+    qint64 transferBytes = 0;
+    qint64 encodedBytes = 0;
+    qint64 decodedBytes = 0;
+    double durationMs = 0;
+    double maxDurationMs = 0;
+    int cacheHits = 0;   // transferSize 0, body present
+    int revalidated = 0; // transfer smaller than the body: 304
+    int network = 0;
+    int opaque = 0;      // cross-origin without Timing-Allow-Origin
+  };
+  struct BucketKey {
+    UrlRuleSet::Kind kind = UrlRuleSet::KindOther;
+    QByteArray host;
+    bool operator==(const BucketKey &o) const {
+      return kind == o.kind && host == o.host;
+    }
+    friend size_t qHash(const BucketKey &k, size_t seed = 0) {
+      return qHash(k.host, seed) ^ k.kind;
+    }
+  };
+  struct Resource {
+    QString name;
+    double durationMs = 0;
+    qint64 transferBytes = 0;
+  };
+  struct Load {
+    QUrl url;
+    qint64 startMs = 0;
+    qint64 endMs = -1;
+    QString status = QStringLiteral("loading");
+    int errorCode = 0;
+    QString error;
+    QHash<BucketKey, Bucket> buckets;
+    QList<Resource> slowest;        // by duration, longest first
+  };
+
+  Load &current();
+  static UrlRuleSet::Kind kindOfEntry(const QString &name,
+                                      const QString &initiator);
+  static QString keyName(const BucketKey &key); // "type host"
+  static Bucket total(const Load &load);
+  static QJsonObject toJson(const QString &key, const Bucket &b);
+
+  QList<Load> m_loads; // oldest first
+};
+
+#endif // NET_ACCOUNTING_H
@@ -0,0 +1,568 @@
+#include "offline_archive.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSaveFile>
+#include <QVariant>
+#include <QWebEngineUrlRequestJob>
+#include <QtGlobal>
+
+namespace {
+constexpr int kSaveDelayMs = 2000;
+constexpr int kMaxAssetsPerBook = 2000;
+
+qint64 nowMs() { return QDateTime::currentMSecsSinceEpoch(); }
+
+QByteArray sha256Hex(const QByteArray &data) {
+  return QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex();
+}
+
+QString urlKey(const QUrl &url) {
+  return url.toString(QUrl::RemoveFragment | QUrl::RemoveUserInfo);
+}
+
+QJsonObject itemJson(const QString &file, const QByteArray &hash, qint64 size,
+                     const QByteArray &type) {
+  QJsonObject o;
+  o.insert(QStringLiteral("f"), file);
+  o.insert(QStringLiteral("h"), QString::fromLatin1(hash));
+  o.insert(QStringLiteral("s"), size);
+  o.insert(QStringLiteral("t"), QString::fromLatin1(type));
+  return o;
+}
+} // namespace
+
+OfflineArchive::OfflineArchive(const QString &root, QObject *parent)
+    : QObject(parent), m_root(root) {
+  QDir().mkpath(m_root);
+  m_saveTimer.setSingleShot(true);
+  m_saveTimer.setInterval(kSaveDelayMs);
+  connect(&m_saveTimer, &QTimer::timeout, this, &OfflineArchive::saveDirty);
+  const QStringList dirs =
+      QDir(m_root).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+  for (const QString &readerId : dirs) {
+    if (isSafeId(readerId))
+      loadBook(readerId);
+  }
+  qInfo() << "[OFFLINE] archive" << m_root << "books" << m_books.size();
+}
+
+OfflineArchive::~OfflineArchive() {
+  if (m_saveTimer.isActive())
+    saveDirty();
+}
+
+bool OfflineArchive::isSafeId(const QString &id) {
+  if (id.isEmpty() || id.size() > 128)
+    return false;
+  for (const QChar ch : id) {
+    const char c = ch.toLatin1();
+    if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+          (c >= 'A' && c <= 'Z') || c == '_' || c == '-'))
+      return false;
+  }
+  return true;
+}
+
+QString OfflineArchive::readerIdOf(const QUrl &url) {
+  if (url.scheme() != QLatin1String("https") ||
+      url.host() != QLatin1String("weread.qq.com"))
+    return QString();
+  // "/web/reader/<readerId>"
+  const QString path = url.path();
+  if (!path.startsWith(QLatin1String("/web/reader/")))
+    return QString();
+  const QString id = path.section(QLatin1Char('/'), 3, 3);
+  return isSafeId(id) ? id : QString();
+}
+
+QString OfflineArchive::contentError(const QByteArray &body) {
+  const QByteArray trimmed = body.trimmed();
+  if (trimmed.isEmpty())
+    return QStringLiteral("empty");
+  if (trimmed.front() != '{' && trimmed.front() != '[')
+    return QString(); // encoded chapter text
+  QJsonParseError err;
+  const QJsonDocument doc = QJsonDocument::fromJson(trimmed, &err);
+  if (err.error != QJsonParseError::NoError)
+    return QStringLiteral("bad_json");
+  if (doc.isArray())
+    return doc.array().isEmpty() ? QStringLiteral("empty") : QString();
+  const QJsonObject o = doc.object();
+  const QJsonValue code = o.contains(QLatin1String("errCode"))
+                              ? o.value(QLatin1String("errCode"))
+                              : o.value(QLatin1String("errcode"));
+  if (!code.isUndefined() && !code.isNull() &&
+      code.toVariant().toDouble() != 0)
+    return QStringLiteral("errCode ") + code.toVariant().toString();
+  if (o.value(QLatin1String("succ")) == QJsonValue(false) ||
+      o.value(QLatin1String("success")) == QJsonValue(false))
+    return QStringLiteral("succ_false");
+  static const QStringList status = {
+      QStringLiteral("errCode"), QStringLiteral("errcode"),
+      QStringLiteral("errMsg"),  QStringLiteral("errmsg"),
+      QStringLiteral("msg"),     QStringLiteral("succ"),
+      QStringLiteral("success"), QStringLiteral("code")};
+  for (auto it = o.begin(); it != o.end(); ++it)
+    if (!status.contains(it.key()))
+      return QString();
+  return QStringLiteral("no_content");
+}
+
+QString OfflineArchive::bookDir(const QString &readerId) const {
+  return m_root + QLatin1Char('/') + readerId;
+}
+
+bool OfflineArchive::hasBook(const QString &readerId) const {
+  return m_books.contains(readerId);
+}
+
+void OfflineArchive::beginBook(const QString &readerId, const QString &bookId,
+                               const QList<Endpoint> &endpoints, int total) {
+  if (!isSafeId(readerId))
+    return;
+  Book &book = m_books[readerId];
+  book.readerId = readerId;
+  if (!bookId.isEmpty())
+    book.bookId = bookId;
+  // endpoint indices are part of stored keys: only ever append
+  for (const Endpoint &e : endpoints) {
+    bool known = false;
+    for (const Endpoint &have : book.endpoints)
+      known = known || have.ep == e.ep;
+    if (!known)
+      book.endpoints.append(e);
+  }
+  book.expected = total;
+  book.complete = false;
+  QDir().mkpath(bookDir(readerId));
+  touch(readerId);
+  qInfo() << "[OFFLINE] begin" << readerId << "book" << book.bookId
+          << "endpoints" << book.endpoints.size() << "expected" << total
+          << "have" << book.chapters.size();
+}
+
+bool OfflineArchive::writeItem(Book &book, const QString &file,
+                               const QByteArray &type, const QByteArray &body,
+                               Item *out) {
+  const QString path = bookDir(book.readerId) + QLatin1Char('/') + file;
+  QDir().mkpath(QFileInfo(path).path());
+  QSaveFile f(path);
+  if (!f.open(QIODevice::WriteOnly) || f.write(body) != body.size() ||
+      !f.commit()) {
+    qWarning() << "[OFFLINE] cannot write" << path;
+    return false;
+  }
+  out->file = file;
+  out->hash = sha256Hex(body);
+  out->size = body.size();
+  out->contentType = type;
+  book.bytes += body.size();
+  return true;
+}
+
+bool OfflineArchive::putChapter(const QString &readerId, const QString &ep,
+                                const QString &uid,
+                                const QByteArray &contentType,
+                                const QByteArray &body) {
+  auto it = m_books.find(readerId);
+  if (it == m_books.end() || !isSafeId(uid) || body.isEmpty())
+    return false;
+  Book &book = it.value();
+  int n = -1;
+  for (int i = 0; i < book.endpoints.size() && n < 0; ++i) {
+    if (book.endpoints.at(i).ep == ep)
+      n = i;
+  }
+  if (n < 0)
+    return false;
+  const QString key = QString::number(n) + QLatin1Char('/') + uid;
+  Item item;
+  if (!writeItem(book, QStringLiteral("c/%1_%2").arg(n).arg(uid), contentType,
+                 body, &item))
+    return false;
+  auto old = book.chapters.constFind(key);
+  if (old != book.chapters.cend())
+    book.bytes -= old->size; // rewritten in place
+  book.chapters.insert(key, item);
+  touch(readerId);
+  return true;
+}
+
+void OfflineArchive::queueAssets(const QString &readerId,
+                                 const QStringList &urls) {
+  auto it = m_books.find(readerId);
+  if (it == m_books.end())
+    return;
+  for (const QString &s : urls) {
+    const QUrl url(s);
+    if (url.scheme() != QLatin1String("https") || url.host().isEmpty())
+      continue;
+    if (it->assets.size() + m_assetQueue.size() >= kMaxAssetsPerBook)
+      break;
+    const QString key = urlKey(url);
+    if (m_assetOf.contains(key))
+      continue;
+    bool queued = false;
+    for (const PendingAsset &p : m_assetQueue)
+      queued = queued || urlKey(p.url) == key;
+    if (!queued)
+      m_assetQueue.append({readerId, url});
+  }
+  startAssets();
+}
+
+void OfflineArchive::startAssets() {
+  while (m_assetsInFlight < kMaxAssetsInFlight && !m_assetQueue.isEmpty()) {
+    const PendingAsset pending = m_assetQueue.takeFirst();
+    QNetworkRequest req(pending.url);
+    // same as the browser: no HTTP/2 (see --disable-http2 in main.cpp)
+    req.setAttribute(QNetworkRequest::Http2AllowedAttribute, false);
+    if (!m_userAgent.isEmpty())
+      req.setHeader(QNetworkRequest::UserAgentHeader, m_userAgent);
+    req.setRawHeader(QByteArrayLiteral("Referer"),
+                     QByteArrayLiteral("https://weread.qq.com/"));
+    QNetworkReply *reply = m_nam.get(req);
+    ++m_assetsInFlight;
+    connect(reply, &QNetworkReply::finished, this, [this, reply, pending]() {
+      reply->deleteLater();
+      --m_assetsInFlight;
+      const int status =
+          reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+      const QByteArray data = reply->readAll();
+      auto it = m_books.find(pending.readerId);
+      if (reply->error() != QNetworkReply::NoError || status != 200 ||
+          data.isEmpty() || it == m_books.end()) {
+        qWarning() << "[OFFLINE] asset failed" << pending.url << "status"
+                   << status << reply->errorString();
+        startAssets();
+        return;
+      }
+      const QString key = urlKey(pending.url);
+      const QString hex = QString::fromLatin1(sha256Hex(key.toUtf8()));
+      const QByteArray type =
+          reply->header(QNetworkRequest::ContentTypeHeader)
+              .toString()
+              .toLatin1();
+      Item item;
+      if (writeItem(it.value(), QStringLiteral("a/") + hex, type, data,
+                    &item)) {
+        it->assets.insert(hex, item);
+        m_assetOf.insert(key, pending.readerId + QStringLiteral("/a/") + hex);
+        touch(pending.readerId);
+      }
+      startAssets();
+    });
+  }
+}
+
+void OfflineArchive::finishBook(const QString &readerId, int failed) {
+  auto it = m_books.find(readerId);
+  if (it == m_books.end())
+    return;
+  it->failed = failed;
+  it->complete = failed == 0 && it->chapters.size() >= it->expected;
+  touch(readerId);
+  qInfo() << "[OFFLINE] finish" << readerId << "chapters" << it->chapters.size()
+          << "expected" << it->expected << "failed" << failed << "assets"
+          << it->assets.size() << "queued" << m_assetQueue.size() << "bytes"
+          << it->bytes;
+}
+
+void OfflineArchive::removeBook(const QString &readerId) {
+  if (!m_books.remove(readerId))
+    return;
+  for (auto it = m_assetOf.begin(); it != m_assetOf.end();) {
+    if (it.value().startsWith(readerId + QLatin1Char('/')))
+      it = m_assetOf.erase(it);
+    else
+      ++it;
+  }
+  m_dirty.removeAll(readerId);
+  QDir(bookDir(readerId)).removeRecursively();
+  qInfo() << "[OFFLINE] removed" << readerId;
+  emit changed();
+}
+
+QUrl OfflineArchive::redirectFor(const QUrl &url) const {
+  const auto it = m_assetOf.constFind(urlKey(url));
+  if (it == m_assetOf.cend())
+    return QUrl();
+  QUrl out;
+  out.setScheme(QLatin1String(kScheme));
+  out.setHost(QLatin1String(kHost));
+  out.setPath(QLatin1Char('/') + it.value());
+  return out;
+}
+
+bool OfflineArchive::read(const QUrl &url, QByteArray *body,
+                          QByteArray *contentType) {
+  // /<readerId>/c/<n>/<uid> or /<readerId>/a/<hex>
+  const QStringList parts = url.path().split(QLatin1Char('/'),
+                                             Qt::SkipEmptyParts);
+  auto book = parts.size() >= 3 ? m_books.find(parts.at(0)) : m_books.end();
+  if (book == m_books.end()) {
+    ++m_misses;
+    return false;
+  }
+  QHash<QString, Item> *items = nullptr;
+  QString key;
+  if (parts.at(1) == QLatin1String("c") && parts.size() == 4) {
+    items = &book->chapters;
+    key = parts.at(2) + QLatin1Char('/') + parts.at(3);
+  } else if (parts.at(1) == QLatin1String("a") && parts.size() == 3) {
+    items = &book->assets;
+    key = parts.at(2);
+  }
+  auto item = items ? items->find(key) : QHash<QString, Item>::iterator();
+  if (!items || item == items->end()) {
+    ++m_misses;
+    return false;
+  }
+  QFile f(bookDir(book->readerId) + QLatin1Char('/') + item->file);
+  QByteArray data;
+  if (f.open(QIODevice::ReadOnly))
+    data = f.readAll();
+  if (data.size() != item->size || sha256Hex(data) != item->hash) {
+    qWarning() << "[OFFLINE] corrupt" << url.path() << "-> dropped";
+    book->bytes -= item->size;
+    f.remove();
+    if (items == &book->assets) {
+      for (auto a = m_assetOf.begin(); a != m_assetOf.end(); ++a) {
+        if (a.value().endsWith(key)) {
+          m_assetOf.erase(a);
+          break;
+        }
+      }
+    }
+    items->erase(item);
+    book->complete = false;
+    ++m_corrupt;
+    ++m_misses;
+    touch(book->readerId);
+    return false;
+  }
+  ++m_hits;
+  *body = data;
+  if (contentType)
+    *contentType = item->contentType;
+  return true;
+}
+
+void OfflineArchive::touch(const QString &readerId) {
+  auto it = m_books.find(readerId);
+  if (it != m_books.end())
+    it->updatedMs = nowMs();
+  if (!m_dirty.contains(readerId))
+    m_dirty.append(readerId);
+  m_saveTimer.start();
+}
+
+void OfflineArchive::loadBook(const QString &readerId) {
+  QFile f(bookDir(readerId) + QStringLiteral("/manifest.json"));
+  if (!f.open(QIODevice::ReadOnly))
+    return;
+  const QJsonObject root = QJsonDocument::fromJson(f.readAll()).object();
+  Book book;
+  book.readerId = readerId;
+  book.bookId = root.value(QStringLiteral("bookId")).toString();
+  book.expected = root.value(QStringLiteral("expected")).toInt();
+  book.failed = root.value(QStringLiteral("failed")).toInt();
+  book.complete = root.value(QStringLiteral("complete")).toBool();
+  book.updatedMs = root.value(QStringLiteral("updatedMs")).toInteger();
+  for (const QJsonValue &v : root.value(QStringLiteral("eps")).toArray()) {
+    const QJsonObject o = v.toObject();
+    book.endpoints.append({o.value(QStringLiteral("ep")).toString(),
+                           o.value(QStringLiteral("where")).toString(),
+                           o.value(QStringLiteral("key")).toString()});
+  }
+  const QString dir = bookDir(readerId) + QLatin1Char('/');
+  auto loadItems = [&](const QString &name, QHash<QString, Item> *out) {
+    const QJsonObject items = root.value(name).toObject();
+    for (auto it = items.begin(); it != items.end(); ++it) {
+      const QJsonObject o = it.value().toObject();
+      Item item;
+      item.file = o.value(QStringLiteral("f")).toString();
+      item.hash = o.value(QStringLiteral("h")).toString().toLatin1();
+      item.size = o.value(QStringLiteral("s")).toInteger();
+      item.contentType = o.value(QStringLiteral("t")).toString().toLatin1();
+      if (item.file.isEmpty() || QFileInfo(dir + item.file).size() != item.size)
+        continue; // file lost (partial copy, manual cleanup)
+      out->insert(it.key(), item);
+      book.bytes += item.size;
+    }
+  };
+  loadItems(QStringLiteral("chapters"), &book.chapters);
+  loadItems(QStringLiteral("assets"), &book.assets);
+  const QJsonObject urls = root.value(QStringLiteral("urls")).toObject();
+  for (auto it = urls.begin(); it != urls.end(); ++it) {
+    const QString hex = it.value().toString();
+    if (book.assets.contains(hex))
+      m_assetOf.insert(it.key(), readerId + QStringLiteral("/a/") + hex);
+  }
+  m_books.insert(readerId, book);
+}
+
+void OfflineArchive::saveBook(const QString &readerId) {
+  const auto book = m_books.constFind(readerId);
+  if (book == m_books.cend())
+    return;
+  QJsonArray eps;
+  for (const Endpoint &e : book->endpoints) {
+    QJsonObject o;
+    o.insert(QStringLiteral("ep"), e.ep);
+    o.insert(QStringLiteral("where"), e.where);
+    o.insert(QStringLiteral("key"), e.key);
+    eps.append(o);
+  }
+  QJsonObject chapters;
+  for (auto it = book->chapters.cbegin(); it != book->chapters.cend(); ++it)
+    chapters.insert(it.key(), itemJson(it->file, it->hash, it->size,
+                                       it->contentType));
+  QJsonObject assets;
+  for (auto it = book->assets.cbegin(); it != book->assets.cend(); ++it)
+    assets.insert(it.key(), itemJson(it->file, it->hash, it->size,
+                                     it->contentType));
+  QJsonObject urls;
+  const QString prefix = readerId + QStringLiteral("/a/");
+  for (auto it = m_assetOf.cbegin(); it != m_assetOf.cend(); ++it) {
+    if (it.value().startsWith(prefix))
+      urls.insert(it.key(), it.value().mid(prefix.size()));
+  }
+  QJsonObject root;
+  root.insert(QStringLiteral("v"), 1);
+  root.insert(QStringLiteral("readerId"), readerId);
+  root.insert(QStringLiteral("bookId"), book->bookId);
+  root.insert(QStringLiteral("expected"), book->expected);
+  root.insert(QStringLiteral("failed"), book->failed);
+  root.insert(QStringLiteral("complete"), book->complete);
+  root.insert(QStringLiteral("updatedMs"), book->updatedMs);
+  root.insert(QStringLiteral("eps"), eps);
+  root.insert(QStringLiteral("chapters"), chapters);
+  root.insert(QStringLiteral("assets"), assets);
+  root.insert(QStringLiteral("urls"), urls);
+  QSaveFile f(bookDir(readerId) + QStringLiteral("/manifest.json"));
+  if (!f.open(QIODevice::WriteOnly) ||
+      f.write(QJsonDocument(root).toJson(QJsonDocument::Compact)) < 0 ||
+      !f.commit())
+    qWarning() << "[OFFLINE] cannot save manifest for" << readerId;
+}
+
+void OfflineArchive::saveDirty() {
+  m_saveTimer.stop();
+  if (m_dirty.isEmpty())
+    return;
+  const QStringList dirty = m_dirty;
+  m_dirty.clear();
+  for (const QString &readerId : dirty)
+    saveBook(readerId);
+  emit changed();
+}
+
+QJsonObject OfflineArchive::pageManifest(const QString &readerId) const {
+  const auto book = m_books.constFind(readerId);
+  if (book == m_books.cend() || book->chapters.isEmpty())
+    return QJsonObject();
+  QJsonArray eps;
+  for (const Endpoint &e : book->endpoints) {
+    QJsonObject o;
+    o.insert(QStringLiteral("ep"), e.ep);
+    o.insert(QStringLiteral("where"), e.where);
+    o.insert(QStringLiteral("key"), e.key);
+    eps.append(o);
+  }
+  QJsonObject have;
+  for (auto it = book->chapters.cbegin(); it != book->chapters.cend(); ++it)
+    have.insert(it.key(), 1);
+  QJsonObject o;
+  o.insert(QStringLiteral("eps"), eps);
+  o.insert(QStringLiteral("have"), have);
+  return o;
+}
+
+QJsonObject OfflineArchive::snapshot() const {
+  QJsonArray books;
+  for (auto book = m_books.cbegin(); book != m_books.cend(); ++book) {
+    QJsonObject o;
+    o.insert(QStringLiteral("readerId"), book->readerId);
+    o.insert(QStringLiteral("bookId"), book->bookId);
+    o.insert(QStringLiteral("chapters"), int(book->chapters.size()));
+    o.insert(QStringLiteral("expected"), book->expected);
+    o.insert(QStringLiteral("failed"), book->failed);
+    o.insert(QStringLiteral("assets"), int(book->assets.size()));
+    o.insert(QStringLiteral("bytes"), book->bytes);
+    o.insert(QStringLiteral("complete"), book->complete);
+    o.insert(QStringLiteral("updatedMs"), book->updatedMs);
+    books.append(o);
+  }
+  QJsonObject o;
+  o.insert(QStringLiteral("root"), m_root);
+  o.insert(QStringLiteral("books"), books);
+  o.insert(QStringLiteral("queuedAssets"),
+           int(m_assetQueue.size()) + m_assetsInFlight);
+  o.insert(QStringLiteral("hits"), qint64(m_hits));
+  o.insert(QStringLiteral("misses"), qint64(m_misses));
+  o.insert(QStringLiteral("corrupt"), qint64(m_corrupt));
+  return o;
+}
+
+QStringList OfflineArchive::summaryLines() const {
+  QStringList lines;
+  for (auto book = m_books.cbegin(); book != m_books.cend(); ++book) {
+    lines << QStringLiteral("%1 book=%2 chapters=%3/%4 failed=%5 assets=%6 "
+                            "bytes=%7 complete=%8")
+                 .arg(book->readerId, book->bookId)
+                 .arg(book->chapters.size())
+                 .arg(book->expected)
+                 .arg(book->failed)
+                 .arg(book->assets.size())
+                 .arg(book->bytes)
+                 .arg(book->complete ? 1 : 0);
+  }
+  lines << QStringLiteral("hits=%1 misses=%2 corrupt=%3 queuedAssets=%4")
+               .arg(m_hits)
+               .arg(m_misses)
+               .arg(m_corrupt)
+               .arg(m_assetQueue.size() + m_assetsInFlight);
+  return lines;
+}
+
+OfflineBookHandler::OfflineBookHandler(OfflineArchive *archive,
+                                       QObject *parent)
+    : QWebEngineUrlSchemeHandler(parent), m_archive(archive) {}
+
+void OfflineBookHandler::requestStarted(QWebEngineUrlRequestJob *job) {
+  if (job->requestMethod() != QByteArrayLiteral("GET")) {
+    job->fail(QWebEngineUrlRequestJob::RequestDenied);
+    return;
+  }
+  QByteArray body;
+  QByteArray contentType;
+  if (!m_archive->read(job->requestUrl(), &body, &contentType)) {
+    job->fail(QWebEngineUrlRequestJob::UrlNotFound);
+    return;
+  }
+#if QT_VERSION >= QT_VERSION_CHECK(6, 7, 0)
+  // chapter content is fetched by the reader page; no other origin may
+  // read archived books
+  QMultiMap<QByteArray, QByteArray> headers;
+  headers.insert(QByteArrayLiteral("Access-Control-Allow-Origin"),
+                 QByteArray(kPageOrigin));
+  job->setAdditionalResponseHeaders(headers);
+#endif
+  auto *buffer = new QBuffer(job);
+  buffer->setData(body);
+  buffer->open(QIODevice::ReadOnly);
+  job->reply(contentType.isEmpty() ? QByteArrayLiteral("text/plain")
+                                   : contentType,
+             buffer);
+}
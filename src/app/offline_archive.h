@@ -0,0 +1,145 @@
+#ifndef OFFLINE_ARCHIVE_H
+#define OFFLINE_ARCHIVE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QNetworkAccessManager>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QUrl>
+#include <QWebEngineUrlSchemeHandler>
+
+class QWebEngineUrlRequestJob;
+
+// Per-book offline archive under <root>/<readerId>/. The page walks the
+// book's chapterInfos and replays the recorded chapter content requests
+// (see the prefetch templates in the chapter observer); every response is
+// stored here together with the images it references. Content requests are
+// identified by endpoint ("METHOD origin/path") plus the field that carries
+// the chapter uid, so the page can map its own request to
+// wrbook://book/<readerId>/c/<endpoint index>/<uid> without asking the host.
+// Images are keyed by URL and redirected by the request interceptor.
+// Every read re-hashes the file; a mismatch drops the entry.
+class OfflineArchive : public QObject {
+  Q_OBJECT
+public:
+  static constexpr const char *kScheme = "wrbook";
+  static constexpr const char *kHost = "book";
+  static constexpr int kMaxAssetsInFlight = 2;
+  // the only origin that may read wrbook:// responses
+  static constexpr const char *kPageOrigin = "https://weread.qq.com";
+
+  // how the page finds the uid in a content request
+  struct Endpoint {
+    QString ep; // "POST https://weread.qq.com/web/book/chapter/e_0"
+    QString where; // body | query
+    QString key;
+  };
+
+  explicit OfflineArchive(const QString &root, QObject *parent = nullptr);
+  ~OfflineArchive() override;
+
+  // reader ids and uids become path components
+  static bool isSafeId(const QString &id);
+  // readerId of a https://weread.qq.com/web/reader/<readerId> URL, else ""
+  static QString readerIdOf(const QUrl &url);
+  // Why a chapter content response must not be archived ("" = fine):
+  // empty, unparsable JSON, a non-zero errCode, succ:false, or only status
+  // fields. Same rules as contentError() in the chapter observer.
+  static QString contentError(const QByteArray &body);
+
+  void setUserAgent(const QByteArray &ua) { m_userAgent = ua; }
+  // Starts (or resumes) a download: records the endpoints and the number of
+  // content responses expected.
+  void beginBook(const QString &readerId, const QString &bookId,
+                 const QList<Endpoint> &endpoints, int total);
+  bool putChapter(const QString &readerId, const QString &ep,
+                  const QString &uid, const QByteArray &contentType,
+                  const QByteArray &body);
+  // Queues https image URLs for download into the book.
+  void queueAssets(const QString &readerId, const QStringList &urls);
+  void finishBook(const QString &readerId, int failed);
+  void removeBook(const QString &readerId);
+
+  bool hasBook(const QString &readerId) const;
+  // wrbook:// URL serving url from an archive, or an empty URL
+  QUrl redirectFor(const QUrl &url) const;
+  // url is a wrbook:// URL
+  bool read(const QUrl &url, QByteArray *body, QByteArray *contentType);
+
+  // {eps:[{ep, where, key}], have:{"<n>/<uid>":1}} for one book, the
+  // lookup table its reader page uses to map content requests; empty when
+  // nothing of the book is archived
+  QJsonObject pageManifest(const QString &readerId) const;
+  QJsonObject snapshot() const;
+  QStringList summaryLines() const;
+
+signals:
+  // a book's contents changed and its manifest was saved
+  void changed();
+
+private:
+  struct Item {
+    QString file; // relative to the book directory
+    QByteArray hash;
+    qint64 size = 0;
+    QByteArray contentType;
+  };
+  struct Book {
+    QString readerId;
+    QString bookId;
+    QList<Endpoint> endpoints;
+    QHash<QString, Item> chapters; // "<n>/<uid>"
+    QHash<QString, Item> assets;   // SHA-256 hex of the image URL
+    int expected = 0;
+    int failed = 0;
+    bool complete = false;
+    qint64 updatedMs = 0;
+    qint64 bytes = 0;
+  };
+  struct PendingAsset {
+    QString readerId;
+    QUrl url;
+  };
+
+  QString bookDir(const QString &readerId) const;
+  bool writeItem(Book &book, const QString &file, const QByteArray &type,
+                 const QByteArray &body, Item *out);
+  void startAssets();
+  void loadBook(const QString &readerId);
+  void saveBook(const QString &readerId);
+  void saveDirty();
+  void touch(const QString &readerId);
+
+  QString m_root;
+  QHash<QString, Book> m_books;      // readerId
+  QHash<QString, QString> m_assetOf; // image URL -> "<readerId>/a/<hex>"
+  QStringList m_dirty;
+  QTimer m_saveTimer;
+  QNetworkAccessManager m_nam;
+  QByteArray m_userAgent;
+  QList<PendingAsset> m_assetQueue;
+  int m_assetsInFlight = 0;
+  quint64 m_hits = 0;
+  quint64 m_misses = 0;
+  quint64 m_corrupt = 0;
+};
+
+// Serves wrbook:// requests from the archive; a miss fails the request so
+// the page falls back to the network.
+class OfflineBookHandler : public QWebEngineUrlSchemeHandler {
+  Q_OBJECT
+public:
+  OfflineBookHandler(OfflineArchive *archive, QObject *parent = nullptr);
+
+  void requestStarted(QWebEngineUrlRequestJob *job) override;
+
+private:
+  OfflineArchive *m_archive = nullptr;
+};
+
+#endif // OFFLINE_ARCHIVE_H
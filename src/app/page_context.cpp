@@ -0,0 +1,42 @@
+#include "page_context.h"
+
+#include <QString>
+
+PageContext PageContext::classify(const QUrl &url) {
+  PageContext ctx;
+  const QString u = url.toString();
+  if (u.contains(QStringLiteral("dedao.cn"))) {
+    ctx.site = Site::Dedao;
+    if (u.contains(QStringLiteral("/ebook/reader")))
+      ctx.kind = Kind::Reader;
+    else if (u.contains(QStringLiteral("/ebook/detail")))
+      ctx.kind = Kind::Detail;
+  } else if (u.contains(QStringLiteral("weread.qq.com"))) {
+    ctx.site = Site::WeRead;
+    if (u.contains(QStringLiteral("/web/reader")))
+      ctx.kind = Kind::Reader;
+  }
+  return ctx;
+}
+
+const char *PageContext::siteName(Site site) {
+  switch (site) {
+  case Site::WeRead:
+    return "weread";
+  case Site::Dedao:
+    return "dedao";
+  default:
+    return "other";
+  }
+}
+
+const char *PageContext::kindName(Kind kind) {
+  switch (kind) {
+  case Kind::Reader:
+    return "reader";
+  case Kind::Detail:
+    return "detail";
+  default:
+    return "other";
+  }
+}
@@ -0,0 +1,46 @@
+#ifndef PAGE_CONTEXT_H
+#define PAGE_CONTEXT_H
+
+#include <QUrl>
+#include <QtGlobal>
+
+class SmartRefreshManager;
+
+// What the current page is: site, page kind, UA mode and the smart refresh
+// manager that owns it. The browser recomputes it once per URL change and
+// per UA switch; gesture, refresh and navigation paths read the fields
+// instead of re-scanning the URL string on every event.
+struct PageContext {
+  enum class Site : quint8 { Other, WeRead, Dedao };
+  enum class Kind : quint8 { Other, Reader, Detail };
+
+  Site site = Site::Other;
+  Kind kind = Kind::Other;
+  bool kindleUA = false;
+  SmartRefreshManager *refresh = nullptr;
+
+  bool isWeReadBook() const {
+    return site == Site::WeRead && kind == Kind::Reader;
+  }
+  bool isDedaoBook() const {
+    return site == Site::Dedao && kind == Kind::Reader;
+  }
+  bool isDedaoSite() const { return site == Site::Dedao; }
+  bool isBookPage() const { return kind == Kind::Reader; }
+  bool isWeReadKindleMode() const { return isWeReadBook() && kindleUA; }
+
+  bool operator==(const PageContext &o) const {
+    return site == o.site && kind == o.kind && kindleUA == o.kindleUA &&
+           refresh == o.refresh;
+  }
+  bool operator!=(const PageContext &o) const { return !(*this == o); }
+
+  // Site and kind only; kindleUA and refresh are the caller's. Matches on
+  // the whole URL string like the checks it replaces, so saved local copies
+  // (WEREAD_LOCAL_HTML) classify the same way as the live pages.
+  static PageContext classify(const QUrl &url);
+  static const char *siteName(Site site);
+  static const char *kindName(Kind kind);
+};
+
+#endif // PAGE_CONTEXT_H
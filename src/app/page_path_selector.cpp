@@ -0,0 +1,189 @@
+#include "page_path_selector.h"
+
+#include <QDebug>
+#include <algorithm>
+#include <bitset>
+
+#include "common.h"
+
+namespace {
+const char *const kPathNames[PagePathSelector::PathCount] = {
+    "scroll", "keys", "pager_click", "dedao_keys"};
+constexpr double kEwmaAlpha = 0.25;
+} // namespace
+
+double PagePathSelector::PathStats::successRate() const {
+  if (window == 0)
+    return 0.0;
+  const quint32 mask = (1u << window) - 1u;
+  return static_cast<double>(std::bitset<32>(outcomes & mask).count()) /
+         window;
+}
+
+void PagePathSelector::PathStats::add(bool ok, qint64 ms) {
+  ++attempts;
+  outcomes = (outcomes << 1) | (ok ? 1u : 0u);
+  if (window < kWindow)
+    ++window;
+  if (!ok)
+    return;
+  ewmaMs = (ewmaMs <= 0) ? ms : ewmaMs + kEwmaAlpha * (ms - ewmaMs);
+}
+
+PagePathSelector::PagePathSelector(QObject *parent) : QObject(parent) {
+  m_clock.start();
+  m_timeout.setSingleShot(true);
+  m_timeout.setInterval(kTimeoutMs);
+  connect(&m_timeout, &QTimer::timeout, this, &PagePathSelector::onTimeout);
+}
+
+const char *PagePathSelector::pathName(int path) {
+  return (path >= 0 && path < PathCount) ? kPathNames[path] : "?";
+}
+
+bool PagePathSelector::reliable(const PathStats &s) {
+  return s.attempts >= kMinSamples && s.successRate() >= kMinSuccessRate;
+}
+
+PagePathSelector::Path
+PagePathSelector::choose(const QString &context, const QList<Path> &viable,
+                         Path fallback) {
+  if (viable.size() <= 1)
+    return viable.isEmpty() ? fallback : viable.first();
+  Context &ctx = m_contexts[context];
+  ++ctx.turns;
+
+  // Explore only once the default has a baseline, and sparingly: a bad
+  // path costs the user a slow turn before the executor's own fallback.
+  const PathStats &base = ctx.paths[fallback];
+  if (base.attempts >= kMinSamples && ctx.turns % kExploreEvery == 0) {
+    for (Path p : viable) {
+      if (p != fallback && ctx.paths[p].attempts < kMinSamples)
+        return p;
+    }
+  }
+  if (ctx.turns % kReprobeEvery == 0) {
+    const Path *stalest = nullptr;
+    for (const Path &p : viable) {
+      if (p == ctx.current)
+        continue;
+      if (!stalest || ctx.paths[p].lastTurn < ctx.paths[*stalest].lastTurn)
+        stalest = &p;
+    }
+    if (stalest)
+      return *stalest;
+  }
+
+  int best = -1;
+  for (Path p : viable) {
+    const PathStats &s = ctx.paths[p];
+    if (!reliable(s))
+      continue;
+    if (best < 0 || s.ewmaMs < ctx.paths[best].ewmaMs)
+      best = p;
+  }
+  int next = fallback;
+  if (best >= 0) {
+    const bool keepCurrent =
+        ctx.current >= 0 && viable.contains(Path(ctx.current)) &&
+        reliable(ctx.paths[ctx.current]) &&
+        ctx.paths[best].ewmaMs >
+            ctx.paths[ctx.current].ewmaMs * kSwitchMargin;
+    next = keepCurrent ? ctx.current : best;
+  }
+  if (next != ctx.current) {
+    qInfo() << "[PATHSEL]" << context << "switch"
+            << pathName(ctx.current) << "->" << pathName(next);
+    ctx.current = next;
+  }
+  return Path(next);
+}
+
+void PagePathSelector::begin(const QString &context, Path path, int seq) {
+  m_pendingContext = context;
+  m_pendingPath = path;
+  m_pendingSeq = seq;
+  m_pendingStartMs = m_clock.elapsed();
+  m_contexts[context].paths[path].lastTurn = m_contexts[context].turns;
+  m_timeout.start();
+}
+
+void PagePathSelector::noteDom(int seq) {
+  if (m_pendingPath < 0 || seq != m_pendingSeq)
+    return;
+  finish(true, m_clock.elapsed() - m_pendingStartMs);
+}
+
+void PagePathSelector::noteFailure(int seq) {
+  if (m_pendingPath < 0 || seq != m_pendingSeq)
+    return;
+  finish(false, m_clock.elapsed() - m_pendingStartMs);
+}
+
+void PagePathSelector::onTimeout() {
+  if (m_pendingPath < 0)
+    return;
+  qInfo() << "[PATHSEL]" << m_pendingContext << pathName(m_pendingPath)
+          << "no DOM change within" << kTimeoutMs << "ms";
+  finish(false, kTimeoutMs);
+}
+
+void PagePathSelector::finish(bool ok, qint64 ms) {
+  m_timeout.stop();
+  PathStats &s = m_contexts[m_pendingContext].paths[m_pendingPath];
+  s.add(ok, ms);
+  if (logLevelAtLeast(LogLevel::Info)) {
+    qInfo() << "[PATHSEL]" << m_pendingContext << pathName(m_pendingPath)
+            << (ok ? "ok" : "fail") << ms << "ms ewma"
+            << qRound(s.ewmaMs) << "rate" << s.successRate();
+  }
+  m_pendingPath = -1;
+}
+
+QJsonObject PagePathSelector::snapshot() const {
+  QJsonObject out;
+  for (auto it = m_contexts.cbegin(); it != m_contexts.cend(); ++it) {
+    const Context &ctx = it.value();
+    QJsonObject paths;
+    for (int p = 0; p < PathCount; ++p) {
+      const PathStats &s = ctx.paths[p];
+      if (s.attempts == 0)
+        continue;
+      QJsonObject obj;
+      obj.insert(QStringLiteral("attempts"), s.attempts);
+      obj.insert(QStringLiteral("rate"), s.successRate());
+      obj.insert(QStringLiteral("ewmaMs"), qRound(s.ewmaMs));
+      paths.insert(QLatin1String(kPathNames[p]), obj);
+    }
+    QJsonObject c;
+    c.insert(QStringLiteral("turns"), static_cast<qint64>(ctx.turns));
+    c.insert(QStringLiteral("current"), QLatin1String(pathName(ctx.current)));
+    c.insert(QStringLiteral("paths"), paths);
+    out.insert(it.key(), c);
+  }
+  return out;
+}
+
+QStringList PagePathSelector::summaryLines() const {
+  QStringList lines;
+  for (auto it = m_contexts.cbegin(); it != m_contexts.cend(); ++it) {
+    const Context &ctx = it.value();
+    QStringList parts;
+    for (int p = 0; p < PathCount; ++p) {
+      const PathStats &s = ctx.paths[p];
+      if (s.attempts == 0)
+        continue;
+      parts << QStringLiteral("%1 n=%2 rate=%3 ewma=%4ms")
+                   .arg(QLatin1String(kPathNames[p]))
+                   .arg(s.attempts)
+                   .arg(s.successRate(), 0, 'f', 2)
+                   .arg(qRound(s.ewmaMs));
+    }
+    lines << QStringLiteral("%1 current=%2 turns=%3 | %4")
+                 .arg(it.key(), QLatin1String(pathName(ctx.current)))
+                 .arg(ctx.turns)
+                 .arg(parts.join(QStringLiteral("; ")));
+  }
+  std::sort(lines.begin(), lines.end());
+  return lines;
+}
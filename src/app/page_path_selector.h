@@ -0,0 +1,93 @@
+#ifndef PAGE_PATH_SELECTOR_H
+#define PAGE_PATH_SELECTOR_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <array>
+
+// Chooses how a page turn is executed in a given site/mode context. Every
+// turn is timed from dispatch to the first DOM change report tagged with
+// the turn's seq (the page runtime's markTurn); no report
+// within kTimeoutMs, or the executor reporting its own fallback, counts as
+// a failure. Per context and path it keeps an EWMA of the latency and the
+// last kWindow outcomes, and prefers the fastest path whose success rate is
+// at least kMinSuccessRate. The caller's default path is used until the
+// alternatives have been sampled, and again whenever nothing else is
+// reliable, so a path that starts failing drops out on its own.
+class PagePathSelector : public QObject {
+  Q_OBJECT
+public:
+  enum Path {
+    PathScroll = 0, // runtime page(n): one scrollTo
+    PathKeys,       // injected arrow keys + input fallback
+    PathPagerClick, // runtime pagerClick(): reader pager button
+    PathDedaoKeys,  // dedao PageDown/PageUp
+    PathCount
+  };
+
+  static constexpr int kTimeoutMs = 1500;
+  static constexpr int kWindow = 10;
+  static constexpr int kMinSamples = 3;
+  static constexpr double kMinSuccessRate = 0.8;
+  // one turn in kExploreEvery samples a path that has too few attempts;
+  // one in kReprobeEvery refreshes the stalest non-current path
+  static constexpr int kExploreEvery = 10;
+  static constexpr int kReprobeEvery = 200;
+  // a challenger must be this much faster to replace the current path
+  static constexpr double kSwitchMargin = 0.9;
+
+  explicit PagePathSelector(QObject *parent = nullptr);
+
+  static const char *pathName(int path);
+
+  // viable: paths that can run in this context; fallback: the path the
+  // UA/mode checks would have picked.
+  Path choose(const QString &context, const QList<Path> &viable,
+              Path fallback);
+  // Start timing turn seq; an unresolved previous turn is dropped unscored.
+  void begin(const QString &context, Path path, int seq);
+  // First DOM change reported for turn seq: success with its latency.
+  // Reports for other turns (late changes, unrelated mutations) are ignored.
+  void noteDom(int seq);
+  // The executor of turn seq had to fall back (nothing moved, no button).
+  void noteFailure(int seq);
+
+  QJsonObject snapshot() const;
+  QStringList summaryLines() const;
+
+private:
+  struct PathStats {
+    int attempts = 0;
+    int window = 0;         // outcomes in the bitmask, <= kWindow
+    quint32 outcomes = 0;   // bit i = attempt i back succeeded
+    double ewmaMs = 0;
+    quint64 lastTurn = 0;   // ctx turn number of the last attempt
+    double successRate() const;
+    void add(bool ok, qint64 ms);
+  };
+  struct Context {
+    std::array<PathStats, PathCount> paths{};
+    quint64 turns = 0;
+    int current = -1;
+  };
+
+  void finish(bool ok, qint64 ms);
+  void onTimeout();
+  static bool reliable(const PathStats &s);
+
+  QHash<QString, Context> m_contexts;
+  QElapsedTimer m_clock;
+  QTimer m_timeout;
+  QString m_pendingContext;
+  int m_pendingPath = -1;
+  int m_pendingSeq = 0;
+  qint64 m_pendingStartMs = 0;
+};
+
+#endif // PAGE_PATH_SELECTOR_H
@@ -0,0 +1,62 @@
+#include "page_turn_controller.h"
+
+PageTurnController::PageTurnController(QObject *parent) : QObject(parent) {
+  m_watchdog.setSingleShot(true);
+  m_watchdog.setInterval(kDefaultWatchdogMs);
+  connect(&m_watchdog, &QTimer::timeout, this,
+          &PageTurnController::onWatchdog);
+}
+
+bool PageTurnController::request(int pages) {
+  return enqueue(pages, kMaxPagesPerTurn);
+}
+
+bool PageTurnController::jump(int pages) {
+  return enqueue(pages, kMaxPagesPerJump);
+}
+
+bool PageTurnController::enqueue(int pages, int limit) {
+  if (pages == 0)
+    return false;
+  if (busy()) {
+    // taps folded onto a queued jump must not shrink it to the tap limit
+    const int bound = qMax(limit, qAbs(m_queued));
+    m_queued = qBound(-bound, m_queued + pages, bound);
+    return false;
+  }
+  start(qBound(-limit, pages, limit));
+  return true;
+}
+
+void PageTurnController::complete(int seq, int pagesDone) {
+  if (seq == 0 || seq != m_inFlightSeq)
+    return;
+  m_watchdog.stop();
+  const int remaining = m_inFlightPages - pagesDone;
+  m_inFlightSeq = 0;
+  m_inFlightPages = 0;
+  const int next =
+      qBound(-kMaxPagesPerJump, m_queued + remaining, kMaxPagesPerJump);
+  m_queued = 0;
+  if (next != 0)
+    start(next);
+  else
+    emit idle();
+}
+
+void PageTurnController::start(int pages) {
+  m_inFlightSeq = ++m_lastSeq;
+  m_inFlightPages = qBound(-kMaxPagesPerJump, pages, kMaxPagesPerJump);
+  m_watchdog.start();
+  emit execute(m_inFlightSeq, m_inFlightPages);
+}
+
+void PageTurnController::onWatchdog() {
+  const int seq = m_inFlightSeq;
+  if (seq == 0)
+    return;
+  emit watchdogExpired(seq);
+  // Nothing came back. Assume the one action an executor sends per turn
+  // landed, so queued taps still run; the other pages stay queued.
+  complete(seq, m_inFlightPages > 0 ? 1 : -1);
+}
@@ -0,0 +1,59 @@
+#ifndef PAGE_TURN_CONTROLLER_H
+#define PAGE_TURN_CONTROLLER_H
+
+#include <QObject>
+#include <QTimer>
+
+// Single owner of page-turn state. A request while a turn is in flight is
+// folded into a net page delta (next + prev cancel out) and runs as one
+// multi-page turn when the current one completes, instead of being dropped.
+// The controller knows nothing about the web view: it emits execute() and
+// the executor reports back through complete(). One watchdog timer is reused
+// for every turn. Executors that move one page per action (the pager button,
+// the WeRead and Dedao keys) report pagesDone = +-1 and the rest runs as the next
+// turn, so each action waits for the previous one to land. The watchdog
+// likewise counts a silent turn as one page moved and requeues the rest.
+class PageTurnController : public QObject {
+  Q_OBJECT
+public:
+  static constexpr int kDefaultWatchdogMs = 1200;
+  static constexpr int kMaxPagesPerTurn = 5;
+  static constexpr int kMaxPagesPerJump = 20;
+
+  explicit PageTurnController(QObject *parent = nullptr);
+
+  // pages: +1 next, -1 prev. Returns true if a turn started right away,
+  // false if it was queued (or pages == 0).
+  bool request(int pages);
+  // Explicit multi-page jump (long swipe, hold-and-drag): same folding as
+  // request() but bounded by kMaxPagesPerJump instead of the tap limit.
+  bool jump(int pages);
+  // The executor finished turn seq after moving pagesDone pages (signed).
+  // Pages it did not get to go back into the queue. Stale seqs are ignored.
+  void complete(int seq, int pagesDone);
+
+  bool busy() const { return m_inFlightSeq != 0; }
+  int inFlightSeq() const { return m_inFlightSeq; }
+  int inFlightPages() const { return m_inFlightPages; }
+  int queuedPages() const { return m_queued; }
+  void setWatchdogMs(int ms) { m_watchdog.setInterval(ms); }
+
+signals:
+  void execute(int seq, int pages);
+  void watchdogExpired(int seq);
+  // A turn completed and nothing is queued behind it.
+  void idle();
+
+private:
+  bool enqueue(int pages, int limit);
+  void start(int pages);
+  void onWatchdog();
+
+  QTimer m_watchdog;
+  int m_lastSeq = 0;
+  int m_inFlightSeq = 0;
+  int m_inFlightPages = 0;
+  int m_queued = 0;
+};
+
+#endif // PAGE_TURN_CONTROLLER_H
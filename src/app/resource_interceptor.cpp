@@ -1,10 +1,57 @@
 #include "resource_interceptor.h"
 #include "weread_browser.h"
 
-void ResourceInterceptor::interceptRequest(QWebEngineUrlRequestInfo &info) {
-  const QString url = info.requestUrl().toString();
+ResourceInterceptor::ResourceInterceptor(WereadBrowser *browser,
+                                         QObject *parent)
+    : QWebEngineUrlRequestInterceptor(parent), m_browser(browser) {
+  const QString corpusPath = qEnvironmentVariable("WEREAD_URL_CORPUS");
+  if (!corpusPath.isEmpty()) {
+    m_corpus.setFileName(corpusPath);
+    if (m_corpus.open(QIODevice::WriteOnly | QIODevice::Append))
+      qInfo() << "[URL_RULES] recording URL corpus to" << corpusPath;
+    else
+      qWarning() << "[URL_RULES] cannot open corpus" << corpusPath;
+  }
+  const QString path = qEnvironmentVariable("WEREAD_URL_RULES");
+  QString error;
+  if (!path.isEmpty() && m_rules.loadFile(path, &error)) {
+    qInfo() << "[URL_RULES] loaded" << m_rules.size() << "rules from" << path;
+    return;
+  }
+  if (!path.isEmpty())
+    qWarning() << "[URL_RULES]" << path << error << "-> built-in rules";
+  m_rules.load(UrlRuleSet::defaultRules());
+}
 
+UrlRuleSet::Kind
+ResourceInterceptor::kindOf(QWebEngineUrlRequestInfo::ResourceType type) {
+  switch (type) {
+  case QWebEngineUrlRequestInfo::ResourceTypeMainFrame:
+  case QWebEngineUrlRequestInfo::ResourceTypeNavigationPreloadMainFrame:
+    return UrlRuleSet::KindMainFrame;
+  case QWebEngineUrlRequestInfo::ResourceTypeSubFrame:
+  case QWebEngineUrlRequestInfo::ResourceTypeNavigationPreloadSubFrame:
+    return UrlRuleSet::KindSubFrame;
+  case QWebEngineUrlRequestInfo::ResourceTypeStylesheet:
+    return UrlRuleSet::KindStylesheet;
+  case QWebEngineUrlRequestInfo::ResourceTypeScript:
+    return UrlRuleSet::KindScript;
+  case QWebEngineUrlRequestInfo::ResourceTypeImage:
+    return UrlRuleSet::KindImage;
+  case QWebEngineUrlRequestInfo::ResourceTypeFontResource:
+    return UrlRuleSet::KindFont;
+  case QWebEngineUrlRequestInfo::ResourceTypeMedia:
+    return UrlRuleSet::KindMedia;
+  case QWebEngineUrlRequestInfo::ResourceTypeXhr:
+    return UrlRuleSet::KindXhr;
+  default:
+    return UrlRuleSet::KindOther;
+  }
+}
+
+void ResourceInterceptor::interceptRequest(QWebEngineUrlRequestInfo &info) {
 #ifdef WEREAD_DEBUG_RESOURCES
+  const QString url = info.requestUrl().toString();
   const qint64 reqStartTs = QDateTime::currentMSecsSinceEpoch();
   const QString resourceTypeStr = [&]() {
     switch (info.resourceType()) {
@@ -36,36 +83,14 @@ void ResourceInterceptor::interceptRequest(QWebEngineUrlRequestInfo &info) {
           << reqStartTs;
 #endif
 
-  auto resourceTypeStr = [&]() {
-    switch (info.resourceType()) {
-    case QWebEngineUrlRequestInfo::ResourceTypeMainFrame:
-      return "MainFrame";
-    case QWebEngineUrlRequestInfo::ResourceTypeNavigationPreloadMainFrame:
-      return "NavPreloadMainFrame";
-    case QWebEngineUrlRequestInfo::ResourceTypeNavigationPreloadSubFrame:
-      return "NavPreloadSubFrame";
-    case QWebEngineUrlRequestInfo::ResourceTypeSubFrame:
-      return "SubFrame";
-    case QWebEngineUrlRequestInfo::ResourceTypeStylesheet:
-      return "Stylesheet";
-    case QWebEngineUrlRequestInfo::ResourceTypeScript:
-      return "Script";
-    case QWebEngineUrlRequestInfo::ResourceTypeImage:
-      return "Image";
-    case QWebEngineUrlRequestInfo::ResourceTypeFontResource:
-      return "Font";
-    case QWebEngineUrlRequestInfo::ResourceTypeMedia:
-      return "Media";
-    case QWebEngineUrlRequestInfo::ResourceTypeXhr:
-      return "XHR";
-    default:
-      return "Other";
-    }
-  };
-
-  if (info.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeMainFrame ||
-      info.resourceType() ==
-          QWebEngineUrlRequestInfo::ResourceTypeNavigationPreloadMainFrame) {
+  const UrlRuleSet::Kind kind = kindOf(info.resourceType());
+  if (m_corpus.isOpen()) {
+    m_corpus.write(UrlRuleSet::kindName(kind));
+    m_corpus.write(" ");
+    m_corpus.write(info.requestUrl().toEncoded());
+    m_corpus.write("\n");
+  }
+  if (kind == UrlRuleSet::KindMainFrame) {
     const QUrl firstParty = info.firstPartyUrl();
     const QUrl initiator = info.initiator();
     const QUrl current = m_browser ? m_browser->currentUrlForLog() : QUrl();
@@ -75,7 +100,7 @@ void ResourceInterceptor::interceptRequest(QWebEngineUrlRequestInfo &info) {
     const qint64 now = QDateTime::currentMSecsSinceEpoch();
     const qint64 reasonAge =
         m_browser ? (now - m_browser->navReasonTs()) : -1;
-    qInfo() << "[RESOURCE_MAIN]" << "url" << url
+    qInfo() << "[RESOURCE_MAIN]" << "url" << info.requestUrl().toString()
             << "navType" << info.navigationType()
             << "firstParty" << firstParty << "initiator" << initiator
             << "method" << info.requestMethod()
@@ -83,37 +108,68 @@ void ResourceInterceptor::interceptRequest(QWebEngineUrlRequestInfo &info) {
             << "reasonTarget" << reasonTarget << "reasonAgeMs" << reasonAge;
   }
 
-  // Block winktemplaterendersvr fonts/media (KaTeX related)
-  if (url.contains(QStringLiteral("/winktemplaterendersvr/")) &&
-      (info.resourceType() ==
-           QWebEngineUrlRequestInfo::ResourceTypeFontResource ||
-       info.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeMedia)) {
-    qWarning() << "[BLOCK]" << resourceTypeStr() << url;
-    info.block(true);
-    return;
+  // 规则匹配 "//host/path?query"：每个请求编码一次（QUrl 只能返回新分配的
+  // 结果，没法写进复用的缓冲区），之后单遍匹配和主机统计不再分配；查询串
+  // 要保留，字体/样式加载器常把字体名放在参数里（如 family=SourceHanSerif）。
+  // 字符串化的完整 URL 只在命中需要打日志时才生成
+  const QByteArray matchUrl = info.requestUrl().toEncoded(
+      QUrl::RemoveScheme | QUrl::RemoveUserInfo | QUrl::RemovePort |
+      QUrl::RemoveFragment);
+  const UrlRuleSet::Result hit = m_rules.match(matchUrl, kind);
+  if (hit.matched) {
+    const QString full = info.requestUrl().toString();
+    for (quint64 m = hit.matched; m; m &= m - 1) {
+      const UrlRuleSet::Rule &rule =
+          m_rules.rule(qCountTrailingZeroBits(m));
+      if (rule.action == UrlRuleSet::Block && !hit.block)
+        continue; // allow 规则放行
+      const QString tag = QStringLiteral("[%1]").arg(
+          QString::fromLatin1(rule.tag));
+      if (rule.action == UrlRuleSet::Block)
+        qWarning().noquote() << tag << UrlRuleSet::kindName(kind) << full;
+      else
+        qInfo().noquote() << tag << UrlRuleSet::kindName(kind) << full;
+    }
   }
-
-  // Block SourceHanSerif heavy fonts (~10MB each)
-  if (url.contains(QStringLiteral("SourceHanSerif"))) {
-    qWarning() << "[BLOCK]" << resourceTypeStr() << url;
+  if (m_browser) {
+    // matchUrl 形如 "//host/path?query"，主机到第一个 '/' 或 '?' 为止
+    qsizetype end = 2;
+    while (end < matchUrl.size() && matchUrl.at(end) != '/' &&
+           matchUrl.at(end) != '?')
+      ++end;
+    // 连接预热的探测（__wr_warm=）不是页面流量，不计入
+    if (matchUrl.indexOf("__wr_warm=", end) < 0)
+      m_browser->netAccounting().noteRequest(
+          kind, QByteArray::fromRawData(matchUrl.constData() + 2, end - 2),
+          hit.block);
+  }
+  if (hit.block) {
     info.block(true);
     return;
   }
 
-  if (url.contains(QStringLiteral("TsangerYunHei-W05")) &&
-      info.resourceType() ==
-          QWebEngineUrlRequestInfo::ResourceTypeFontResource) {
-    qInfo() << "[FONT_ALLOW]" << resourceTypeStr() << url;
-  }
-
-  if (url.contains(QStringLiteral("chapterInfos"), Qt::CaseInsensitive)) {
-    qInfo() << "[CHAPTER_NET]" << resourceTypeStr() << url;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 7, 0)
+  // 带哈希的脚本/样式与字体：改由本地存储应答，未命中时 handler 代取并入库。
+  // 字体和 crossorigin 脚本是 CORS 请求，应答要带 Access-Control-Allow-Origin，
+  // 只有 6.7 起才能给 scheme handler 的应答加头，更早的版本不重定向
+  if (m_assets &&
+      (kind == UrlRuleSet::KindScript || kind == UrlRuleSet::KindStylesheet ||
+       kind == UrlRuleSet::KindFont) &&
+      info.requestMethod() == QByteArrayLiteral("GET") &&
+      AssetStore::isStorable(info.requestUrl())) {
+    info.redirect(AssetStore::toScheme(info.requestUrl()));
+    return;
   }
+#endif
 
-  // 进度接口早期记录（包括 ServiceWorker 发出的请求）
-  if (url.contains(QStringLiteral("/web/book/read")) ||
-      url.contains(QStringLiteral("getProgress"))) {
-    qInfo() << "[PROGRESS_NET]" << resourceTypeStr() << url;
+  // 离线书籍的插图：从归档应答，不再走网络
+  if (m_offline && kind == UrlRuleSet::KindImage &&
+      info.requestMethod() == QByteArrayLiteral("GET")) {
+    const QUrl archived = m_offline->redirectFor(info.requestUrl());
+    if (archived.isValid()) {
+      info.redirect(archived);
+      return;
+    }
   }
 
 #ifdef WEREAD_DEBUG_RESOURCES
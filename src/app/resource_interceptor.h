@@ -3,26 +3,43 @@
 
 #include <QDateTime>
 #include <QDebug>
+#include <QFile>
 #include <QWebEngineUrlRequestInfo>
 #include <QWebEngineUrlRequestInterceptor>
 
+#include "asset_store.h"
+#include "offline_archive.h"
+#include "url_rules.h"
+
 class WereadBrowser;
 
 // 条件编译开关：取消注释下行以启用详细资源日志（会影响性能）
 // #define WEREAD_DEBUG_RESOURCES
 
 // 网络请求拦截器：阻止不必要的大字体和资源
+// 规则编译成单遍匹配器（见 url_rules.h）；WEREAD_URL_RULES=<文件> 替换内置规则，
+// WEREAD_URL_CORPUS=<文件> 逐行记录 "<类型> <URL>"，供 WereadUrlRuleBench 回放
 class ResourceInterceptor : public QWebEngineUrlRequestInterceptor {
   Q_OBJECT
 public:
   explicit ResourceInterceptor(WereadBrowser *browser,
-                               QObject *parent = nullptr)
-      : QWebEngineUrlRequestInterceptor(parent), m_browser(browser) {}
+                               QObject *parent = nullptr);
 
   void interceptRequest(QWebEngineUrlRequestInfo &info) override;
 
+  const UrlRuleSet &rules() const { return m_rules; }
+  // 设置后不可变资源重定向到 wrasset://，由 AssetSchemeHandler 应答
+  void setAssetStore(AssetStore *store) { m_assets = store; }
+  // 设置后离线书籍里存过的图片重定向到 wrbook://，由 OfflineBookHandler 应答
+  void setOfflineArchive(OfflineArchive *archive) { m_offline = archive; }
+  static UrlRuleSet::Kind kindOf(QWebEngineUrlRequestInfo::ResourceType type);
+
 private:
   WereadBrowser *m_browser = nullptr;
+  UrlRuleSet m_rules;
+  QFile m_corpus;
+  AssetStore *m_assets = nullptr;
+  OfflineArchive *m_offline = nullptr;
 };
 
 #endif // RESOURCE_INTERCEPTOR_H
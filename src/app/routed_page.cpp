@@ -1,14 +1,173 @@
 #include "routed_page.h"
 #include "common.h"
 
+#include <QFile>
+#include <QRandomGenerator>
+#include <QWebChannel>
+#include <QWebEngineScript>
+#include <QWebEngineScriptCollection>
+
+namespace {
+// 运行在 qwebchannel.js 之后（同一函数作用域内，QWebChannel 不泄漏到页面）。
+// 通道建立前的消息先排队；通道不可用时按旧格式写控制台，由
+// handleLegacyControlMessage 兜底解析。
+// 每个槽都要带上会话令牌：令牌只在这段闭包里，页面脚本即使拿到传输对象
+// 直接调槽也会被拒绝。send 在页面脚本运行前取出，QWebChannel 只经闭包里
+// 的 port 收发，页面事后包装 send 也看不到令牌。qt 对象本身不能删：宿主
+// 回包时按 qt.webChannelTransport.onmessage 查找投递。
+const char kBridgeBootstrap[] = R"WR(
+  const TOKEN = '%1';
+  const rawLog = console.log.bind(console);
+  const transport = window.qt && qt.webChannelTransport;
+  const rawSend = transport && transport.send;
+  const port = transport ? {send: (m) => rawSend.call(transport, m), onmessage: null} : null;
+  if (transport) {
+    transport.onmessage = (ev) => { if (port.onmessage) port.onmessage(ev); };
+    try { Object.freeze(transport); } catch (e) {}
+  }
+  const queue = [];
+  let bridge = null;
+  let broken = !port;
+  const legacy = (kind, arg) => {
+    if (kind === 'refreshEvents') rawLog('[REFRESH_EVENTS]' + TOKEN + arg);
+    else if (kind === 'refreshBurstEnd') rawLog('[REFRESH_BURST_END]' + TOKEN);
+    else if (kind === 'chapterInfosMapped') rawLog('[OBS] chapterInfos mapped', arg);
+    else if (kind === 'scriptRepaired') rawLog('[SCRIPT_REPAIR]' + TOKEN + arg);
+    else if (kind === 'offlineData') rawLog('[OFFLINE_DATA]' + TOKEN + arg);
+  };
+  const deliver = (kind, arg) => {
+    if (kind === 'refreshEvents') bridge.refreshEvents(TOKEN, String(arg));
+    else if (kind === 'refreshBurstEnd') bridge.refreshBurstEnd(TOKEN);
+    else if (kind === 'chapterInfosMapped') bridge.chapterInfosMapped(TOKEN, arg | 0);
+    else if (kind === 'scriptRepaired') bridge.scriptRepaired(TOKEN, String(arg));
+    else if (kind === 'offlineData') bridge.offlineData(TOKEN, String(arg));
+  };
+  const post = (kind, arg) => {
+    if (bridge) deliver(kind, arg);
+    else if (broken || queue.length >= 64) legacy(kind, arg);
+    else queue.push([kind, arg]);
+  };
+  const drain = () => {
+    const items = queue.splice(0);
+    for (const item of items) (bridge ? deliver : legacy)(item[0], item[1]);
+  };
+  try {
+    new QWebChannel(port, (channel) => {
+      bridge = channel.objects.wrBridge || null;
+      broken = !bridge;
+      if (bridge) bridge.ready(TOKEN, String(location.href));
+      drain();
+    });
+  } catch (e) {
+    broken = true;
+  }
+  try {
+    Object.defineProperty(window, '__wrPost', {value: post, configurable: true});
+  } catch (e) {
+    window.__wrPost = post;
+  }
+)WR";
+
+QString loadWebChannelJs() {
+  // QtWebEngine 自带的资源，与所链接的 QtWebChannel 版本一致
+  QFile file(QStringLiteral(":/qtwebchannel/qwebchannel.js"));
+  if (!file.open(QIODevice::ReadOnly))
+    return QString();
+  return QString::fromUtf8(file.readAll());
+}
+} // namespace
+
+PageBridge::PageBridge(RoutedPage *page) : QObject(page), m_page(page) {}
+
+bool PageBridge::accept(const QString &token, const char *slot) {
+  if (m_page->bridgeTokenMatches(token))
+    return true;
+  // 不是引导脚本发来的（页面或第三方脚本直接调传输对象）
+  if (++m_rejected <= 8 || (m_rejected & (m_rejected - 1)) == 0)
+    qWarning() << "[BRIDGE] rejected" << slot << "bad token, total"
+               << m_rejected;
+  return false;
+}
+
+void PageBridge::ready(const QString &token, const QString &url) {
+  if (accept(token, "ready") && logLevelAtLeast(LogLevel::Info))
+    qInfo() << "[BRIDGE] connected" << url;
+}
+
+void PageBridge::refreshEvents(const QString &token, const QString &json) {
+  if (accept(token, "refreshEvents"))
+    emit m_page->smartRefreshEvents(json);
+}
+
+void PageBridge::refreshBurstEnd(const QString &token) {
+  if (accept(token, "refreshBurstEnd"))
+    emit m_page->smartRefreshBurstEnd();
+}
+
+void PageBridge::chapterInfosMapped(const QString &token, int count) {
+  if (!accept(token, "chapterInfosMapped"))
+    return;
+  if (logLevelAtLeast(LogLevel::Info))
+    qInfo() << "[BRIDGE] chapterInfos mapped" << count;
+  emit m_page->chapterInfosMapped(count);
+}
+
+void PageBridge::scriptRepaired(const QString &token, const QString &json) {
+  if (accept(token, "scriptRepaired"))
+    emit m_page->scriptRepaired(json);
+}
+
+void PageBridge::offlineData(const QString &token, const QString &json) {
+  if (accept(token, "offlineData"))
+    emit m_page->offlineData(json);
+}
+
+RoutedPage::RoutedPage(QWebEngineProfile *profile, QWebEngineView *view,
+                       QObject *parent)
+    : QWebEnginePage(profile, parent), m_view(view) {
+  installBridge();
+  connect(this, &QWebEnginePage::urlChanged, this,
+          [this](const QUrl &url) { m_context = PageContext::classify(url); });
+}
+
+void RoutedPage::installBridge() {
+  const QString channelJs = loadWebChannelJs();
+  if (channelJs.isEmpty()) {
+    qWarning() << "[BRIDGE] qwebchannel.js unavailable, control messages "
+                  "stay on console";
+    return;
+  }
+  // MainWorld：智能刷新、章节观察与离线下载脚本都跑在页面主世界，要
+  // hook 页面自己的 fetch/XHR，放不进隔离世界。槽函数因此逐个校验会话
+  // 令牌；页面仍能调用 window.__wrPost，数据类消息由宿主再做内容校验。
+  quint32 words[4];
+  QRandomGenerator::system()->fillRange(words);
+  m_bridgeToken = QString::fromLatin1(
+      QByteArray(reinterpret_cast<const char *>(words), sizeof(words))
+          .toHex());
+  m_channel = new QWebChannel(this);
+  m_channel->registerObject(QStringLiteral("wrBridge"), new PageBridge(this));
+  setWebChannel(m_channel, QWebEngineScript::MainWorld);
+
+  const QString bootstrap =
+      QString::fromUtf8(kBridgeBootstrap).arg(m_bridgeToken);
+  QWebEngineScript script;
+  script.setName(QStringLiteral("weread-page-bridge"));
+  script.setInjectionPoint(QWebEngineScript::DocumentCreation);
+  script.setWorldId(QWebEngineScript::MainWorld);
+  script.setRunsOnSubFrames(false);
+  script.setSourceCode(QStringLiteral("(function() {\n"
+                                      "if (window.__wrPost) return;\n") +
+                       channelJs + bootstrap + QStringLiteral("})();\n"));
+  scripts().insert(script);
+  qInfo() << "[BRIDGE] page bridge installed";
+}
+
 QWebEnginePage *RoutedPage::createWindow(WebWindowType type) {
   Q_UNUSED(type);
-  const QString currentUrl = m_view ? m_view->url().toString() : QString();
-  const bool isDedaoBook = currentUrl.contains(QStringLiteral("dedao.cn")) &&
-                           currentUrl.contains(QStringLiteral("/ebook/reader"));
-
-  if (isDedaoBook) {
-    qInfo() << "[WINDOW] blocked popup on dedao book page" << currentUrl;
+  if (m_context.isDedaoBook()) {
+    qInfo() << "[WINDOW] blocked popup on dedao book page"
+            << (m_view ? m_view->url() : url());
     return nullptr;
   }
 
@@ -33,13 +192,9 @@ bool RoutedPage::acceptNavigationRequest(const QUrl &url, NavigationType type,
   qInfo() << "[NAV] request" << url << "type" << type << "mainFrame"
           << isMainFrame << "ts" << ts << "sinceReload" << rel << "from"
           << currentUrl;
-  const bool inDedaoReader =
-      currentUrl.contains(QStringLiteral("dedao.cn")) &&
-      currentUrl.contains(QStringLiteral("/ebook/reader"));
-  if (inDedaoReader) {
+  if (m_context.isDedaoBook()) {
     const QString target = url.toString();
-    const bool sameReader = target.contains(QStringLiteral("dedao.cn")) &&
-                            target.contains(QStringLiteral("/ebook/reader"));
+    const bool sameReader = PageContext::classify(url).isDedaoBook();
     const bool isDetail = target.contains(QStringLiteral("/ebook/detail"));
     if (!sameReader) {
       const qint64 allowUntil =
@@ -67,44 +222,72 @@ bool RoutedPage::acceptNavigationRequest(const QUrl &url, NavigationType type,
   return QWebEnginePage::acceptNavigationRequest(url, type, isMainFrame);
 }
 
+bool RoutedPage::bridgeTokenMatches(const QString &token) const {
+  return !m_bridgeToken.isEmpty() && token == m_bridgeToken;
+}
+
+bool RoutedPage::handleLegacyControlMessage(const QString &message) {
+  // 控制消息只认引导脚本带令牌写出的，页面伪造的直接吞掉
+  if (message.startsWith(QLatin1String("[REFRESH_EVENTS]"))) {
+    if (!m_bridgeToken.isEmpty() &&
+        QStringView(message).mid(16).startsWith(m_bridgeToken))
+      emit smartRefreshEvents(message.mid(16 + m_bridgeToken.size()));
+    return true;
+  }
+  if (message.startsWith(QLatin1String("[REFRESH_BURST_END]"))) {
+    if (!m_bridgeToken.isEmpty() &&
+        QStringView(message).mid(19) == m_bridgeToken)
+      emit smartRefreshBurstEnd();
+    return true;
+  }
+  if (message.startsWith(QLatin1String("[OFFLINE_DATA]"))) {
+    if (!m_bridgeToken.isEmpty() &&
+        QStringView(message).mid(14).startsWith(m_bridgeToken))
+      emit offlineData(message.mid(14 + m_bridgeToken.size()));
+    return true;
+  }
+  if (message.startsWith(QLatin1String("[SCRIPT_REPAIR]"))) {
+    if (!m_bridgeToken.isEmpty() &&
+        QStringView(message).mid(15).startsWith(m_bridgeToken))
+      emit scriptRepaired(message.mid(15 + m_bridgeToken.size()));
+    return true;
+  }
+  if (message.startsWith(QLatin1String("[OBS] chapterInfos mapped"))) {
+    bool ok = false;
+    const int count = message.section(' ', -1).toInt(&ok);
+    emit chapterInfosMapped(ok ? count : -1);
+  }
+  return false;
+}
+
 void RoutedPage::javaScriptConsoleMessage(JavaScriptConsoleMessageLevel level,
                                           const QString &message,
                                           int lineNumber,
                                           const QString &sourceID) {
-  const bool isWeReadSrc =
-      sourceID.contains(QStringLiteral("weread.qq.com"), Qt::CaseInsensitive);
-  if (isWeReadSrc && message.contains(QStringLiteral("Unexpected end of input"),
-                                      Qt::CaseInsensitive)) {
+  const bool isProblem = level == QWebEnginePage::ErrorMessageLevel ||
+                         level == QWebEnginePage::WarningMessageLevel;
+  // 引擎抛出的语法错误不经过 bridge，仍从控制台识别
+  if (level == QWebEnginePage::ErrorMessageLevel &&
+      message.contains(QStringLiteral("Unexpected end of input"),
+                       Qt::CaseInsensitive) &&
+      sourceID.contains(QStringLiteral("weread.qq.com"), Qt::CaseInsensitive)) {
     emit jsUnexpectedEnd(message, sourceID);
   }
 
-  if (message.startsWith(QStringLiteral("[REFRESH_EVENTS]"))) {
-    const QString json = message.mid(16);
-    emit smartRefreshEvents(json);
-  }
-  if (message == QStringLiteral("[REFRESH_BURST_END]")) {
-    emit smartRefreshBurstEnd();
-  }
-  if (message.startsWith(QStringLiteral("[OBS] chapterInfos mapped"))) {
-    const QString countStr = message.section(' ', -1);
-    bool ok = false;
-    const int count = countStr.toInt(&ok);
-    emit chapterInfosMapped(ok ? count : -1);
-  }
-  const bool logInfo = logLevelAtLeast(LogLevel::Info);
-  const bool logWarn = logLevelAtLeast(LogLevel::Warning);
-  const bool isNoisy = message.startsWith(QStringLiteral("[REFRESH_EVENTS]")) ||
-                       message.startsWith(QStringLiteral("[DOM_SCORE]"));
-  const bool isTagged = message.startsWith(QStringLiteral("["));
-  if (level == QWebEnginePage::ErrorMessageLevel ||
-      level == QWebEnginePage::WarningMessageLevel) {
-    if (logWarn) {
+  // 控制消息正常走 PageBridge；这里只兜底通道不可用的页面（带令牌）
+  const bool isTagged = !message.isEmpty() && message.at(0) == QLatin1Char('[');
+  if (isTagged && !isProblem && handleLegacyControlMessage(message))
+    return;
+
+  if (isProblem) {
+    if (logLevelAtLeast(LogLevel::Warning)) {
       qWarning().noquote() << "[JS]" << sourceID << ":" << lineNumber
                            << message;
     }
-  } else {
-    if (logInfo && isTagged && !isNoisy) {
-      qInfo().noquote() << "[JS]" << sourceID << ":" << lineNumber << message;
-    }
+    return;
   }
+  if (!isTagged || !logLevelAtLeast(LogLevel::Info) ||
+      message.startsWith(QLatin1String("[DOM_SCORE]")))
+    return;
+  qInfo().noquote() << "[JS]" << sourceID << ":" << lineNumber << message;
 }
@@ -8,19 +8,53 @@
 #include <QWebEngineProfile>
 #include <QWebEngineView>
 
+#include "page_context.h"
+
+class QWebChannel;
+class RoutedPage;
+
+// 页面 -> 宿主的控制消息通道（QWebChannel 对象 "wrBridge"）。
+// 槽函数校验会话令牌后转发为 RoutedPage 的信号，页面侧通过
+// window.__wrPost 调用。
+class PageBridge : public QObject {
+  Q_OBJECT
+public:
+  explicit PageBridge(RoutedPage *page);
+
+public slots:
+  void ready(const QString &token, const QString &url);
+  void refreshEvents(const QString &token, const QString &json);
+  void refreshBurstEnd(const QString &token);
+  void chapterInfosMapped(const QString &token, int count);
+  void scriptRepaired(const QString &token, const QString &json);
+  void offlineData(const QString &token, const QString &json);
+
+private:
+  bool accept(const QString &token, const char *slot);
+
+  RoutedPage *m_page = nullptr;
+  quint64 m_rejected = 0;
+};
+
 // 页面路由控制：处理窗口创建和导航请求
 class RoutedPage : public QWebEnginePage {
   Q_OBJECT
 public:
   RoutedPage(QWebEngineProfile *profile, QWebEngineView *view,
-             QObject *parent = nullptr)
-      : QWebEnginePage(profile, parent), m_view(view) {}
+             QObject *parent = nullptr);
+
+  // 引导脚本闭包里的会话令牌（每个页面对象随机生成一次）
+  bool bridgeTokenMatches(const QString &token) const;
 
 signals:
   void smartRefreshEvents(const QString &json);
   void smartRefreshBurstEnd();
   void jsUnexpectedEnd(const QString &message, const QString &source);
   void chapterInfosMapped(int count);
+  // 定点重取脚本的结果 {src, ok, stage, status, bytes, expected, ms}
+  void scriptRepaired(const QString &json);
+  // 离线下载进度与章节内容 {t: begin|chapter|end, readerId, ...}
+  void offlineData(const QString &json);
 
 protected:
   QWebEnginePage *createWindow(WebWindowType type) override;
@@ -31,7 +65,14 @@ protected:
                                 const QString &sourceID) override;
 
 private:
+  void installBridge();
+  bool handleLegacyControlMessage(const QString &message);
+
   QWebEngineView *m_view = nullptr;
+  QWebChannel *m_channel = nullptr;
+  QString m_bridgeToken;
+  PageContext m_context; // 当前页面分类，urlChanged 时更新
+
   qint64 m_bookEnterTs = 0;
   qint64 m_lastReloadTs = 0;
 };
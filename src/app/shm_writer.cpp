@@ -1,8 +1,10 @@
 #include "shm_writer.h"
+#include "eink_quantize.h"
 
 #include <QByteArray>
 #include <QDebug>
 #include <QFile>
+#include <cmath>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -72,21 +74,47 @@ bool ShmFrameWriter::init(const QString &path) {
     return true;
 }
 
-void ShmFrameWriter::publish(const QImage &srcImg) {
+void ShmFrameWriter::publish(const QImage &srcImg, const QRect &damage,
+                             uint32_t contentClass) {
     if (!m_ready) return;
     QImage img = srcImg;
-    if (img.format() != QImage::Format_ARGB32) {
+    // RGB32 is ARGB32 with opaque alpha: same bytes, no conversion needed
+    if (img.format() != QImage::Format_ARGB32 && img.format() != QImage::Format_RGB32) {
         img = img.convertToFormat(QImage::Format_ARGB32);
     }
+    const QRect full(0, 0, static_cast<int>(m_width), static_cast<int>(m_height));
+    QRect area = damage.isNull() ? full : damage;
+    bool scaled = false;
     // Resize/letterbox if needed
     if (img.width() != static_cast<int>(m_width) || img.height() != static_cast<int>(m_height)) {
+        const double sx = double(m_width) / img.width();
+        const double sy = double(m_height) / img.height();
         img = img.scaled(static_cast<int>(m_width), static_cast<int>(m_height), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        scaled = true;
+        if (!damage.isNull()) {
+            // source -> frame coordinates, rounded outward plus one pixel
+            // for the smoothing filter's reach
+            area = QRect(QPoint(int(std::floor(damage.left() * sx)) - 1,
+                                int(std::floor(damage.top() * sy)) - 1),
+                         QPoint(int(std::ceil((damage.right() + 1) * sx)),
+                                int(std::ceil((damage.bottom() + 1) * sy))));
+        }
     }
+    area = area.intersected(full);
+    // The caller classified the unscaled damage; smooth scaling blends edges
+    // into mid grays, so classify the pixels actually published instead.
+    if (scaled && contentClass != 0)
+        contentClass = EinkQuantizer::classify(img, area);
 
     uint8_t *dst = (m_hdr->active_buffer == 0) ? m_buf1 : m_buf0; // write to inactive buffer
     for (uint32_t y = 0; y < m_height; ++y) {
         memcpy(dst + y * m_stride, img.constScanLine(y), static_cast<size_t>(m_stride));
     }
+    m_hdr->reserved[0] = static_cast<uint32_t>(area.x());
+    m_hdr->reserved[1] = static_cast<uint32_t>(area.y());
+    m_hdr->reserved[2] = static_cast<uint32_t>(area.width());
+    m_hdr->reserved[3] = static_cast<uint32_t>(area.height());
+    m_hdr->reserved[4] = contentClass;
     // publish
     m_gen++;
     m_hdr->active_buffer = (m_hdr->active_buffer == 0) ? 1 : 0;
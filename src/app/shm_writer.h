@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QImage>
+#include <QRect>
 #include <QString>
 
 struct ShmHeader {
@@ -12,7 +13,7 @@ struct ShmHeader {
     uint32_t format;      // 1=ARGB32, 2=RGB565
     uint32_t gen_counter;
     uint32_t active_buffer; // 0/1
-    uint32_t reserved[8];
+    uint32_t reserved[8];   // [0..3] damage x/y/w/h, [4] content class (see EinkQuantizer)
 };
 
 class ShmFrameWriter {
@@ -21,7 +22,15 @@ public:
     ~ShmFrameWriter();
 
     bool init(const QString &path = "/dev/shm/weread_frame");
-    void publish(const QImage &img);
+    // damage: changed area in img coordinates, null = full frame; mapped to
+    // frame coordinates when img is scaled to the frame size
+    // contentClass: 0 unknown, 1 bilevel (DU/A2 safe), 2 gray16; reclassified
+    // over the published area when img is scaled
+    void publish(const QImage &img, const QRect &damage = QRect(),
+                 uint32_t contentClass = 0);
+
+    int width() const { return static_cast<int>(m_width); }
+    int height() const { return static_cast<int>(m_height); }
 
 private:
     void cleanup();
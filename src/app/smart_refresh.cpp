@@ -1,4 +1,5 @@
 #include "smart_refresh.h"
+#include "ink_latency_tracer.h"
 #include <QDateTime>
 #include <QDebug>
 #include <climits>
@@ -58,6 +59,11 @@ SmartRefreshManager::SmartRefreshManager(FbRefreshHelper *fb, int w, int h,
   connect(&m_postClickA2Timer, &QTimer::timeout, this,
           &SmartRefreshManager::performPostClickA2);
 
+  // 跳页：同一个定时器先做兜底、松手后做静置
+  m_jumpTimer.setSingleShot(true);
+  connect(&m_jumpTimer, &QTimer::timeout, this,
+          &SmartRefreshManager::onJumpTimer);
+
   m_dedaoFallback1s.setSingleShot(true);
   m_dedaoFallback2s.setSingleShot(true);
   m_dedaoFallback3s.setSingleShot(true);
@@ -368,6 +374,7 @@ void SmartRefreshManager::triggerDedaoDuRefresh(const QString &reason) {
     m_lastDedaoDuRefreshMs = now;
     qInfo() << "[SMART_REFRESH]" << m_tag << "dedao full refresh (ghost)"
             << "reason" << reason;
+    emit refreshIssued(QRect());
     return;
   }
   m_fb->refreshUI(0, 0, m_width, m_height);
@@ -378,6 +385,7 @@ void SmartRefreshManager::triggerDedaoDuRefresh(const QString &reason) {
   qInfo() << "[SMART_REFRESH]" << m_tag << "dedao DU refresh"
           << "reason" << reason << "ghostingRisk" << m_ghostingRisk
           << "duCount" << m_duCount;
+  emit refreshIssued(QRect());
 }
 
 void SmartRefreshManager::scheduleDedaoDelayedRefresh(const QString &reason) {
@@ -478,10 +486,121 @@ void SmartRefreshManager::updateDedaoFallbackPending() {
   m_dedaoFallbackShifted = false;
 }
 
+void SmartRefreshManager::beginJump() {
+  m_jumpActive = true;
+  m_jumpSettling = false;
+  m_discardOnSettle = false; // 预翻回后接着拖动/跳页：期间事件照常收尾
+  m_batchTimer.stop();
+  m_jumpTimer.start(kJumpGuardMs);
+  qInfo() << "[SMART_REFRESH]" << m_tag << "jump begin, queue"
+          << m_eventQueue.size();
+}
+
+void SmartRefreshManager::previewJump(const QRect &region) {
+  if (!m_jumpActive)
+    beginJump();
+  else if (!m_jumpSettling)
+    m_jumpTimer.start(kJumpGuardMs);
+  const QRect r = region.intersected(QRect(0, 0, m_width, m_height));
+  if (!m_fb || r.isEmpty())
+    return;
+  // 直接下发，不走 executeRefresh：书籍页 A2 转 DU 的规则不适用于预览框
+  emit refreshIssued(r);
+  m_fb->refreshA2(r.x(), r.y(), r.width(), r.height());
+  m_ghostingRisk += 0.01f;
+}
+
+void SmartRefreshManager::settleJump() {
+  if (!m_jumpActive)
+    beginJump();
+  m_jumpSettling = true;
+  m_jumpTimer.start(kJumpSettleMs);
+}
+
+void SmartRefreshManager::cancelJump(const QRect &previewRegion) {
+  const bool wasActive = m_jumpActive;
+  m_jumpActive = false;
+  m_jumpSettling = false;
+  m_jumpTimer.stop();
+  const QRect r = previewRegion.intersected(QRect(0, 0, m_width, m_height));
+  if (m_fb && !r.isEmpty()) {
+    // 清掉预览框的 A2 残影
+    emit refreshIssued(r);
+    m_fb->refreshPartialGC16(r.x(), r.y(), r.width(), r.height());
+    m_partialCount++;
+  }
+  if (wasActive && !m_eventQueue.isEmpty() && !m_batchTimer.isActive())
+    m_batchTimer.start();
+}
+
+void SmartRefreshManager::onJumpTimer() {
+  if (!m_jumpActive)
+    return;
+  const bool settled = m_jumpSettling;
+  m_jumpActive = false;
+  m_jumpSettling = false;
+  if (settled && m_discardOnSettle) {
+    m_discardOnSettle = false;
+    const qsizetype dropped =
+        m_speculationMark >= 0 ? m_eventQueue.size() - m_speculationMark : 0;
+    if (dropped > 0)
+      m_eventQueue.resize(m_speculationMark);
+    m_speculationMark = -1;
+    qInfo() << "[SMART_REFRESH]" << m_tag << "speculation discarded, dropped"
+            << dropped << "queued" << m_eventQueue.size();
+    if (!m_eventQueue.isEmpty() && !m_batchTimer.isActive())
+      m_batchTimer.start();
+    return;
+  }
+  m_speculationMark = -1;
+  if (!settled) {
+    qWarning() << "[SMART_REFRESH]" << m_tag
+               << "jump guard expired, resuming normal refresh";
+    if (!m_eventQueue.isEmpty())
+      processBatch();
+    return;
+  }
+  qInfo() << "[SMART_REFRESH]" << m_tag << "jump settled, queued events"
+          << m_eventQueue.size();
+  // 跳页滚动带来的 DOM 变化与 CONTENT_READY 同批，只出一次 GC16 局刷，
+  // 其分数同时成为后续补刷的门槛
+  m_jumpRefreshPending = true;
+  RefreshEvent e;
+  e.type = RefreshEvent::CONTENT_READY;
+  pushEvent(e);
+  m_jumpRefreshPending = false;
+}
+
+void SmartRefreshManager::beginSpeculation() {
+  beginJump();
+  m_speculationMark = static_cast<int>(m_eventQueue.size());
+}
+
+void SmartRefreshManager::commitSpeculation() {
+  m_speculationMark = -1;
+  if (m_jumpActive)
+    cancelJump();
+}
+
+void SmartRefreshManager::discardSpeculation() {
+  if (!m_jumpActive) {
+    m_speculationMark = -1;
+    return;
+  }
+  // 翻回滚动的 DOM 变化回报晚于 JS 回调，落定窗口后再丢
+  m_discardOnSettle = true;
+  m_jumpSettling = true;
+  m_jumpTimer.start(kJumpSettleMs);
+}
+
 void SmartRefreshManager::processBatch() {
   if (m_eventQueue.isEmpty()) {
     return;
   }
+  if (m_jumpActive) {
+    // 跳页期间的变化留到 onJumpTimer 一次性处理
+    return;
+  }
 
   int totalScore = 0;
   int totalScrollDelta = 0;
@@ -700,6 +819,7 @@ void SmartRefreshManager::executeRefresh(WaveformChoice wf,
     }
     return;
   }
+  InkLatencyTracer::instance().mark(InkLatencyTracer::Decision);
 
   const bool isDedaoBook = (m_tag == QStringLiteral("dedao")) && m_isBookPage;
   const bool needFullCleanup =
@@ -757,6 +877,7 @@ void SmartRefreshManager::executeRefresh(WaveformChoice wf,
   }
 
   m_lastRefreshTime.restart();
+  emit refreshIssued(isFullScreen ? QRect() : region);
 
   switch (wf) {
   case WF_GC16_FULL:
@@ -767,7 +888,16 @@ void SmartRefreshManager::executeRefresh(WaveformChoice wf,
     m_lastFullRefresh.restart();
     break;
   case WF_GC16_PARTIAL:
-    if (isFullScreen) {
+    if (m_jumpRefreshPending) {
+      // 跳页收尾：整页内容都换了，用 GC16 清掉预览与旧页残影
+      m_jumpRefreshPending = false;
+      if (isFullScreen) {
+        m_fb->refreshPartialGC16(0, 0, m_width, m_height);
+      } else {
+        m_fb->refreshPartialGC16(region.x(), region.y(), region.width(),
+                                 region.height());
+      }
+    } else if (isFullScreen) {
       m_fb->refreshPartial(0, 0, m_width, m_height);
     } else {
       m_fb->refreshPartial(region.x(), region.y(), region.width(),
@@ -830,6 +960,7 @@ void SmartRefreshManager::performPostClickA2() {
   } else {
     m_fb->refreshA2(0, 0, m_width, m_height);
   }
+  emit refreshIssued(QRect());
 
   if (m_postClickA2Count < kMaxPostClickA2Count) {
     m_postClickA2Timer.start();
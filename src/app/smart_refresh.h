@@ -83,15 +83,35 @@ public:
   void scheduleDedaoDelayedRefresh(const QString &reason);
   void cancelDedaoDelayedRefresh();
 
+  // 跳页（长滑/按住拖动）：手指按下期间只对预览框发 A2，常规批处理暂停；
+  // 跳页滚动完成后静置片刻，整批只出一次 GC16 局刷。拖动滚动（pan）也走这套：
+  // 每次滚动落地对整屏 previewJump，松手后 settleJump
+  void beginJump();
+  void previewJump(const QRect &region);
+  void settleJump();
+  void cancelJump(const QRect &previewRegion = QRect());
+  bool jumpActive() const { return m_jumpActive; }
+
+  // 预翻页：按下即翻页但沿用跳页的暂停状态压住刷新。commit 照常处理期间
+  // 排入的事件；discard（已翻回，屏幕内容不变）等 DOM 变化落定后丢掉这些事件
+  void beginSpeculation();
+  void commitSpeculation();
+  void discardSpeculation();
+
   // 获取状态
   float ghostingRisk() const { return m_ghostingRisk; }
   int partialCount() const { return m_partialCount; }
   int duCount() const { return m_duCount; }
 
+signals:
+  // 每次实际下发刷新时发出（region 为空表示全屏），供离屏抓帧使用
+  void refreshIssued(const QRect &region);
+
 private slots:
   void processBatch();
   void onIdle();
   void performPostClickA2();
+  void onJumpTimer();
 
 private:
   WaveformChoice decideWaveform(const QVector<RefreshEvent> &events);
@@ -156,6 +176,16 @@ private:
   bool m_dedaoFallbackPending = false;
   bool m_dedaoFallbackShifted = false;
 
+  // 跳页状态
+  bool m_jumpActive = false;
+  bool m_jumpSettling = false;
+  bool m_jumpRefreshPending = false; // 下一次 GC16_PARTIAL 用真 GC16 波形
+  QTimer m_jumpTimer;
+  int m_speculationMark = -1;      // 预翻页开始时的队列长度
+  bool m_discardOnSettle = false;  // 落定时丢弃 m_speculationMark 之后的事件
+  static constexpr int kJumpSettleMs = 300;  // 滚动后等 DOM 变化落定
+  static constexpr int kJumpGuardMs = 5000;  // 丢失松手/完成时的兜底
+
   QString m_tag;
 };
 
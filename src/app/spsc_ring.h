@@ -0,0 +1,64 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+// Fixed-capacity single-producer/single-consumer ring. push() may only be
+// called from one thread and pop() from one other thread; neither blocks or
+// allocates. head/tail live on separate cache lines so the producer and the
+// consumer do not bounce a line between cores on every element.
+template <typename T, std::size_t Capacity> class SpscRing {
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                "capacity must be a power of two");
+  static_assert(std::is_trivially_copyable<T>::value,
+                "elements are copied across threads without locking");
+
+public:
+  // Producer side. Returns false (and drops the element) when full.
+  bool push(const T &item) {
+    const std::size_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tailCache == Capacity) {
+      m_tailCache = m_tail.load(std::memory_order_acquire);
+      if (head - m_tailCache == Capacity)
+        return false;
+    }
+    m_slots[head & (Capacity - 1)] = item;
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Returns false when empty.
+  bool pop(T &out) {
+    const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail == m_headCache) {
+      m_headCache = m_head.load(std::memory_order_acquire);
+      if (tail == m_headCache)
+        return false;
+    }
+    out = m_slots[tail & (Capacity - 1)];
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Approximate; exact only when called from either side while the other
+  // is idle.
+  std::size_t size() const {
+    return m_head.load(std::memory_order_acquire) -
+           m_tail.load(std::memory_order_acquire);
+  }
+
+  static constexpr std::size_t capacity() { return Capacity; }
+
+private:
+  static constexpr std::size_t kLine = 64;
+
+  alignas(kLine) std::atomic<std::size_t> m_head{0};
+  std::size_t m_tailCache = 0; // producer's last view of m_tail
+  alignas(kLine) std::atomic<std::size_t> m_tail{0};
+  std::size_t m_headCache = 0; // consumer's last view of m_head
+  alignas(kLine) T m_slots[Capacity];
+};
+
+#endif // SPSC_RING_H
@@ -0,0 +1,115 @@
+#include "touch_trace.h"
+
+#include <QEvent>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+constexpr char kMagic[4] = {'W', 'R', 'T', 'T'};
+constexpr quint16 kVersion = 1;
+constexpr int kHeaderSize = 8;
+constexpr int kRecordSize = 24;
+constexpr int kFlushRecords = 64;
+
+void putFloat(uchar *dst, float v) {
+  quint32 bits;
+  std::memcpy(&bits, &v, sizeof(bits));
+  qToLittleEndian(bits, dst);
+}
+
+float getFloat(const uchar *src) {
+  const quint32 bits = qFromLittleEndian<quint32>(src);
+  float v;
+  std::memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+} // namespace
+
+bool TouchTraceWriter::open(const QString &path) {
+  close();
+  m_file.setFileName(path);
+  if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return false;
+  uchar header[kHeaderSize];
+  std::memcpy(header, kMagic, sizeof(kMagic));
+  qToLittleEndian(kVersion, header + 4);
+  qToLittleEndian(quint16(kRecordSize), header + 6);
+  m_file.write(reinterpret_cast<const char *>(header), kHeaderSize);
+  m_file.flush();
+  m_buffer.reserve(kRecordSize * kFlushRecords);
+  m_count = 0;
+  return true;
+}
+
+void TouchTraceWriter::append(const TouchTraceEvent &event) {
+  if (!m_file.isOpen())
+    return;
+  uchar rec[kRecordSize];
+  qToLittleEndian(event.tMs, rec);
+  rec[4] = event.type;
+  rec[5] = event.source;
+  qToLittleEndian(event.flags, rec + 6);
+  putFloat(rec + 8, event.x);
+  putFloat(rec + 12, event.y);
+  putFloat(rec + 16, event.gx);
+  putFloat(rec + 20, event.gy);
+  m_buffer.append(reinterpret_cast<const char *>(rec), kRecordSize);
+  ++m_count;
+  const bool lift = event.type == QEvent::TouchEnd ||
+                    event.type == QEvent::MouseButtonRelease;
+  if (lift || m_buffer.size() >= kRecordSize * kFlushRecords)
+    flush();
+}
+
+void TouchTraceWriter::flush() {
+  if (!m_file.isOpen() || m_buffer.isEmpty())
+    return;
+  m_file.write(m_buffer);
+  m_file.flush();
+  m_buffer.clear();
+}
+
+void TouchTraceWriter::close() {
+  if (!m_file.isOpen())
+    return;
+  flush();
+  m_file.close();
+}
+
+bool readTouchTrace(const QString &path, QList<TouchTraceEvent> *events,
+                    QString *error) {
+  auto fail = [error](const QString &why) {
+    if (error)
+      *error = why;
+    return false;
+  };
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly))
+    return fail(QStringLiteral("cannot open %1").arg(path));
+  const QByteArray data = file.readAll();
+  const auto *p = reinterpret_cast<const uchar *>(data.constData());
+  if (data.size() < kHeaderSize ||
+      std::memcmp(p, kMagic, sizeof(kMagic)) != 0)
+    return fail(QStringLiteral("not a touch trace"));
+  if (qFromLittleEndian<quint16>(p + 4) != kVersion ||
+      qFromLittleEndian<quint16>(p + 6) != kRecordSize)
+    return fail(QStringLiteral("unsupported trace version"));
+  // a partial record at the end (writer killed mid-write) is ignored
+  const qsizetype count = (data.size() - kHeaderSize) / kRecordSize;
+  events->clear();
+  events->reserve(count);
+  const uchar *rec = p + kHeaderSize;
+  for (qsizetype i = 0; i < count; ++i, rec += kRecordSize) {
+    TouchTraceEvent ev;
+    ev.tMs = qFromLittleEndian<quint32>(rec);
+    ev.type = rec[4];
+    ev.source = rec[5];
+    ev.flags = qFromLittleEndian<quint16>(rec + 6);
+    ev.x = getFloat(rec + 8);
+    ev.y = getFloat(rec + 12);
+    ev.gx = getFloat(rec + 16);
+    ev.gy = getFloat(rec + 20);
+    events->append(ev);
+  }
+  return true;
+}
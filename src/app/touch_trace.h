@@ -0,0 +1,68 @@
+#ifndef TOUCH_TRACE_H
+#define TOUCH_TRACE_H
+
+#include <QFile>
+#include <QList>
+#include <QPointF>
+#include <QString>
+#include <QtGlobal>
+
+// One pointer event as GestureFilter decoded it, plus the browser state its
+// decision depended on, so a replay can answer the same queries. 24 bytes
+// on disk, little-endian, after an 8-byte header ("WRTT", version, record
+// size).
+struct TouchTraceEvent {
+  enum Flag : quint16 {
+    TargetWidget = 1 << 0,  // delivered to a QWidget, not the QWidgetWindow
+    TargetOverlay = 1 << 1, // ... inside the menu overlay or CatalogWidget
+    NoPoints = 1 << 2,      // touch event without points
+    WeReadBook = 1 << 4,
+    DedaoBook = 1 << 5,
+    WeReadKindle = 1 << 6,
+    KindleUA = 1 << 7,
+    CatalogHit = 1 << 8,     // position inside the visible catalog
+    MenuHit = 1 << 9,        // global position inside the visible menu
+    InjectedBypass = 1 << 10, // browser: pass as our own injected input
+    InjectedReplay = 1 << 11, // browser: re-post injected mouse unsynthesized
+  };
+
+  quint32 tMs = 0;   // since the trace started
+  quint8 type = 0;   // QEvent::Type; all pointer types fit in a byte
+  quint8 source = 0; // Qt::MouseEventSource, mouse events only
+  quint16 flags = 0;
+  float x = 0, y = 0;   // window position
+  float gx = 0, gy = 0; // global position
+
+  QPointF pos() const { return QPointF(x, y); }
+  QPointF globalPos() const { return QPointF(gx, gy); }
+  void setPos(const QPointF &p, const QPointF &global) {
+    x = float(p.x());
+    y = float(p.y());
+    gx = float(global.x());
+    gy = float(global.y());
+  }
+};
+
+// Buffered appender; records reach the file in 64-record chunks and at
+// every contact lift, so a crash loses at most the gesture in progress.
+class TouchTraceWriter {
+public:
+  ~TouchTraceWriter() { close(); }
+
+  bool open(const QString &path);
+  void append(const TouchTraceEvent &event);
+  void flush();
+  void close();
+  quint64 count() const { return m_count; }
+
+private:
+  QFile m_file;
+  QByteArray m_buffer;
+  quint64 m_count = 0;
+};
+
+// Reads a whole trace; false with *error set on a bad header.
+bool readTouchTrace(const QString &path, QList<TouchTraceEvent> *events,
+                    QString *error = nullptr);
+
+#endif // TOUCH_TRACE_H
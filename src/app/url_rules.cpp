@@ -0,0 +1,267 @@
+#include "url_rules.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QtAlgorithms>
+#include <cstring>
+#include <deque>
+
+namespace {
+const char *const kKindNames[UrlRuleSet::KindCount] = {
+    "mainframe", "subframe", "stylesheet", "script", "image",
+    "font",      "media",    "xhr",        "other"};
+const char *const kActionNames[] = {"observe", "block", "allow"};
+constexpr int kAlphabet = 256;
+constexpr int kMaxStates = 0xffff;
+
+struct FoldTable {
+  uchar map[kAlphabet];
+  constexpr FoldTable() : map() {
+    for (int c = 0; c < kAlphabet; ++c)
+      map[c] = uchar((c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c);
+  }
+};
+constexpr FoldTable kFold;
+
+// WeRead reader: fonts that cost seconds on the device, plus the endpoints
+// whose timing is worth a log line.
+const char kDefaultRules[] = R"(# action  types       pattern                  tag           flags
+# KaTeX fonts/media from the template renderer
+block     font,media  /winktemplaterendersvr/
+# SourceHanSerif, ~10MB per weight
+block     *           SourceHanSerif
+observe   font        TsangerYunHei-W05        FONT_ALLOW
+observe   *           chapterInfos             CHAPTER_NET   nocase
+# progress endpoints, including ServiceWorker requests
+observe   *           /web/book/read           PROGRESS_NET
+observe   *           getProgress              PROGRESS_NET
+)";
+
+bool parseKinds(const QByteArray &field, quint32 *mask) {
+  if (field == "*") {
+    *mask = (1u << UrlRuleSet::KindCount) - 1u;
+    return true;
+  }
+  *mask = 0;
+  for (const QByteArray &name : field.split(',')) {
+    int kind = 0;
+    while (kind < UrlRuleSet::KindCount && name != kKindNames[kind])
+      ++kind;
+    if (kind == UrlRuleSet::KindCount)
+      return false;
+    *mask |= 1u << kind;
+  }
+  return *mask != 0;
+}
+} // namespace
+
+const char *UrlRuleSet::defaultRules() { return kDefaultRules; }
+
+const char *UrlRuleSet::kindName(int kind) {
+  return (kind >= 0 && kind < KindCount) ? kKindNames[kind] : "?";
+}
+
+bool UrlRuleSet::load(const QByteArray &text, QString *error) {
+  auto fail = [error](int line, const QString &why) {
+    if (error)
+      *error = QStringLiteral("line %1: %2").arg(line).arg(why);
+    return false;
+  };
+  QList<Rule> rules;
+  qsizetype patternBytes = 0;
+  int lineNo = 0;
+  for (const QByteArray &raw : text.split('\n')) {
+    ++lineNo;
+    const qsizetype hash = raw.indexOf('#');
+    const QByteArray line =
+        (hash >= 0 ? raw.left(hash) : raw).simplified();
+    if (line.isEmpty())
+      continue;
+    const QList<QByteArray> f = line.split(' ');
+    if (f.size() < 3 || f.size() > 5)
+      return fail(lineNo, QStringLiteral("expected 3-5 fields"));
+    Rule r;
+    if (f[0] == "block")
+      r.action = Block;
+    else if (f[0] == "allow")
+      r.action = Allow;
+    else if (f[0] == "observe")
+      r.action = Observe;
+    else
+      return fail(lineNo, QStringLiteral("unknown action %1")
+                              .arg(QString::fromLatin1(f[0])));
+    if (!parseKinds(f[1], &r.kinds))
+      return fail(lineNo, QStringLiteral("bad types %1")
+                              .arg(QString::fromLatin1(f[1])));
+    r.pattern = f[2];
+    if (f.size() >= 4)
+      r.tag = f[3];
+    else
+      r.tag = r.action == Block   ? QByteArrayLiteral("BLOCK")
+              : r.action == Allow ? QByteArrayLiteral("ALLOW")
+                                  : QByteArrayLiteral("URL_RULE");
+    if (f.size() == 5) {
+      if (f[4] != "nocase")
+        return fail(lineNo, QStringLiteral("unknown flag %1")
+                                .arg(QString::fromLatin1(f[4])));
+      r.caseSensitive = false;
+    }
+    if (rules.size() == kMaxRules)
+      return fail(lineNo, QStringLiteral("more than %1 rules").arg(kMaxRules));
+    patternBytes += r.pattern.size();
+    if (patternBytes >= kMaxStates)
+      return fail(lineNo, QStringLiteral("patterns too long"));
+    rules.append(r);
+  }
+  m_rules = rules;
+  compile();
+  return true;
+}
+
+bool UrlRuleSet::loadFile(const QString &path, QString *error) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    if (error)
+      *error = QStringLiteral("cannot open %1").arg(path);
+    return false;
+  }
+  return load(file.readAll(), error);
+}
+
+void UrlRuleSet::compile() {
+  // Trie over folded bytes; -1 marks a missing edge until the BFS below
+  // turns the trie into a full transition table.
+  std::vector<int> next(kAlphabet, -1);
+  std::vector<quint64> out(1, 0);
+  m_kindMask.fill(0);
+  m_blockMask = m_allowMask = m_caseMask = 0;
+  for (int i = 0; i < m_rules.size(); ++i) {
+    const Rule &r = m_rules.at(i);
+    const quint64 bit = quint64(1) << i;
+    int s = 0;
+    for (char ch : r.pattern) {
+      const uchar c = kFold.map[uchar(ch)];
+      if (next[size_t(s) * kAlphabet + c] < 0) {
+        next[size_t(s) * kAlphabet + c] = int(out.size());
+        out.push_back(0);
+        next.resize(out.size() * kAlphabet, -1);
+      }
+      s = next[size_t(s) * kAlphabet + c];
+    }
+    out[s] |= bit;
+    for (int k = 0; k < KindCount; ++k)
+      if (r.kinds & (1u << k))
+        m_kindMask[k] |= bit;
+    if (r.action == Block)
+      m_blockMask |= bit;
+    else if (r.action == Allow)
+      m_allowMask |= bit;
+    if (r.caseSensitive)
+      m_caseMask |= bit;
+  }
+
+  std::vector<int> fail(out.size(), 0);
+  std::deque<int> queue;
+  for (int c = 0; c < kAlphabet; ++c) {
+    int &t = next[c];
+    if (t < 0) {
+      t = 0;
+    } else {
+      fail[t] = 0;
+      queue.push_back(t);
+    }
+  }
+  while (!queue.empty()) {
+    const int s = queue.front();
+    queue.pop_front();
+    out[s] |= out[fail[s]];
+    for (int c = 0; c < kAlphabet; ++c) {
+      int &t = next[size_t(s) * kAlphabet + c];
+      const int viaFail = next[size_t(fail[s]) * kAlphabet + c];
+      if (t < 0) {
+        t = viaFail;
+      } else {
+        fail[t] = viaFail;
+        queue.push_back(t);
+      }
+    }
+  }
+
+  m_stateCount = int(out.size());
+  m_next.assign(next.begin(), next.end());
+  m_out = std::move(out);
+  for (auto &h : m_hits)
+    h.store(0, std::memory_order_relaxed);
+}
+
+UrlRuleSet::Result UrlRuleSet::match(const char *url, qsizetype size,
+                                     Kind kind) {
+  Result res;
+  if (m_next.empty())
+    return res;
+  const quint64 wanted = m_kindMask[kind];
+  if (!wanted)
+    return res;
+  const auto *p = reinterpret_cast<const uchar *>(url);
+  const quint16 *next = m_next.data();
+  const quint64 *outs = m_out.data();
+  quint32 s = 0;
+  for (qsizetype i = 0; i < size; ++i) {
+    s = next[s * kAlphabet + kFold.map[p[i]]];
+    quint64 fresh = outs[s] & wanted & ~res.matched;
+    if (!fresh)
+      continue;
+    // folded match; case-sensitive rules must also match byte for byte
+    quint64 verify = fresh & m_caseMask;
+    while (verify) {
+      const int r = qCountTrailingZeroBits(verify);
+      verify &= verify - 1;
+      const QByteArray &pat = m_rules.at(r).pattern;
+      if (std::memcmp(p + i + 1 - pat.size(), pat.constData(),
+                      size_t(pat.size())) != 0)
+        fresh &= ~(quint64(1) << r);
+    }
+    res.matched |= fresh;
+  }
+  for (quint64 m = res.matched; m; m &= m - 1)
+    m_hits[qCountTrailingZeroBits(m)].fetch_add(1, std::memory_order_relaxed);
+  res.block = (res.matched & m_blockMask) && !(res.matched & m_allowMask);
+  return res;
+}
+
+QJsonObject UrlRuleSet::snapshot() const {
+  QJsonArray rules;
+  for (int i = 0; i < m_rules.size(); ++i) {
+    const Rule &r = m_rules.at(i);
+    QJsonArray kinds;
+    for (int k = 0; k < KindCount; ++k)
+      if (r.kinds & (1u << k))
+        kinds.append(QString::fromLatin1(kKindNames[k]));
+    QJsonObject o;
+    o.insert(QStringLiteral("action"),
+             QString::fromLatin1(kActionNames[r.action]));
+    o.insert(QStringLiteral("types"), kinds);
+    o.insert(QStringLiteral("pattern"), QString::fromLatin1(r.pattern));
+    o.insert(QStringLiteral("tag"), QString::fromLatin1(r.tag));
+    o.insert(QStringLiteral("nocase"), !r.caseSensitive);
+    o.insert(QStringLiteral("hits"), qint64(hits(i)));
+    rules.append(o);
+  }
+  QJsonObject root;
+  root.insert(QStringLiteral("states"), m_stateCount);
+  root.insert(QStringLiteral("rules"), rules);
+  return root;
+}
+
+QStringList UrlRuleSet::summaryLines() const {
+  QStringList lines;
+  for (int i = 0; i < m_rules.size(); ++i) {
+    const Rule &r = m_rules.at(i);
+    lines << QStringLiteral("%1 %2 %3 hits %4")
+                 .arg(QLatin1String(kActionNames[r.action]),
+                      QString::fromLatin1(r.tag),
+                      QString::fromLatin1(r.pattern))
+                 .arg(hits(i));
+  }
+  return lines;
+}
@@ -0,0 +1,104 @@
+#ifndef URL_RULES_H
+#define URL_RULES_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+#include <array>
+#include <atomic>
+#include <vector>
+
+// Block / allow / observe rules for request URLs, compiled into one
+// Aho-Corasick automaton so a request costs a single pass over its bytes no
+// matter how many rules there are. Patterns are substrings of the encoded
+// "//host/path?query" form of the URL (the query is kept: font and style
+// loaders name the family there); matching folds ASCII case and re-checks
+// case-sensitive patterns at the match position, so match() itself
+// allocates nothing. The caller supplies the encoded bytes: the interceptor
+// pays one QUrl::toEncoded() per request, since QUrl has no way to encode
+// into a reused buffer. Every rule counts its hits (relaxed atomics: the
+// interceptor may run off the GUI thread).
+//
+// Rule file, one rule per line, '#' starts a comment:
+//   <block|allow|observe> <types> <pattern> [tag] [nocase]
+// types is '*' or a comma list of mainframe, subframe, stylesheet, script,
+// image, font, media, xhr, other. A request is blocked when a block rule
+// matches and no allow rule does; tag is the log prefix for hits.
+class UrlRuleSet {
+public:
+  enum Action : quint8 { Observe = 0, Block, Allow };
+  enum Kind : quint8 {
+    KindMainFrame = 0,
+    KindSubFrame,
+    KindStylesheet,
+    KindScript,
+    KindImage,
+    KindFont,
+    KindMedia,
+    KindXhr,
+    KindOther,
+    KindCount
+  };
+  static constexpr int kMaxRules = 64;
+
+  struct Rule {
+    Action action = Observe;
+    quint32 kinds = 0; // bit per Kind
+    bool caseSensitive = true;
+    QByteArray pattern;
+    QByteArray tag;
+  };
+
+  struct Result {
+    quint64 matched = 0; // bit per rule index
+    bool block = false;
+  };
+
+  UrlRuleSet() = default;
+  UrlRuleSet(const UrlRuleSet &) = delete;
+  UrlRuleSet &operator=(const UrlRuleSet &) = delete;
+
+  // The rules that used to be hard-coded in ResourceInterceptor.
+  static const char *defaultRules();
+  static const char *kindName(int kind);
+
+  // Replaces the rule set; on error (*error says which line) the previous
+  // rules stay in place. Not thread-safe against match().
+  bool load(const QByteArray &text, QString *error = nullptr);
+  bool loadFile(const QString &path, QString *error = nullptr);
+
+  // url: encoded "//host/path?query". Counts hits for the rules it returns.
+  Result match(const char *url, qsizetype size, Kind kind);
+  Result match(const QByteArray &url, Kind kind) {
+    return match(url.constData(), url.size(), kind);
+  }
+
+  int size() const { return int(m_rules.size()); }
+  const Rule &rule(int index) const { return m_rules.at(index); }
+  quint64 hits(int index) const {
+    return m_hits[index].load(std::memory_order_relaxed);
+  }
+  int stateCount() const { return m_stateCount; }
+
+  QJsonObject snapshot() const;
+  QStringList summaryLines() const;
+
+private:
+  void compile();
+
+  QList<Rule> m_rules;
+  // goto function completed with failure links: m_next[state * 256 + byte]
+  std::vector<quint16> m_next;
+  std::vector<quint64> m_out; // rules ending in each state, suffixes included
+  std::array<quint64, KindCount> m_kindMask{};
+  quint64 m_blockMask = 0;
+  quint64 m_allowMask = 0;
+  quint64 m_caseMask = 0;
+  int m_stateCount = 0;
+  std::array<std::atomic<quint64>, kMaxRules> m_hits{};
+};
+
+#endif // URL_RULES_H
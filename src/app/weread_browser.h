@@ -8,9 +8,11 @@
 #include <QDateTime>
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QEventLoop>
 #include <QFile>
 #include <QFrame>
+#include <QHash>
 #include <QHBoxLayout>
 #include <QHostAddress>
 #include <QIODevice>
@@ -18,6 +20,7 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QKeyEvent>
+#include <QLabel>
 #include <QMainWindow>
 #include <QMouseEvent>
 #include <QNetworkCookie>
@@ -26,7 +29,6 @@
 #include <QRect>
 #include <QStandardPaths>
 #include <QString>
-#include <QTcpSocket>
 #include <QTimer>
 #include <QTouchEvent>
 #include <QUdpSocket>
@@ -47,6 +49,7 @@
 #include <QtGlobal>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
 #include <fcntl.h>
 #include <stdint.h>
 #include <sys/ioctl.h>
@@ -57,8 +60,19 @@
 #include <sys/un.h>
 #include <unistd.h>
 
+#include "asset_store.h"
 #include "common.h"
+#include "connection_warmer.h"
 #include "eink_refresh.h"
+#include "frame_capture.h"
+#include "gesture_target.h"
+#include "ink_latency_tracer.h"
+#include "js_profiler.h"
+#include "net_accounting.h"
+#include "offline_archive.h"
+#include "page_context.h"
+#include "page_path_selector.h"
+#include "page_turn_controller.h"
 #include "resource_interceptor.h"
 #include "routed_page.h"
 #include "smart_refresh.h"
@@ -70,7 +84,7 @@ static inline bool domScoreDebugEnabled() {
   return qEnvironmentVariableIntValue("WEREAD_DOM_SCORE_DEBUG") != 0;
 }
 
-class WereadBrowser : public QMainWindow {
+class WereadBrowser : public QMainWindow, public GestureTarget {
   Q_OBJECT
 public:
   WereadBrowser(const QUrl &url, FbRefreshHelper *fbRef = nullptr);
@@ -80,45 +94,67 @@ private slots:
 
 public:
   CatalogWidget *catalogWidget() const;
-  void injectMouse(Qt::MouseButton btn, QEvent::Type type, const QPointF &pos);
-  void injectTouch(QEvent::Type type, const QPointF &pos, int id = 0);
+  int viewWidth() const override;
+  QRect catalogRect() const override;
+  QRect menuRect() const override;
+  void injectMouse(Qt::MouseButton btn, QEvent::Type type,
+                   const QPointF &pos) override;
+  void injectTouch(QEvent::Type type, const QPointF &pos,
+                   int id = 0) override;
   void armInjectedMousePassThrough(const QPointF &pos, int durationMs = 600);
-  void armInjectedTouchPassThrough(const QPointF &pos, int durationMs = 600);
-  bool shouldReplayInjectedMouse(const QPointF &pos, qint64 nowMs) const;
-  void noteInjectedMouseReplayed(const QPointF &pos, qint64 nowMs);
+  void armInjectedTouchPassThrough(const QPointF &pos,
+                                   int durationMs = 600) override;
+  bool shouldReplayInjectedMouse(const QPointF &pos,
+                                 qint64 nowMs) const override;
+  void noteInjectedMouseReplayed(const QPointF &pos, qint64 nowMs) override;
   bool shouldBypassGestureForInjectedMouse(const QPointF &pos,
-                                           qint64 nowMs) const;
+                                           qint64 nowMs) const override;
   bool shouldBypassGestureForInjectedTouch(const QPointF &pos,
-                                           qint64 nowMs) const;
+                                           qint64 nowMs) const override;
   void injectKey(int key);
   // 获取内部 WebEngineView，用于安装事件过滤器（如 GestureFilter）
   QWebEngineView *view() const;
-  void scrollByJs(int dy);
+  void scrollByJs(int dy) override;
+  // 拖动滚动：位移累积后按 kPanFlushMs 节拍合并成一次 window.scrollBy，
+  // 同时只有一个在途；拖动中每次落地发整屏 A2，松手后统一一次 GC16 落定
+  void panScrollBy(int dy) override;
+  void endPanScroll() override;
   int pageStep() const;
   void hittestJs(const QPointF &pos);
   void injectWheel(const QPointF &pos, int dy);
-  void goNextPage(const QPointF &inputPos = QPointF());
-  void goPrevPage(const QPointF &inputPos = QPointF());
+  void goNextPage(const QPointF &inputPos = QPointF()) override;
+  void goPrevPage(const QPointF &inputPos = QPointF()) override;
+  // 多页跳转（长滑/按住拖动）：一次滚动，收尾只出一次 GC16 局刷
+  // previewPageJump 在手指按下期间显示目标页数预览（A2 刷新预览框）
+  void previewPageJump(int pages) override;
+  void jumpPages(int pages) override;
+  void cancelPageJump() override;
+  // 预翻页：按下即发下一页滚动并压住刷新，松手确认后放行，否则翻回并丢弃
+  // 期间的刷新事件（仅微信读书书籍页）
+  bool beginSpeculativeTurn() override;
+  void commitSpeculativeTurn() override;
+  void revertSpeculativeTurn() override;
   void openCatalog();
-  bool handleMenuTap(const QPointF &globalPos);
+  bool handleMenuTap(const QPointF &globalPos) override;
   void openWeReadFontPanelAndSelect();
   void adjustFont(bool increase);
   void toggleTheme();
   void toggleFontFamily();
   void toggleService();
   void applyDefaultLightTheme();
-  void dedaoScroll(bool forward);
+  void dedaoScroll(int seq, int pages);
 
   void fetchCatalog();
 
-  void goBack();
-  void goWeReadHome();
+  void goBack() override;
+  void goWeReadHome() override;
   void allowDedaoDetailOnce();
-  void showMenu();
-  void exitToXochitl(const QString &exitReason = QStringLiteral("unknown"));
+  void showMenu() override;
+  void exitToXochitl(
+      const QString &exitReason = QStringLiteral("unknown")) override;
 
   // 触发全黑覆盖 + 双次全屏清理刷新（INIT FULL → GC16 FULL）
-  void triggerFullRefresh();
+  void triggerFullRefresh() override;
 
 public slots:
   void sendBookState();
@@ -135,12 +171,25 @@ private:
   void initSessionAutoSave();
   void initMenuOverlay();
   void initStateResponder();
+  void initFrameCapture();
 
   QWebEngineView *m_view = nullptr; // Active view shown to user
   CatalogWidget *m_catalogWidget = nullptr;
   FbRefreshHelper *m_fbRef = nullptr;
   SmartRefreshManager *m_smartRefreshWeRead = nullptr; // 智能刷新管理器（微信读书）
   SmartRefreshManager *m_smartRefreshDedao = nullptr;  // 智能刷新管理器（得到）
+  FrameCapturePipeline *m_frameCapture = nullptr; // 离屏模式抓帧（offscreen）
+  mutable JsCallProfiler m_jsProfiler; // runJavaScript 往返耗时（按调用点）
+  static constexpr qint64 kJsSlowCallMs = 800;
+  // 文档里没有运行时时调用串返回的标记
+  static constexpr const char *kRuntimeMissing = "__wr_missing__";
+  struct PendingProbe {
+    QString call; // 运行时调用串，如 "chapterState()"，相同调用共用一次执行
+    QVector<std::function<void(const QVariant &)>> callbacks;
+  };
+  static constexpr int kProbeBatchWindowMs = 200;
+  mutable QVector<PendingProbe> m_pendingProbes;
+  mutable QTimer m_probeBatchTimer;
   QTimer *m_idleCleanupTimer = nullptr;          // 空闲清理定时器
   QTimer *m_sessionSaveTimer = nullptr; // 定期保存会话状态定时器（每分钟）
   mutable qint64 m_lastSessionSaveTime =
@@ -171,14 +220,31 @@ private:
   bool m_pingDisabled = false;    // 环境变量 WEREAD_PING_DISABLE 可关闭
   int m_pingMaxRetries = 3;       // ping 失败重试次数
   int m_pingRetryDelayMs = 10000; // 重试间隔 10s
-  int m_pingTimeoutMs = 8000;     // 单次 TCP 探测超时
+  int m_pingTimeoutMs = 8000;     // 单次预热请求超时
   qint64 m_pingLastReloadMs = 0; // 最近一次因 ping 失败触发 reload 的时间戳
+  // 连接预热：翻页节拍之外，章末前 kWarmPagesAhead 屏内、且距上次预热超过
+  // kWarmStaleMs 时再预热一次，让下一章请求落在热连接上
+  static constexpr int kWarmPagesAhead = 6;
+  static constexpr qint64 kWarmStaleMs = 30000;
+  static constexpr int kWarmExtraHosts = 2;
+  ConnectionWarmer m_warmer;
+  quint64 m_warmRound = 0;
+  // 尚未收尾的预热轮次 -> done；宿主侧超时与结果回调谁先到谁收尾
+  QHash<quint64, std::function<void(int, int)>> m_warmPending;
+  // runJavaScript 回调的宽限：页面卡死或渲染进程崩溃时回调不会来
+  static constexpr int kWarmCallbackSlackMs = 4000;
   int m_emptyReadyPolls = 0;
   bool m_enableAutoReload = false; // 旧的自动重载策略（已默认关闭）
   int m_jsUnexpectedCount = 0;
   qint64 m_jsLastUnexpectedMs = 0;
   qint64 m_jsUnexpectedLastLogMs = 0;
   qint64 m_jsReloadCooldownMs = 0;
+  // 截断脚本的定点重取：每个脚本每次加载最多 kScriptRepairAttempts 次
+  static constexpr int kScriptRepairAttempts = 1;
+  static constexpr int kScriptRepairTimeoutMs = 20000;
+  QHash<QString, int> m_scriptRepairs;
+  QString m_scriptRepairPending; // 正在重取的脚本，空为无
+  qint64 m_scriptRepairStartMs = 0;
   bool m_stallRescueTriggered = false;
   bool m_firstFrameDone = false;
   int m_reloadAttempts = 0;
@@ -208,6 +274,7 @@ private:
   bool m_defaultSettingsScriptInstalled = false;
   bool m_dedaoDefaultSettingsScriptInstalled = false;
   bool m_chapterObserverScriptInstalled = false;
+  bool m_pageRuntimeScriptInstalled = false;
   int m_rescueSeq = 0;
   bool m_iframeFixApplied = false;
   bool m_lowPowerCssInjected = false;
@@ -215,6 +282,12 @@ private:
   QUdpSocket m_stateSender;
   QUdpSocket m_stateResponder;
   QUrl currentUrl;
+  // currentUrl/UA 的分类缓存：urlChanged 与 UA 切换时由 updatePageContext()
+  // 重算，isWeReadBook()/smartRefreshForPage() 等只读字段
+  PageContext m_pageContext;
+  // 翻页路径用的 Kindle 判定（含书籍页 UA），随 updatePageContext() 更新
+  bool m_weReadTurnKindleUA = false;
+  void updatePageContext();
   QString m_prevUrlStr;
   QString m_lastNavReason;
   QUrl m_lastNavReasonTarget;
@@ -237,11 +310,34 @@ private:
   QString m_dedaoCatalogCacheKey;
   QJsonArray m_dedaoCatalogCache;
   bool m_dedaoCatalogJumpPending = false;
-  bool m_navigating = false; // 翻页防抖锁
-  int m_navSequence = 0;     // 翻页序列号，防止僵尸回调
-  qint64 m_navStartTime = 0; // 翻页开始时间（用于检测慢速翻页）
-  int m_pendingNavSeq = 0; // 待处理的翻页序列号（用于取消机制）
-  QTimer *m_navTimeoutTimer = nullptr; // 翻页超时定时器（可取消）
+  // 翻页状态机：序列号/看门狗/连击合并为净页数，各翻页路径完成后回报
+  PageTurnController m_pageTurn;
+  // 按站点/模式给各翻页路径计时（派发到首个 DOM 变化），自动选最快且可靠的
+  PagePathSelector m_pagePaths;
+  ResourceInterceptor *m_interceptor = nullptr; // 请求规则及命中计数
+  AssetStore *m_assetStore = nullptr; // 不可变资源本地存储（可为空）
+  OfflineArchive *m_offline = nullptr; // 离线下载的整本书
+  QString m_offlineManifestReader; // 已下发离线书目的书（readerId）
+  QString m_offlineDownloadReader; // 正在下载的书，下载期间书目不更新
+  // 最近几次页面加载的请求数/字节/耗时/缓存命中（按类型+host）
+  NetAccounting m_netStats;
+  quint64 m_netLoadSeq = 0; // 每次主框架加载 +1，丢弃迟到的采集结果
+  QLabel *m_jumpPreview = nullptr;        // 跳页预览框（手指按下期间）
+  bool m_pageJumpSettlePending = false; // 跳页执行完等控制器空闲后收尾刷新
+  // 拖动滚动的合并下发状态
+  void flushPanScroll();
+  void finishPanScroll();
+  static constexpr int kPanFlushMs = 120; // ≈ 面板 A2 一次更新的时长
+  static constexpr int kPanIdleEndMs = 600; // 丢失松手时的兜底收尾
+  QTimer m_panFlushTimer;
+  QTimer m_panIdleTimer;
+  QElapsedTimer m_panLastFlush;
+  int m_panPendingDy = 0;
+  bool m_panActive = false;
+  bool m_panInFlight = false;
+  bool m_panEnding = false;
+  bool m_speculativeTurn = false;        // 预翻页已发出，等待确认
+  bool m_speculationRevertPending = false; // 翻回执行完后丢弃压住的刷新
   int m_pendingInputFallbackSeq = 0;   // 输入注入等待fallback的序列号
   qint64 m_inputFallbackStartMs = 0;   // 输入注入起始时间
   bool m_inputDomObserved = false;   // 输入注入后是否观察到DOM变化
@@ -268,24 +364,26 @@ public:
   QUrl navReasonTarget() const { return m_lastNavReasonTarget; }
   qint64 navReasonTs() const { return m_lastNavReasonTs; }
   QUrl currentUrlForLog() const { return currentUrl; }
+  NetAccounting &netAccounting() { return m_netStats; }
 
   // 会话恢复相关方法（public，供 main() 调用）
   static QString getSessionStatePath();
   static QString getExitReasonPath();
   static void saveExitReason(const QString &reason);
   static QString loadExitReason();
-  void saveSessionState() const;
+  void saveSessionState() const override;
   QUrl loadSessionUrl() const;
   int loadSessionScrollPosition() const;
   int m_restoredScrollY = 0; // 恢复的滚动位置（public，供 main() 访问）
   bool m_isRestoringSession =
       false; // 是否正在恢复会话（public，供 main() 访问）
   // 以下方法供外部类（如 GestureFilter）调用，需要保持 public
-  bool isWeReadBook() const;
-  bool isKindleUA() const;
-  bool isWeReadKindleMode() const;
-  bool isDedaoBook() const;
+  bool isWeReadBook() const override;
+  bool isKindleUA() const override;
+  bool isWeReadKindleMode() const override;
+  bool isDedaoBook() const override;
   bool isDedaoSite() const;
+  const PageContext &pageContext() const { return m_pageContext; }
   QWebEngineView *getView() const;
   SmartRefreshManager *getSmartRefresh() const;
   SmartRefreshManager *getSmartRefreshWeRead() const;
@@ -294,7 +392,7 @@ public:
   SmartRefreshManager *smartRefreshForPage() const;
   void handleSmartRefreshEvents(const QString &json);
   void handleSmartRefreshBurstEnd();
-  void scheduleBookCaptures(bool force = false);
+  void scheduleBookCaptures(bool force = false) override;
   void restartCaptureLoop();
   void openDedaoMenu();
   void updateLastTouchTs(qint64 ts);
@@ -304,11 +402,15 @@ private:
   void logPageTurnEffect(int currentSeq, const QString &source,
                          const QString &trigger, int score);
   QPointF resolveInputPos(const QPointF &inputPos, bool forward) const;
+  void requestPageTurn(int pages);
+  // PageTurnController::execute 的执行端：按页面类型分派，完成后 complete()
+  void executePageTurn(int seq, int pages);
   void markPageTurnTriggered(int currentSeq, const QString &source);
   void scheduleInputFallback(bool forward, int currentSeq);
   void runWeReadPagerJsClick(bool forward, int currentSeq,
                              const QString &trigger);
   void noteDomEventFromJson(const QString &json);
+  void markPageTurnSeq(int seq);
   // 根据 URL 切换 UA：微信书籍页用 Qt 默认 UA，其余用配置的 iOS/Kindle/Android
   // UA
   void updateUserAgentForUrl(const QUrl &url);
@@ -337,6 +439,9 @@ private:
   void recordNavReason(const QString &reason, const QUrl &target);
 
   void handleJsUnexpected(const QString &message, const QString &source);
+  bool repairScript(const QString &source);
+  void handleScriptRepaired(const QString &json);
+  void reloadForJsError(bool allowLog);
 
 private:
   void updateHeartbeat();
@@ -354,8 +459,14 @@ private:
   // 翻页节拍：每 N 次翻页发送一次 ping（独立于 idx/章节状态）
   void onPageTurnEvent();
 
-  // 进程内网络探针：使用 Qt 网络层，绕过页面环境
+  // 网络探针：经页面自身的网络栈预热 HTTPS 连接，失败按次数重试
   void sendKeepAlivePing(int triggerCount, int attempt);
+  // 一轮预热；done(ok, failed) 在结果取回后调用，恰好一次。页面回调迟迟
+  // 不来时由宿主侧超时按失败收尾；ok、failed 都为 0 表示没有结论
+  void warmConnections(const QString &reason,
+                       const std::function<void(int, int)> &done = {});
+  void finishWarmRound(quint64 round, int ok, int failed);
+  void logWarm() const;
 
   void maybeReloadAfterPingFail(int triggerCount);
 
@@ -365,6 +476,40 @@ private:
   void installChapterObserverScript();
   void installSmartRefreshScript(const QString &flagName);
   QString buildSmartRefreshScript(const QString &flagName) const;
+  // 常驻页面运行时 window.__wr：每个文档只编译一次，C++ 只发短调用串
+  void installPageRuntimeScript();
+  // 所有 runJavaScript 统一入口：按 site 记录排队/执行/回传耗时
+  void runPageJs(
+      const char *site, const QString &script,
+      const std::function<void(const QVariant &)> &callback = {}) const;
+  void logJsProfile() const;
+  // 在当前页测量运行时/章节观察脚本与一次典型调用串的解析编译耗时
+  void measureJsCompile(const std::function<void(const QJsonObject &)> &done);
+  // 翻页输入到上墨（触摸→派发→JS→DOM→决策→ioctl→完成）各段 p50/p95/p99
+  void logInkTrace() const;
+  void logPagePaths() const;
+  void logUrlRules() const;
+  // 拉取本次加载新增的 resource timing 条目并计入 m_netStats
+  void collectNetEntries(const std::function<void()> &done = {});
+  void logNetStats() const;
+  // 离线下载：当前微信读书书籍按 chapterInfos 逐章取回存入 m_offline
+  void startOfflineDownload();
+  void handleOfflineData(const QString &json);
+  // 只给 weread.qq.com 阅读页下发该书自己的离线书目；url 不是阅读页时撤掉
+  void installOfflineManifestScript(const QUrl &url);
+  void logOffline() const;
+  // callPageRuntime 实际发送的脚本（带 $call 计时包装与缺失标记）
+  static QString runtimeCallScript(const QString &call);
+  // call 形如 "scroll(1357)"；运行时缺失时补注入运行时并再发一次调用
+  void callPageRuntime(
+      const QString &call,
+      const std::function<void(const QVariant &)> &callback = {}) const;
+  // 诊断/状态探针合批：时间窗内的探针合成一次 runJavaScript，结果按请求分发。
+  // maxDelayMs 只会把本批的截止时间提前，不会推迟已排队的探针
+  void queuePageProbe(const QString &call,
+                      const std::function<void(const QVariant &)> &callback,
+                      int maxDelayMs = kProbeBatchWindowMs) const;
+  void flushPageProbes() const;
 
 public:
   void cycleUserAgentMode();
@@ -388,8 +533,8 @@ public:
   // 全量扫描文本长度/画布/图片数量，用于判断非 DOM 文本渲染
   void logTextScan(bool once = true);
 
-  // 微信读书：滚动替代分页，步长为屏高 0.8，滚动后对齐行高
-  void weReadScroll(bool forward);
+  // 微信读书：滚动替代分页，步长为屏高 0.8 取整行（页面内几何缓存计算）
+  void weReadScroll(int seq, int pages);
   void triggerStalledRescue(const QString &reason, int chapterLen, int bodyLen,
                             int pollCount);
 
@@ -397,6 +542,7 @@ public:
   static const QString &getChapterObserverScript();
   static const QString &getDefaultSettingsScript();
   static const QString &getDedaoDefaultSettingsScript();
+  static const QString &getPageRuntimeScript();
 };
 
 #endif // WEREAD_BROWSER_H
@@ -10,4 +10,5 @@ WereadBrowser::WereadBrowser(const QUrl &url, FbRefreshHelper *fbRef)
   initSessionAutoSave();
   initMenuOverlay();
   initStateResponder();
+  initFrameCapture();
 }
@@ -143,6 +143,25 @@ void WereadBrowser::initLoadSignals()
               << "reason" << m_lastNavReason
               << "reasonTarget" << m_lastNavReasonTarget
               << "reasonAgeMs" << reasonAge;
+      if (status == QWebEngineLoadingInfo::LoadStartedStatus) {
+        ++m_netLoadSeq;
+        m_netStats.beginLoad(info.url(), ts);
+        m_scriptRepairs.clear();
+        m_scriptRepairPending.clear();
+      } else {
+        m_netStats.finishLoad(info.url(), statusStr, info.errorCode(),
+                              info.errorString(), ts);
+        // 书籍页在 loadFinished 之后还要拉二三十秒资源：完成时采一次，
+        // 之后再补采两次（只计本次加载的新增条目）
+        collectNetEntries();
+        const quint64 seq = m_netLoadSeq;
+        for (int delayMs : {10000, 40000}) {
+          QTimer::singleShot(delayMs, this, [this, seq]() {
+            if (seq == m_netLoadSeq)
+              collectNetEntries();
+          });
+        }
+      }
       if (status == QWebEngineLoadingInfo::LoadSucceededStatus) {
         if (m_dedaoCatalogJumpPending && isDedaoBook() && m_smartRefreshDedao) {
           qInfo() << "[CATALOG_DEDAO] load succeeded after jump, refresh";
@@ -242,7 +261,8 @@ void WereadBrowser::initLoadSignals()
   return {ok:true, updated, before, after:{fontLevel: setting.fontLevel, fontFamily: setting.fontFamily}};
 })()
 )JS");
-                  m_view->page()->runJavaScript(
+                  runPageJs(
+                      "dedaoHomeSettings",
                       js, [](const QVariant &res) {
                         qInfo() << "[DEDAO_HOME_SETTINGS]" << res;
                       });
@@ -274,7 +294,8 @@ void WereadBrowser::initLoadSignals()
           if (m_restoredScrollY > 0) {
               QTimer::singleShot(500, this, [this]() {
                   if (m_view && m_view->page()) {
-                      m_view->page()->runJavaScript(
+                      runPageJs(
+                          "restoreScroll",
                           QStringLiteral("window.scrollTo(0, %1)").arg(m_restoredScrollY)
                       );
                       qInfo() << "[SESSION] Restored scroll position:" << m_restoredScrollY;
@@ -328,7 +349,7 @@ void WereadBrowser::initLoadSignals()
   setTimeout(() => clearInterval(checkReady), 60000);
   })();
   )");
-          m_view->page()->runJavaScript(perfMonitorJs);
+          runPageJs("perfMonitor", perfMonitorJs);
   }
   
           const bool isWeReadBookPage = isWeReadBook();
@@ -350,7 +371,7 @@ void WereadBrowser::initLoadSignals()
               installSmartRefreshScript(smartRefreshFlag);
               const QString smartRefreshJs =
                   buildSmartRefreshScript(smartRefreshFlag);
-              m_view->page()->runJavaScript(smartRefreshJs);
+              runPageJs("smartRefresh.inject", smartRefreshJs);
               qInfo() << "[SMART_REFRESH] Injected JS monitor script "
                          "(loadFinished)"
                       << smartRefreshFlag;
@@ -455,7 +476,7 @@ void WereadBrowser::initLoadSignals()
   console.log('[RETRY] Auto-retry listener installed');
   })();
   )");
-          m_view->page()->runJavaScript(autoRetryJs);
+          runPageJs("autoRetry.inject", autoRetryJs);
           qInfo() << "[SMART_REFRESH] Injected auto-retry listener (loadFinished)";
           }
   
@@ -468,7 +489,7 @@ void WereadBrowser::initLoadSignals()
           scheduleBookCaptures();
           // 内容完整性检查：非书籍页走旧逻辑，书籍页单独做核心探针后再决定是否重载
           if (!isWeReadBook() && !isDedaoBook()) {
-              m_view->page()->runJavaScript(QStringLiteral(
+              runPageJs("integrityProbe", QStringLiteral(
                   "(() => {"
                   "  try {"
                   "    const bodyLen = (document.body && document.body.innerText) ? document.body.innerText.length : 0;"
@@ -495,7 +516,7 @@ void WereadBrowser::initLoadSignals()
               });
           } else if (isWeReadBook()) {
               // 书籍页：loadFinished 后早期自检正文/iframe，若全部为空且尚未重载过，尝试一次绕缓存重载
-              m_view->page()->runJavaScript(QStringLiteral(
+              runPageJs("bookEarlyProbe", QStringLiteral(
                   "(() => {"
                   "  try {"
                   "    const bodyLen = (document.body && document.body.innerText) ? document.body.innerText.length : 0;"
@@ -539,7 +560,7 @@ void WereadBrowser::initLoadSignals()
               // 延迟3秒后加载，使 loadFinished 不再等待这些脚本
               QTimer::singleShot(3000, [this]() {
                   qInfo() << "[OPTIMIZATION] 延迟加载被拦截的脚本 (WASM/支付/Worker)";
-                  m_view->page()->runJavaScript(QStringLiteral(
+                  runPageJs("deferredScripts", QStringLiteral(
                       "(function() {"
                       "  // 创建脚本加载函数"
                       "  const loadScript = (src) => {"
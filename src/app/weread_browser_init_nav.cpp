@@ -74,6 +74,12 @@ void WereadBrowser::initNavigationSignals()
               << "reasonTarget" << m_lastNavReasonTarget
               << "reasonAgeMs" << reasonAge;
       logHistoryState(QStringLiteral("pageUrlChanged"));
+      const QString readerId = OfflineArchive::readerIdOf(url);
+      // 下载脚本随旧文档一起没了，不会再发 end
+      if (readerId != m_offlineDownloadReader)
+        m_offlineDownloadReader.clear();
+      if (readerId != m_offlineManifestReader)
+        installOfflineManifestScript(url);
   });
 
   connect(m_view->page(), &QWebEnginePage::titleChanged, this,
@@ -94,6 +100,7 @@ void WereadBrowser::initNavigationSignals()
       const QString oldUrl = currentUrl.toString();
       const QString newUrlStr = url.toString();
       currentUrl = url;
+      updatePageContext();
       const qint64 now = QDateTime::currentMSecsSinceEpoch();
       const qint64 reasonAge =
           m_lastNavReasonTs > 0 ? (now - m_lastNavReasonTs) : -1;
@@ -204,7 +211,7 @@ void WereadBrowser::initNavigationSignals()
                              [this, smartRefreshJs, smartRefreshFlag,
                               injectWeReadRetry]() {
               if (m_view && m_view->page()) {
-                  m_view->page()->runJavaScript(smartRefreshJs);
+                  runPageJs("smartRefresh.injectEarly", smartRefreshJs);
                   qInfo() << "[SMART_REFRESH] Injected JS monitor script from "
                              "urlChanged (early injection)"
                           << smartRefreshFlag;
@@ -311,7 +318,7 @@ void WereadBrowser::initNavigationSignals()
   console.log('[RETRY] Auto-retry listener installed (from urlChanged)');
   })();
   )");
-                  m_view->page()->runJavaScript(autoRetryJs);
+                  runPageJs("autoRetry.injectEarly", autoRetryJs);
               }
           });
       }
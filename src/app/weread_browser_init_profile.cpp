@@ -44,8 +44,8 @@ void WereadBrowser::initProfileAndView(const QUrl &url) {
             << "force" << forceClearCache << "marker" << cacheClearMarker;
   }
   // 安装请求拦截器，阻断字体 / 统计 / 媒体等资源
-  ResourceInterceptor *interceptor = new ResourceInterceptor(this, this);
-  m_profile->setUrlRequestInterceptor(interceptor);
+  m_interceptor = new ResourceInterceptor(this, this);
+  m_profile->setUrlRequestInterceptor(m_interceptor);
   // 暂时移除所有注入脚本，排查 SyntaxError/空白根因（资源加载/缓存/上游）
   const QString uaDefault = m_profile->httpUserAgent();
   m_kindleUA = QStringLiteral(
@@ -81,6 +81,46 @@ void WereadBrowser::initProfileAndView(const QUrl &url) {
           << (uaMode.isEmpty() ? QStringLiteral("default") : uaMode)
           << "non-weRead" << m_uaNonWeRead << "weRead-book" << m_uaWeReadBook
           << "dedao-book" << m_uaDedaoBook << "bookMode" << m_weReadBookMode;
+  // 不可变资源（带哈希的 JS/CSS 包、字体）走本地内容寻址存储：
+  // 目录不在 HTTP 缓存下，清缓存后仍在；WEREAD_ASSET_STORE=1 启用。
+  // 应答需要 CORS 头，Qt 6.7 之前无法设置，拦截器不会重定向，存储不启用
+#if QT_VERSION < QT_VERSION_CHECK(6, 7, 0)
+  if (qEnvironmentVariableIntValue("WEREAD_ASSET_STORE") == 1)
+    qWarning() << "[ASSETS] WEREAD_ASSET_STORE needs Qt 6.7+ (CORS response"
+                  " headers), store disabled on Qt" << qVersion();
+#else
+  if (qEnvironmentVariableIntValue("WEREAD_ASSET_STORE") == 1) {
+    bool budgetOk = false;
+    const int budgetMb =
+        qEnvironmentVariableIntValue("WEREAD_ASSET_BUDGET_MB", &budgetOk);
+    m_assetStore = new AssetStore(
+        dataDir + QStringLiteral("/assets"),
+        budgetOk && budgetMb > 0 ? qint64(budgetMb) * 1024 * 1024
+                                 : AssetStore::kDefaultBudgetBytes,
+        this);
+    auto *assetHandler = new AssetSchemeHandler(m_assetStore, this);
+    assetHandler->setUserAgent(m_desktopChromeUA.toLatin1());
+    assetHandler->useProfileNetwork(m_profile);
+    m_profile->installUrlSchemeHandler(AssetStore::kScheme, assetHandler);
+    m_interceptor->setAssetStore(m_assetStore);
+  }
+#endif
+  // 离线下载的书：章节内容由页面钩子改取 wrbook://，插图由拦截器重定向
+  m_offline = new OfflineArchive(dataDir + QStringLiteral("/offline"), this);
+  m_offline->setUserAgent(m_desktopChromeUA.toLatin1());
+  m_profile->installUrlSchemeHandler(OfflineArchive::kScheme,
+                                     new OfflineBookHandler(m_offline, this));
+  m_interceptor->setOfflineArchive(m_offline);
+  // 归档约每 2 秒落盘一次：下载期间不重发书目，结束后的那次落盘再发
+  connect(m_offline, &OfflineArchive::changed, this, [this]() {
+    if (m_offlineDownloadReader.isEmpty())
+      installOfflineManifestScript(currentUrl);
+  });
+#if QT_VERSION < QT_VERSION_CHECK(6, 7, 0)
+  qWarning() << "[OFFLINE] Qt" << qVersion()
+             << "cannot add CORS headers to wrbook:// replies: books can be"
+                " downloaded but are not served offline (needs Qt 6.7+)";
+#endif
   qInfo() << "[PROFILE] data" << m_profile->persistentStoragePath() << "cache"
           << m_profile->cachePath() << "cookiesPolicy"
           << m_profile->persistentCookiesPolicy() << "offTheRecord"
@@ -149,6 +189,41 @@ void WereadBrowser::initProfileAndView(const QUrl &url) {
   installWeReadDefaultSettingsScript();
   installDedaoDefaultSettingsScript();
   installChapterObserverScript();
+  installPageRuntimeScript();
+  installOfflineManifestScript(url);
+  m_probeBatchTimer.setSingleShot(true);
+  connect(&m_probeBatchTimer, &QTimer::timeout, this,
+          [this]() { flushPageProbes(); });
+  connect(&m_pageTurn, &PageTurnController::execute, this,
+          [this](int seq, int pages) { executePageTurn(seq, pages); });
+  connect(&m_pageTurn, &PageTurnController::watchdogExpired, this,
+          [](int seq) {
+            qWarning() << "[PAGER] Force unlock (timeout"
+                       << PageTurnController::kDefaultWatchdogMs << "ms) seq"
+                       << seq;
+          });
+  connect(&m_pageTurn, &PageTurnController::idle, this, [this]() {
+    if (m_speculationRevertPending) {
+      // 预翻页已翻回：屏幕内容未变，压住的刷新事件整批丢弃
+      m_speculationRevertPending = false;
+      if (SmartRefreshManager *mgr = smartRefreshForPage())
+        mgr->discardSpeculation();
+    }
+    if (!m_pageJumpSettlePending)
+      return;
+    m_pageJumpSettlePending = false;
+    if (SmartRefreshManager *mgr = smartRefreshForPage())
+      mgr->settleJump();
+  });
+  m_panFlushTimer.setSingleShot(true);
+  connect(&m_panFlushTimer, &QTimer::timeout, this,
+          [this]() { flushPanScroll(); });
+  m_panIdleTimer.setSingleShot(true);
+  connect(&m_panIdleTimer, &QTimer::timeout, this, [this]() {
+    // 超过一个兜底周期仍在途的 scrollBy 视为丢失回调（页面已切换）
+    m_panInFlight = false;
+    endPanScroll();
+  });
 
   // 创建智能刷新管理器
   if (m_fbRef) {
@@ -188,6 +263,10 @@ void WereadBrowser::initProfileAndView(const QUrl &url) {
             [this](const QString &msg, const QString &src) {
               handleJsUnexpected(msg, src);
             });
+    connect(routedPage, &RoutedPage::scriptRepaired, this,
+            [this](const QString &json) { handleScriptRepaired(json); });
+    connect(routedPage, &RoutedPage::offlineData, this,
+            [this](const QString &json) { handleOfflineData(json); });
     qInfo() << "[SMART_REFRESH] Connected to RoutedPage signals";
   }
   QWebEngineSettings *settings = m_view->settings();
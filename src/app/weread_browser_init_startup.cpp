@@ -72,6 +72,7 @@ void WereadBrowser::initMenuOverlay() {
   };
   addBtn(QStringLiteral("微信读书/得到"), [this]() { toggleService(); });
   addBtn(QStringLiteral("目录"), [this]() { openCatalog(); });
+  addBtn(QStringLiteral("下载全书"), [this]() { startOfflineDownload(); });
   auto *fontPlus =
       addBtn(QStringLiteral("字体 +"), [this]() { adjustFont(true); });
   if (fontPlus) {
@@ -181,7 +182,8 @@ void WereadBrowser::initMenuOverlay() {
   return {ok:false, reason:'no-catalog-panel-or-button', panelVisible};
 })()
 )WR");
-          m_view->page()->runJavaScript(
+          runPageJs(
+              "catalogNative.open",
               openPanelJs, [this](const QVariant &res) {
                 qInfo() << "[CATALOG] open panel" << res;
                 if (!m_view)
@@ -357,7 +359,8 @@ void WereadBrowser::initMenuOverlay() {
                              maxRetries](auto &&self, int retryCount) -> void {
             if (!m_view || !m_view->page() || clickSeq != m_catalogClickSeq)
               return;
-            m_view->page()->runJavaScript(
+            runPageJs(
+                "catalogNative.click",
                 clickJs, [this, clickJs, clickSeq, maxRetries, retryCount,
                           self](const QVariant &res) mutable {
                   if (clickSeq != m_catalogClickSeq)
@@ -441,7 +444,8 @@ void WereadBrowser::initMenuOverlay() {
                   QTimer::singleShot(180, this, [this, hidePanelJs]() {
                     if (!m_view || !m_view->page())
                       return;
-                    m_view->page()->runJavaScript(
+                    runPageJs(
+                        "catalogNative.hide",
                         hidePanelJs, [](const QVariant &res) {
                           qInfo() << "[CATALOG_NATIVE] hide panel" << res;
                         });
@@ -474,3 +478,29 @@ void WereadBrowser::initStateResponder() {
 
   // 暂停所有注入脚本（探针/错误钩子），验证是否为注入引起的解析问题
 }
+
+void WereadBrowser::initFrameCapture() {
+  // 回退显示路径：QT_QPA_PLATFORM=offscreen 时把窗口帧发布到 /dev/shm，
+  // 仅在刷新决策表明有损伤时抓帧，转换/拷贝在后台线程完成
+  if (!FrameCapturePipeline::enabledForPlatform()) {
+    qInfo() << "[FRAME] capture disabled (platform"
+            << QGuiApplication::platformName() << ")";
+    return;
+  }
+  m_frameCapture = new FrameCapturePipeline(this, this);
+  if (!m_frameCapture->start()) {
+    delete m_frameCapture;
+    m_frameCapture = nullptr;
+    return;
+  }
+  for (SmartRefreshManager *mgr : {m_smartRefreshWeRead, m_smartRefreshDedao}) {
+    if (!mgr)
+      continue;
+    connect(mgr, &SmartRefreshManager::refreshIssued, this,
+            [this](const QRect &region) {
+              if (m_frameCapture)
+                m_frameCapture->noteDamage(region);
+            });
+  }
+  scheduleBookCaptures();
+}
@@ -4,7 +4,10 @@
 #include <QTextStream>
 #include <QtTest/qtesttouch.h>
 
-void WereadBrowser::captureFrame() { /* 一体化模式下不再抓帧到 SHM，留空 */
+void WereadBrowser::captureFrame() {
+  // 一体化模式（linuxfb/epaper）下 m_frameCapture 为空，直接返回
+  if (m_frameCapture)
+    m_frameCapture->captureNow();
 }
 
 namespace {
@@ -28,6 +31,21 @@ void WereadBrowser::onExitClicked() { /* removed */
 
 CatalogWidget *WereadBrowser::catalogWidget() const { return m_catalogWidget; }
 
+int WereadBrowser::viewWidth() const { return width(); }
+
+QRect WereadBrowser::catalogRect() const {
+  if (!m_catalogWidget || !m_catalogWidget->isVisible())
+    return QRect();
+  return m_catalogWidget->geometry();
+}
+
+QRect WereadBrowser::menuRect() const {
+  if (!m_menu || !m_menu->isVisible())
+    return QRect();
+  // 全局坐标，与 handleMenuTap 的命中判断一致
+  return QRect(m_menu->mapToGlobal(QPoint(0, 0)), m_menu->size());
+}
+
 void WereadBrowser::injectMouse(Qt::MouseButton btn, QEvent::Type type,
                                 const QPointF &pos) {
   if (!m_view)
@@ -151,8 +169,7 @@ QWebEngineView *WereadBrowser::view() const { return m_view; }
 void WereadBrowser::scrollByJs(int dy) {
   if (!m_view || !m_view->page())
     return;
-  m_view->page()->runJavaScript(
-      QStringLiteral("window.scrollBy(0,%1);").arg(dy));
+  runPageJs("scrollBy", QStringLiteral("window.scrollBy(0,%1);").arg(dy));
   qInfo() << "[TOUCH] js scroll" << dy;
   scheduleBookCaptures();
   // 使用智能刷新管理器处理滚动刷新
@@ -177,6 +194,86 @@ void WereadBrowser::scrollByJs(int dy) {
     m_idleCleanupTimer->start();
 }
 
+void WereadBrowser::panScrollBy(int dy) {
+  if (!m_view || !m_view->page() || dy == 0)
+    return;
+  if (!m_panActive) {
+    m_panActive = true;
+    m_panEnding = false;
+    // 拖动期间暂停常规批处理，滚动带来的 DOM 变化留到松手后一次处理
+    if (SmartRefreshManager *mgr = smartRefreshForPage())
+      mgr->beginJump();
+    qInfo() << "[PAN] begin";
+  }
+  m_panPendingDy += dy;
+  m_panIdleTimer.start(kPanIdleEndMs);
+  if (m_panInFlight || m_panFlushTimer.isActive())
+    return;
+  // 距上次下发不足一个节拍时等到节拍点，否则立即下发（首段拖动不加延迟）
+  const qint64 since =
+      m_panLastFlush.isValid() ? m_panLastFlush.elapsed() : kPanFlushMs;
+  if (since >= kPanFlushMs)
+    flushPanScroll();
+  else
+    m_panFlushTimer.start(int(kPanFlushMs - since));
+}
+
+void WereadBrowser::flushPanScroll() {
+  if (m_panInFlight || m_panPendingDy == 0 || !m_view || !m_view->page())
+    return;
+  const int dy = m_panPendingDy;
+  m_panPendingDy = 0;
+  m_panInFlight = true;
+  m_panLastFlush.start();
+  runPageJs("panScroll", QStringLiteral("window.scrollBy(0,%1);").arg(dy),
+            [this, dy](const QVariant &) {
+              m_panInFlight = false;
+              if (logLevelAtLeast(LogLevel::Info))
+                qInfo() << "[PAN] scrolled" << dy;
+              scheduleBookCaptures();
+              if (SmartRefreshManager *mgr = smartRefreshForPage())
+                mgr->previewJump(QRect(0, 0, width(), height()));
+              else if (m_fbRef)
+                m_fbRef->refreshA2(0, 0, width(), height());
+              if (m_panPendingDy != 0) {
+                // 在途期间又累积了位移：按节拍补发下一次
+                const qint64 wait = kPanFlushMs - m_panLastFlush.elapsed();
+                if (!m_panFlushTimer.isActive())
+                  m_panFlushTimer.start(int(qMax<qint64>(0, wait)));
+              } else if (m_panEnding) {
+                finishPanScroll();
+              }
+            });
+}
+
+void WereadBrowser::endPanScroll() {
+  if (!m_panActive)
+    return;
+  m_panEnding = true;
+  m_panIdleTimer.stop();
+  // 剩余位移立即下发，最后一次滚动落地后再收尾
+  m_panFlushTimer.stop();
+  if (m_panPendingDy != 0)
+    flushPanScroll();
+  if (!m_panInFlight && m_panPendingDy == 0)
+    finishPanScroll();
+}
+
+void WereadBrowser::finishPanScroll() {
+  if (!m_panActive)
+    return;
+  m_panActive = false;
+  m_panEnding = false;
+  m_panIdleTimer.stop();
+  qInfo() << "[PAN] settle";
+  if (SmartRefreshManager *mgr = smartRefreshForPage())
+    mgr->settleJump();
+  else if (m_fbRef)
+    m_fbRef->refreshPartialGC16(0, 0, width(), height());
+  if (m_idleCleanupTimer)
+    m_idleCleanupTimer->start();
+}
+
 int WereadBrowser::pageStep() const {
   if (m_view)
     return static_cast<int>(m_view->height() * 0.3);
@@ -191,43 +288,12 @@ void WereadBrowser::hittestJs(const QPointF &pos) {
   const QPointF pagePos = pos / zoomFactor;
   qInfo() << "[HITTEST] Screen pos:" << pos << "Page pos:" << pagePos
           << "Zoom:" << zoomFactor;
-  const QString script =
-      QStringLiteral("var x=%1,y=%2;"
-                     "function tag(e){if(!e) return 'null';"
-                     " var t=e.tagName; if(e.id) t+='#'+e.id;"
-                     " if(e.className) t+='.'+e.className; return t;}"
-                     "var el=document.elementFromPoint(x,y);"
-                     "var res='';"
-                     "if(!el){res='null';}"
-                     "else if(el.tagName==='IFRAME'){"
-                     "  res='iframe';"
-                     "  var r=el.getBoundingClientRect();"
-                     "  try{"
-                     "    var d=el.contentDocument||el.contentWindow.document;"
-                     "    if(d){"
-                     "      var inner=d.elementFromPoint(x-r.left,y-r.top);"
-                     "      res+='->'+tag(inner);"
-                     "      if(inner && inner.click) inner.click();"
-                     "    }"
-                     "  }catch(e){ res+='->blocked'; }"
-                     "}"
-                     "else {"
-                     "  var cls=(el.className||'')+'';"
-                     "  var txt=(el.innerText||'').trim();"
-                     "  res=tag(el)+\"|\"+txt;"
-                     "  if(!(cls.includes('btn focus-btn') && "
-                     "location.href.includes('/ebook/reader/'))){"
-                     "    if(el.click) el.click();"
-                     "  } else {"
-                     "    res+='|blocked';"
-                     "  }"
-                     "}"
-                     "res;")
-          .arg(pagePos.x())
-          .arg(pagePos.y());
-  m_view->page()->runJavaScript(script, [](const QVariant &v) {
-    qInfo() << "[HITTEST]" << v.toString();
-  });
+  callPageRuntime(QStringLiteral("hittest(%1,%2)")
+                      .arg(pagePos.x())
+                      .arg(pagePos.y()),
+                  [](const QVariant &v) {
+                    qInfo() << "[HITTEST]" << v.toString();
+                  });
 }
 
 void WereadBrowser::injectWheel(const QPointF &pos, int dy) {
@@ -248,171 +314,149 @@ void WereadBrowser::injectWheel(const QPointF &pos, int dy) {
 void WereadBrowser::goNextPage(const QPointF &inputPos) {
   qInfo() << "[PAGER] goNextPage() called"
           << "inputPos" << inputPos;
-  if (!m_view) {
-    qWarning() << "[PAGER] goNextPage() aborted: m_view is null";
+  requestPageTurn(1);
+}
+
+void WereadBrowser::goPrevPage(const QPointF &inputPos) {
+  qInfo() << "[PAGER] goPrevPage() called"
+          << "inputPos" << inputPos;
+  requestPageTurn(-1);
+}
+
+void WereadBrowser::requestPageTurn(int pages) {
+  if (!m_view || !m_view->page()) {
+    qWarning() << "[PAGER] page turn aborted: no page";
     return;
   }
-  if (!m_view->page()) {
-    qWarning() << "[PAGER] goNextPage() aborted: m_view->page() is null";
-    return;
+  InkLatencyTracer::instance().mark(InkLatencyTracer::Dispatch);
+  // 翻页进行中的连击不再丢弃：合并为净页数，当前翻页完成后一次执行
+  if (!m_pageTurn.request(pages)) {
+    qInfo() << "[PAGER] queued" << pages << "in flight seq"
+            << m_pageTurn.inFlightSeq() << "net queued"
+            << m_pageTurn.queuedPages();
   }
-  const qint64 now = QDateTime::currentMSecsSinceEpoch();
-
-  // 如果已经有翻页在进行，检查是否应该取消
-  if (m_navigating) {
-    const qint64 elapsed = now - m_navStartTime;
-    if (elapsed > 500) { // 如果第1次点击超过500ms还没完成
-      qWarning() << "[PAGER] Previous navigation taking too long (" << elapsed
-                 << "ms), cancelling and processing new click. Old seq:"
-                 << m_pendingNavSeq << "New seq:" << (m_navSequence + 1);
-
-      // 取消旧的超时定时器
-      if (m_navTimeoutTimer) {
-        m_navTimeoutTimer->stop();
-        m_navTimeoutTimer->disconnect(); // 断开所有连接，避免回调执行
-        m_navTimeoutTimer->deleteLater();
-        m_navTimeoutTimer = nullptr;
-      }
+}
 
-      // 标记旧序列为已取消（回调中会检查）
-      m_pendingNavSeq = 0; // 设置为0表示已取消
+void WereadBrowser::previewPageJump(int pages) {
+  if (!m_view)
+    return;
+  if (!m_jumpPreview) {
+    // 与菜单一样放在 webview 上层，抓帧时能被 grab() 到
+    m_jumpPreview = new QLabel(m_view);
+    m_jumpPreview->setObjectName("weread_jump_preview");
+    m_jumpPreview->setAlignment(Qt::AlignCenter);
+    m_jumpPreview->setAttribute(Qt::WA_TransparentForMouseEvents, true);
+    m_jumpPreview->setStyleSheet(
+        "QLabel { color: #000000; background: #ffffff; font-size: 40px; "
+        "font-weight: 700; border: 3px solid #000000; border-radius: 12px; }");
+    m_jumpPreview->setFixedSize(360, 120);
+  }
+  if (pages == 0) {
+    cancelPageJump();
+    return;
+  }
+  SmartRefreshManager *mgr = smartRefreshForPage();
+  if (mgr && !mgr->jumpActive())
+    mgr->beginJump();
+  m_jumpPreview->setText(pages > 0 ? QStringLiteral("向后 %1 页").arg(pages)
+                                   : QStringLiteral("向前 %1 页").arg(-pages));
+  m_jumpPreview->move((m_view->width() - m_jumpPreview->width()) / 2,
+                      (m_view->height() - m_jumpPreview->height()) / 2);
+  m_jumpPreview->show();
+  m_jumpPreview->raise();
+  m_jumpPreview->repaint(); // 先把预览画进帧缓冲，再发 A2
+  if (mgr)
+    mgr->previewJump(m_jumpPreview->geometry());
+}
 
-      // 继续处理新的点击（不return）
-    } else {
-      // 如果第1次点击还在500ms内，跳过第2次
-      qInfo() << "[PAGER] skip next: navigating (m_navigating=true, elapsed="
-              << elapsed << "ms)";
-      return;
-    }
+void WereadBrowser::jumpPages(int pages) {
+  if (pages == 0) {
+    cancelPageJump();
+    return;
   }
+  if (!m_view || !m_view->page()) {
+    qWarning() << "[PAGER] jump aborted: no page";
+    return;
+  }
+  if (m_jumpPreview)
+    m_jumpPreview->hide(); // 预览框区域由收尾 GC16 一并刷新
+  qInfo() << "[PAGER] jump" << pages << "pages";
+  InkLatencyTracer::instance().mark(InkLatencyTracer::Dispatch);
+  SmartRefreshManager *mgr = smartRefreshForPage();
+  if (mgr && !mgr->jumpActive())
+    mgr->beginJump();
+  // 先置位：按键注入路径会在 jump() 内同步完成并发出 idle()
+  m_pageJumpSettlePending = (mgr != nullptr);
+  if (!m_pageTurn.jump(pages)) {
+    qInfo() << "[PAGER] jump queued, in flight seq"
+            << m_pageTurn.inFlightSeq() << "net queued"
+            << m_pageTurn.queuedPages();
+  }
+}
 
-  const int currentSeq = ++m_navSequence;
-  m_navigating = true;
-  m_navStartTime = now;         // 记录开始时间
-  m_pendingNavSeq = currentSeq; // 记录待处理的序列号
-  cancelPendingCaptures();      // 取消旧页面的待执行抓帧
-  m_firstFrameDone = false;
-  m_reloadAttempts = 0;
-  const qint64 tsStart = QDateTime::currentMSecsSinceEpoch();
-  qInfo() << "[PAGER] next start ts" << tsStart << "seq" << currentSeq << "url"
-          << m_view->url();
-
-  // 通知智能刷新管理器：点击操作，重置score阈值（仅在书籍页面生效）
+void WereadBrowser::cancelPageJump() {
+  QRect previewRect;
+  if (m_jumpPreview && m_jumpPreview->isVisible()) {
+    previewRect = m_jumpPreview->geometry();
+    m_jumpPreview->hide();
+  }
   if (SmartRefreshManager *mgr = smartRefreshForPage()) {
-    mgr->resetScoreThreshold();
+    if (mgr->jumpActive() && !m_pageJumpSettlePending)
+      mgr->cancelJump(previewRect);
   }
+}
 
-  if (isDedaoBook()) {
-    dedaoScroll(true);
-    return;
-  }
-  if (isWeReadBook()) {
-    const bool isKindleUA =
-        m_currentUA.contains(QStringLiteral("Kindle"), Qt::CaseInsensitive) ||
-        m_uaWeReadBook.contains(QStringLiteral("Kindle"),
-                                Qt::CaseInsensitive) ||
-        m_uaMode.compare(QStringLiteral("kindle"), Qt::CaseInsensitive) == 0;
-    if (m_weReadBookMode == QStringLiteral("mobile") && !isKindleUA) {
-      logPageProbe(QStringLiteral("[PAGER] weRead next probe (mobile)"));
-      weReadScroll(true);
-      return;
-    }
-    qInfo() << "[PAGER] weRead kindle/web mode: using pager buttons";
-  }
-
-  // 使用成员变量的定时器，可以取消
-  if (m_navTimeoutTimer) {
-    m_navTimeoutTimer->stop();
-    m_navTimeoutTimer->disconnect(); // 断开所有连接，避免回调执行
-    m_navTimeoutTimer->deleteLater();
-    m_navTimeoutTimer = nullptr; // 立即设置为nullptr，避免重复使用
-  }
-  m_navTimeoutTimer = new QTimer(this);
-  m_navTimeoutTimer->setSingleShot(true);
-  m_navTimeoutTimer->setInterval(1000);
-  connect(m_navTimeoutTimer, &QTimer::timeout, this, [this, currentSeq]() {
-    if (m_navigating && m_navSequence == currentSeq &&
-        m_pendingNavSeq == currentSeq) {
-      m_navigating = false;
-      m_pendingNavSeq = 0;
-      qWarning() << "[PAGER] Force unlock next (timeout 1000ms) seq"
-                 << currentSeq;
-    }
-  });
-  m_navTimeoutTimer->start();
-  if (isWeReadBook()) {
-    const bool isKindleUA =
-        m_currentUA.contains(QStringLiteral("Kindle"), Qt::CaseInsensitive) ||
-        m_uaWeReadBook.contains(QStringLiteral("Kindle"),
-                                Qt::CaseInsensitive) ||
-        m_uaMode.compare(QStringLiteral("kindle"), Qt::CaseInsensitive) == 0;
-    if (m_weReadBookMode == QStringLiteral("mobile") && !isKindleUA) {
-      runWeReadPagerJsClick(true, currentSeq,
-                            QStringLiteral("mobile-fallback"));
-      return;
-    }
-    injectKey(Qt::Key_Right);
-    markPageTurnTriggered(currentSeq, QStringLiteral("input"));
-    m_pendingInputFallbackSeq = currentSeq;
-    m_inputFallbackStartMs = now;
-    m_inputDomObserved = false;
-    scheduleInputFallback(true, currentSeq);
+bool WereadBrowser::beginSpeculativeTurn() {
+  SmartRefreshManager *mgr = smartRefreshForPage();
+  // 有翻页/跳页/拖动在途时不预翻，避免和它们的刷新收尾交错
+  if (!mgr || !isWeReadBook() || m_pageTurn.busy() || mgr->jumpActive() ||
+      m_panActive || m_speculationRevertPending)
+    return false;
+  mgr->beginSpeculation();
+  m_speculativeTurn = true;
+  qInfo() << "[PAGER] speculative next (refresh held)";
+  requestPageTurn(1);
+  return true;
+}
+
+void WereadBrowser::commitSpeculativeTurn() {
+  if (!m_speculativeTurn)
     return;
-  }
-  runWeReadPagerJsClick(true, currentSeq, QStringLiteral("direct"));
+  m_speculativeTurn = false;
+  qInfo() << "[PAGER] speculative next committed, in flight"
+          << m_pageTurn.busy();
+  if (SmartRefreshManager *mgr = smartRefreshForPage())
+    mgr->commitSpeculation();
 }
 
-void WereadBrowser::goPrevPage(const QPointF &inputPos) {
-  qInfo() << "[PAGER] goPrevPage() called"
-          << "inputPos" << inputPos;
-  if (!m_view) {
-    qWarning() << "[PAGER] goPrevPage() aborted: m_view is null";
+void WereadBrowser::revertSpeculativeTurn() {
+  if (!m_speculativeTurn)
     return;
-  }
-  if (!m_view->page()) {
-    qWarning() << "[PAGER] goPrevPage() aborted: m_view->page() is null";
+  m_speculativeTurn = false;
+  qInfo() << "[PAGER] speculative next reverted";
+  if (!m_view || !m_view->page()) {
+    if (SmartRefreshManager *mgr = smartRefreshForPage())
+      mgr->discardSpeculation();
     return;
   }
-  const qint64 now = QDateTime::currentMSecsSinceEpoch();
-
-  // 如果已经有翻页在进行，检查是否应该取消
-  if (m_navigating) {
-    const qint64 elapsed = now - m_navStartTime;
-    if (elapsed > 500) { // 如果第1次点击超过500ms还没完成
-      qWarning() << "[PAGER] Previous navigation taking too long (" << elapsed
-                 << "ms), cancelling and processing new prev click. Old seq:"
-                 << m_pendingNavSeq << "New seq:" << (m_navSequence + 1);
-
-      // 取消旧的超时定时器
-      if (m_navTimeoutTimer) {
-        m_navTimeoutTimer->stop();
-        m_navTimeoutTimer->disconnect(); // 断开所有连接，避免回调执行
-        m_navTimeoutTimer->deleteLater();
-        m_navTimeoutTimer = nullptr;
-      }
-
-      // 标记旧序列为已取消（回调中会检查）
-      m_pendingNavSeq = 0; // 设置为0表示已取消
+  // 翻回与前一页合并排队；控制器空闲后（见 PageTurnController::idle）丢弃
+  m_speculationRevertPending = true;
+  requestPageTurn(-1);
+}
 
-      // 继续处理新的点击（不return）
-    } else {
-      // 如果第1次点击还在500ms内，跳过第2次
-      qInfo() << "[PAGER] skip prev: navigating (m_navigating=true, elapsed="
-              << elapsed << "ms)";
-      return;
-    }
+void WereadBrowser::executePageTurn(int seq, int pages) {
+  if (!m_view || !m_view->page()) {
+    m_pageTurn.complete(seq, pages);
+    return;
   }
-
-  const int currentSeq = ++m_navSequence;
-  m_navigating = true;
-  m_navStartTime = now;         // 记录开始时间
-  m_pendingNavSeq = currentSeq; // 记录待处理的序列号
-  cancelPendingCaptures();      // 取消旧页面的待执行抓帧
+  InkLatencyTracer::instance().mark(InkLatencyTracer::JsSent);
+  const bool forward = pages > 0;
+  cancelPendingCaptures(); // 取消旧页面的待执行抓帧
   m_firstFrameDone = false;
   m_reloadAttempts = 0;
   const qint64 tsStart = QDateTime::currentMSecsSinceEpoch();
-  qInfo() << "[PAGER] prev start ts" << tsStart << "seq" << currentSeq << "url"
-          << m_view->url();
+  qInfo() << "[PAGER]" << (forward ? "next" : "prev") << "start ts" << tsStart
+          << "seq" << seq << "pages" << pages << "url" << m_view->url();
 
   // 通知智能刷新管理器：点击操作，重置score阈值（仅在书籍页面生效）
   if (SmartRefreshManager *mgr = smartRefreshForPage()) {
@@ -420,63 +464,58 @@ void WereadBrowser::goPrevPage(const QPointF &inputPos) {
   }
 
   if (isDedaoBook()) {
-    dedaoScroll(false);
+    m_pagePaths.begin(QStringLiteral("dedao"),
+                      PagePathSelector::PathDedaoKeys, seq);
+    markPageTurnSeq(seq);
+    dedaoScroll(seq, pages);
     return;
   }
   if (isWeReadBook()) {
-    const bool isKindleUA =
-        m_currentUA.contains(QStringLiteral("Kindle"), Qt::CaseInsensitive) ||
-        m_uaWeReadBook.contains(QStringLiteral("Kindle"),
-                                Qt::CaseInsensitive) ||
-        m_uaMode.compare(QStringLiteral("kindle"), Qt::CaseInsensitive) == 0;
-    if (m_weReadBookMode == QStringLiteral("mobile") && !isKindleUA) {
-      logPageProbe(QStringLiteral("[PAGER] weRead prev probe (mobile)"));
-      weReadScroll(false);
+    const bool isKindleUA = m_weReadTurnKindleUA;
+    const bool mobile =
+        m_weReadBookMode == QStringLiteral("mobile") && !isKindleUA;
+    // UA/模式只决定默认路径与候选集，实际路径由各路径的实测延迟/成功率选出
+    const QString context =
+        QStringLiteral("weread:%1")
+            .arg(mobile ? QStringLiteral("mobile")
+                 : isKindleUA ? QStringLiteral("kindle")
+                              : m_weReadBookMode);
+    const QList<PagePathSelector::Path> viable =
+        mobile ? QList<PagePathSelector::Path>{PagePathSelector::PathScroll,
+                                               PagePathSelector::PathPagerClick}
+               : QList<PagePathSelector::Path>{PagePathSelector::PathKeys,
+                                               PagePathSelector::PathPagerClick};
+    const PagePathSelector::Path path = m_pagePaths.choose(
+        context, viable,
+        mobile ? PagePathSelector::PathScroll : PagePathSelector::PathKeys);
+    m_pagePaths.begin(context, path, seq);
+    markPageTurnSeq(seq);
+    if (path == PagePathSelector::PathScroll) {
+      logPageProbe(forward
+                       ? QStringLiteral("[PAGER] weRead next probe (mobile)")
+                       : QStringLiteral("[PAGER] weRead prev probe (mobile)"));
+      weReadScroll(seq, pages);
       return;
     }
-    qInfo() << "[PAGER] weRead kindle/web mode: using pager buttons";
-  }
-
-  // 使用成员变量的定时器，可以取消
-  if (m_navTimeoutTimer) {
-    m_navTimeoutTimer->stop();
-    m_navTimeoutTimer->disconnect(); // 断开所有连接，避免回调执行
-    m_navTimeoutTimer->deleteLater();
-    m_navTimeoutTimer = nullptr; // 立即设置为nullptr，避免重复使用
-  }
-  m_navTimeoutTimer = new QTimer(this);
-  m_navTimeoutTimer->setSingleShot(true);
-  m_navTimeoutTimer->setInterval(1000);
-  connect(m_navTimeoutTimer, &QTimer::timeout, this, [this, currentSeq]() {
-    if (m_navigating && m_navSequence == currentSeq &&
-        m_pendingNavSeq == currentSeq) {
-      m_navigating = false;
-      m_pendingNavSeq = 0;
-      qWarning() << "[PAGER] Force unlock prev (timeout 1000ms) seq"
-                 << currentSeq;
-    }
-  });
-  m_navTimeoutTimer->start();
-  if (isWeReadBook()) {
-    const bool isKindleUA =
-        m_currentUA.contains(QStringLiteral("Kindle"), Qt::CaseInsensitive) ||
-        m_uaWeReadBook.contains(QStringLiteral("Kindle"),
-                                Qt::CaseInsensitive) ||
-        m_uaMode.compare(QStringLiteral("kindle"), Qt::CaseInsensitive) == 0;
-    if (m_weReadBookMode == QStringLiteral("mobile") && !isKindleUA) {
-      runWeReadPagerJsClick(false, currentSeq,
-                            QStringLiteral("mobile-fallback"));
+    if (path == PagePathSelector::PathPagerClick) {
+      // 页面按钮一次只翻一页，其余页数由控制器排到下一轮
+      runWeReadPagerJsClick(forward, seq, QStringLiteral("pathsel"));
       return;
     }
-    injectKey(Qt::Key_Left);
-    markPageTurnTriggered(currentSeq, QStringLiteral("input"));
-    m_pendingInputFallbackSeq = currentSeq;
-    m_inputFallbackStartMs = now;
+    qInfo() << "[PAGER] weRead" << context << "using key input";
+    // 连发的方向键会被阅读器吞掉：每轮只注入一次，等到本轮的 DOM 事件
+    // （或兜底超时）再完成，其余页数由控制器排到下一轮
+    injectKey(forward ? Qt::Key_Right : Qt::Key_Left);
+    InkLatencyTracer::instance().mark(InkLatencyTracer::JsDone);
+    markPageTurnTriggered(seq, QStringLiteral("input"));
+    m_pendingInputFallbackSeq = seq;
+    m_inputFallbackStartMs = tsStart;
     m_inputDomObserved = false;
-    scheduleInputFallback(false, currentSeq);
+    scheduleInputFallback(forward, seq);
     return;
   }
-  runWeReadPagerJsClick(false, currentSeq, QStringLiteral("direct"));
+  // 页面按钮一次只翻一页，其余页数由控制器排到下一轮
+  runWeReadPagerJsClick(forward, seq, QStringLiteral("direct"));
 }
 
 void WereadBrowser::openCatalog() {
@@ -518,130 +557,14 @@ void WereadBrowser::openWeReadFontPanelAndSelect() {
   cancelPendingCaptures(); // 取消旧的待执行抓帧
   m_firstFrameDone = false;
   m_reloadAttempts = 0;
-  const QString openPanelJs = QStringLiteral(R"WR(
-(() => {
-  const selectors = [
-    'button.readerControls_item.fontSizeButton',
-    '.readerControls_item.fontSizeButton',
-    '.readerControls .fontSizeButton',
-    'button[title*="字体"]',
-    'button[aria-label*="字体"]'
-  ];
-  let btn = null;
-  for (const sel of selectors) {
-    const el = document.querySelector(sel);
-    if (el) { btn = el; break; }
-  }
-  if (!btn) return {ok:false, reason:'no-font-button', selectors};
-  const style = window.getComputedStyle ? getComputedStyle(btn) : null;
-  const visible = style ? (style.display !== 'none' && style.visibility !== 'hidden' && style.opacity !== '0') : true;
-  if (btn.click) btn.click();
-  return {ok:true, visible, cls: btn.className || '', tag: btn.tagName || ''};
-})()
-)WR");
-  m_view->page()->runJavaScript(openPanelJs, [this](const QVariant &res) {
+  callPageRuntime(QStringLiteral("fontPanelOpen()"), [](const QVariant &res) {
     qInfo() << "[MENU] font panel open" << res;
   });
+  // 面板渲染需要时间；fontSelect 在页面内自行重试
   QTimer::singleShot(250, this, [this]() {
-    const QString selectFontJs = QStringLiteral(R"WR(
-(() => {
-  const targetKey = 'TsangerYunHei-W05';
-  const targetName = '仓耳云黑';
-  const maxTries = 8;
-  const delayMs = 150;
-  const normalize = (s) => (s || '').replace(/\s+/g, '').replace(/["']/g, '').toLowerCase();
-  const firstFamily = (fam) => {
-    if (!fam) return '';
-    const parts = String(fam).split(',');
-    if (!parts.length) return '';
-    return parts[0].trim().replace(/^["']|["']$/g, '');
-  };
-  const collectMeta = (el) => {
-    const styleAttr = el.getAttribute('style') || '';
-    const famInline = (el.style && el.style.fontFamily) || '';
-    const famComp = (window.getComputedStyle ? getComputedStyle(el).fontFamily : '') || '';
-    const text = (el.innerText || el.textContent || '');
-    const dataFont = el.getAttribute('data-font') || el.getAttribute('data-id') || el.getAttribute('data-key') || el.getAttribute('data-name') || '';
-    const dataset = el.dataset ? Object.values(el.dataset).join(' ') : '';
-    const key = (dataFont || dataset || '').trim();
-    const family = firstFamily(famInline || famComp || styleAttr);
-    return {styleAttr, famInline, famComp, text, dataFont, dataset, key, family};
-  };
-  const isTarget = (el) => {
-    const meta = collectMeta(el);
-    const hay = normalize(meta.styleAttr + ' ' + meta.famInline + ' ' + meta.famComp + ' ' + meta.text + ' ' + meta.dataFont + ' ' + meta.dataset);
-    const hasName = hay.includes(normalize(targetName)) || hay.includes('tsangeryunhei') || hay.includes(normalize(targetKey));
-    const hasW05 = hay.includes('05') || hay.includes('w05');
-    return hasName && hasW05;
-  };
-  const fire = (el) => {
-    if (!el) return;
-    const rect = el.getBoundingClientRect ? el.getBoundingClientRect() : {left:0, top:0, width:0, height:0};
-    const opts = {bubbles:true, cancelable:true, clientX: rect.left + rect.width / 2, clientY: rect.top + rect.height / 2};
-    try { el.dispatchEvent(new PointerEvent('pointerdown', opts)); } catch(e) {}
-    try { el.dispatchEvent(new PointerEvent('pointerup', opts)); } catch(e) {}
-    try { el.dispatchEvent(new MouseEvent('click', opts)); } catch(e) {}
-    try { if (el.click) el.click(); } catch(e) {}
-  };
-  const applySetting = (meta) => {
-    const key = 'wrLocalSetting';
-    let setting = {};
-    try { setting = JSON.parse(localStorage.getItem(key) || '{}'); } catch(e) { setting = {}; }
-    const before = setting.fontFamily || '';
-    const preferred = meta.key || targetKey;
-    if (preferred && setting.fontFamily !== preferred) {
-      setting.fontFamily = preferred;
-      if (!setting.fontSizeLevel) setting.fontSizeLevel = 4;
-      try { localStorage.setItem(key, JSON.stringify(setting)); } catch(e) {}
-    }
-    return {before, after: setting.fontFamily || '', applied: setting.fontFamily !== before};
-  };
-  const trySelect = (tryIdx) => {
-    const items = Array.from(document.querySelectorAll('.font-panel-content-fonts-item'));
-    if (!items.length) {
-      if (tryIdx < maxTries) return setTimeout(() => trySelect(tryIdx + 1), delayMs);
-      console.log('[FONT_SELECT] no-font-items');
-      return;
-    }
-    const target = items.find(isTarget);
-    if (!target) {
-      if (tryIdx < maxTries) return setTimeout(() => trySelect(tryIdx + 1), delayMs);
-      const sample = items.slice(0,3).map(el => (el.getAttribute('style') || '')).join(' | ');
-      console.log('[FONT_SELECT] target-not-found', items.length, sample);
-      return;
-    }
-    if (target.scrollIntoView) target.scrollIntoView({block:'center', inline:'nearest'});
-    fire(target);
-    fire(target.querySelector('div, svg, span'));
-    const meta = collectMeta(target);
-    setTimeout(() => {
-      const setting = applySetting(meta);
-      const cls = target.className || '';
-      const selected = cls.includes('selected') || cls.includes('active');
-      console.log('[FONT_SELECT]' + JSON.stringify({
-        try: tryIdx,
-        selected,
-        cls,
-        key: meta.key,
-        family: meta.family,
-        before: setting.before,
-        after: setting.after,
-        applied: setting.applied
-      }));
-      if (setting.applied) {
-        setTimeout(() => location.reload(), 150);
-      } else if (!selected && tryIdx < maxTries) {
-        setTimeout(() => trySelect(tryIdx + 1), delayMs);
-      }
-    }, 120);
-  };
-  trySelect(0);
-  return {ok:true, scheduled:true, targetKey};
-})()
-)WR");
-    m_view->page()->runJavaScript(selectFontJs, [this](const QVariant &res) {
-      qInfo() << "[MENU] font select" << res;
-    });
+    callPageRuntime(
+        QStringLiteral("fontSelect('TsangerYunHei-W05','仓耳云黑')"),
+        [](const QVariant &res) { qInfo() << "[MENU] font select" << res; });
   });
 }
 
@@ -671,81 +594,28 @@ void WereadBrowser::adjustFont(bool increase) {
   m_firstFrameDone = false;
   m_reloadAttempts = 0;
   if (isDedaoBook()) {
-    const QString openSettingJs = QStringLiteral(
-        "(() => {"
-        "  const settingBtn = "
-        "document.querySelector('.reader-tool-button.tool-margin-right');"
-        "  if (settingBtn && typeof settingBtn.click === 'function') {"
-        "    settingBtn.click();"
-        "    return {ok:true, action:'open-setting'};"
-        "  }"
-        "  return {ok:false, reason:'no-setting-btn'};"
-        "})();");
-    m_view->page()->runJavaScript(openSettingJs, [this, increase](
-                                                     const QVariant &res) {
-      qInfo() << "[MENU] open setting panel" << res;
-      QTimer::singleShot(300, this, [this, increase]() {
-        const QString adjustFontJs =
-            QStringLiteral(
-                "(() => {"
-                "  const inc=%1;"
-                "  const buttons = "
-                "Array.from(document.querySelectorAll('.set-tool-box-change-"
-                "font button'));"
-                "  if (buttons.length === 0) return {ok:false, "
-                "reason:'no-font-buttons'};"
-                "  const btn = inc>0 ? buttons[buttons.length-1] : "
-                "buttons[0];"
-                "  if (btn && btn.click) {"
-                "    btn.click();"
-                "    const fontNum = "
-                "document.querySelector('.set-tool-box-font-number');"
-                "    const num = fontNum ? fontNum.textContent.trim() : '';"
-                "    return {ok:true, mode:'dedao', inc, font:num};"
-                "  }"
-                "  return {ok:false, reason:'btn-no-click', mode:'dedao'};"
-                "})();")
-                .arg(increase ? 1 : -1);
-        m_view->page()->runJavaScript(
-            adjustFontJs, [this](const QVariant &res) {
-              qInfo() << "[MENU] font step (dedao)" << res;
-            });
-      });
-    });
+    callPageRuntime(
+        QStringLiteral("dedaoOpenSetting()"),
+        [this, increase](const QVariant &res) {
+          qInfo() << "[MENU] open setting panel" << res;
+          QTimer::singleShot(300, this, [this, increase]() {
+            callPageRuntime(
+                QStringLiteral("dedaoFontStep(%1)").arg(increase ? 1 : -1),
+                [](const QVariant &res) {
+                  qInfo() << "[MENU] font step (dedao)" << res;
+                });
+          });
+        });
     m_isAdjustingFont = false;
     return;
   }
   // Simple reload approach with scroll position preservation
-  const QString js =
-      QStringLiteral(
-          "(() => {"
-          "  const delta=%1;"
-          "  let setting={};"
-          "  try{ "
-          "setting=JSON.parse(localStorage.getItem('wrLocalSetting')||'{}'); "
-          "}catch(e){ setting={}; }"
-          "  const raw = setting.fontSizeLevel;"
-          "  let before = parseInt(raw, 10);"
-          "  if (Number.isNaN(before)) before = 4;"
-          "  const after=Math.max(1, Math.min(7, before+delta));"
-          "  setting.fontSizeLevel=after;"
-          "  if(!setting.fontFamily) setting.fontFamily='TsangerYunHei-W05';"
-          "  try{ localStorage.setItem('wrFontLevelUserSet','1'); }catch(e){}"
-          "  try{ localStorage.setItem('wrLocalSetting', "
-          "JSON.stringify(setting)); }catch(e){}"
-          "  "
-          "  try{ sessionStorage.setItem('wr_scrollY', window.scrollY || 0); "
-          "}catch(e){}"
-          "  "
-          "  setTimeout(()=>location.reload(),50);"
-          "  return {ok:true,before,after,raw,method:'reload'};"
-          "})();")
-          .arg(increase ? 1 : -1);
-
-  m_view->page()->runJavaScript(js, [this](const QVariant &res) {
-    qInfo() << "[MENU] font adjust" << res;
-    m_isAdjustingFont = false;
-  });
+  callPageRuntime(
+      QStringLiteral("weReadFontStep(%1)").arg(increase ? 1 : -1),
+      [this](const QVariant &res) {
+        qInfo() << "[MENU] font adjust" << res;
+        m_isAdjustingFont = false;
+      });
 }
 
 void WereadBrowser::toggleTheme() {
@@ -756,77 +626,22 @@ void WereadBrowser::toggleTheme() {
   m_firstFrameDone = false;
   m_reloadAttempts = 0;
   if (isDedaoBook()) {
-    const QString openSettingJs = QStringLiteral(
-        "(() => {"
-        "  const settingBtn = "
-        "document.querySelector('.reader-tool-button.tool-margin-right');"
-        "  if (settingBtn && typeof settingBtn.click === 'function') {"
-        "    settingBtn.click();"
-        "    return {ok:true, action:'open-setting'};"
-        "  }"
-        "  return {ok:false, reason:'no-setting-btn'};"
-        "})();");
-    m_view->page()->runJavaScript(openSettingJs, [this](const QVariant &res) {
+    auto onOpened = [this](const QVariant &res) {
       qInfo() << "[MENU] open setting panel for theme" << res;
       QTimer::singleShot(300, this, [this]() {
-        const QString toggleThemeJs = QStringLiteral(
-            "(() => {"
-            "  const list = "
-            "Array.from(document.querySelectorAll('.tool-box-theme-group "
-            ".reader-tool-theme-button'));"
-            "  if (list.length === 0) return {ok:false, "
-            "reason:'no-theme-buttons'};"
-            "  const curIdx = list.findIndex(el => "
-            "el.classList.contains('reader-tool-theme-button-selected'));"
-            "  const nextIdx = list.length ? ((curIdx>=0 ? "
-            "(curIdx+1)%list.length : 0)) : -1;"
-            "  if (nextIdx>=0 && list[nextIdx] && list[nextIdx].click) {"
-            "    list[nextIdx].click();"
-            "    const sel = "
-            "list[nextIdx].querySelector('.reader-tool-theme-button-text');"
-            "    const text = sel ? sel.textContent.trim() : '';"
-            "    return {ok:true, cur:curIdx, next:nextIdx, "
-            "count:list.length, mode:'dedao', text};"
-            "  }"
-            "  return {ok:false, reason:'no-theme-btn', count:list.length, "
-            "mode:'dedao'};"
-            "})();");
-        m_view->page()->runJavaScript(
-            toggleThemeJs, [this](const QVariant &res) {
-              qInfo() << "[MENU] theme toggle (dedao)" << res;
-            });
+        callPageRuntime(QStringLiteral("dedaoToggleTheme()"),
+                        [](const QVariant &res) {
+                          qInfo() << "[MENU] theme toggle (dedao)" << res;
+                        });
       });
-    });
+    };
+    callPageRuntime(QStringLiteral("dedaoOpenSetting()"), onOpened);
     return;
   }
-  const QString js = QStringLiteral(
-      "(() => {"
-      "  function getCookie(name){"
-      "    return "
-      "document.cookie.split(';').map(s=>s.trim()).filter(s=>s.startsWith("
-      "name+'='))"
-      "      .map(s=>s.substring(name.length+1))[0] || '';"
-      "  }"
-      "  const cookieTheme = getCookie('wr_theme');"
-      "  const lsTheme = (localStorage && localStorage.getItem('wr_theme')) "
-      "|| '';"
-      "  const current = (cookieTheme||lsTheme||'dark').toLowerCase();"
-      "  const next = current==='white' ? 'dark' : 'white';"
-      "  try { document.cookie = 'wr_theme='+next+'; domain=.weread.qq.com; "
-      "path=/; max-age=31536000'; } catch(e) {}"
-      "  try { localStorage && localStorage.setItem('wr_theme', next); } "
-      "catch(e) {}"
-      "  const delay=300;"
-      "  console.log('[THEME] reload scheduled in',delay,'ms');"
-      "  setTimeout(()=>{ console.log('[THEME] reloading now'); "
-      "location.reload(); },delay);"
-      "  return {ok:true, before:current, after:next, "
-      "cookieAfter:getCookie('wr_theme'), "
-      "lsAfter:(localStorage&&localStorage.getItem('wr_theme'))||''};"
-      "})();");
-  m_view->page()->runJavaScript(js, [this](const QVariant &res) {
-    qInfo() << "[MENU] theme toggle" << res;
-  });
+  callPageRuntime(QStringLiteral("weReadToggleTheme()"),
+                  [](const QVariant &res) {
+                    qInfo() << "[MENU] theme toggle" << res;
+                  });
 }
 
 void WereadBrowser::toggleFontFamily() {
@@ -834,40 +649,10 @@ void WereadBrowser::toggleFontFamily() {
     return;
   m_firstFrameDone = false;
   m_reloadAttempts = 0;
-  const QString js = QStringLiteral(
-      "(() => {"
-      "  const key='wrLocalSetting';"
-      "  let setting={};"
-      "  try{ setting=JSON.parse(localStorage.getItem(key)||'{}'); "
-      "}catch(e){ setting={}; }"
-      "  const cur=(setting.fontFamily||'TsangerYunHei-W05').toLowerCase();"
-      "  const custom='custom_noto_sans';"
-      "  const next = (cur===custom) ? 'TsangerYunHei-W05' : custom;"
-      "  setting.fontFamily = next;"
-      "  if(!setting.fontSizeLevel) setting.fontSizeLevel = 4;"
-      "  try{ localStorage.setItem(key, JSON.stringify(setting)); }catch(e){}"
-      "  const cssId='wr-font-override';"
-      "  const exist=document.getElementById(cssId);"
-      "  if (exist) exist.remove();"
-      "  if (next===custom){"
-      "    const style=document.createElement('style');"
-      "    style.id=cssId;"
-      "    style.textContent = "
-      "\"@font-face{font-family:'CustomNotoSans';src:url('file:///home/root/"
-      ".fonts/NotoSansCJKsc-Regular.otf') format('opentype');}\"+"
-      "      \".renderTargetContent, .renderTargetContent * { "
-      "font-family:'CustomNotoSans', 'Noto Sans CJK SC', 'Noto Sans SC', "
-      "sans-serif !important; }\";"
-      "    try{ "
-      "(document.documentElement||document.body).appendChild(style); "
-      "}catch(e){}"
-      "  }"
-      "  setTimeout(()=>location.reload(), 200);"
-      "  return {ok:true,next};"
-      "})();");
-  m_view->page()->runJavaScript(js, [this](const QVariant &res) {
-    qInfo() << "[MENU] font toggle" << res;
-  });
+  callPageRuntime(QStringLiteral("toggleFontFamily()"),
+                  [](const QVariant &res) {
+                    qInfo() << "[MENU] font toggle" << res;
+                  });
 }
 
 void WereadBrowser::toggleService() {
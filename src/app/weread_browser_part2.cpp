@@ -3,241 +3,6 @@
 #include <QUrlQuery>
 
 namespace {
-const char kDedaoCatalogOpenScript[] = R"WR(
-(() => {
-  const hideClass = '__dedao_catalog_hide';
-  if (document.body && document.body.classList.contains(hideClass)) {
-    document.body.classList.remove(hideClass);
-  }
-  const list = document.querySelector('.iget-reader-catalog-content');
-  const items = list ? list.querySelectorAll('li') : null;
-  const listCount = items ? items.length : 0;
-  const wrapper = document.querySelector('.iget-reader-catalog-wrapper');
-  const panelVisible = (() => {
-    if (!wrapper || !window.getComputedStyle) return false;
-    const style = getComputedStyle(wrapper);
-    return style.display !== 'none' && style.visibility !== 'hidden' && style.opacity !== '0';
-  })();
-  if (listCount > 0) {
-    return {ok:true, action:'already-open', listCount, panelVisible};
-  }
-  const textMatch = (el, key) => {
-    const text = (el && el.innerText) ? el.innerText.trim() : '';
-    return text.indexOf(key) !== -1;
-  };
-  let btn = null;
-  const icon = document.querySelector('.iget-icon-list');
-  if (icon && icon.closest) {
-    btn = icon.closest('button');
-  }
-  if (!btn) {
-    const buttons = Array.from(document.querySelectorAll('button, [role=button]'));
-    btn = buttons.find(b => textMatch(b, '目录')) || null;
-  }
-  let tab = null;
-  const tabs = Array.from(document.querySelectorAll('.slide-tags-item'));
-  tab = tabs.find(t => textMatch(t, '目录')) || null;
-  if (tab && tab.click) tab.click();
-  if (btn && btn.click) {
-    btn.click();
-    return {ok:true, action:'clicked', listCount, panelVisible, hasTab: !!tab};
-  }
-  if (tab) {
-    return {ok:true, action:'tab-clicked', listCount, panelVisible, hasTab: true};
-  }
-  return {ok:false, reason:'no-btn', listCount, panelVisible};
-})()
-)WR";
-
-const char kDedaoCatalogHideScript[] = R"WR(
-(() => {
-  const hideClass = '__dedao_catalog_hide';
-  const styleId = '__dedao_catalog_hide_style';
-  if (!document.getElementById(styleId)) {
-    const style = document.createElement('style');
-    style.id = styleId;
-    style.textContent =
-      'body.' + hideClass + ' .iget-reader-catalog-wrapper{display:none !important;visibility:hidden !important;opacity:0 !important;pointer-events:none !important;}' +
-      'body.' + hideClass + ' .slide-wrapper-tags{display:none !important;visibility:hidden !important;opacity:0 !important;pointer-events:none !important;}';
-    (document.head || document.documentElement).appendChild(style);
-  }
-  if (document.body) {
-    document.body.classList.add(hideClass);
-    return {ok:true};
-  }
-  return {ok:false, reason:'no-body'};
-})()
-)WR";
-
-const char kDedaoCatalogCurrentScript[] = R"WR(
-(() => {
-  const normalize = (s) => String(s || '').replace(/\s+/g, ' ').trim();
-  const selected =
-    document.querySelector('.iget-reader-catalog-item-selected .iget-reader-catalog-item-text') ||
-    document.querySelector('.iget-reader-catalog-item-selected');
-  if (!selected) return {ok:false, reason:'no-selected'};
-  const title = normalize(selected.innerText || '');
-  if (!title) return {ok:false, reason:'empty-title'};
-  return {ok:true, title};
-})()
-)WR";
-
-const char kDedaoCatalogScrollStepScript[] = R"WR(
-(() => {
-  const stepPx = %1;
-  const reset = %2;
-  const normalize = (s) => String(s || '').replace(/\s+/g, ' ').trim();
-  const tabs = Array.from(document.querySelectorAll('.slide-tags-item'));
-  const tab = tabs.find(t => normalize(t.innerText) === '\u76ee\u5f55');
-  if (tab && tab.classList && !tab.classList.contains('slide-tags-item-active') && tab.click) {
-    tab.click();
-  }
-  const list = document.querySelector('.iget-reader-catalog-content');
-  if (!list) return {ok:false, reason:'no-list'};
-  const findScroller = (el) => {
-    let cur = el;
-    for (let i = 0; i < 6 && cur; i++) {
-      if (cur.scrollHeight > cur.clientHeight + 10) return cur;
-      cur = cur.parentElement;
-    }
-    return document.scrollingElement || document.documentElement || null;
-  };
-  const scroller = findScroller(list);
-  if (!scroller) return {ok:false, reason:'no-scroller'};
-  if (reset) {
-    scroller.scrollTop = 0;
-  } else if (stepPx > 0) {
-    const maxTop = Math.max(0, scroller.scrollHeight - scroller.clientHeight);
-    scroller.scrollTop = Math.min(scroller.scrollTop + stepPx, maxTop);
-  }
-  const items = Array.from(list.querySelectorAll('li'));
-  let expanded = 0;
-  items.forEach((item) => {
-    const icon = item.querySelector('.iget-icon-play');
-    if (!icon) return;
-    if (icon.classList.contains('catalog-item-icon-actived')) return;
-    try { if (icon.click) icon.click(); expanded++; } catch (e) {}
-  });
-  return {
-    ok:true,
-    scrollTop: scroller.scrollTop || 0,
-    scrollHeight: scroller.scrollHeight || 0,
-    clientHeight: scroller.clientHeight || 0,
-    expanded,
-    stepPx
-  };
-})()
-)WR";
-
-const char kDedaoCatalogScrapeScript[] = R"WR(
-(() => {
-  const list = document.querySelector('.iget-reader-catalog-content');
-  const items = Array.from(list ? list.querySelectorAll('li') : []);
-  if (!items.length) return {ok:false, reason:'no-items'};
-  const normalize = (s) => String(s || '').replace(/\s+/g, ' ').trim();
-  let minPad = null;
-  const padList = items.map((item) => {
-    let pad = NaN;
-    if (item.style && item.style.paddingLeft) {
-      pad = parseInt(item.style.paddingLeft, 10);
-    }
-    if (!Number.isFinite(pad) && window.getComputedStyle) {
-      pad = parseInt(getComputedStyle(item).paddingLeft, 10);
-    }
-    if (!Number.isFinite(pad)) pad = 0;
-    if (minPad === null || pad < minPad) minPad = pad;
-    return pad;
-  });
-  if (!Number.isFinite(minPad)) minPad = 0;
-  const step = 20;
-  const toLevel = (pad) => {
-    const delta = pad - minPad;
-    const level = Math.round(delta / step) + 1;
-    return level > 0 ? level : 1;
-  };
-  const chapters = items.map((item, idx) => {
-    const titleEl = item.querySelector('.iget-reader-catalog-item-text');
-    let title = titleEl ? titleEl.innerText : '';
-    if (!title) title = item.innerText || '';
-    title = normalize(title);
-    const isCurrent = item.classList.contains('iget-reader-catalog-item-selected');
-    const pad = padList[idx] || 0;
-    return {
-      index: idx,
-      title,
-      level: toLevel(pad),
-      isCurrent,
-      matchKey: title,
-      chapterUid: title
-    };
-  }).filter(ch => ch && ch.title);
-  return {ok:true, chapters, count: chapters.length, source:'dedao-dom'};
-})()
-)WR";
-
-const char kDedaoCatalogClickScript[] = R"WR(
-(() => {
-  const matchTitleRaw = (%1[0] || '');
-  const targetIdx = %2;
-  const normalize = (s) => String(s || '').replace(/\s+/g, ' ').trim();
-  const list = document.querySelector('.iget-reader-catalog-content');
-  const items = Array.from(list ? list.querySelectorAll('li') : []);
-  if (!items.length) return {ok:false, reason:'no-items'};
-  const getTitle = (item) => {
-    const titleEl = item.querySelector('.iget-reader-catalog-item-text');
-    let title = titleEl ? titleEl.innerText : '';
-    if (!title) title = item.innerText || '';
-    return normalize(title);
-  };
-  const matchTitle = normalize(matchTitleRaw);
-  let target = null;
-  let method = '';
-  let matchCount = 0;
-  if (matchTitle) {
-    items.forEach((item, idx) => {
-      const t = getTitle(item);
-      if (t && t === matchTitle) {
-        matchCount++;
-        if (!target || idx === targetIdx) {
-          target = item;
-          method = idx === targetIdx ? 'title+index' : 'title';
-        }
-      }
-    });
-  }
-  if (!target && targetIdx >= 0 && targetIdx < items.length) {
-    target = items[targetIdx];
-    method = 'index';
-  }
-  if (!target) {
-    return {ok:false, reason:'no-target', matchTitleRaw, targetIdx, matchCount, count: items.length};
-  }
-  const tab = Array.from(document.querySelectorAll('.slide-tags-item'))
-    .find(el => normalize(el.innerText) === '目录');
-  if (tab && tab.classList && !tab.classList.contains('slide-tags-item-active') && tab.click) {
-    tab.click();
-  }
-  try { if (target.scrollIntoView) target.scrollIntoView({block:'center'}); } catch (e) {}
-  const clickable = target.querySelector('.iget-reader-catalog-item-text') || target;
-  if (!clickable || !clickable.getBoundingClientRect) {
-    return {ok:false, reason:'no-rect', matchTitleRaw, targetIdx, matchCount};
-  }
-  const r = clickable.getBoundingClientRect();
-  const rect = {x: r.left + r.width / 2, y: r.top + r.height / 2, w: r.width, h: r.height};
-  if (!(rect.w > 1 && rect.h > 1)) {
-    return {ok:false, reason:'rect-empty', rect, matchTitleRaw, targetIdx, matchCount};
-  }
-  const fire = (el) => {
-    try { el.dispatchEvent(new PointerEvent('pointerdown', {bubbles:true,cancelable:true})); } catch (e) {}
-    try { el.dispatchEvent(new PointerEvent('pointerup', {bubbles:true,cancelable:true})); } catch (e) {}
-    try { el.dispatchEvent(new MouseEvent('click', {bubbles:true,cancelable:true})); } catch (e) {}
-    try { if (el.click) el.click(); } catch (e) {}
-  };
-  fire(clickable);
-  return {ok:true, method, rect, matchCount, targetIdx};
-})()
-)WR";
-
 QString dedaoCatalogKeyForUrl(const QUrl &url) {
   if (!url.host().contains(QStringLiteral("dedao.cn"),
                            Qt::CaseInsensitive)) {
@@ -253,44 +18,34 @@ QString dedaoCatalogKeyForUrl(const QUrl &url) {
 }
 } // namespace
 
-void WereadBrowser::dedaoScroll(bool forward) {
+void WereadBrowser::dedaoScroll(int seq, int pages) {
   if (!m_view || !m_view->page()) {
-    m_navigating = false;
+    m_pageTurn.complete(seq, pages);
     return;
   }
+  const bool forward = pages > 0;
 
-  const int currentSeq = ++m_navSequence;
-  m_navigating = true;
-
-  // 看门狗保持 1200ms
-  QTimer::singleShot(1200, this, [this, currentSeq]() {
-    if (m_navigating && m_navSequence == currentSeq) {
-      m_navigating = false;
-      qWarning() << "[PAGER] Force unlock (timeout 1200ms) seq" << currentSeq;
-    }
-  });
-
-  auto dispatchKey = [this, currentSeq, forward]() {
+  auto dispatchKey = [this, seq, pages, forward]() {
     if (!m_view || !m_view->page()) {
-      m_navigating = false;
+      m_pageTurn.complete(seq, pages);
       return;
     }
     const qint64 ts = QDateTime::currentMSecsSinceEpoch();
     const int key = forward ? Qt::Key_PageDown : Qt::Key_PageUp;
     const QString keyName =
         forward ? QStringLiteral("PageDown") : QStringLiteral("PageUp");
-    qInfo() << "[PAGER] dedao key dispatch seq" << currentSeq << "forward"
-            << forward << "key" << keyName << "ts" << ts;
+    qInfo() << "[PAGER] dedao key dispatch seq" << seq << "pages" << pages
+            << "key" << keyName << "ts" << ts;
+    // 每轮只发一键：连发的按键阅读器会丢。其余页数由控制器排成下一轮
     injectKeyWithModifiers(key, Qt::NoModifier);
+    InkLatencyTracer::instance().mark(InkLatencyTracer::JsDone);
 
-    if (m_navSequence == currentSeq) {
-      m_navigating = false;
-      if (m_smartRefreshDedao) {
-        qInfo() << "[SMART_REFRESH] dedao page turn trigger seq" << currentSeq
-                << "source key";
-        m_smartRefreshDedao->triggerPageTurn();
-      }
+    if (m_smartRefreshDedao) {
+      qInfo() << "[SMART_REFRESH] dedao page turn trigger seq" << seq
+              << "source key";
+      m_smartRefreshDedao->triggerPageTurn();
     }
+    m_pageTurn.complete(seq, forward ? 1 : -1);
   };
 
   const QString clickSeqJs = QStringLiteral(R"(
@@ -304,10 +59,12 @@ void WereadBrowser::dedaoScroll(bool forward) {
   return null;
 })()
   )");
-  m_view->page()->runJavaScript(
+  runPageJs(
+      "dedaoScroll.clickSeq",
       clickSeqJs,
-      [this, currentSeq, dispatchKey](const QVariant &v) mutable {
-        if (m_navSequence != currentSeq) {
+      [this, seq, dispatchKey](const QVariant &v) mutable {
+        // 看门狗已放弃本轮（超时）则不再补发按键
+        if (m_pageTurn.inFlightSeq() != seq) {
           return;
         }
         if (v.isNull()) {
@@ -325,60 +82,8 @@ void WereadBrowser::fetchCatalog() {
       return;
     qInfo() << "[CATALOG] Fetching starting...";
 
-    // Step 1: Click catalog button (synchronous IIFE)
-    const QString clickJs = QStringLiteral(R"(
-(() => {
-  const list = document.querySelector('.readerCatalog_list');
-  const panel = document.querySelector('.readerCatalog');
-  const panelVisible = panel ? (getComputedStyle(panel).display !== 'none') : false;
-  if (list && list.children.length > 0) {
-    return {ok:true, action:'already-open', count: list.children.length, panelVisible};
-  }
-  const selectors = [
-    '.readerControls_item.catalog',
-    '.readerControls .catalog',
-    'button[title*="\u76ee\u5f55"]',
-    '[data-action="catalog"]'
-  ];
-  const isVisible = (el) => {
-    if (!el) return false;
-    const style = window.getComputedStyle ? getComputedStyle(el) : null;
-    if (style) {
-      if (style.display === 'none' || style.visibility === 'hidden' || style.opacity === '0') {
-        return false;
-      }
-      if (style.pointerEvents === 'none') return false;
-    }
-    const rect = el.getBoundingClientRect ? el.getBoundingClientRect() : null;
-    if (rect && (rect.width === 0 || rect.height === 0)) return false;
-    return true;
-  };
-  const found = [];
-  let picked = null;
-  for (const sel of selectors) {
-    const el = document.querySelector(sel);
-    if (el) {
-      const info = {sel, tag: el.tagName, cls: el.className || '', visible: isVisible(el)};
-      found.push(info);
-      if (!picked) picked = {el, sel, visible: info.visible};
-    }
-  }
-  if (picked && picked.el) {
-    if (picked.el.click) picked.el.click();
-    return {
-      ok:true,
-      action:'clicked',
-      selector: picked.sel,
-      visible: picked.visible,
-      panelVisible,
-      found
-    };
-  }
-  return {ok:false, error:'no-btn', panelVisible, found};
-})()
-    )");
-
-    m_view->page()->runJavaScript(clickJs, [this](const QVariant &res) {
+    // Step 1: Click catalog button
+    callPageRuntime(QStringLiteral("catalogOpen()"), [](const QVariant &res) {
       qInfo() << "[CATALOG] Click result:" << res;
       QVariantMap resMap = res.toMap();
       if (!resMap.value("ok", false).toBool()) {
@@ -387,47 +92,10 @@ void WereadBrowser::fetchCatalog() {
       }
     });
 
-    // Step 2: After delay, scrape catalog data (synchronous IIFE)
+    // Step 2: After delay, scrape catalog data
     QTimer::singleShot(500, this, [this]() {
-      const QString scrapeJs = QStringLiteral(R"(
-(() => {
-  console.log('[CATALOG_DEBUG] Starting catalog scrape (dom-only)...');
-  const items = Array.from(document.querySelectorAll('.readerCatalog_list_item'));
-  console.log('[CATALOG_DEBUG] Found ' + items.length + ' DOM items');
-  if (items.length === 0) {
-    return {ok:false, error:'no-items'};
-  }
-  const normalize = (s) => String(s || '').replace(/\s+/g, ' ').trim();
-  const data = items.map((item, idx) => {
-    const titleEl = item.querySelector('.readerCatalog_list_item_title_text');
-    let title = titleEl ? titleEl.innerText : '';
-    if (!title) {
-      title = item.innerText || '';
-    }
-    title = normalize(title);
-    const isCurrent = item.classList.contains('readerCatalog_list_item_selected');
-    let level = 1;
-    const inner = item.querySelector('.readerCatalog_list_item_inner');
-    const className = inner ? inner.className : item.className;
-    const m = String(className || '').match(/readerCatalog_list_item_level_(\d+)/);
-    if (m) {
-      const parsed = parseInt(m[1], 10);
-      level = Number.isFinite(parsed) && parsed > 0 ? parsed : 1;
-    }
-    return {
-      index: idx,
-      title: title,
-      level: level,
-      isCurrent: isCurrent,
-      matchKey: title,
-      chapterUid: title
-    };
-  }).filter((item) => item && item.title);
-  return {ok:true, chapters: data, source:'dom-only'};
-})()
-      )");
-
-      m_view->page()->runJavaScript(scrapeJs, [this](const QVariant &v) {
+      callPageRuntime(QStringLiteral("catalogScrape()"),
+                      [this](const QVariant &v) {
         qInfo() << "[CATALOG] Scrape result type:" << v.typeName();
         QVariantMap resMap = v.toMap();
         if (!resMap.value("ok", false).toBool()) {
@@ -483,15 +151,15 @@ void WereadBrowser::fetchDedaoCatalog() {
       !m_dedaoCatalogCache.isEmpty()) {
     qInfo() << "[CATALOG_DEDAO] using cache" << m_dedaoCatalogCache.size()
             << "key" << cacheKey;
-    const QString openJs = QString::fromUtf8(kDedaoCatalogOpenScript);
-    m_view->page()->runJavaScript(openJs, [](const QVariant &res) {
-      qInfo() << "[CATALOG_DEDAO] open panel" << res;
-    });
+    callPageRuntime(QStringLiteral("dedaoCatalog.open()"),
+                    [](const QVariant &res) {
+                      qInfo() << "[CATALOG_DEDAO] open panel" << res;
+                    });
     QTimer::singleShot(200, this, [this]() {
       if (!m_view || !m_view->page())
         return;
-      const QString currentJs = QString::fromUtf8(kDedaoCatalogCurrentScript);
-      m_view->page()->runJavaScript(currentJs, [this](const QVariant &v) {
+      callPageRuntime(QStringLiteral("dedaoCatalog.current()"),
+                      [this](const QVariant &v) {
         const QVariantMap map = v.toMap();
         const bool ok = map.value(QStringLiteral("ok")).toBool();
         if (ok) {
@@ -537,10 +205,10 @@ void WereadBrowser::fetchDedaoCatalog() {
   m_dedaoCatalogScanStepPx = 0;
   m_dedaoCatalogScanKey = cacheKey;
   qInfo() << "[CATALOG_DEDAO] Fetching starting...";
-  const QString openJs = QString::fromUtf8(kDedaoCatalogOpenScript);
-  m_view->page()->runJavaScript(openJs, [](const QVariant &res) {
-    qInfo() << "[CATALOG_DEDAO] open panel" << res;
-  });
+  callPageRuntime(QStringLiteral("dedaoCatalog.open()"),
+                  [](const QVariant &res) {
+                    qInfo() << "[CATALOG_DEDAO] open panel" << res;
+                  });
 
   QTimer::singleShot(200, this,
                      [this]() { advanceDedaoCatalogScan(true); });
@@ -554,10 +222,10 @@ void WereadBrowser::advanceDedaoCatalogScan(bool reset) {
   const int stepPx = m_dedaoCatalogScanStepPx > 0
                          ? m_dedaoCatalogScanStepPx
                          : 240;
-  const QString scanJs = QString::fromUtf8(kDedaoCatalogScrollStepScript)
-                             .arg(stepPx)
-                             .arg(reset ? 1 : 0);
-  m_view->page()->runJavaScript(scanJs, [this](const QVariant &v) {
+  const QString scanCall = QStringLiteral("dedaoCatalog.scrollStep(%1,%2)")
+                               .arg(stepPx)
+                               .arg(reset ? 1 : 0);
+  callPageRuntime(scanCall, [this](const QVariant &v) {
     const QVariantMap resMap = v.toMap();
     if (!resMap.value(QStringLiteral("ok")).toBool()) {
       qWarning() << "[CATALOG_DEDAO] scan failed" << resMap;
@@ -607,8 +275,8 @@ void WereadBrowser::scheduleDedaoCatalogScrape(int delayMs) {
       m_dedaoCatalogScanning = false;
       return;
     }
-    const QString scrapeJs = QString::fromUtf8(kDedaoCatalogScrapeScript);
-    m_view->page()->runJavaScript(scrapeJs, [this](const QVariant &v) {
+    callPageRuntime(QStringLiteral("dedaoCatalog.scrape()"),
+                    [this](const QVariant &v) {
       QVariantMap resMap = v.toMap();
       if (!resMap.value(QStringLiteral("ok")).toBool()) {
         qWarning() << "[CATALOG_DEDAO] scrape failed" << resMap;
@@ -644,10 +312,10 @@ void WereadBrowser::scheduleDedaoCatalogScrape(int delayMs) {
 void WereadBrowser::hideDedaoNativeCatalog() {
   if (!m_view || !m_view->page())
     return;
-  const QString hideJs = QString::fromUtf8(kDedaoCatalogHideScript);
-  m_view->page()->runJavaScript(hideJs, [](const QVariant &res) {
-    qInfo() << "[CATALOG_DEDAO] hide native" << res;
-  });
+  callPageRuntime(QStringLiteral("dedaoCatalog.hide()"),
+                  [](const QVariant &res) {
+                    qInfo() << "[CATALOG_DEDAO] hide native" << res;
+                  });
 }
 
 void WereadBrowser::handleDedaoCatalogClick(int index, const QString &uid) {
@@ -657,25 +325,26 @@ void WereadBrowser::handleDedaoCatalogClick(int index, const QString &uid) {
     m_menu->hide();
   if (m_catalogWidget)
     m_catalogWidget->hide();
-  const QString openPanelJs = QString::fromUtf8(kDedaoCatalogOpenScript);
-  m_view->page()->runJavaScript(openPanelJs, [](const QVariant &res) {
+  const QString openPanelCall = QStringLiteral("dedaoCatalog.open()");
+  callPageRuntime(openPanelCall, [](const QVariant &res) {
     qInfo() << "[CATALOG_DEDAO] open panel" << res;
   });
 
   const QJsonArray uidArr{QJsonValue(uid)};
   const QString uidJson = QString::fromUtf8(
       QJsonDocument(uidArr).toJson(QJsonDocument::Compact));
-  const QString clickJs =
-      QString::fromUtf8(kDedaoCatalogClickScript).arg(uidJson).arg(index);
+  const QString clickCall =
+      QStringLiteral("dedaoCatalog.click(%1[0],%2)")
+          .arg(uidJson, QString::number(index));
   const quint64 clickSeq = ++m_catalogClickSeq;
   const int maxRetries = 2;
-  auto runAttempt = [this, clickSeq, clickJs, openPanelJs,
+  auto runAttempt = [this, clickSeq, clickCall, openPanelCall,
                      maxRetries](auto &&self, int retryCount) -> void {
     if (!m_view || !m_view->page() || clickSeq != m_catalogClickSeq)
       return;
-    m_view->page()->runJavaScript(
-        clickJs, [this, clickSeq, openPanelJs, maxRetries, retryCount,
-                  self](const QVariant &res) mutable {
+    callPageRuntime(
+        clickCall, [this, clickSeq, openPanelCall, maxRetries, retryCount,
+                    self](const QVariant &res) mutable {
           if (clickSeq != m_catalogClickSeq)
             return;
           qInfo() << "[CATALOG_DEDAO] click" << res;
@@ -699,7 +368,7 @@ void WereadBrowser::handleDedaoCatalogClick(int index, const QString &uid) {
               reason == QStringLiteral("offscreen");
           if (!shouldRetry || retryCount >= maxRetries)
             return;
-          m_view->page()->runJavaScript(openPanelJs, [](const QVariant &res) {
+          callPageRuntime(openPanelCall, [](const QVariant &res) {
             qInfo() << "[CATALOG_DEDAO] reopen panel" << res;
           });
           QTimer::singleShot(300, this, [self, retryCount]() mutable {
@@ -756,7 +425,7 @@ void WereadBrowser::goBack() {
     if (canBack) {
       // Use JS history.back so SPA can handle its own stack; then log the
       // result a moment later.
-      m_view->page()->runJavaScript(QStringLiteral("window.history.back();"));
+      runPageJs("historyBack", QStringLiteral("window.history.back();"));
       QTimer::singleShot(800, this, [this]() {
         auto *h = m_view->page()->history();
         const int afterCount = h ? h->count() : -1;
@@ -863,6 +532,10 @@ void WereadBrowser::exitToXochitl(const QString &exitReason ) {
     saveExitReason(exitReason);
     // 先保存会话状态
     saveSessionState();
+    flushPageProbes();
+    logJsProfile();
+    logInkTrace();
+    logPagePaths();
     // 启动退出脚本（停止后端，启动 xochitl）
     QProcess::startDetached(
         QStringLiteral("/home/root/weread/exit-wechatread.sh"));
@@ -987,7 +660,84 @@ void WereadBrowser::handleStateRequest() {
       QHostAddress sender;
       quint16 port = 0;
       m_stateResponder.readDatagram(d.data(), d.size(), &sender, &port);
-      Q_UNUSED(d);
+      if (d.trimmed() == QByteArrayLiteral("jsprof")) {
+        // 调试查询：直接回给请求方 runJavaScript 各调用点的 p50/p95/p99
+        const QByteArray json =
+            QJsonDocument(m_jsProfiler.snapshot())
+                .toJson(QJsonDocument::Compact);
+        m_stateResponder.writeDatagram(json, sender, port);
+        logJsProfile();
+        continue;
+      }
+      if (d.trimmed() == QByteArrayLiteral("jsparse")) {
+        // 运行时/观察脚本与短调用串在当前页的解析编译耗时
+        measureJsCompile([this, sender, port](const QJsonObject &obj) {
+          m_stateResponder.writeDatagram(
+              QJsonDocument(obj).toJson(QJsonDocument::Compact), sender, port);
+        });
+        continue;
+      }
+      if (d.trimmed() == QByteArrayLiteral("inktrace")) {
+        // 翻页从触摸到上墨的分阶段耗时分位数
+        const QByteArray json =
+            QJsonDocument(InkLatencyTracer::instance().snapshot())
+                .toJson(QJsonDocument::Compact);
+        m_stateResponder.writeDatagram(json, sender, port);
+        logInkTrace();
+        continue;
+      }
+      if (d.trimmed() == QByteArrayLiteral("pathsel")) {
+        // 各站点/模式下翻页路径的成功率与延迟，以及当前选中的路径
+        const QByteArray json =
+            QJsonDocument(m_pagePaths.snapshot())
+                .toJson(QJsonDocument::Compact);
+        m_stateResponder.writeDatagram(json, sender, port);
+        logPagePaths();
+        continue;
+      }
+      if (d.trimmed() == QByteArrayLiteral("netstats")) {
+        // 最近几次加载的网络统计；先补采一次当前页的 resource timing 再回复
+        collectNetEntries([this, sender, port]() {
+          const QByteArray json = QJsonDocument(m_netStats.snapshot())
+                                      .toJson(QJsonDocument::Compact);
+          m_stateResponder.writeDatagram(json, sender, port);
+          logNetStats();
+        });
+        continue;
+      }
+      if (d.trimmed() == QByteArrayLiteral("assets") && m_assetStore) {
+        // 本地资源存储：条目/字节/命中/淘汰
+        const QByteArray json = QJsonDocument(m_assetStore->snapshot())
+                                    .toJson(QJsonDocument::Compact);
+        m_stateResponder.writeDatagram(json, sender, port);
+        qInfo().noquote() << "[ASSETS]" << json;
+        continue;
+      }
+      if (d.trimmed() == QByteArrayLiteral("warm")) {
+        // 连接预热：各 origin 的 TTFB/建连/TLS 握手 p50/p95 与复用次数
+        const QByteArray json = QJsonDocument(m_warmer.snapshot())
+                                    .toJson(QJsonDocument::Compact);
+        m_stateResponder.writeDatagram(json, sender, port);
+        logWarm();
+        continue;
+      }
+      if (d.trimmed() == QByteArrayLiteral("offline") && m_offline) {
+        // 离线归档：每本书的章节/插图/字节数与完整性
+        const QByteArray json = QJsonDocument(m_offline->snapshot())
+                                    .toJson(QJsonDocument::Compact);
+        m_stateResponder.writeDatagram(json, sender, port);
+        logOffline();
+        continue;
+      }
+      if (d.trimmed() == QByteArrayLiteral("urlrules") && m_interceptor) {
+        // 请求拦截规则及各自命中次数
+        const QByteArray json =
+            QJsonDocument(m_interceptor->rules().snapshot())
+                .toJson(QJsonDocument::Compact);
+        m_stateResponder.writeDatagram(json, sender, port);
+        logUrlRules();
+        continue;
+      }
       sendBookState(); // reply by sending current state to 45456 as usual
       qInfo() << "[STATE] request received from" << sender.toString() << "port"
               << port;
@@ -1008,34 +758,45 @@ QString WereadBrowser::detectUaMode(const QString &ua) const {
 
 
 bool WereadBrowser::isWeReadBook() const {
-    const QString u = currentUrl.toString();
-    // 放宽匹配：只要域是 weread.qq.com 且路径包含 /web/reader 即视为书籍页
-    return u.contains(QStringLiteral("weread.qq.com")) &&
-           u.contains(QStringLiteral("/web/reader"));
+    return m_pageContext.isWeReadBook();
   }
 
 
-bool WereadBrowser::isKindleUA() const {
-    const QString ua = m_currentUA.toLower();
-    return ua.contains(QStringLiteral("kindle")) ||
-           m_uaMode.compare(QStringLiteral("kindle"), Qt::CaseInsensitive) == 0;
+bool WereadBrowser::isKindleUA() const { return m_pageContext.kindleUA; }
+
+
+bool WereadBrowser::isWeReadKindleMode() const {
+    return m_pageContext.isWeReadKindleMode();
   }
 
 
-bool WereadBrowser::isWeReadKindleMode() const { return isWeReadBook() && isKindleUA(); }
 
+bool WereadBrowser::isDedaoBook() const { return m_pageContext.isDedaoBook(); }
 
 
-bool WereadBrowser::isDedaoBook() const {
-    const QString u = currentUrl.toString();
-    return u.contains(QStringLiteral("dedao.cn")) &&
-           u.contains(QStringLiteral("/ebook/reader"));
-  }
+bool WereadBrowser::isDedaoSite() const { return m_pageContext.isDedaoSite(); }
 
 
-bool WereadBrowser::isDedaoSite() const {
-    const QString u = currentUrl.toString();
-    return u.contains(QStringLiteral("dedao.cn"));
+void WereadBrowser::updatePageContext() {
+    PageContext ctx = PageContext::classify(currentUrl);
+    const QString ua = m_currentUA.toLower();
+    ctx.kindleUA = ua.contains(QStringLiteral("kindle")) ||
+                   m_uaMode.compare(QStringLiteral("kindle"),
+                                    Qt::CaseInsensitive) == 0;
+    // 翻页路径另外看书籍页配置的 UA：当前 UA 尚未切换时也按 Kindle 处理
+    m_weReadTurnKindleUA =
+        ctx.kindleUA || m_uaWeReadBook.contains(QStringLiteral("Kindle"),
+                                                Qt::CaseInsensitive);
+    ctx.refresh = ctx.site == PageContext::Site::Dedao ? m_smartRefreshDedao
+                  : ctx.site == PageContext::Site::WeRead
+                      ? m_smartRefreshWeRead
+                      : nullptr;
+    if (ctx == m_pageContext)
+      return;
+    m_pageContext = ctx;
+    qInfo() << "[PAGE_CTX] site" << PageContext::siteName(ctx.site) << "kind"
+            << PageContext::kindName(ctx.kind) << "kindleUA" << ctx.kindleUA
+            << "url" << currentUrl;
   }
 
 
@@ -1052,28 +813,18 @@ SmartRefreshManager *WereadBrowser::getSmartRefreshDedao() const {
   }
 
 SmartRefreshManager *WereadBrowser::smartRefreshForUrl(const QUrl &url) const {
-    const QString u = url.toString();
-    if (u.contains(QStringLiteral("dedao.cn"))) {
+    switch (PageContext::classify(url).site) {
+    case PageContext::Site::Dedao:
       return m_smartRefreshDedao;
-    }
-    if (u.contains(QStringLiteral("weread.qq.com"))) {
+    case PageContext::Site::WeRead:
       return m_smartRefreshWeRead;
+    default:
+      return nullptr;
     }
-    return nullptr;
   }
 
 SmartRefreshManager *WereadBrowser::smartRefreshForPage() const {
-    QUrl pageUrl;
-    if (m_view && m_view->page()) {
-      pageUrl = m_view->page()->url();
-      if (pageUrl.isEmpty()) {
-        pageUrl = m_view->url();
-      }
-    }
-    if (pageUrl.isEmpty()) {
-      pageUrl = currentUrl;
-    }
-    return smartRefreshForUrl(pageUrl);
+    return m_pageContext.refresh;
   }
 
 SmartRefreshManager *WereadBrowser::getSmartRefresh() const {
@@ -1102,14 +853,22 @@ void WereadBrowser::handleSmartRefreshBurstEnd() {
 
 
 
-void WereadBrowser::scheduleBookCaptures(bool force ) {
-    Q_UNUSED(force);
-    // 一体化模式不抓帧，仅保留接口
+void WereadBrowser::scheduleBookCaptures(bool force) {
+  // 一体化模式不抓帧；离屏模式下合并为一次延迟抓帧，force 立即抓取
+  if (!m_frameCapture)
+    return;
+  if (force) {
+    captureFrame();
+    return;
   }
+  scheduleCapture(150);
+}
 
 
-void WereadBrowser::restartCaptureLoop() { /* no-op */
-  }
+void WereadBrowser::restartCaptureLoop() {
+  cancelPendingCaptures();
+  scheduleBookCaptures(true);
+}
 
 
 void WereadBrowser::updateLastTouchTs(qint64 ts) { m_lastTouchTs = ts; }
@@ -1119,19 +878,9 @@ void WereadBrowser::updateLastTouchTs(qint64 ts) { m_lastTouchTs = ts; }
 void WereadBrowser::forceRepaintNudge() {
     if (!m_view || !m_view->page())
       return;
-    const QString js =
-        QStringLiteral("(() => {"
-                       "  try {"
-                       "    window.scrollBy(0,1);"
-                       "    setTimeout(()=>window.scrollBy(0,-1),50);"
-                       "    const b=document.body; if(b){ const "
-                       "op=b.style.opacity; b.style.opacity='0.999'; "
-                       "setTimeout(()=>{b.style.opacity=op||'';},50); }"
-                       "    return {ok:true};"
-                       "  } catch(e) { return {ok:false, error:String(e)}; }"
-                       "})();");
-    m_view->page()->runJavaScript(
-        js, [](const QVariant &res) { qInfo() << "[REPAINT_NUDGE]" << res; });
+    callPageRuntime(QStringLiteral("repaintNudge()"), [](const QVariant &res) {
+      qInfo() << "[REPAINT_NUDGE]" << res;
+    });
   }
 
 
@@ -1172,7 +921,8 @@ void WereadBrowser::markPageTurnTriggered(int currentSeq, const QString &source)
     m_lastPageTurnSeqNotified = currentSeq;
     qWarning() << "[PAGER] page turn triggered" << source << "seq"
                << currentSeq;
-    QTimer::singleShot(200, this, [this]() { keepAliveNearChapterEnd(); });
+    // 探针合批窗口本身约 200ms，与翻页探针/会话保存同批执行
+    keepAliveNearChapterEnd();
     onPageTurnEvent();
   }
 
@@ -1188,7 +938,12 @@ void WereadBrowser::scheduleInputFallback(bool forward, int currentSeq) {
       }
       qWarning() << "[PAGER_INPUT] no dom event after input, giving up"
                  << (forward ? "next" : "prev") << "seq" << currentSeq;
+      m_pagePaths.noteFailure(currentSeq);
       m_pendingInputFallbackSeq = 0;
+      // 按键没生效：剩余页数一并放弃，不再继续注入
+      m_pageTurn.complete(currentSeq, m_pageTurn.inFlightSeq() == currentSeq
+                                          ? m_pageTurn.inFlightPages()
+                                          : 0);
     });
   }
 
@@ -1196,51 +951,21 @@ void WereadBrowser::scheduleInputFallback(bool forward, int currentSeq) {
 void WereadBrowser::runWeReadPagerJsClick(bool forward, int currentSeq, const QString &trigger) {
     if (!m_view || !m_view->page())
       return;
-    const QString js =
-        forward
-            ? QStringLiteral("(function(){"
-                             "  var "
-                             "btn=document.querySelector('.renderTarget_pager_"
-                             "button_right');"
-                             "  if(!btn){console.log('[PAGER_JS] button not "
-                             "found');return false;}"
-                             "  if(!btn.click){console.log('[PAGER_JS] button "
-                             "has no click method');return false;}"
-                             "  var jsStartTime = new Date().getTime();"
-                             "  console.log('[PAGER_JS] button found, "
-                             "clicking...', jsStartTime);"
-                             "  var clickStart = new Date().getTime();"
-                             "  btn.click();"
-                             "  var clickEnd = new Date().getTime();"
-                             "  console.log('[PAGER_JS] button clicked, "
-                             "duration', clickEnd - clickStart, 'ms');"
-                             "  return true;"
-                             "})()")
-            : QStringLiteral(
-                  "(function(){"
-                  "  var "
-                  "btn=document.querySelector('.renderTarget_pager_button');"
-                  "  if(!btn){console.log('[PAGER_JS] button not "
-                  "found');return false;}"
-                  "  if(!btn.click){console.log('[PAGER_JS] button has no "
-                  "click method');return false;}"
-                  "  console.log('[PAGER_JS] button found, clicking...');"
-                  "  btn.click();"
-                  "  return true;"
-                  "})()");
     const qint64 jsCallTime = QDateTime::currentMSecsSinceEpoch();
     qInfo() << "[PAGER_JS] dispatch" << (forward ? "next" : "prev") << "trigger"
             << trigger << "seq" << currentSeq << "ts" << jsCallTime;
-    m_view->page()->runJavaScript(js, [this, currentSeq, jsCallTime, forward,
-                                       trigger](const QVariant &res) {
-      if (m_pendingNavSeq != currentSeq) {
-        qInfo() << "[PAGER] callback cancelled (seq mismatch: pending="
-                << m_pendingNavSeq << "current=" << currentSeq << ")";
-        if (m_navTimeoutTimer) {
-          m_navTimeoutTimer->stop();
-        }
+    callPageRuntime(QStringLiteral("pagerClick(%1)")
+                        .arg(forward ? QStringLiteral("true")
+                                     : QStringLiteral("false")),
+                    [this, currentSeq, jsCallTime, forward,
+                     trigger](const QVariant &res) {
+      if (m_pageTurn.inFlightSeq() != currentSeq) {
+        qInfo() << "[PAGER] callback cancelled (seq mismatch: inFlight="
+                << m_pageTurn.inFlightSeq() << "current=" << currentSeq
+                << ")";
         return;
       }
+      InkLatencyTracer::instance().mark(InkLatencyTracer::JsDone);
       const qint64 jsResultTime = QDateTime::currentMSecsSinceEpoch();
       const qint64 jsDelay = jsResultTime - jsCallTime;
       const bool ok = res.toBool();
@@ -1248,6 +973,7 @@ void WereadBrowser::runWeReadPagerJsClick(bool forward, int currentSeq, const QS
               << ok << "seq" << currentSeq << "trigger" << trigger
               << "JS execution delay" << jsDelay << "ms";
       if (!ok) {
+        m_pagePaths.noteFailure(currentSeq);
         if (isWeReadBook()) {
           qWarning()
               << "[PAGER]" << (forward ? "next" : "prev")
@@ -1275,19 +1001,8 @@ void WereadBrowser::runWeReadPagerJsClick(bool forward, int currentSeq, const QS
         logPageTurnEffect(currentSeq, QStringLiteral("js-click"), trigger, -1);
       }
       markPageTurnTriggered(currentSeq, QStringLiteral("js-click"));
-      if (m_navSequence == currentSeq && m_pendingNavSeq == currentSeq) {
-        m_navigating = false;
-        m_pendingNavSeq = 0;
-        if (m_navTimeoutTimer) {
-          m_navTimeoutTimer->stop();
-        }
-      } else {
-        qInfo() << "[PAGER]" << (forward ? "next" : "prev")
-                << "callback ignored, seq mismatch (navSeq=" << m_navSequence
-                << "pending=" << m_pendingNavSeq << "current=" << currentSeq
-                << ")";
-      }
       if (isWeReadBook() && m_weReadBookMode == QStringLiteral("mobile"))
         alignWeReadPagination();
+      m_pageTurn.complete(currentSeq, forward ? 1 : -1);
     });
   }
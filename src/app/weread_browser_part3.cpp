@@ -2,15 +2,16 @@
 #include <QTextStream>
 
 void WereadBrowser::noteDomEventFromJson(const QString &json) {
-  if (m_pendingInputFallbackSeq <= 0 && !logLevelAtLeast(LogLevel::Info)) {
+  if (!json.contains(QLatin1String("\"t\":\"dom\"")))
     return;
-  }
+  InkLatencyTracer::instance().mark(InkLatencyTracer::FirstDom);
   QJsonParseError err;
   QJsonDocument doc = QJsonDocument::fromJson(json.toUtf8(), &err);
   if (err.error != QJsonParseError::NoError || !doc.isArray())
     return;
   const QJsonArray arr = doc.array();
   int totalScore = 0;
+  int turnSeq = 0; // 页面运行时 markTurn 记下的最近一次翻页
   bool hasDom = false;
   for (const QJsonValue &val : arr) {
     if (!val.isObject())
@@ -20,32 +21,43 @@ void WereadBrowser::noteDomEventFromJson(const QString &json) {
       continue;
     hasDom = true;
     totalScore += obj.value(QStringLiteral("s")).toInt();
+    turnSeq = qMax(turnSeq, obj.value(QStringLiteral("q")).toInt());
   }
   if (!hasDom)
     return;
+  // 只认本轮翻页下发之后的变化，迟到的上一轮变化和无关变动不算数
+  m_pagePaths.noteDom(turnSeq);
   const qint64 now = QDateTime::currentMSecsSinceEpoch();
   m_lastDomEventMs = now;
   m_lastDomEventScore = totalScore;
-  if (m_pendingInputFallbackSeq > 0 && now >= m_inputFallbackStartMs) {
+  if (m_pendingInputFallbackSeq > 0 && turnSeq == m_pendingInputFallbackSeq &&
+      now >= m_inputFallbackStartMs) {
     const int seq = m_pendingInputFallbackSeq;
     m_inputDomObserved = true;
     logPageTurnEffect(seq, QStringLiteral("input"), QString(), totalScore);
     m_pendingInputFallbackSeq = 0;
+    // 按键路径每轮一页：页面有反应后才放行下一键
+    if (m_pageTurn.inFlightSeq() == seq)
+      m_pageTurn.complete(seq, m_pageTurn.inFlightPages() > 0 ? 1 : -1);
   }
 }
 
+void WereadBrowser::markPageTurnSeq(int seq) {
+  // 不等回包：同一页面的 runJavaScript 按序执行，排在执行器调用之前；
+  // 按键路径的 DOM 报告在下一帧才打标，届时标记已落地
+  callPageRuntime(QStringLiteral("markTurn(%1)").arg(seq));
+}
+
 void WereadBrowser::updateUserAgentForUrl(const QUrl &url) {
   if (!m_profile)
     return;
-  const QString u = url.toString();
-  const bool weReadBook = u.contains(QStringLiteral("weread.qq.com")) &&
-                          u.contains(QStringLiteral("/web/reader/"));
-  const bool dedaoBook = u.contains(QStringLiteral("dedao.cn")) &&
-                         u.contains(QStringLiteral("/ebook/reader"));
-  const bool dedaoSite = u.contains(QStringLiteral("dedao.cn"));
+  const PageContext page = PageContext::classify(url);
+  const bool weReadBook = page.isWeReadBook();
+  const bool dedaoBook = page.isDedaoBook();
+  const bool dedaoSite = page.isDedaoSite();
   // 检测是否是微信读书首页（weread.qq.com但不是书籍页）
   const bool weReadHome =
-      u.contains(QStringLiteral("weread.qq.com")) && !weReadBook;
+      page.site == PageContext::Site::WeRead && !weReadBook;
   QString targetUA;
   if (dedaoSite) {
     targetUA = m_uaDedaoBook.isEmpty() ? m_uaNonWeRead : m_uaDedaoBook;
@@ -64,11 +76,13 @@ void WereadBrowser::updateUserAgentForUrl(const QUrl &url) {
   if (targetUA == m_currentUA) {
     // UA相同，无需切换
     m_uaMode = detectUaMode(m_currentUA);
+    updatePageContext();
     return;
   }
   m_profile->setHttpUserAgent(targetUA);
   m_currentUA = targetUA;
   m_uaMode = detectUaMode(m_currentUA);
+  updatePageContext();
   const char *uaScene = "non-weread";
   if (dedaoSite) {
     uaScene = dedaoBook ? "dedao-book" : "dedao-site";
@@ -90,6 +104,7 @@ void WereadBrowser::ensureDedaoDefaults() {
     m_profile->setHttpUserAgent(m_uaDedaoBook);
     m_currentUA = m_uaDedaoBook;
     m_uaMode = detectUaMode(m_currentUA);
+    updatePageContext();
     qInfo() << "[DEDAO] UA forced to mobile";
   }
   // 缩放：2.0
@@ -101,36 +116,17 @@ void WereadBrowser::ensureDedaoDefaults() {
 }
 
 void WereadBrowser::scheduleCapture(int delayMs) {
-  Q_UNUSED(delayMs); /* no-op in integrated mode */
+  // no-op in integrated mode; offscreen mode coalesces into one grab
+  if (m_frameCapture)
+    m_frameCapture->noteDamage(QRect(), delayMs);
 }
 
 void WereadBrowser::alignWeReadPagination() {
   if (!isWeReadBook() || m_weReadBookMode != QStringLiteral("mobile") ||
       !m_view || !m_view->page())
     return;
-  const QString js = QStringLiteral(
-      "(() => {"
-      "  const el = document.querySelector('.renderTargetContent') || "
-      "document.scrollingElement || document.documentElement;"
-      "  if (!el) return {ok:false, reason:'no-container'};"
-      "  try {"
-      "    // el.style.padding = '20px 35px'; // 临时禁用：排查布局/隐藏问题"
-      "    el.style.boxSizing = 'border-box';"
-      "    el.style.width = '100%';"
-      "    el.style.maxWidth = '100%';"
-      "  } catch(e) {}"
-      "  const sample = el.querySelector('p, div, span');"
-      "  const lh = sample ? parseFloat(getComputedStyle(sample).lineHeight) "
-      "|| 32 : 32;"
-      "  const padTop = parseFloat(getComputedStyle(el).paddingTop) || 0;"
-      "  const cur = el.scrollTop;"
-      "  const aligned = Math.max(0, Math.round((cur - padTop) / lh) * lh + "
-      "padTop);"
-      "  if (Math.abs(aligned - cur) > 0.5) el.scrollTo({ top: aligned, "
-      "behavior: 'auto' });"
-      "  return {ok:true, from:cur, to:aligned, lineHeight:lh};"
-      "})()");
-  m_view->page()->runJavaScript(js, [](const QVariant &res) {
+  // 与 weReadScroll 共用页面内的几何缓存（容器/行高/padding）
+  callPageRuntime(QStringLiteral("align()"), [](const QVariant &res) {
     qInfo() << "[PAGER] align weRead" << res;
   });
 }
@@ -190,7 +186,7 @@ void WereadBrowser::runVisualDiagnostic() {
       "    };"
       "  } catch(e) { return {error: String(e)}; }"
       "})()");
-  m_view->page()->runJavaScript(js, [](const QVariant &res) {
+  runPageJs("visualDiagnostic", js, [](const QVariant &res) {
     qWarning().noquote() << "[VISUAL_DIAG]" << res;
   });
 }
@@ -204,28 +200,9 @@ void WereadBrowser::applyBookPageFixes() {
   // 延迟执行，等待页面内容加载
   QTimer::singleShot(500, this, [this]() {
     // 检查是否有文本内容
-    m_view->page()->runJavaScript(
-        QStringLiteral(
-            "(() => {"
-            "  try {"
-            "    const bodyLen = (document.body && document.body.innerText) "
-            "? document.body.innerText.length : 0;"
-            "    const cont = document.querySelector('.renderTargetContent');"
-            "    const contLen = cont ? ((cont.innerText||'').length) : 0;"
-            "    let iframeText = 0;"
-            "    const frames = "
-            "Array.from(document.querySelectorAll('iframe'));"
-            "    frames.forEach(f=>{"
-            "      try{ const "
-            "d=f.contentDocument||f.contentWindow?.document; "
-            "if(d&&d.body&&d.body.innerText){ iframeText += "
-            "d.body.innerText.length; } }catch(_e){}"
-            "    });"
-            "    const hasText = (contLen > 100) || (bodyLen > 500) || "
-            "(iframeText > 300);"
-            "    return {hasText, bodyLen, contLen, iframeText};"
-            "  } catch(e){ return {error:String(e)}; }"
-            "})()"),
+    // 正文就绪判定直接触发 CONTENT_READY 刷新，不再额外等待批次窗口
+    queuePageProbe(
+        QStringLiteral("contentProbe()"),
         [this](const QVariant &res) {
           const auto m = res.toMap();
           const bool hasText = m.value(QStringLiteral("hasText")).toBool();
@@ -252,43 +229,8 @@ void WereadBrowser::applyBookPageFixes() {
           // 应用 iframe 修复样式
           if (hasText && !m_iframeFixApplied) {
             m_iframeFixApplied = true;
-            const QString fixJs = QStringLiteral(
-                "(() => {"
-                "  try {"
-                "    const cont = "
-                "document.querySelector('.renderTargetContent');"
-                "    if (cont) {"
-                "      cont.style.minHeight = '100vh';"
-                "      cont.style.width = '100%';"
-                "      cont.style.display = 'block';"
-                "      cont.style.opacity = '1';"
-                "      cont.style.visibility = 'visible';"
-                "      cont.style.background = '#fff';"
-                "    }"
-                "    const iframes = "
-                "Array.from(document.querySelectorAll('iframe'));"
-                "    iframes.forEach(f => {"
-                "      f.style.display = 'block';"
-                "      f.style.minHeight = '100vh';"
-                "      f.style.width = '100%';"
-                "      try {"
-                "        const d = f.contentDocument || (f.contentWindow && "
-                "f.contentWindow.document);"
-                "        if (d && d.body) {"
-                "          d.body.style.background = '#fff';"
-                "          d.body.style.color = '#000';"
-                "          d.body.style.opacity = '1';"
-                "          d.documentElement && "
-                "(d.documentElement.style.background = '#fff');"
-                "        }"
-                "      } catch(_) {}"
-                "    });"
-                "    window.scrollBy(0,1); "
-                "setTimeout(()=>window.scrollBy(0,-1),30);"
-                "    return {ok:true, iframes: iframes.length};"
-                "  } catch(e){ return {ok:false, error:String(e)};}"
-                "})()");
-            m_view->page()->runJavaScript(fixJs, [](const QVariant &res) {
+            callPageRuntime(QStringLiteral("iframeFix()"),
+                            [](const QVariant &res) {
               qInfo() << "[STYLE] iframe fix" << res;
             });
           }
@@ -296,40 +238,13 @@ void WereadBrowser::applyBookPageFixes() {
           // 注入低功耗样式（仅一次）
           if (hasText && !m_lowPowerCssInjected) {
             m_lowPowerCssInjected = true;
-            const QString lowPowerCss = QStringLiteral(
-                "(() => {"
-                "  try {"
-                "    if (document.getElementById('weread-low-power-style')) "
-                "return {ok:true, existed:true};"
-                "    const style = document.createElement('style');"
-                "    style.id = 'weread-low-power-style';"
-                "    style.textContent = `"
-                "      * {"
-                "        animation-duration: 0.001s !important;"
-                "        animation-iteration-count: 1 !important;"
-                "        transition-duration: 0s !important;"
-                "        scroll-behavior: auto !important;"
-                "      }"
-                "      html, body, .readerChapterContent, "
-                ".renderTargetContent, .readerContent {"
-                "        scroll-behavior: auto !important;"
-                "        transition: none !important;"
-                "        animation: none !important;"
-                "      }"
-                "      .loading, .mask, .reader_loading {"
-                "        transition: none !important;"
-                "        animation: none !important;"
-                "      }"
-                "    `;"
-                "    document.head.appendChild(style);"
-                "    return {ok:true, injected:true};"
-                "  } catch(e) { return {ok:false, error:String(e)}; }"
-                "})()");
-            m_view->page()->runJavaScript(lowPowerCss, [](const QVariant &res) {
+            callPageRuntime(QStringLiteral("lowPowerCss()"),
+                            [](const QVariant &res) {
               qInfo() << "[STYLE] low-power css" << res;
             });
           }
-        });
+        },
+        0);
   });
 }
 
@@ -375,7 +290,8 @@ void WereadBrowser::applyWeReadFontOverrideIfNeeded() {
   } catch(e) { return {ok:false, error:String(e)}; }
 })()
 )WR");
-  m_view->page()->runJavaScript(
+  runPageJs(
+      "fontOverride",
       js, [](const QVariant &res) { qInfo() << "[FONT_OVERRIDE]" << res; });
 }
 
@@ -403,6 +319,20 @@ void WereadBrowser::handleJsUnexpected(const QString &message,
     }
     return;
   }
+  // 外部脚本被截断：先只重取这一个脚本，重取失败才整页重载（约 30s）
+  if (repairScript(source))
+    return;
+  if (m_jsUnexpectedCount < 2) {
+    if (allowLog) {
+      qWarning() << "[JS_UNEXPECTED] reload skipped (wait for repeat)";
+    }
+    return;
+  }
+  reloadForJsError(allowLog);
+}
+
+void WereadBrowser::reloadForJsError(bool allowLog) {
+  const qint64 now = QDateTime::currentMSecsSinceEpoch();
   const bool allowReload =
       qEnvironmentVariableIsSet("WEREAD_JS_RELOAD_ON_ERROR") &&
       qEnvironmentVariableIntValue("WEREAD_JS_RELOAD_ON_ERROR") != 0;
@@ -412,12 +342,6 @@ void WereadBrowser::handleJsUnexpected(const QString &message,
     }
     return;
   }
-  if (m_jsUnexpectedCount < 2) {
-    if (allowLog) {
-      qWarning() << "[JS_UNEXPECTED] reload skipped (wait for repeat)";
-    }
-    return;
-  }
   if (now - m_jsReloadCooldownMs < 120000) {
     if (allowLog) {
       qWarning() << "[JS_UNEXPECTED] reload skipped (cooldown)";
@@ -433,13 +357,130 @@ void WereadBrowser::handleJsUnexpected(const QString &message,
   }
 }
 
+bool WereadBrowser::repairScript(const QString &source) {
+  const QUrl url(source);
+  const bool external =
+      (url.scheme() == QLatin1String("https") ||
+       url.scheme() == QLatin1String(AssetStore::kScheme)) &&
+      url.adjusted(QUrl::RemoveFragment) !=
+          currentUrl.adjusted(QUrl::RemoveFragment);
+  // 内联脚本（来源即文档）没法单独重取
+  if (!external || !m_view || !m_view->page())
+    return false;
+  if (m_scriptRepairPending == source)
+    return true; // 同一脚本的重复报错，等结果
+  if (!m_scriptRepairPending.isEmpty() ||
+      m_scriptRepairs.value(source) >= kScriptRepairAttempts)
+    return false;
+  m_scriptRepairs[source] += 1;
+  m_scriptRepairPending = source;
+  const qint64 startMs = QDateTime::currentMSecsSinceEpoch();
+  m_scriptRepairStartMs = startMs;
+
+  // 本地存储里的副本先作废，重取会经 AssetSchemeHandler 校验后重新入库
+  if (m_assetStore) {
+    m_assetStore->remove(url.scheme() == QLatin1String(AssetStore::kScheme)
+                             ? AssetStore::fromScheme(url)
+                             : url);
+  }
+  qWarning() << "[JS_REPAIR] refetch" << source << "attempt"
+             << m_scriptRepairs.value(source);
+
+  // cache:'reload' 绕过并覆盖 HTTP 缓存里的截断副本。长度只对同源、未压缩
+  // 的应答核对 Content-Length（跨域或压缩后的长度对不上不说明截断），其余
+  // 只靠解析检查；CSP 禁 eval 时跳过解析检查。no-cors 拿到的不透明应答
+  // 读不到内容，无法确认修好，算失败。通过后重新插入 <script>，结果经
+  // __wrPost 回报。
+  const QString srcJson = QString::fromUtf8(
+      QJsonDocument(QJsonArray{QJsonValue(source)})
+          .toJson(QJsonDocument::Compact));
+  const QString js = QStringLiteral(
+      "(() => {"
+      "  const src = %1[0];"
+      "  const t0 = Date.now();"
+      "  const report = (o) => {"
+      "    o.src = src; o.ms = Date.now() - t0;"
+      "    if (window.__wrPost) window.__wrPost('scriptRepaired', JSON.stringify(o));"
+      "  };"
+      "  const get = (mode) => fetch(src, {cache: 'reload', mode: mode,"
+      " credentials: 'include'});"
+      "  const reinsert = (o) => {"
+      "    const old = Array.from(document.scripts).find(s => s.src === src);"
+      "    const s = document.createElement('script');"
+      "    if (old && old.crossOrigin !== null) s.crossOrigin = old.crossOrigin;"
+      "    s.src = src;"
+      "    s.onload = () => { o.ok = true; report(o); };"
+      "    s.onerror = () => { o.ok = false; o.stage = 'exec'; report(o); };"
+      "    (document.head || document.documentElement).appendChild(s);"
+      "  };"
+      "  get('cors').catch(() => get('no-cors')).then(async (r) => {"
+      "    const o = {ok: false, stage: 'fetch', status: r.status,"
+      " bytes: -1, expected: -1};"
+      "    if (r.type === 'opaque') { o.stage = 'opaque'; return report(o); }"
+      "    if (!r.ok) return report(o);"
+      "    const buf = await r.arrayBuffer();"
+      "    const text = new TextDecoder().decode(buf);"
+      "    o.bytes = buf.byteLength;"
+      "    const len = r.headers.get('Content-Length');"
+      "    const enc = r.headers.get('Content-Encoding');"
+      "    const sameOrigin = r.type === 'basic' &&"
+      " new URL(src, location.href).origin === location.origin;"
+      "    if (sameOrigin && len !== null && (!enc || enc === 'identity'))"
+      "      o.expected = +len;"
+      "    o.stage = 'length';"
+      "    if (o.expected >= 0 && o.bytes !== o.expected) return report(o);"
+      "    o.stage = 'parse';"
+      "    try { new Function(text); } catch (e) {"
+      "      if (e instanceof SyntaxError) return report(o);"
+      "    }"
+      "    o.stage = 'done';"
+      "    reinsert(o);"
+      "  }).catch(() => report({ok: false, stage: 'fetch', status: 0,"
+      " bytes: -1, expected: -1}));"
+      "  return true;"
+      "})()")
+                         .arg(srcJson);
+  runPageJs("jsRepair", js);
+  QTimer::singleShot(kScriptRepairTimeoutMs, this, [this, source, startMs]() {
+    if (m_scriptRepairPending != source || m_scriptRepairStartMs != startMs)
+      return;
+    qWarning() << "[JS_REPAIR] no result within" << kScriptRepairTimeoutMs
+               << "ms" << source;
+    m_scriptRepairPending.clear();
+    reloadForJsError(true);
+  });
+  return true;
+}
+
+void WereadBrowser::handleScriptRepaired(const QString &json) {
+  const QJsonObject o = QJsonDocument::fromJson(json.toUtf8()).object();
+  const QString source = o.value(QStringLiteral("src")).toString();
+  if (source.isEmpty() || source != m_scriptRepairPending)
+    return; // 超时后迟到的结果，或页面自己发的
+  m_scriptRepairPending.clear();
+  const bool ok = o.value(QStringLiteral("ok")).toBool();
+  qWarning() << "[JS_REPAIR]" << (ok ? "ok" : "failed") << source << "stage"
+             << o.value(QStringLiteral("stage")).toString() << "status"
+             << o.value(QStringLiteral("status")).toInt() << "bytes"
+             << o.value(QStringLiteral("bytes")).toInteger() << "expected"
+             << o.value(QStringLiteral("expected")).toInteger() << "ms"
+             << o.value(QStringLiteral("ms")).toInteger();
+  if (ok) {
+    m_jsUnexpectedCount = 0;
+    return;
+  }
+  reloadForJsError(true);
+}
+
 void WereadBrowser::updateHeartbeat() {
   Q_UNUSED(m_isBookPage);
   // heartbeat captures disabled; keep stub to avoid timer reuse
   m_heartbeatTimer.stop();
 }
 
-void WereadBrowser::cancelPendingCaptures() { /* no-op */
+void WereadBrowser::cancelPendingCaptures() {
+  if (m_frameCapture)
+    m_frameCapture->cancel();
 }
 
 void WereadBrowser::checkContentAndRetryIfNeeded() {
@@ -466,53 +507,8 @@ void WereadBrowser::checkContentAndRetryIfNeeded() {
 void WereadBrowser::keepAliveNearChapterEnd() {
   if (!m_view || !m_view->page())
     return;
-  const QString js = QStringLiteral(
-      "(() => {"
-      "  try {"
-      "    const obs = window.__WR_CHAPTER_OBS || {};"
-      "    let source = '';"
-      "    let bookId = '';"
-      "    let idx = -1;"
-      "    let total = 0;"
-      "    let uid = null;"
-      "    if (obs && (obs.bookId || obs.chapterUid || obs.total || "
-      "obs.chapterIdx!==undefined || obs.idx!==undefined || "
-      "obs.localIdx!==undefined)) {"
-      "      source = 'observer';"
-      "      bookId = obs.bookId || '';"
-      "      uid = obs.chapterUid || null;"
-      "      if (obs.total) total = obs.total;"
-      "      if (obs.chapterIdx !== undefined) idx = obs.chapterIdx;"
-      "      if (idx < 0 && obs.idx !== undefined) idx = obs.idx;"
-      "      if (idx < 0 && obs.localIdx !== undefined) idx = obs.localIdx;"
-      "    }"
-      "    const urlMatch = (location.href || "
-      "'').match(/reader\\/([a-zA-Z0-9]+)/);"
-      "    if (!bookId) bookId = urlMatch ? urlMatch[1] : '';"
-      "    let hasLocal=false;"
-      "    let localIdx=-1;"
-      "    try {"
-      "      const lcRaw = localStorage.getItem('book:lastChapters');"
-      "      if (lcRaw) {"
-      "        hasLocal=true;"
-      "        const parsed = JSON.parse(lcRaw);"
-      "        if (bookId && parsed && parsed[bookId]!=null) {"
-      "          localIdx = parseInt(parsed[bookId]);"
-      "          if (idx < 0) idx = localIdx;"
-      "        }"
-      "      }"
-      "    } catch(e) {}"
-      "    const hasBook = !!bookId;"
-      "    const hasIdx = (idx >= 0 && total > 0);"
-      "    const ok = hasBook; // 不再强依赖 "
-      "idx/total，可部分信息缺失时仍返回 ok=true"
-      "    const reason = hasBook ? (hasIdx ? 'ok' : 'missing_idx') : "
-      "'missing_book';"
-      "    return {ok, reason, source, bookId, chapterUid: uid, idx, total, "
-      "hasLocal, localIdx, shouldPing:false};"
-      "  } catch(e) { return {ok:false, error:''+e}; }"
-      "})();");
-  m_view->page()->runJavaScript(js, [this](const QVariant &res) {
+  queuePageProbe(QStringLiteral("chapterState()"),
+                 [this](const QVariant &res) {
     const QVariantMap map = res.toMap();
     const bool ok = map.value(QStringLiteral("ok")).toBool();
     if (!ok && map.value(QStringLiteral("reason")).toString() ==
@@ -526,4 +522,31 @@ void WereadBrowser::keepAliveNearChapterEnd() {
     }
     qInfo() << "[KEEPALIVE]" << res;
   });
+  if (!isWeReadBook())
+    return;
+  // 章末预取下一章：与 chapterState 同批执行，剩余不足 3 屏时才真正发请求
+  queuePageProbe(QStringLiteral("prefetchNext(3)"),
+                 [this](const QVariant &res) {
+    const QVariantMap map = res.toMap();
+    const QString reason = map.value(QStringLiteral("reason")).toString();
+    // 离章末还有几屏（或没有预取模板、由页面自己在章末取下一章）：
+    // 下一章请求快来了，连接凉了就先预热
+    const bool nearEnd =
+        (reason == QLatin1String("far") &&
+         map.value(QStringLiteral("pagesLeft")).toDouble() <=
+             kWarmPagesAhead) ||
+        reason == QLatin1String("no_template");
+    if (nearEnd && QDateTime::currentMSecsSinceEpoch() -
+                           m_warmer.lastWarmMs() >
+                       kWarmStaleMs)
+      warmConnections(QStringLiteral("chapter_end"));
+    if (map.value(QStringLiteral("started")).toInt() > 0) {
+      qInfo() << "[PREFETCH] next chapter" << map.value(QStringLiteral("uid"))
+              << "requests" << map.value(QStringLiteral("started")).toInt()
+              << "stats" << map.value(QStringLiteral("stats"));
+    } else if (logLevelAtLeast(LogLevel::Info) &&
+               reason == QLatin1String("no_template")) {
+      qInfo() << "[PREFETCH] no content template yet" << res;
+    }
+  });
 }
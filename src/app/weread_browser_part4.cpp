@@ -4,52 +4,8 @@
 void WereadBrowser::keepAliveNearChapterEndWithRetry() {
     if (!m_view || !m_view->page())
       return;
-    const QString js = QStringLiteral(
-        "(() => {"
-        "  try {"
-        "    const obs = window.__WR_CHAPTER_OBS || {};"
-        "    let source = '';"
-        "    let bookId = '';"
-        "    let idx = -1;"
-        "    let total = 0;"
-        "    let uid = null;"
-        "    if (obs && (obs.bookId || obs.chapterUid || obs.total || "
-        "obs.chapterIdx!==undefined || obs.idx!==undefined || "
-        "obs.localIdx!==undefined)) {"
-        "      source = 'observer';"
-        "      bookId = obs.bookId || '';"
-        "      uid = obs.chapterUid || null;"
-        "      if (obs.total) total = obs.total;"
-        "      if (obs.chapterIdx !== undefined) idx = obs.chapterIdx;"
-        "      if (idx < 0 && obs.idx !== undefined) idx = obs.idx;"
-        "      if (idx < 0 && obs.localIdx !== undefined) idx = obs.localIdx;"
-        "    }"
-        "    const urlMatch = (location.href || "
-        "'').match(/reader\\/([a-zA-Z0-9]+)/);"
-        "    if (!bookId) bookId = urlMatch ? urlMatch[1] : '';"
-        "    let hasLocal=false;"
-        "    let localIdx=-1;"
-        "    try {"
-        "      const lcRaw = localStorage.getItem('book:lastChapters');"
-        "      if (lcRaw) {"
-        "        hasLocal=true;"
-        "        const parsed = JSON.parse(lcRaw);"
-        "        if (bookId && parsed && parsed[bookId]!=null) {"
-        "          localIdx = parseInt(parsed[bookId]);"
-        "          if (idx < 0) idx = localIdx;"
-        "        }"
-        "      }"
-        "    } catch(e) {}"
-        "    const hasBook = !!bookId;"
-        "    const hasIdx = (idx >= 0 && total > 0);"
-        "    const ok = hasBook; // 不再强依赖 idx/total"
-        "    const reason = hasBook ? (hasIdx ? 'ok' : 'missing_idx') : "
-        "'missing_book';"
-        "    return {ok, reason, source, bookId, chapterUid: uid, idx, total, "
-        "hasLocal, localIdx, shouldPing:false};"
-        "  } catch(e) { return {ok:false, error:''+e}; }"
-        "})();");
-    m_view->page()->runJavaScript(js, [this](const QVariant &res) {
+    queuePageProbe(QStringLiteral("chapterState()"),
+                   [this](const QVariant &res) {
       const QVariantMap map = res.toMap();
       const bool ok = map.value(QStringLiteral("ok")).toBool();
       const int total = map.value(QStringLiteral("total")).toInt();
@@ -104,26 +60,8 @@ void WereadBrowser::keepAliveNearChapterEndWithRetry() {
         // 触发重试：通过JavaScript重新触发API请求（不重新加载页面）
         if (m_view && m_view->page()) {
           // 直接调用重试函数，不等待Promise结果（因为Qt的runJavaScript不能直接处理Promise）
-          const QString retryJs = QStringLiteral(
-              "(function() {"
-              "  try {"
-              "    if (window.__WR_RETRY_BOOK_READ__) {"
-              "      window.__WR_RETRY_BOOK_READ__().then(() => {"
-              "        console.log('[RETRY] JS API retry succeeded');"
-              "      }).catch(err => {"
-              "        console.error('[RETRY] JS API retry failed:', err);"
-              "      });"
-              "      return {ok: true, method: 'js_api_retry_triggered'};"
-              "    } else {"
-              "      return {ok: false, error: 'retry_function_not_available'};"
-              "    }"
-              "  } catch(e) {"
-              "    return {ok: false, error: String(e)};"
-              "  }"
-              "})()");
-
-          m_view->page()->runJavaScript(retryJs, [this,
-                                                  bookId](const QVariant &res) {
+          callPageRuntime(QStringLiteral("retryBookRead()"),
+                          [this, bookId](const QVariant &res) {
             QVariantMap map = res.toMap();
             bool jsOk = map.value(QStringLiteral("ok")).toBool();
             if (jsOk) {
@@ -186,54 +124,106 @@ void WereadBrowser::sendKeepAlivePing(int triggerCount, int attempt) {
     }
     qInfo() << "[KEEPALIVE_PING_SCHED]"
             << "count" << triggerCount << "attempt" << attempt << "dispatch";
-    // TCP 探测：仅连接 weread.qq.com:80，不依赖页面/SSL，超时强制结束
-    QTcpSocket *sock = new QTcpSocket(this);
-    sock->setProperty("handled", false);
-    QTimer *timeout = new QTimer(sock);
-    timeout->setSingleShot(true);
-    timeout->setInterval(m_pingTimeoutMs);
-
-    auto finalize = [this, sock, triggerCount, attempt](bool ok,
-                                                        const QString &reason) {
-      if (sock->property("handled").toBool())
-        return;
-      sock->setProperty("handled", true);
-      if (ok) {
+    // 预热页面实际使用的 HTTPS 连接（同一连接池），并测 TTFB/握手耗时；
+    // 有一个 origin 通就算成功，全部失败（含页面回调超时）才算 ping 失败
+    warmConnections(QStringLiteral("page_turn"),
+                    [this, triggerCount, attempt](int ok, int failed) {
+      if (ok > 0) {
         qInfo() << "[KEEPALIVE_PING]"
                 << "count" << triggerCount << "attempt" << attempt << "ok"
-                << "status" << 200 << reason;
-      } else {
-        qWarning() << "[KEEPALIVE_PING]"
-                   << "count" << triggerCount << "attempt" << attempt << "fail"
-                   << reason << "status" << 0;
-        if (attempt < m_pingMaxRetries) {
-          QTimer::singleShot(m_pingRetryDelayMs, this,
-                             [this, triggerCount, attempt]() {
-                               sendKeepAlivePing(triggerCount, attempt + 1);
-                             });
-        } else {
-          maybeReloadAfterPingFail(triggerCount);
-        }
+                << ok << "failed" << failed;
+        return;
       }
-      if (sock->isOpen()) {
-        sock->disconnectFromHost();
+      // 一个结果都没有（期间换了文档、没有可探测的 origin）：没有结论，
+      // 重试；重试用完也不据此重载
+      const bool inconclusive = failed == 0;
+      qWarning() << "[KEEPALIVE_PING]"
+                 << "count" << triggerCount << "attempt" << attempt
+                 << (inconclusive ? "inconclusive" : "fail") << "failed"
+                 << failed;
+      if (attempt < m_pingMaxRetries) {
+        QTimer::singleShot(m_pingRetryDelayMs, this,
+                           [this, triggerCount, attempt]() {
+                             sendKeepAlivePing(triggerCount, attempt + 1);
+                           });
+      } else if (!inconclusive) {
+        maybeReloadAfterPingFail(triggerCount);
+      }
+    });
+  }
+
+
+void WereadBrowser::warmConnections(
+    const QString &reason, const std::function<void(int, int)> &done) {
+    if (!m_view || !m_view->page()) {
+      if (done)
+        done(0, 0);
+      return;
+    }
+    // 页面 origin、章节内容接口所在 origin，加上本次加载 XHR 最多的主机
+    QStringList extra;
+    for (const QString &host :
+         m_netStats.busiestHosts(UrlRuleSet::KindXhr, kWarmExtraHosts))
+      extra << QStringLiteral("https://") + host;
+    const quint64 round = ++m_warmRound;
+    m_warmer.begin(reason, QDateTime::currentMSecsSinceEpoch());
+    m_warmPending.insert(round, done);
+    // 两次 runJavaScript 各给一份宽限，外加探测自身的超时
+    QTimer::singleShot(m_pingTimeoutMs + 500 + 2 * kWarmCallbackSlackMs, this,
+                       [this, round, reason]() {
+      if (!m_warmPending.contains(round))
+        return;
+      qWarning() << "[WARM]" << reason << "round" << round
+                 << "no page callback, counted as failed";
+      finishWarmRound(round, 0, 1);
+    });
+    runPageJs("warm",
+              ConnectionWarmer::warmScript(round, m_pingTimeoutMs, extra),
+              [this, round, reason](const QVariant &res) {
+      if (!m_warmPending.contains(round))
+        return; // 已超时收尾
+      const QVariantMap map = res.toMap();
+      if (!map.value(QStringLiteral("ok")).toBool()) {
+        qWarning() << "[WARM] round" << round << "not started" << res;
+        finishWarmRound(round, 0, 1);
+        return;
       }
-      sock->deleteLater();
-    };
-
-    connect(sock, &QTcpSocket::connected, this,
-            [finalize]() { finalize(true, QStringLiteral("tcp_connect_ok")); });
-    connect(sock, &QTcpSocket::errorOccurred, this,
-            [finalize, sock](QAbstractSocket::SocketError) {
-              finalize(false, sock->errorString());
-            });
-    connect(timeout, &QTimer::timeout, this, [sock, finalize]() {
-      sock->abort();
-      finalize(false, QStringLiteral("timeout"));
+      // 探测自带 m_pingTimeoutMs 超时，之后结果必然已落在页面里
+      QTimer::singleShot(m_pingTimeoutMs + 500, this, [this, round, reason]() {
+        if (!m_warmPending.contains(round))
+          return;
+        runPageJs("warmResults", ConnectionWarmer::resultsScript(),
+                  [this, round, reason](const QVariant &res) {
+          if (!m_warmPending.contains(round))
+            return;
+          const QVariantList results = res.toList();
+          const ConnectionWarmer::RoundResult r =
+              m_warmer.addResults(results, round);
+          for (const QVariant &v : results) {
+            const QVariantMap m = v.toMap();
+            qInfo() << "[WARM]" << reason << "round" << round
+                    << m.value(QStringLiteral("origin")).toString() << "status"
+                    << m.value(QStringLiteral("status")).toInt() << "ttfb"
+                    << m.value(QStringLiteral("ttfb"), -1).toInt() << "connect"
+                    << m.value(QStringLiteral("connect"), -1).toInt() << "tls"
+                    << m.value(QStringLiteral("tls"), -1).toInt() << "reused"
+                    << m.value(QStringLiteral("reused")).toBool() << "ms"
+                    << m.value(QStringLiteral("ms")).toInt()
+                    << m.value(QStringLiteral("error")).toString();
+          }
+          // 期间换了文档时结果随旧文档丢失：ok/failed 都为 0，交给调用方
+          // 按没有结论处理
+          finishWarmRound(round, r.ok, r.failed);
+        });
+      });
     });
+  }
+
 
-    timeout->start();
-    sock->connectToHost(QStringLiteral("weread.qq.com"), 80);
+void WereadBrowser::finishWarmRound(quint64 round, int ok, int failed) {
+    const auto done = m_warmPending.take(round);
+    if (done)
+      done(ok, failed);
   }
 
 
@@ -308,7 +298,7 @@ void WereadBrowser::runDomDiagnostic() {
         "  report.controls=controls;"
         "  return report;"
         "})();");
-    m_view->page()->runJavaScript(js, [](const QVariant &res) {
+    runPageJs("domDiagnostic", js, [](const QVariant &res) {
       const auto map = res.toMap();
       qInfo() << "[DIAG] url" << map.value(QStringLiteral("url")).toString();
       const auto catalog = map.value(QStringLiteral("catalog")).toMap();
@@ -378,7 +368,8 @@ void WereadBrowser::runDedaoProbe() {
                 } catch(e) { return {error:String(e)}; }
             })()
         )";
-    m_view->page()->runJavaScript(
+    runPageJs(
+        "dedaoProbe",
         js, [](const QVariant &res) { qInfo() << "[DEDAO_PROBE]" << res; });
   }
 
@@ -433,7 +424,7 @@ void WereadBrowser::runDedaoUiFixes() {
   };
 })()
 )JS");
-    m_view->page()->runJavaScript(js, [](const QVariant &res) {
+    runPageJs("dedaoUiFixes", js, [](const QVariant &res) {
       const auto map = res.toMap();
       if (map.value(QStringLiteral("ok")).toBool()) {
         qInfo() << "[DEDAO] hide app banner" << res;
@@ -488,7 +479,7 @@ void WereadBrowser::runDedaoUiFixes() {
   return info;
 })()
 )JS");
-    m_view->page()->runJavaScript(styleJs, [this](const QVariant &res) {
+    runPageJs("dedaoUiFixes.style", styleJs, [this](const QVariant &res) {
       qInfo() << "[DEDAO_STYLE]" << res;
     });
   }
@@ -550,7 +541,7 @@ void WereadBrowser::runWeReadUiFixes() {
   return {ok: first > 0 || observed > 0, hidden: first + observed, selectors};
 })()
 )JS");
-    m_view->page()->runJavaScript(js, [](const QVariant &res) {
+    runPageJs("weReadUiFixes", js, [](const QVariant &res) {
       const auto map = res.toMap();
       if (map.value(QStringLiteral("ok")).toBool()) {
         qInfo() << "[WEREAD] hide download bar" << res;
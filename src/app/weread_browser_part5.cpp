@@ -51,6 +51,368 @@ void WereadBrowser::installDedaoDefaultSettingsScript() {
   qInfo() << "[DEDAO_DEFAULTS] script installed";
 }
 
+void WereadBrowser::installPageRuntimeScript() {
+  if (!m_view || !m_view->page())
+    return;
+  if (m_pageRuntimeScriptInstalled)
+    return;
+  // MainWorld：运行时需要读取页面侧的 __WR_CHAPTER_OBS / __WR_RETRY_BOOK_READ__
+  QWebEngineScript script;
+  script.setName(QStringLiteral("weread-page-runtime"));
+  script.setInjectionPoint(QWebEngineScript::DocumentCreation);
+  script.setWorldId(QWebEngineScript::MainWorld);
+  script.setRunsOnSubFrames(false);
+  script.setSourceCode(getPageRuntimeScript());
+  m_view->page()->scripts().insert(script);
+  m_pageRuntimeScriptInstalled = true;
+  qInfo() << "[JSRT] runtime installed bytes" << getPageRuntimeScript().size();
+}
+
+void WereadBrowser::runPageJs(
+    const char *site, const QString &script,
+    const std::function<void(const QVariant &)> &callback) const {
+  if (!m_view || !m_view->page())
+    return;
+  // 与页面内 Date.now() 同一时钟，才能拆出 queue/exec/ipc
+  const qint64 enqueueMs = QDateTime::currentMSecsSinceEpoch();
+  const QString siteName = QString::fromLatin1(site);
+  m_view->page()->runJavaScript(script, [this, siteName, enqueueMs,
+                                         callback](const QVariant &res) {
+    const qint64 recvMs = QDateTime::currentMSecsSinceEpoch();
+    JsCallProfiler::Sample sample;
+    sample.totalMs = recvMs - enqueueMs;
+    QVariant value = res;
+    qint64 jsStart = 0;
+    qint64 jsEnd = 0;
+    if (res.typeId() == QMetaType::QVariantMap) {
+      const QVariantMap map = res.toMap();
+      const QVariantList stamps = map.value(QStringLiteral("__wrt")).toList();
+      if (stamps.size() == 2) {
+        // window.__wr.$call 包装：取出真实返回值
+        jsStart = stamps.at(0).toLongLong();
+        jsEnd = stamps.at(1).toLongLong();
+        value = map.value(QStringLiteral("v"));
+      } else {
+        jsStart = map.value(QStringLiteral("t_js_start")).toLongLong();
+        jsEnd = map.value(QStringLiteral("t_js_end")).toLongLong();
+      }
+    }
+    if (jsStart > 0 && jsEnd >= jsStart) {
+      sample.queueMs = qMax<qint64>(0, jsStart - enqueueMs);
+      sample.execMs = jsEnd - jsStart;
+      sample.ipcMs = qMax<qint64>(0, recvMs - jsEnd);
+    }
+    m_jsProfiler.record(siteName, sample);
+    if (sample.totalMs > kJsSlowCallMs) {
+      qWarning().noquote() << QStringLiteral("[JSPROF] slow %1 total=%2ms "
+                                             "queue=%3 exec=%4 ipc=%5")
+                                  .arg(siteName)
+                                  .arg(sample.totalMs)
+                                  .arg(sample.queueMs)
+                                  .arg(sample.execMs)
+                                  .arg(sample.ipcMs);
+    }
+    if (callback)
+      callback(value);
+  });
+}
+
+void WereadBrowser::logJsProfile() const {
+  const QStringList lines = m_jsProfiler.summaryLines();
+  qInfo() << "[JSPROF] sites" << lines.size()
+          << "(p50/p95/p99/max ms, '-' = not reported)";
+  for (const QString &line : lines)
+    qInfo().noquote() << "[JSPROF]" << line;
+}
+
+void WereadBrowser::measureJsCompile(
+    const std::function<void(const QJsonObject &)> &done) {
+  if (!m_view || !m_view->page())
+    return;
+  // 运行时整段只在文档创建时编译一次；对比每次调用实际发送的短串
+  QJsonObject sources;
+  sources.insert(QStringLiteral("runtime"), getPageRuntimeScript());
+  sources.insert(QStringLiteral("observer"), getChapterObserverScript());
+  sources.insert(QStringLiteral("call"),
+                 runtimeCallScript(QStringLiteral("page(1)")));
+  runPageJs("jsCompile", JsCallProfiler::compileCostScript(sources, 20),
+            [done](const QVariant &res) {
+              const QJsonObject obj = QJsonObject::fromVariantMap(res.toMap());
+              qInfo().noquote()
+                  << "[JSPROF] compile (ms)"
+                  << QString::fromUtf8(
+                         QJsonDocument(obj).toJson(QJsonDocument::Compact));
+              if (done)
+                done(obj);
+            });
+}
+
+void WereadBrowser::logInkTrace() const {
+  const QStringList lines = InkLatencyTracer::instance().summaryLines();
+  for (const QString &line : lines)
+    qInfo().noquote() << "[INK_TRACE]" << line;
+}
+
+void WereadBrowser::logPagePaths() const {
+  const QStringList lines = m_pagePaths.summaryLines();
+  for (const QString &line : lines)
+    qInfo().noquote() << "[PATHSEL]" << line;
+}
+
+void WereadBrowser::collectNetEntries(const std::function<void()> &done) {
+  if (!m_view || !m_view->page()) {
+    if (done)
+      done();
+    return;
+  }
+  const quint64 seq = m_netLoadSeq;
+  runPageJs("netEntries", NetAccounting::entriesScript(),
+            [this, seq, done](const QVariant &res) {
+              // 回来时已开始新的加载：条目属于旧文档，丢弃
+              if (seq == m_netLoadSeq)
+                m_netStats.addEntries(res.toList());
+              if (done)
+                done();
+            });
+}
+
+void WereadBrowser::logNetStats() const {
+  const QStringList lines = m_netStats.summaryLines();
+  for (const QString &line : lines)
+    qInfo().noquote() << "[NETSTATS]" << line;
+}
+
+void WereadBrowser::startOfflineDownload() {
+  if (m_menu)
+    m_menu->hide();
+  if (!m_offline || !isWeReadBook()) {
+    qInfo() << "[OFFLINE] download needs an open WeRead book" << currentUrl;
+    return;
+  }
+  // 页面侧逐章重放章节内容请求（模板来自预取），结果经 offlineData 回传
+  callPageRuntime(QStringLiteral("downloadBook()"), [](const QVariant &res) {
+    qInfo() << "[OFFLINE] download" << res;
+  });
+}
+
+void WereadBrowser::handleOfflineData(const QString &json) {
+  if (!m_offline)
+    return;
+  const QJsonObject o = QJsonDocument::fromJson(json.toUtf8()).object();
+  const QString readerId = o.value(QStringLiteral("readerId")).toString();
+  // 页面脚本也能调到这个槽：只收当前打开这本书的数据
+  if (readerId.isEmpty() || OfflineArchive::readerIdOf(currentUrl) != readerId)
+    return;
+  const QString type = o.value(QStringLiteral("t")).toString();
+  if (type == QLatin1String("begin")) {
+    QList<OfflineArchive::Endpoint> eps;
+    for (const QJsonValue &v : o.value(QStringLiteral("eps")).toArray()) {
+      const QJsonObject e = v.toObject();
+      eps.append({e.value(QStringLiteral("ep")).toString(),
+                  e.value(QStringLiteral("where")).toString(),
+                  e.value(QStringLiteral("key")).toString()});
+    }
+    m_offline->beginBook(readerId, o.value(QStringLiteral("bookId")).toString(),
+                         eps, o.value(QStringLiteral("total")).toInt());
+    m_offlineDownloadReader = readerId;
+    return;
+  }
+  if (type == QLatin1String("chapter")) {
+    const QString ep = o.value(QStringLiteral("ep")).toString();
+    const QString uid = o.value(QStringLiteral("uid")).toString();
+    const QByteArray text = o.value(QStringLiteral("text")).toString().toUtf8();
+    // 页面侧已查过一遍；错误应答存进去离线时会顶替正文，这里再查一次
+    const QString bad = ep.isEmpty() || uid.isEmpty()
+                            ? QStringLiteral("missing_fields")
+                            : OfflineArchive::contentError(text);
+    const bool stored =
+        bad.isEmpty() &&
+        m_offline->putChapter(
+            readerId, ep, uid,
+            o.value(QStringLiteral("type")).toString().toLatin1(), text);
+    QStringList images;
+    for (const QJsonValue &v : o.value(QStringLiteral("images")).toArray())
+      images << v.toString();
+    if (stored)
+      m_offline->queueAssets(readerId, images);
+    else
+      qWarning() << "[OFFLINE] chapter not stored" << readerId << uid << bad;
+    const int n = o.value(QStringLiteral("n")).toInt();
+    if (n % 20 == 0 || n == o.value(QStringLiteral("total")).toInt())
+      qInfo() << "[OFFLINE] progress" << readerId << n << "/"
+              << o.value(QStringLiteral("total")).toInt();
+    return;
+  }
+  if (type == QLatin1String("end")) {
+    qInfo() << "[OFFLINE] download finished" << readerId << "done"
+            << o.value(QStringLiteral("done")).toInt() << "skipped"
+            << o.value(QStringLiteral("skipped")).toInt() << "failed"
+            << o.value(QStringLiteral("failed")).toInt() << "ms"
+            << o.value(QStringLiteral("ms")).toInteger();
+    // finishBook 落盘后的 changed 带着完整书目重新下发
+    m_offlineDownloadReader.clear();
+    m_offline->finishBook(readerId, o.value(QStringLiteral("failed")).toInt());
+    logOffline();
+  }
+}
+
+void WereadBrowser::installOfflineManifestScript(const QUrl &url) {
+  if (!m_view || !m_view->page() || !m_offline)
+    return;
+  const QString readerId = OfflineArchive::readerIdOf(url);
+  m_offlineManifestReader = readerId;
+  QWebEngineScriptCollection &scripts = m_view->page()->scripts();
+  const QString name = QStringLiteral("weread-offline-books");
+  for (const QWebEngineScript &old : scripts.find(name))
+    scripts.remove(old);
+#if QT_VERSION < QT_VERSION_CHECK(6, 7, 0)
+  // wrbook:// 应答带不了 CORS 头，页面 fetch 读不到：不下发，章节照常走网络
+  return;
+#endif
+  if (readerId.isEmpty())
+    return;
+  // 只含这本书；脚本按文档创建时注入，再核对一遍地址，防止页面已换走。
+  // 当前文档同步更新，下载完不用重载即可离线读
+  const QJsonObject manifest = m_offline->pageManifest(readerId);
+  QJsonObject books;
+  if (!manifest.isEmpty())
+    books.insert(readerId, manifest);
+  const QString js =
+      QStringLiteral("(() => {"
+                     "  if (location.origin !== '%1' ||"
+                     "      location.pathname.split('/')[3] !== '%2') return;"
+                     "  window.__WR_OFFLINE = %3;"
+                     "})();")
+          .arg(QLatin1String(OfflineArchive::kPageOrigin), readerId,
+               QString::fromUtf8(
+                   QJsonDocument(books).toJson(QJsonDocument::Compact)));
+  QWebEngineScript script;
+  script.setName(name);
+  script.setInjectionPoint(QWebEngineScript::DocumentCreation);
+  script.setWorldId(QWebEngineScript::MainWorld);
+  script.setRunsOnSubFrames(false);
+  script.setSourceCode(js);
+  scripts.insert(script);
+  runPageJs("offlineManifest", js);
+}
+
+void WereadBrowser::logOffline() const {
+  if (!m_offline)
+    return;
+  const QStringList lines = m_offline->summaryLines();
+  for (const QString &line : lines)
+    qInfo().noquote() << "[OFFLINE]" << line;
+}
+
+void WereadBrowser::logWarm() const {
+  const QStringList lines = m_warmer.summaryLines();
+  for (const QString &line : lines)
+    qInfo().noquote() << "[WARM]" << line;
+}
+
+void WereadBrowser::logUrlRules() const {
+  if (!m_interceptor)
+    return;
+  const QStringList lines = m_interceptor->rules().summaryLines();
+  for (const QString &line : lines)
+    qInfo().noquote() << "[URL_RULES]" << line;
+}
+
+QString WereadBrowser::runtimeCallScript(const QString &call) {
+  return QStringLiteral("window.__wr?window.__wr.$call(()=>window.__wr.%1):'%2'")
+      .arg(call, QLatin1String(kRuntimeMissing));
+}
+
+void WereadBrowser::callPageRuntime(
+    const QString &call,
+    const std::function<void(const QVariant &)> &callback) const {
+  if (!m_view || !m_view->page())
+    return;
+  // site 取函数名，例如 "rt.dedaoCatalog.click"
+  const int paren = call.indexOf(QLatin1Char('('));
+  const QByteArray site =
+      QByteArrayLiteral("rt.") + call.left(paren).toLatin1();
+  const QString timedCall =
+      QStringLiteral("$call(()=>window.__wr.%1)").arg(call);
+  const QString js = runtimeCallScript(call);
+  auto onResult = [this, site, timedCall, callback](const QVariant &res) {
+    if (!m_view || !m_view->page())
+      return;
+    if (res.toString() != QLatin1String(kRuntimeMissing)) {
+      if (callback)
+        callback(res);
+      return;
+    }
+    // 文档早于脚本注册创建（或被页面替换）时才会走到这里：整段补注入一次
+    qWarning() << "[JSRT] runtime missing, reinjecting for" << site;
+    runPageJs("rt.reinject",
+              getPageRuntimeScript() + QStringLiteral("\nwindow.__wr.") +
+                  timedCall,
+              callback);
+  };
+  runPageJs(site.constData(), js, onResult);
+}
+
+void WereadBrowser::queuePageProbe(
+    const QString &call,
+    const std::function<void(const QVariant &)> &callback,
+    int maxDelayMs) const {
+  if (!m_view || !m_view->page())
+    return;
+  bool merged = false;
+  for (PendingProbe &probe : m_pendingProbes) {
+    if (probe.call == call) {
+      probe.callbacks.append(callback);
+      merged = true;
+      break;
+    }
+  }
+  if (!merged)
+    m_pendingProbes.append(PendingProbe{call, {callback}});
+  const int delay = qMax(0, maxDelayMs);
+  // 已有更早的截止时间则保持，整批一起执行
+  if (m_probeBatchTimer.isActive() &&
+      m_probeBatchTimer.remainingTime() <= delay)
+    return;
+  m_probeBatchTimer.start(delay);
+}
+
+void WereadBrowser::flushPageProbes() const {
+  m_probeBatchTimer.stop();
+  if (m_pendingProbes.isEmpty())
+    return;
+  const QVector<PendingProbe> batch = std::move(m_pendingProbes);
+  m_pendingProbes.clear();
+  if (batch.size() == 1) {
+    const QVector<std::function<void(const QVariant &)>> callbacks =
+        batch.first().callbacks;
+    callPageRuntime(batch.first().call, [callbacks](const QVariant &res) {
+      for (const auto &cb : callbacks) {
+        if (cb)
+          cb(res);
+      }
+    });
+    return;
+  }
+  QStringList thunks;
+  thunks.reserve(batch.size());
+  for (const PendingProbe &probe : batch)
+    thunks << QStringLiteral("()=>window.__wr.") + probe.call;
+  qInfo() << "[PROBE_BATCH] run" << batch.size() << "probes";
+  const QString call =
+      QStringLiteral("$batch([%1])").arg(thunks.join(QLatin1Char(',')));
+  callPageRuntime(call, [batch](const QVariant &res) {
+    const QVariantList results = res.toList();
+    for (int i = 0; i < batch.size(); ++i) {
+      const QVariant value = i < results.size() ? results.at(i) : QVariant();
+      for (const auto &cb : batch.at(i).callbacks) {
+        if (cb)
+          cb(value);
+      }
+    }
+  });
+}
+
 void WereadBrowser::installSmartRefreshScript(const QString &flagName) {
   if (!m_view || !m_view->page())
     return;
@@ -77,7 +439,8 @@ void WereadBrowser::installChapterObserver() {
   if (!isBook)
     return;
   installChapterObserverScript();
-  m_view->page()->runJavaScript(
+  runPageJs(
+      "chapterObserver",
       getChapterObserverScript(),
       [](const QVariant &res) { qInfo() << "[OBS] install" << res; });
 }
@@ -131,6 +494,7 @@ void WereadBrowser::cycleUserAgentMode() {
   updateUserAgentForUrl(currentUrl);
   // 以实际生效的 UA 回填模式
   m_uaMode = detectUaMode(m_profile ? m_profile->httpUserAgent() : targetUA);
+  updatePageContext();
   m_lastReloadTs = QDateTime::currentMSecsSinceEpoch();
   qInfo() << "[UA] cycle to" << m_uaMode << "UA:" << targetUA << "reload"
           << currentUrl << "ts" << m_lastReloadTs;
@@ -168,29 +532,9 @@ void WereadBrowser::logHistoryState(const QString &tag) {
 }
 
 void WereadBrowser::logPageProbe(const QString &tag) {
-  if (!m_view || !m_view->page())
-    return;
-  const QString js = QStringLiteral(
-      "(() => {"
-      "  const url = location.href || '';"
-      "  const host = location.host || '';"
-      "  const path = location.pathname || '';"
-      "  const cont = document.querySelector('.renderTargetContent');"
-      "  const docEl = document.documentElement;"
-      "  const scrollEl = document.scrollingElement || docEl || "
-      "document.body;"
-      "  const info = {"
-      "    url, host, path,"
-      "    hasRenderTarget: !!cont,"
-      "    scrollElTag: scrollEl ? scrollEl.tagName : '',"
-      "    scrollH: scrollEl ? scrollEl.scrollHeight : 0,"
-      "    clientH: scrollEl ? scrollEl.clientHeight : 0,"
-      "    offsetH: scrollEl ? scrollEl.offsetHeight : 0,"
-      "  };"
-      "  return info;"
-      "})()");
-  m_view->page()->runJavaScript(
-      js, [tag](const QVariant &v) { qInfo() << "[PROBE]" << tag << v; });
+  queuePageProbe(QStringLiteral("pageProbe()"), [tag](const QVariant &v) {
+    qInfo() << "[PROBE]" << tag << v;
+  });
 }
 
 QString WereadBrowser::buildSmartRefreshScript(const QString &flagName) const {
@@ -214,69 +558,136 @@ QString WereadBrowser::buildSmartRefreshScript(const QString &flagName) const {
   let pendingEvents = [];
   let burstMode = false, burstTimeout = null;
   let lastReportTime = 0;
+  // 走 QWebChannel 桥（子 frame 借用同源顶层的）。拿不到桥的跨域子 frame
+  // 不上报：控制台兜底要带令牌，令牌只在顶层引导脚本的闭包里
+  const flushEvents = () => {
+  const json = JSON.stringify(pendingEvents);
+  pendingEvents = [];
+  let post = window.__wrPost;
+  if (!post && window.top !== window) {
+      try { post = window.top.__wrPost; } catch (e) {}
+  }
+  if (post) post('refreshEvents', json);
+  };
   const sendTrace = (reason, extra) => {
   const payload = Object.assign({
       t:'trace', host:host, path:path, flag:'%1',
       dedao:isDedaoSite, weread:isWeRead, reason:reason || ''
   }, extra || {});
   pendingEvents.push(payload);
-  console.log('[REFRESH_EVENTS]' + JSON.stringify(pendingEvents));
-  pendingEvents = [];
+  flushEvents();
   lastReportTime = Date.now();
   };
   sendTrace('install');
+  // 当前翻页序号（页面运行时 markTurn 写入），子 frame 读同源顶层的
+  const turnSeq = () => {
+  try {
+      const wr = window.__wr || (window.top !== window ? window.top.__wr : null);
+      return wr && wr.turnSeq ? wr.turnSeq() : 0;
+  } catch (e) { return 0; }
+  };
 
-  // MutationObserver 检测 DOM 变化（优化：减少getBoundingClientRect调用，延迟处理区域计算）
-  let pendingMutations = [];
-  const processMutations = () => {
-  if (pendingMutations.length === 0) return;
-  const mutations = pendingMutations;
-  pendingMutations = [];
-  
+  // DOM 变化打分：MutationObserver 只收集脏元素，几何由 IntersectionObserver
+  // 异步给出（intersectionRect 已按视口裁剪，不触发同步布局），视口外的变化
+  // 不计分。分数按可见面积计，整屏 = 1000，与 C++ 侧 10/100/300 阈值对应
+  // 屏幕面积的 1%/10%/30%。
+  const kFullScreenScore = 1000;
+  const kRemovalShare = 0.02;  // 每个移除节点按 2% 屏幕计，上限为容器可见面积
+  const kSizeWatchMax = 64;
+  const dirty = new Map();     // element -> 移除的子节点数（0 = 自身/内容变化）
+  const viewportArea = () =>
+      Math.max(1, (window.innerWidth || 0) * (window.innerHeight || 0));
+  const visibility = window.IntersectionObserver ? new IntersectionObserver((entries) => {
   let score = 0;
-  let regions = [];
-  for (const m of mutations) {
-      if (m.type === 'childList') {
-          score += m.addedNodes.length * 10 + m.removedNodes.length * 10;
-          // 优化：限制区域计算，只处理前5个节点，避免大量getBoundingClientRect调用影响点击响应
-          const maxNodes = 5;
-          let nodeCount = 0;
-          for (const n of m.addedNodes) {
-              if (nodeCount >= maxNodes) break;
-              if (n.nodeType === 1 && n.getBoundingClientRect) {
-                  try {
-                      const r = n.getBoundingClientRect();
-                      if (r.width > 0 && r.height > 0) {
-                          regions.push({x:r.x|0, y:r.y|0, w:Math.ceil(r.width), h:Math.ceil(r.height)});
-                          nodeCount++;
-                      }
-                  } catch(e) {}
-              }
-          }
-      } else if (m.type === 'attributes') score += 2;
-      else if (m.type === 'characterData') score += 3;
+  const regions = [];
+  for (const entry of entries) {
+      const el = entry.target;
+      visibility.unobserve(el);
+      const removed = dirty.get(el) || 0;
+      dirty.delete(el);
+      const box = entry.boundingClientRect;
+      if (removed === 0 && box.width * box.height === 0) {
+          // 还没有尺寸（图片未加载/懒渲染），等 ResizeObserver 报尺寸后再算
+          if (sizeWatch && el.isConnected) sizeWatch.watch(el);
+          continue;
+      }
+      if (!entry.isIntersecting) continue;
+      const r = entry.intersectionRect;
+      let area = r.width * r.height;
+      if (area <= 0) continue;
+      if (removed > 0) area = Math.min(area, removed * kRemovalShare * viewportArea());
+      score += Math.max(1, Math.round(area * kFullScreenScore / viewportArea()));
+      regions.push({x:r.x|0, y:r.y|0, w:Math.ceil(r.width), h:Math.ceil(r.height)});
   }
-  
   if (score > 0) {
-      pendingEvents.push({t:'dom', s:score, r:regions});
+      pendingEvents.push({t:'dom', s:Math.min(score, kFullScreenScore), r:regions,
+                         q:turnSeq()});
   }
+  }) : null;
+  const markDirty = (el, removed) => {
+  if (!el || el.nodeType !== 1) return;
+  dirty.set(el, (dirty.get(el) || 0) + removed);
+  visibility.observe(el);
   };
-  
+  const sizeWatch = (visibility && window.ResizeObserver) ? (() => {
+  const watched = new Set();
+  const ro = new ResizeObserver((entries) => {
+      for (const entry of entries) {
+          const el = entry.target;
+          const size = entry.contentRect;
+          if (!el.isConnected || size.width * size.height > 0) {
+              ro.unobserve(el);
+              watched.delete(el);
+              if (el.isConnected) markDirty(el, 0);
+          }
+      }
+  });
+  return {
+      watch(el) {
+          if (watched.has(el)) return;
+          if (watched.size >= kSizeWatchMax) {
+              const oldest = watched.values().next().value;
+              ro.unobserve(oldest);
+              watched.delete(oldest);
+          }
+          watched.add(el);
+          ro.observe(el);
+      }
+  };
+  })() : null;
+
   const observer = new MutationObserver((mutations) => {
-  // 批量收集mutations，延迟处理以减少对点击响应的影响
-  pendingMutations.push(...mutations);
-  // 使用requestIdleCallback延迟处理，如果浏览器不支持则使用setTimeout
-  if (window.requestIdleCallback) {
-      requestIdleCallback(processMutations, {timeout: 50});
-  } else {
-      setTimeout(processMutations, 0);
+  if (!visibility) {
+      // 无 IntersectionObserver 时退回按节点计数，不给区域
+      let score = 0;
+      for (const m of mutations) {
+          if (m.type === 'childList') score += (m.addedNodes.length + m.removedNodes.length) * 10;
+          else if (m.type === 'attributes') score += 2;
+          else if (m.type === 'characterData') score += 3;
+      }
+      if (score > 0) pendingEvents.push({t:'dom', s:score, r:[], q:turnSeq()});
+      return;
+  }
+  // 只登记，几何与打分在下一帧的 IntersectionObserver 回调里完成
+  for (const m of mutations) {
+      if (m.type === 'childList') {
+          for (const n of m.addedNodes) markDirty(n.nodeType === 1 ? n : m.target, 0);
+          if (m.removedNodes.length > 0) markDirty(m.target, m.removedNodes.length);
+      } else if (m.type === 'attributes') {
+          markDirty(m.target, 0);
+      } else if (m.type === 'characterData') {
+          markDirty(m.target.parentElement, 0);
+      }
   }
   });
   
   // 延迟启动观察器，等待 body 准备就绪
   const startObserver = () => {
   if (document.body) {
-      observer.observe(document.body, {childList:true, subtree:true, attributes:true, characterData:true});
+      // 只关心影响外观的属性，data-* / aria-* 之类不参与打分
+      observer.observe(document.body, {childList:true, subtree:true, attributes:true,
+                                       attributeFilter:['class', 'style', 'src', 'hidden', 'open'],
+                                       characterData:true});
   } else {
       setTimeout(startObserver, 100);
   }
@@ -310,8 +721,7 @@ QString WereadBrowser::buildSmartRefreshScript(const QString &flagName) const {
           // 实时汇报：如果距离上次汇报超过 50ms，立即发送（不等待批量窗口）
           const now = Date.now();
           if (now - lastReportTime > 50) {
-              console.log('[REFRESH_EVENTS]' + JSON.stringify(pendingEvents));
-              pendingEvents = [];
+              flushEvents();
               lastReportTime = now;
           }
       }
@@ -542,8 +952,7 @@ QString WereadBrowser::buildSmartRefreshScript(const QString &flagName) const {
   if (isWeRead || (isDedaoSite && !isDedaoReader)) {
   setInterval(() => {
   if (pendingEvents.length > 0) {
-      console.log('[REFRESH_EVENTS]' + JSON.stringify(pendingEvents));
-      pendingEvents = [];
+      flushEvents();
       lastReportTime = Date.now();
   }
   }, 100);
@@ -589,7 +998,8 @@ void WereadBrowser::logScriptInventory(bool once) {
       "    return mapped;"
       "  } catch(e) { return {error:String(e)}; }"
       "})()");
-  m_view->page()->runJavaScript(
+  runPageJs(
+      "scriptInventory",
       js, [](const QVariant &res) { qInfo() << "[SCRIPT_LIST]" << res; });
 }
 
@@ -625,7 +1035,8 @@ void WereadBrowser::logResourceEntries(bool once) {
       "    return mapped;"
       "  } catch(e) { return {error:String(e)}; }"
       "})()");
-  m_view->page()->runJavaScript(
+  runPageJs(
+      "resourceEntries",
       js, [](const QVariant &res) { qInfo() << "[RES_ENTRY]" << res; });
 }
 
@@ -638,62 +1049,12 @@ void WereadBrowser::logComputedFontOnce() {
     return;
   const bool isDedao = isDedaoBook();
   m_fontLogged = true;
-  const QString js =
-      isDedao ? QStringLiteral(
-                    "(() => {"
-                    "  try {"
-                    "    const cont = "
-                    "document.querySelector('.iget-reader-book') || "
-                    "document.querySelector('.reader-content') || "
-                    "document.querySelector('.iget-reader-container') || "
-                    "document.querySelector('.reader-body') || "
-                    "document.body;"
-                    "    const style = cont ? getComputedStyle(cont) : null;"
-                    "    let setting = {};"
-                    "    let raw = '';"
-                    "    try { raw = localStorage.getItem('readerSettings') || "
-                    "''; } catch(e) { raw = ''; }"
-                    "    if (raw) {"
-                    "      try {"
-                    "        const parsed = JSON.parse(raw);"
-                    "        if (parsed && typeof parsed === 'object') "
-                    "setting = parsed;"
-                    "      } catch(e) { setting = {}; }"
-                    "    }"
-                    "    return {"
-                    "      site: 'dedao',"
-                    "      fontFamily: style ? style.fontFamily : '',"
-                    "      fontSize: style ? style.fontSize : '',"
-                    "      fontWeight: style ? style.fontWeight : '',"
-                    "      settingFont: setting.fontFamily || '',"
-                    "      settingLevel: setting.fontLevel || '',"
-                    "      settingRaw: raw || ''"
-                    "    };"
-                    "  } catch(e) { return {error:String(e), site:'dedao'}; }"
-                    "})()")
-              : QStringLiteral(
-                    "(() => {"
-                    "  try {"
-                    "    const cont = "
-                    "document.querySelector('.renderTargetContent') || "
-                    "document.body;"
-                    "    const style = cont ? getComputedStyle(cont) : null;"
-                    "    let setting = {};"
-                    "    try { setting = "
-                    "JSON.parse(localStorage.getItem('wrLocalSetting') "
-                    "|| '{}'); } catch(e) { setting = {}; }"
-                    "    return {"
-                    "      site: 'weread',"
-                    "      fontFamily: style ? style.fontFamily : '',"
-                    "      fontSize: style ? style.fontSize : '',"
-                    "      fontWeight: style ? style.fontWeight : '',"
-                    "      settingFont: setting.fontFamily || '',"
-                    "      settingSize: setting.fontSizeLevel || ''"
-                    "    };"
-                    "  } catch(e) { return {error:String(e), site:'weread'}; }"
-                    "})()");
-  m_view->page()->runJavaScript(
-      js, [](const QVariant &res) { qInfo() << "[FONT] computed" << res; });
+  queuePageProbe(QStringLiteral("computedFont(%1)")
+                     .arg(isDedao ? QStringLiteral("true")
+                                  : QStringLiteral("false")),
+                 [](const QVariant &res) {
+                   qInfo() << "[FONT] computed" << res;
+                 });
 }
 
 void WereadBrowser::logTextScan(bool once) {
@@ -705,92 +1066,26 @@ void WereadBrowser::logTextScan(bool once) {
     return;
   if (once)
     m_textScanDone = true;
-  const QString js = QStringLiteral(
-      "(() => {"
-      "  try {"
-      "    const bodyLen = (document.body && document.body.innerText) ? "
-      "document.body.innerText.length : 0;"
-      "    let shadowText = 0;"
-      "    const all = Array.from(document.querySelectorAll('*'));"
-      "    let canvasCount = 0, imgCount = 0;"
-      "    all.forEach(el => {"
-      "      const tag = (el.tagName || '').toLowerCase();"
-      "      if (tag === 'canvas') canvasCount++;"
-      "      if (tag === 'img') imgCount++;"
-      "      if (el.shadowRoot && el.shadowRoot.innerText) shadowText += "
-      "el.shadowRoot.innerText.length;"
-      "    });"
-      "    let iframeText = 0; let iframeBlocked = 0; let iframeCount = 0;"
-      "    Array.from(document.querySelectorAll('iframe')).forEach(f => {"
-      "      iframeCount++;"
-      "      try {"
-      "        const d = f.contentDocument || (f.contentWindow && "
-      "f.contentWindow.document);"
-      "        if (d && d.body && d.body.innerText) iframeText += "
-      "d.body.innerText.length;"
-      "      } catch(_) { iframeBlocked++; }"
-      "    });"
-      "    // 也统计 renderTarget/readerChapter 节点长度，方便对比"
-      "    const core = document.querySelector('.renderTargetContent') || "
-      "document.querySelector('.readerChapterContent');"
-      "    const coreLen = core ? ((core.innerText||'').length) : 0;"
-      "    return {bodyLen, shadowText, iframeText, iframeCount, "
-      "iframeBlocked, canvasCount, imgCount};"
-      "  } catch(e) { return {error:String(e)}; }"
-      "})()");
-  m_view->page()->runJavaScript(js, [](const QVariant &res) {
+  queuePageProbe(QStringLiteral("textScan()"), [](const QVariant &res) {
     qWarning().noquote() << "[TEXT_SCAN]" << res;
   });
 }
 
-void WereadBrowser::weReadScroll(bool forward) {
+void WereadBrowser::weReadScroll(int seq, int pages) {
   if (!m_view || !m_view->page()) {
-    m_navigating = false;
+    m_pageTurn.complete(seq, pages);
     return;
   }
-  const int currentSeq = ++m_navSequence;
-  m_navigating = true;
-  const int stepPx =
-      qRound((m_view ? m_view->height() : 1600) * (forward ? 0.8 : -0.8));
+  const bool forward = pages > 0;
   const qint64 cppSend = QDateTime::currentMSecsSinceEpoch();
   qInfo() << "[PAGER] weRead scroll dispatch"
-          << "forward" << forward << "step" << stepPx << "seq" << currentSeq
-          << "ts" << cppSend;
-
-  QTimer::singleShot(1200, this, [this, currentSeq]() {
-    if (m_navigating && m_navSequence == currentSeq) {
-      m_navigating = false;
-      qWarning() << "[PAGER] weRead force unlock (timeout 1200ms) seq"
-                 << currentSeq;
-    }
-  });
+          << "pages" << pages << "seq" << seq << "ts" << cppSend;
 
-  const QString js = QStringLiteral(
-                         R"(
-            (() => {
-                try {
-                    const t_js_start = Date.now();
-                    const step = %1;
-                    const el = document.querySelector('.renderTargetContent') || document.scrollingElement || document.documentElement;
-                    if (!el) return {ok:false, reason:'no-container'};
-                    const before = el.scrollTop || 0;
-                    el.scrollBy(0, step);
-                    const after = el.scrollTop || 0;
-                    // 对齐到行高整数倍，减少半截行
-                    const sample = el.querySelector('p, div, span');
-                    const lh = sample ? parseFloat(getComputedStyle(sample).lineHeight)||32 : 32;
-                    const padTop = parseFloat(getComputedStyle(el).paddingTop)||0;
-                    const aligned = Math.max(0, Math.round((after - padTop)/lh)*lh + padTop);
-                    if (Math.abs(aligned - after) > 0.5) el.scrollTo({top: aligned, behavior:'auto'});
-                    const t_js_end = Date.now();
-                    return {ok:true, before, after:aligned, delta: aligned-before, t_js_start, t_js_end, tag: el.tagName};
-                } catch(e) { return {ok:false, error:String(e)}; }
-            })()
-            )")
-                         .arg(stepPx);
-
-  m_view->page()->runJavaScript(
-      js, [this, cppSend, currentSeq, forward](const QVariant &res) {
+  // 步长（0.8 屏、按行对齐）由页面内缓存的几何模型给出，N 页也只一次 scrollTo
+  callPageRuntime(
+      QStringLiteral("page(%1)").arg(pages),
+      [this, cppSend, seq, pages, forward](const QVariant &res) {
+        InkLatencyTracer::instance().mark(InkLatencyTracer::JsDone);
         const qint64 cppRecv = QDateTime::currentMSecsSinceEpoch();
         const QVariantMap m = res.toMap();
         const qint64 jsStart =
@@ -824,45 +1119,23 @@ void WereadBrowser::weReadScroll(bool forward) {
                                    .arg(delta);
         }
         if (isWeReadBook() && delta == 0) {
+          m_pagePaths.noteFailure(seq);
           qWarning().noquote() << QString("[PAGER] weRead scroll delta=0, "
                                           "fallback to pager button (%1)")
                                       .arg(forward ? QStringLiteral("next")
                                                    : QStringLiteral("prev"));
-          const QString clickJs =
-              forward
-                  ? QStringLiteral(
-                        "(() => {"
-                        "  const btn = "
-                        "document.querySelector('.renderTarget_pager_button_"
-                        "right');"
-                        "  if (!btn) return {ok:false, reason:'no-next-btn'};"
-                        "  const span = btn.querySelector('span') || btn;"
-                        "  "
-                        "['pointerdown','pointerup','click'].forEach(t=>span."
-                        "dispatchEvent(new "
-                        "PointerEvent(t,{bubbles:true,cancelable:true})));"
-                        "  return {ok:true, action:'next'};"
-                        "})()")
-                  : QStringLiteral(
-                        "(() => {"
-                        "  const btn = "
-                        "document.querySelector('.renderTarget_pager_button');"
-                        "  if (!btn) return {ok:false, reason:'no-prev-btn'};"
-                        "  const span = btn.querySelector('span') || btn;"
-                        "  "
-                        "['pointerdown','pointerup','click'].forEach(t=>span."
-                        "dispatchEvent(new "
-                        "PointerEvent(t,{bubbles:true,cancelable:true})));"
-                        "  return {ok:true, action:'prev'};"
-                        "})()");
-          m_view->page()->runJavaScript(clickJs, [forward](const QVariant &r) {
-            qInfo() << "[PAGER] weRead pager fallback result"
-                    << (forward ? "next" : "prev") << r;
-          });
-        }
-        if (m_navSequence == currentSeq) {
-          m_navigating = false;
+          callPageRuntime(QStringLiteral("pagerPointer(%1)")
+                              .arg(forward ? QStringLiteral("true")
+                                           : QStringLiteral("false")),
+                          [forward](const QVariant &r) {
+                            qInfo() << "[PAGER] weRead pager fallback result"
+                                    << (forward ? "next" : "prev") << r;
+                          });
+          // 按钮只翻一页，其余页数由控制器排到下一轮
+          m_pageTurn.complete(seq, forward ? 1 : -1);
+          return;
         }
+        m_pageTurn.complete(seq, pages);
       });
 }
 
@@ -872,17 +1145,9 @@ void WereadBrowser::triggerStalledRescue(const QString &reason, int chapterLen,
     return;
   m_stallRescueTriggered = true;
   const int seq = ++m_rescueSeq;
-  const QString js = QStringLiteral(
-      "(() => {"
-      "  const btn = "
-      "document.querySelector('.renderTarget_pager_button_right');"
-      "  if (btn && btn.click) { btn.click(); return {ok:true, "
-      "action:'click-next'}; }"
-      "  location.reload();"
-      "  return {ok:true, action:'reload'};"
-      "})()");
-  m_view->page()->runJavaScript(js, [this, seq, reason, chapterLen, bodyLen,
-                                     pollCount](const QVariant &res) {
+  callPageRuntime(QStringLiteral("stalledRescue()"),
+                  [seq, reason, chapterLen, bodyLen,
+                   pollCount](const QVariant &res) {
     qWarning() << "[RESCUE] stalled seq" << seq << "reason" << reason
                << "pollCount" << pollCount << "chapterLen" << chapterLen
                << "bodyLen" << bodyLen << res;
@@ -892,62 +1157,11 @@ void WereadBrowser::triggerStalledRescue(const QString &reason, int chapterLen,
 // 会话恢复方法实现（类外实现）
 
 void WereadBrowser::openDedaoMenu() {
-
   if (!isDedaoBook() || !m_view || !m_view->page())
-
     return;
-
-  const QString js = R"(
-
-        (function() {
-
-            try {
-
-                window.scrollTo(0,0);
-
-                const toolbar = document.querySelector('.iget-reader-toolbar');
-
-                const btn = Array.from(toolbar ? toolbar.querySelectorAll('button,[role=button]') : [])
-
-                    .find(b => ((b.innerText||'').includes('设置')) || (b.className||'').includes('iget-icon-font'));
-
-                if (btn && btn.click) {
-
-                    btn.click();
-
-                    setTimeout(() => {
-
-                        const panel = document.querySelector('.set-tool-box');
-
-                        if (panel) {
-
-                            panel.style.cssText += '; display:block !important; visibility:visible !important; opacity:1 !important;'
-
-                                + ' z-index:99999 !important; position:fixed !important; top:15% !important; left:10% !important; width:80% !important;'
-
-                                + ' min-width:300px !important; min-height:150px !important; background:#fff !important; border:2px solid #000 !important;';
-
-                            console.log('[MENU_FIX] Styles forced');
-
-                        }
-
-                    }, 50);
-
-                    return {ok:true, action:'clicked'};
-
-                }
-
-                return {ok:false, reason:'no-btn'};
-
-            } catch(e) { return {ok:false, error:String(e)}; }
-
-        })()
-
-    )";
-
-  m_view->page()->runJavaScript(
-
-      js, [](const QVariant &res) { qInfo() << "[MENU] dedao open" << res; });
+  callPageRuntime(QStringLiteral("dedaoOpenMenu()"), [](const QVariant &res) {
+    qInfo() << "[MENU] dedao open" << res;
+  });
 }
 
 QString WereadBrowser::getSessionStatePath() {
@@ -1110,8 +1324,8 @@ void WereadBrowser::saveSessionState() const {
   }
 
   // 通过 JavaScript 获取滚动位置
-  m_view->page()->runJavaScript(
-      QStringLiteral("({url: window.location.href, scrollY: window.scrollY})"),
+  queuePageProbe(
+      QStringLiteral("sessionState()"),
       [this, now](const QVariant &result) {
         const QJsonObject obj = result.toJsonObject();
         const QString urlStr = obj.value("url").toString();
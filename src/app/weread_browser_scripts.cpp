@@ -265,7 +265,8 @@ const QString &chapterObserverScriptSource() {
       }
       markCurrentInList();
       try {
-        console.log('[OBS] chapterInfos mapped', list.length);
+        if (window.__wrPost) window.__wrPost('chapterInfosMapped', list.length);
+        else console.log('[OBS] chapterInfos mapped', list.length);
         if (!obs.chapterInfosLogged) {
           obs.chapterInfosLogged = true;
           const dataKeys = data && typeof data === 'object'
@@ -278,6 +279,402 @@ const QString &chapterObserverScriptSource() {
     } catch (e) {}
   }
 
+  // ---- next-chapter prefetch ----
+  // Chapter content requests are recorded as templates: endpoint, method,
+  // headers and the body/query field that carries a known chapterUid. Near
+  // the end of a chapter the template is replayed with the next uid through
+  // the unhooked fetch, and the hooked fetch/XHR answer the page's own
+  // request for that chapter from the stored response. Bodies whose uid is
+  // encoded never match idxByUid and produce no template.
+  const pf = window.__WR_PREFETCH = window.__WR_PREFETCH || {
+    templates: {}, cache: {}, inflight: {}, failedAt: {},
+    stats: {recorded: 0, fetched: 0, hits: 0, failed: 0}
+  };
+  const PF_TTL_MS = 10 * 60 * 1000;
+  const PF_RETRY_MS = 60 * 1000;
+  const PF_MAX_ENTRIES = 8;
+
+  function isContentUrl(lowerUrl) {
+    return lowerUrl.indexOf('/book/chapter/') !== -1;
+  }
+
+  function endpointOf(method, url) {
+    try {
+      const u = new URL(url, location.href);
+      return String(method || 'GET').toUpperCase() + ' ' + u.origin + u.pathname;
+    } catch (e) {
+      return '';
+    }
+  }
+
+  // A field counts as the chapter uid when its value is a known uid and its
+  // name says so, or it equals the uid the reader is on.
+  function uidFieldOf(url, body) {
+    const known = obs.idxByUid || {};
+    const cur = obs.chapterUid != null ? String(obs.chapterUid) : '';
+    const looksUid = (k, v) => known[v] != null &&
+      (/uid|chapter/i.test(k) || v === cur);
+    try {
+      if (typeof body === 'string' && body) {
+        const obj = JSON.parse(body);
+        if (obj && typeof obj === 'object' && !Array.isArray(obj)) {
+          for (const k of Object.keys(obj)) {
+            const v = obj[k];
+            if ((typeof v === 'string' || typeof v === 'number') &&
+                looksUid(k, String(v))) {
+              return {where: 'body', key: k, uid: String(v)};
+            }
+          }
+        }
+      }
+    } catch (e) {}
+    try {
+      const u = new URL(url, location.href);
+      for (const [k, v] of u.searchParams) {
+        if (looksUid(k, v)) return {where: 'query', key: k, uid: v};
+      }
+    } catch (e) {}
+    return null;
+  }
+
+  // Shape of a template: method, uid field, header names and body/query
+  // field names, not their values. WeRead signs every content request with
+  // a timestamp, so hashing values would never match; a changed shape means
+  // the page now asks differently and older prefetched bodies do not apply.
+  function templateShape(t) {
+    let fields = [];
+    try {
+      if (t.body) {
+        const obj = JSON.parse(t.body);
+        if (obj && typeof obj === 'object') fields = Object.keys(obj);
+      }
+    } catch (e) { fields = ['<raw>']; }
+    try {
+      const u = new URL(t.url, location.href);
+      for (const k of u.searchParams.keys()) fields.push('?' + k);
+    } catch (e) {}
+    const text = [t.method, t.where, t.key, Object.keys(t.headers || {}).sort().join(','),
+                  fields.sort().join(',')].join('|');
+    let h = 0x811c9dc5; // FNV-1a
+    for (let i = 0; i < text.length; i++) {
+      h ^= text.charCodeAt(i);
+      h = Math.imul(h, 0x01000193) >>> 0;
+    }
+    return h.toString(16);
+  }
+
+  function prefetchKey(bookId, ep, uid, t) {
+    return bookId + '|' + ep + '|' + uid + '|' + templateShape(t);
+  }
+
+  // '' if a content response body can be handed to the page, else why not.
+  // Failures come back as HTTP 200 with a JSON error object ({errCode},
+  // {succ: false}, an expired signature); chapter content itself is either
+  // an encoded string or a JSON object with fields beyond the status ones.
+  function contentError(text) {
+    if (typeof text !== 'string' || !text.trim()) return 'empty';
+    const head = text.trimStart().charAt(0);
+    if (head !== '{' && head !== '[') return '';
+    let obj = null;
+    try { obj = JSON.parse(text); } catch (e) { return 'bad_json'; }
+    if (!obj || typeof obj !== 'object') return 'bad_json';
+    if (Array.isArray(obj)) return obj.length ? '' : 'empty';
+    const code = obj.errCode != null ? obj.errCode : obj.errcode;
+    if (code != null && Number(code) !== 0) return 'errCode ' + code;
+    if (obj.succ === false || obj.success === false) return 'succ_false';
+    const status = {errCode: 1, errcode: 1, errMsg: 1, errmsg: 1, msg: 1,
+                    succ: 1, success: 1, code: 1};
+    if (!Object.keys(obj).some(k => !status[k])) return 'no_content';
+    return '';
+  }
+
+  // Records the template and returns the cache key of this request.
+  function contentRequest(method, url, body, headers) {
+    try {
+      const f = uidFieldOf(url, body);
+      if (!f) return '';
+      const ep = endpointOf(method, url);
+      if (!ep) return '';
+      if (!pf.templates[ep]) {
+        pf.stats.recorded++;
+        console.log('[PREFETCH] template', ep, f.where, f.key);
+      }
+      const t = pf.templates[ep] = {
+        method: String(method || 'GET').toUpperCase(),
+        url: String(url),
+        body: typeof body === 'string' ? body : '',
+        headers: headers || {},
+        where: f.where,
+        key: f.key,
+        bookId: obs.bookId || ''
+      };
+      return prefetchKey(t.bookId, ep, f.uid, t);
+    } catch (e) {
+      return '';
+    }
+  }
+
+  function takePrefetched(key) {
+    const entry = key ? pf.cache[key] : null;
+    if (!entry) return null;
+    delete pf.cache[key];
+    if (Date.now() - entry.at > PF_TTL_MS) return null;
+    pf.stats.hits++;
+    try { console.log('[PREFETCH] hit', key); } catch (e) {}
+    return entry;
+  }
+
+  function storePrefetched(key, entry) {
+    pf.cache[key] = entry;
+    const keys = Object.keys(pf.cache);
+    if (keys.length <= PF_MAX_ENTRIES) return;
+    keys.sort((a, b) => pf.cache[a].at - pf.cache[b].at);
+    keys.slice(0, keys.length - PF_MAX_ENTRIES).forEach(k => delete pf.cache[k]);
+  }
+
+  // {method, url, body, headers} of a fetch() content request, else null
+  function fetchRequestOf(args) {
+    try {
+      const a0 = args && args[0];
+      const init = (args && args[1]) || {};
+      const url = typeof a0 === 'string' ? a0
+                : (a0 && a0.url) ? String(a0.url) : String(a0 || '');
+      if (!isContentUrl(url.toLowerCase())) return null;
+      const method = init.method || (a0 && a0.method) || 'GET';
+      const headers = {};
+      try {
+        new Headers(init.headers || {}).forEach((v, k) => { headers[k] = v; });
+      } catch (e) {}
+      return {method, url, headers,
+              body: typeof init.body === 'string' ? init.body : ''};
+    } catch (e) {
+      return null;
+    }
+  }
+
+  function fetchContentKey(req) {
+    return req ? contentRequest(req.method, req.url, req.body, req.headers) : '';
+  }
+
+  function rawFetchOf() {
+    const ref = window.__wr_fetch_ref;
+    return (ref && ref.__wr_orig) || window.fetch;
+  }
+
+  // ---- offline book ----
+  // window.__WR_OFFLINE (host script, see OfflineArchive::pageManifest):
+  // {readerId: {eps: [{ep, where, key}], have: {"<n>/<uid>": 1}}}, only the
+  // book this reader page shows. A content
+  // request whose endpoint and uid are archived is answered from
+  // wrbook://book/<readerId>/c/<n>/<uid>; the archive lookup does not need
+  // chapterInfos, so it also works when that request fails offline.
+  function offlineUrlOf(req) {
+    try {
+      const books = window.__WR_OFFLINE;
+      const m = req && books && obs.readerId ? books[obs.readerId] : null;
+      if (!m) return '';
+      const ep = endpointOf(req.method, req.url);
+      for (let n = 0; n < m.eps.length; n++) {
+        const t = m.eps[n];
+        if (t.ep !== ep) continue;
+        let uid = null;
+        if (t.where === 'body') {
+          const obj = JSON.parse(req.body || '{}');
+          uid = obj && obj[t.key] != null ? String(obj[t.key]) : null;
+        } else {
+          uid = new URL(req.url, location.href).searchParams.get(t.key);
+        }
+        if (uid && m.have[n + '/' + uid]) {
+          return 'wrbook://book/' + obs.readerId + '/c/' + n + '/' +
+                 encodeURIComponent(uid);
+        }
+      }
+    } catch (e) {}
+    return '';
+  }
+
+  // Completes an XHR from a stored response: the fields axios and friends
+  // read, then readystatechange/load/loadend on the next task.
+  function serveXhr(xhr, entry) {
+    const def = (k, v) => {
+      try { Object.defineProperty(xhr, k, {configurable: true, get: () => v}); }
+      catch (e) {}
+    };
+    let response = entry.text;
+    if (xhr.responseType === 'json') {
+      try { response = JSON.parse(entry.text); } catch (e) { response = null; }
+    }
+    def('readyState', 4);
+    def('status', 200);
+    def('statusText', 'OK');
+    def('responseURL', entry.url);
+    def('responseText', entry.text);
+    def('response', response);
+    xhr.getAllResponseHeaders = () =>
+      entry.type ? 'content-type: ' + entry.type + '\r\n' : '';
+    xhr.getResponseHeader = (name) =>
+      String(name).toLowerCase() === 'content-type' ? (entry.type || null) : null;
+    setTimeout(() => {
+      ['readystatechange', 'load', 'loadend'].forEach(t => {
+        try { xhr.dispatchEvent(new ProgressEvent(t)); } catch (e) {}
+      });
+    }, 0);
+  }
+
+  function nextChapterUid() {
+    const cur = obs.chapterUid != null ? String(obs.chapterUid) : '';
+    const idxByUid = obs.idxByUid || {};
+    const uidByIdx = obs.uidByIdx || [];
+    const idx = (cur && idxByUid[cur] != null) ? idxByUid[cur]
+                                                : toNum(obs.chapterIdx);
+    if (idx === null) return '';
+    for (let i = idx + 1; i < uidByIdx.length; i++) {
+      if (uidByIdx[i] != null) return String(uidByIdx[i]);
+    }
+    return '';
+  }
+
+  function requestFor(t, uid) {
+    if (t.where === 'body') {
+      const obj = JSON.parse(t.body);
+      obj[t.key] = typeof obj[t.key] === 'number' ? Number(uid) : uid;
+      return {url: t.url, body: JSON.stringify(obj)};
+    }
+    const u = new URL(t.url, location.href);
+    u.searchParams.set(t.key, uid);
+    return {url: u.toString(), body: t.body};
+  }
+
+  if (!pf.prefetchNext) {
+    pf.prefetchNext = () => {
+      const uid = nextChapterUid();
+      if (!uid) return {ok: false, reason: 'no_next'};
+      const bookId = obs.bookId || '';
+      const eps = Object.keys(pf.templates)
+        .filter(ep => pf.templates[ep].bookId === bookId);
+      if (!eps.length) return {ok: false, reason: 'no_template', uid};
+      const rawFetch = rawFetchOf();
+      const now = Date.now();
+      let started = 0;
+      eps.forEach(ep => {
+        const t = pf.templates[ep];
+        const key = prefetchKey(bookId, ep, uid, t);
+        if (pf.cache[key] || pf.inflight[key]) return;
+        if (pf.failedAt[key] && now - pf.failedAt[key] < PF_RETRY_MS) return;
+        let req = null;
+        try { req = requestFor(t, uid); } catch (e) { return; }
+        const init = {method: t.method, credentials: 'include', headers: t.headers};
+        if (t.method !== 'GET' && t.method !== 'HEAD') init.body = req.body;
+        pf.inflight[key] = true;
+        started++;
+        rawFetch.call(window, req.url, init).then(resp => {
+          if (!resp.ok) throw new Error('status ' + resp.status);
+          const type = resp.headers.get('content-type') || '';
+          return resp.text().then(text => {
+            // never hand an error body to the page in place of its own fetch
+            const bad = contentError(text);
+            if (bad) throw new Error(bad);
+            storePrefetched(key, {url: resp.url || req.url, type, text, at: Date.now()});
+            pf.stats.fetched++;
+            delete pf.failedAt[key];
+            console.log('[PREFETCH] stored', key, text.length);
+          });
+        }).catch(err => {
+          pf.stats.failed++;
+          pf.failedAt[key] = Date.now();
+          try { console.log('[PREFETCH] failed', key, String(err)); } catch (e) {}
+        }).finally(() => { delete pf.inflight[key]; });
+      });
+      return {ok: true, uid, started, cached: Object.keys(pf.cache).length,
+              stats: pf.stats};
+    };
+  }
+
+  // Replays every content template for every chapter in chapterInfos, one
+  // request at a time with a short gap, and posts each response to the host
+  // archive together with the image URLs found in it. Chapters the archive
+  // already has are skipped, so a broken download resumes where it stopped.
+  const OFFLINE_GAP_MS = 300;
+  const OFFLINE_IMAGE_RE = /https:\/\/[^\s"'<>()\\]+?\.(?:png|jpe?g|gif|webp|svg)(?:\?[^\s"'<>()\\]*)?/gi;
+
+  if (!pf.downloadBook) {
+    pf.downloadBook = () => {
+      if (pf.download && pf.download.running) {
+        const d = pf.download;
+        return {ok: false, reason: 'running', done: d.done, total: d.total};
+      }
+      if (!window.__wrPost) return {ok: false, reason: 'no_bridge'};
+      const bookId = obs.bookId || '';
+      const readerId = obs.readerId || '';
+      const uids = (obs.uidByIdx || []).filter(u => u != null).map(String);
+      if (!readerId || !uids.length) return {ok: false, reason: 'no_chapters'};
+      const eps = Object.keys(pf.templates)
+        .filter(ep => pf.templates[ep].bookId === bookId);
+      if (!eps.length) return {ok: false, reason: 'no_template'};
+      const archived = (window.__WR_OFFLINE || {})[readerId] || {eps: [], have: {}};
+      const archivedEps = archived.eps.map(e => e.ep);
+      const post = (o) => {
+        o.readerId = readerId;
+        o.bookId = bookId;
+        const json = JSON.stringify(o);
+        // bridge only: an untokened console line would be dropped
+        window.__wrPost('offlineData', json);
+      };
+      const jobs = [];
+      let skipped = 0;
+      uids.forEach(uid => eps.forEach(ep => {
+        const n = archivedEps.indexOf(ep);
+        if (n >= 0 && archived.have[n + '/' + uid]) skipped++;
+        else jobs.push([ep, uid]);
+      }));
+      const d = pf.download = {running: true, total: jobs.length + skipped,
+                               done: 0, skipped, failed: 0, at: Date.now()};
+      post({t: 'begin', total: d.total, chapters: uids.length,
+            eps: eps.map(ep => ({ep, where: pf.templates[ep].where,
+                                 key: pf.templates[ep].key}))});
+      const rawFetch = rawFetchOf();
+      const next = () => {
+        const job = jobs.shift();
+        if (!job) {
+          d.running = false;
+          post({t: 'end', total: d.total, done: d.done, skipped: d.skipped,
+                failed: d.failed, ms: Date.now() - d.at});
+          return;
+        }
+        const [ep, uid] = job;
+        const t = pf.templates[ep];
+        let req = null;
+        try { req = requestFor(t, uid); } catch (e) {
+          d.failed++;
+          next();
+          return;
+        }
+        const init = {method: t.method, credentials: 'include', headers: t.headers};
+        if (t.method !== 'GET' && t.method !== 'HEAD') init.body = req.body;
+        rawFetch.call(window, req.url, init).then(resp => {
+          if (!resp.ok) throw new Error('status ' + resp.status);
+          const type = resp.headers.get('content-type') || '';
+          return resp.text().then(text => {
+            // an error body would replace the chapter when read offline
+            const bad = contentError(text);
+            if (bad) throw new Error(bad);
+            const plain = text.replace(/\\\//g, '/');
+            const images = Array.from(new Set(plain.match(OFFLINE_IMAGE_RE) || []));
+            post({t: 'chapter', ep, uid, type, text, images: images.slice(0, 64),
+                  n: d.skipped + d.done + d.failed + 1, total: d.total});
+            d.done++;
+          });
+        }).catch(err => {
+          d.failed++;
+          try { console.log('[OFFLINE] failed', ep, uid, String(err)); } catch (e) {}
+        }).finally(() => setTimeout(next, OFFLINE_GAP_MS));
+      };
+      next();
+      return {ok: true, total: d.total, chapters: uids.length,
+              endpoints: eps.length, skipped};
+    };
+  }
+
   function extractUrl(resp, args) {
     try {
       if (resp && resp.url) return String(resp.url);
@@ -304,6 +701,21 @@ const QString &chapterObserverScriptSource() {
       if (typeof fn !== 'function') return fn;
       if (fn.__wr_hooked) return fn;
       const wrapped = function(...args) {
+        const req = fetchRequestOf(args);
+        const key = fetchContentKey(req);
+        const offline = offlineUrlOf(req);
+        if (offline) {
+          return fn.call(this, offline)
+            .then(r => r.ok ? r : Promise.reject(new Error('miss')))
+            .catch(() => fn.apply(this, args));
+        }
+        const hit = takePrefetched(key);
+        if (hit) {
+          return Promise.resolve(new Response(hit.text, {
+            status: 200,
+            headers: hit.type ? {'content-type': hit.type} : {}
+          }));
+        }
         return fn.apply(this, args).then(resp => {
           try {
             const urlStr = extractUrl(resp, args);
@@ -373,15 +785,52 @@ const QString &chapterObserverScriptSource() {
       if (proto.open && !proto.open.__wr_hooked) {
         const origOpen = proto.open;
         const openWrapper = function(method, url) {
+          this.__wr_method = method;
           this.__wr_url = url;
+          this.__wr_headers = {};
           return origOpen.apply(this, arguments);
         };
         openWrapper.__wr_hooked = true;
         proto.open = openWrapper;
       }
+      if (proto.setRequestHeader && !proto.setRequestHeader.__wr_hooked) {
+        const origSetHeader = proto.setRequestHeader;
+        const setHeaderWrapper = function(name, value) {
+          try {
+            if (this.__wr_headers) this.__wr_headers[String(name)] = String(value);
+          } catch (e) {}
+          return origSetHeader.apply(this, arguments);
+        };
+        setHeaderWrapper.__wr_hooked = true;
+        proto.setRequestHeader = setHeaderWrapper;
+      }
       if (proto.send && !proto.send.__wr_hooked) {
         const origSend = proto.send;
-        const sendWrapper = function() {
+        const sendWrapper = function(body) {
+          const urlStr0 = this.__wr_url ? String(this.__wr_url) : '';
+          if (isContentUrl(urlStr0.toLowerCase())) {
+            const offline = offlineUrlOf({
+              method: this.__wr_method || 'GET', url: urlStr0,
+              body: typeof body === 'string' ? body : ''});
+            if (offline) {
+              const xhr = this;
+              const sendArgs = arguments;
+              rawFetchOf().call(window, offline).then(r => {
+                if (!r.ok) throw new Error('miss');
+                const type = r.headers.get('content-type') || '';
+                return r.text().then(text =>
+                  serveXhr(xhr, {url: urlStr0, type, text}));
+              }).catch(() => origSend.apply(xhr, sendArgs));
+              return undefined;
+            }
+            const hit = takePrefetched(contentRequest(
+                this.__wr_method, urlStr0,
+                typeof body === 'string' ? body : '', this.__wr_headers));
+            if (hit) {
+              serveXhr(this, hit);
+              return undefined;
+            }
+          }
           this.addEventListener('load', function() {
             try {
               const urlStr = this.__wr_url ? String(this.__wr_url) : '';
@@ -705,6 +1154,963 @@ const QString &dedaoDefaultSettingsScriptSource() {
   static const QString js = QString::fromUtf8(kDedaoDefaultSettingsScript);
   return js;
 }
+// Persistent page runtime: installed once per document so C++ only ships
+// short call strings like `window.__wr.scroll(1357)` instead of rebuilding
+// and recompiling each helper script on every action.
+static const char kPageRuntimeScript[] = R"WR(
+(() => {
+  const VERSION = 8;
+  if (window.__wr && window.__wr.version === VERSION) return;
+  const installStart = performance.now();
+  // 默认只留 250 条 resource timing，书籍页一次打开就会超出（网络统计要用）
+  try { performance.setResourceTimingBufferSize(2000); } catch (e) {}
+  const normalize = (s) => String(s || '').replace(/\s+/g, ' ').trim();
+  const q = (sel) => document.querySelector(sel);
+  const qa = (sel, root) => Array.from((root || document).querySelectorAll(sel));
+  const textMatch = (el, key) => {
+    const text = (el && el.innerText) ? el.innerText.trim() : '';
+    return text.indexOf(key) !== -1;
+  };
+  const isVisible = (el) => {
+    if (!el) return false;
+    const style = window.getComputedStyle ? getComputedStyle(el) : null;
+    if (style) {
+      if (style.display === 'none' || style.visibility === 'hidden' || style.opacity === '0') {
+        return false;
+      }
+      if (style.pointerEvents === 'none') return false;
+    }
+    const rect = el.getBoundingClientRect ? el.getBoundingClientRect() : null;
+    if (rect && (rect.width === 0 || rect.height === 0)) return false;
+    return true;
+  };
+  const firePointerClick = (el) => {
+    ['pointerdown','pointerup','click'].forEach(t => el.dispatchEvent(
+      new PointerEvent(t, {bubbles:true, cancelable:true})));
+  };
+
+  const rt = {version: VERSION};
+
+  // Timing envelope read back by the C++ profiler (runPageJs unwraps it).
+  rt.$call = (fn) => {
+    const t0 = Date.now();
+    const v = fn();
+    return {__wrt: [t0, Date.now()], v};
+  };
+
+  // Probe batch: one round trip runs every pending probe; a failing probe
+  // only poisons its own slot.
+  rt.$batch = (fns) => fns.map((fn) => {
+    try { return fn(); } catch (e) { return {error:String(e)}; }
+  });
+
+  // ---- page-turn marker ----
+  // The host stamps each turn's seq here before running its executor; the
+  // DOM change reports carry it so a change is credited to the turn that
+  // caused it, not to whichever turn happens to be in flight.
+  const turn = {seq: 0};
+  rt.markTurn = (seq) => { turn.seq = seq | 0; return turn.seq; };
+  rt.turnSeq = () => turn.seq;
+
+  // ---- WeRead page geometry ----
+  // Scroll container, line height, padding and viewport height are measured
+  // once and cached, so a page turn is a single scrollTo with no style
+  // recalc. Invalidated when the container or the sampled paragraph resizes
+  // or is replaced, when web fonts finish loading, and on font changes.
+  const geom = {el:null, sample:null, ro:null, roPrimed:false, valid:false,
+                lh:32, padTop:0, viewH:0, pageLines:1, builds:0, styled:null};
+  const invalidateGeom = () => { geom.valid = false; };
+  const watchGeom = () => {
+    if (!window.ResizeObserver) return;
+    if (geom.ro) geom.ro.disconnect();
+    geom.roPrimed = false;
+    geom.ro = new ResizeObserver(() => {
+      // the first callback only reports the sizes we just measured
+      if (geom.roPrimed) invalidateGeom();
+      geom.roPrimed = true;
+    });
+    geom.ro.observe(geom.el);
+    if (geom.sample) geom.ro.observe(geom.sample);
+  };
+  const measureGeom = () => {
+    if (!geom.el || !geom.el.isConnected) {
+      geom.el = q('.renderTargetContent') || document.scrollingElement || document.documentElement;
+      geom.valid = false;
+      if (!geom.el) return null;
+    }
+    if (geom.sample && !geom.sample.isConnected) geom.valid = false;
+    if (geom.valid) return geom;
+    const el = geom.el;
+    geom.sample = el.querySelector('p, div, span');
+    geom.lh = geom.sample ? parseFloat(getComputedStyle(geom.sample).lineHeight) || 32 : 32;
+    geom.padTop = parseFloat(getComputedStyle(el).paddingTop) || 0;
+    geom.viewH = el.clientHeight || window.innerHeight || 0;
+    // 0.8 of the viewport, rounded down to whole lines
+    geom.pageLines = Math.max(1, Math.floor(geom.viewH * 0.8 / geom.lh));
+    geom.valid = true;
+    ++geom.builds;
+    watchGeom();
+    return geom;
+  };
+  const alignedTop = (g, top) => Math.max(0, Math.round((top - g.padTop) / g.lh) * g.lh + g.padTop);
+  try {
+    if (document.fonts && document.fonts.addEventListener)
+      document.fonts.addEventListener('loadingdone', invalidateGeom);
+  } catch (e) {}
+
+  // ---- WeRead pagination ----
+  const scrollToAligned = (target) => {
+    try {
+      const t_js_start = Date.now();
+      const g = measureGeom();
+      if (!g) return {ok:false, reason:'no-container'};
+      const el = g.el;
+      const before = el.scrollTop || 0;
+      const top = alignedTop(g, target(g, before));
+      if (Math.abs(top - before) > 0.5) el.scrollTo({top, behavior:'auto'});
+      const after = el.scrollTop || 0;
+      const t_js_end = Date.now();
+      return {ok:true, before, after, delta: after-before, lines: Math.round((after-before)/g.lh),
+              t_js_start, t_js_end, tag: el.tagName};
+    } catch (e) { return {ok:false, error:String(e)}; }
+  };
+
+  // n pages forward (n > 0) or back in one line-aligned scrollTo; queued
+  // taps arrive here already folded into a net n
+  rt.page = (n) => scrollToAligned((g, top) => top + (Math.trunc(n) || 0) * g.pageLines * g.lh);
+
+  // arbitrary pixel step, still a single line-aligned scrollTo
+  rt.scroll = (step) => scrollToAligned((g, top) => top + step);
+
+  // snap the current position to a line boundary (after a pager-button turn)
+  rt.align = () => {
+    const g = measureGeom();
+    if (!g) return {ok:false, reason:'no-container'};
+    if (g.styled !== g.el) {
+      try {
+        g.el.style.boxSizing = 'border-box';
+        g.el.style.width = '100%';
+        g.el.style.maxWidth = '100%';
+      } catch (e) {}
+      g.styled = g.el;
+      invalidateGeom();
+    }
+    const res = scrollToAligned((g, top) => top);
+    res.lineHeight = geom.lh;
+    return res;
+  };
+
+  rt.geometry = () => {
+    const g = measureGeom();
+    if (!g) return {ok:false, reason:'no-container'};
+    return {ok:true, tag:g.el.tagName, lineHeight:g.lh, padTop:g.padTop, viewH:g.viewH,
+            pageLines:g.pageLines, builds:g.builds};
+  };
+
+  // pointer-event fallback when scrolling did not move
+  rt.pagerPointer = (forward) => {
+    const btn = q(forward ? '.renderTarget_pager_button_right' : '.renderTarget_pager_button');
+    if (!btn) return {ok:false, reason: forward ? 'no-next-btn' : 'no-prev-btn'};
+    firePointerClick(btn.querySelector('span') || btn);
+    return {ok:true, action: forward ? 'next' : 'prev'};
+  };
+
+  rt.pagerClick = (forward) => {
+    const btn = q(forward ? '.renderTarget_pager_button_right' : '.renderTarget_pager_button');
+    if (!btn || !btn.click) return false;
+    btn.click();
+    return true;
+  };
+
+  rt.repaintNudge = () => {
+    try {
+      window.scrollBy(0, 1);
+      setTimeout(() => window.scrollBy(0, -1), 50);
+      const b = document.body;
+      if (b) {
+        const op = b.style.opacity;
+        b.style.opacity = '0.999';
+        setTimeout(() => { b.style.opacity = op || ''; }, 50);
+      }
+      return {ok:true};
+    } catch (e) { return {ok:false, error:String(e)}; }
+  };
+
+  rt.hittest = (x, y) => {
+    const tag = (e) => {
+      if (!e) return 'null';
+      let t = e.tagName;
+      if (e.id) t += '#' + e.id;
+      if (e.className) t += '.' + e.className;
+      return t;
+    };
+    const el = document.elementFromPoint(x, y);
+    if (!el) return 'null';
+    if (el.tagName === 'IFRAME') {
+      let res = 'iframe';
+      const r = el.getBoundingClientRect();
+      try {
+        const d = el.contentDocument || el.contentWindow.document;
+        if (d) {
+          const inner = d.elementFromPoint(x - r.left, y - r.top);
+          res += '->' + tag(inner);
+          if (inner && inner.click) inner.click();
+        }
+      } catch (e) { res += '->blocked'; }
+      return res;
+    }
+    const cls = (el.className || '') + '';
+    const txt = (el.innerText || '').trim();
+    let res = tag(el) + '|' + txt;
+    if (!(cls.includes('btn focus-btn') && location.href.includes('/ebook/reader/'))) {
+      if (el.click) el.click();
+    } else {
+      res += '|blocked';
+    }
+    return res;
+  };
+
+  // ---- content state / retry ----
+  rt.chapterState = () => {
+    try {
+      const obs = window.__WR_CHAPTER_OBS || {};
+      let source = '';
+      let bookId = '';
+      let idx = -1;
+      let total = 0;
+      let uid = null;
+      if (obs && (obs.bookId || obs.chapterUid || obs.total ||
+                  obs.chapterIdx !== undefined || obs.idx !== undefined ||
+                  obs.localIdx !== undefined)) {
+        source = 'observer';
+        bookId = obs.bookId || '';
+        uid = obs.chapterUid || null;
+        if (obs.total) total = obs.total;
+        if (obs.chapterIdx !== undefined) idx = obs.chapterIdx;
+        if (idx < 0 && obs.idx !== undefined) idx = obs.idx;
+        if (idx < 0 && obs.localIdx !== undefined) idx = obs.localIdx;
+      }
+      const urlMatch = (location.href || '').match(/reader\/([a-zA-Z0-9]+)/);
+      if (!bookId) bookId = urlMatch ? urlMatch[1] : '';
+      let hasLocal = false;
+      let localIdx = -1;
+      try {
+        const lcRaw = localStorage.getItem('book:lastChapters');
+        if (lcRaw) {
+          hasLocal = true;
+          const parsed = JSON.parse(lcRaw);
+          if (bookId && parsed && parsed[bookId] != null) {
+            localIdx = parseInt(parsed[bookId]);
+            if (idx < 0) idx = localIdx;
+          }
+        }
+      } catch (e) {}
+      const hasBook = !!bookId;
+      const hasIdx = (idx >= 0 && total > 0);
+      // ok only needs the book id; idx/total may be partially missing
+      const ok = hasBook;
+      const reason = hasBook ? (hasIdx ? 'ok' : 'missing_idx') : 'missing_book';
+      return {ok, reason, source, bookId, chapterUid: uid, idx, total,
+              hasLocal, localIdx, shouldPing:false};
+    } catch (e) { return {ok:false, error:'' + e}; }
+  };
+
+  // Warm the next chapter once no more than maxPages screens of the current
+  // one are left. Templates and the response cache live in the chapter
+  // observer (window.__WR_PREFETCH); the fetch itself is fire-and-forget.
+  rt.prefetchNext = (maxPages) => {
+    const pf = window.__WR_PREFETCH;
+    if (!pf || !pf.prefetchNext) return {ok:false, reason:'no_prefetcher'};
+    const g = measureGeom();
+    if (g && g.viewH > 0 && g.el.scrollHeight > g.viewH + 1) {
+      const left = (g.el.scrollHeight - (g.el.scrollTop || 0) - g.viewH) / g.viewH;
+      if (left > maxPages) return {ok:false, reason:'far', pagesLeft: Math.round(left * 10) / 10};
+    }
+    return pf.prefetchNext();
+  };
+
+  // Offline download of the whole book: the chapter observer walks
+  // chapterInfos and posts every content response to the host.
+  rt.downloadBook = () => {
+    const pf = window.__WR_PREFETCH;
+    if (!pf || !pf.downloadBook) return {ok:false, reason:'no_prefetcher'};
+    return pf.downloadBook();
+  };
+
+  // fire-and-forget: runJavaScript cannot await the Promise
+  rt.retryBookRead = () => {
+    try {
+      if (!window.__WR_RETRY_BOOK_READ__) {
+        return {ok:false, error:'retry_function_not_available'};
+      }
+      window.__WR_RETRY_BOOK_READ__().then(() => {
+        console.log('[RETRY] JS API retry succeeded');
+      }).catch(err => {
+        console.error('[RETRY] JS API retry failed:', err);
+      });
+      return {ok:true, method:'js_api_retry_triggered'};
+    } catch (e) { return {ok:false, error:String(e)}; }
+  };
+
+  // ---- diagnostics probes ----
+  rt.pageProbe = () => {
+    const cont = q('.renderTargetContent');
+    const docEl = document.documentElement;
+    const scrollEl = document.scrollingElement || docEl || document.body;
+    return {
+      url: location.href || '',
+      host: location.host || '',
+      path: location.pathname || '',
+      hasRenderTarget: !!cont,
+      scrollElTag: scrollEl ? scrollEl.tagName : '',
+      scrollH: scrollEl ? scrollEl.scrollHeight : 0,
+      clientH: scrollEl ? scrollEl.clientHeight : 0,
+      offsetH: scrollEl ? scrollEl.offsetHeight : 0,
+    };
+  };
+
+  rt.textScan = () => {
+    const bodyLen = (document.body && document.body.innerText) ? document.body.innerText.length : 0;
+    let shadowText = 0;
+    let canvasCount = 0, imgCount = 0;
+    qa('*').forEach(el => {
+      const tag = (el.tagName || '').toLowerCase();
+      if (tag === 'canvas') canvasCount++;
+      if (tag === 'img') imgCount++;
+      if (el.shadowRoot && el.shadowRoot.innerText) shadowText += el.shadowRoot.innerText.length;
+    });
+    let iframeText = 0, iframeBlocked = 0, iframeCount = 0;
+    qa('iframe').forEach(f => {
+      iframeCount++;
+      try {
+        const d = f.contentDocument || (f.contentWindow && f.contentWindow.document);
+        if (d && d.body && d.body.innerText) iframeText += d.body.innerText.length;
+      } catch (_) { iframeBlocked++; }
+    });
+    // renderTarget/readerChapter length, for comparison with bodyLen
+    const core = q('.renderTargetContent') || q('.readerChapterContent');
+    const coreLen = core ? ((core.innerText || '').length) : 0;
+    return {bodyLen, coreLen, shadowText, iframeText, iframeCount,
+            iframeBlocked, canvasCount, imgCount};
+  };
+
+  rt.computedFont = (isDedao) => {
+    if (isDedao) {
+      const cont = q('.iget-reader-book') || q('.reader-content') ||
+                   q('.iget-reader-container') || q('.reader-body') || document.body;
+      const style = cont ? getComputedStyle(cont) : null;
+      let setting = {};
+      let raw = '';
+      try { raw = localStorage.getItem('readerSettings') || ''; } catch (e) { raw = ''; }
+      if (raw) {
+        try {
+          const parsed = JSON.parse(raw);
+          if (parsed && typeof parsed === 'object') setting = parsed;
+        } catch (e) { setting = {}; }
+      }
+      return {
+        site: 'dedao',
+        fontFamily: style ? style.fontFamily : '',
+        fontSize: style ? style.fontSize : '',
+        fontWeight: style ? style.fontWeight : '',
+        settingFont: setting.fontFamily || '',
+        settingLevel: setting.fontLevel || '',
+        settingRaw: raw || ''
+      };
+    }
+    const cont = q('.renderTargetContent') || document.body;
+    const style = cont ? getComputedStyle(cont) : null;
+    let setting = {};
+    try { setting = JSON.parse(localStorage.getItem('wrLocalSetting') || '{}'); } catch (e) { setting = {}; }
+    return {
+      site: 'weread',
+      fontFamily: style ? style.fontFamily : '',
+      fontSize: style ? style.fontSize : '',
+      fontWeight: style ? style.fontWeight : '',
+      settingFont: setting.fontFamily || '',
+      settingSize: setting.fontSizeLevel || ''
+    };
+  };
+
+  rt.sessionState = () => ({url: window.location.href, scrollY: window.scrollY});
+
+  // ---- WeRead book page fixes ----
+  rt.contentProbe = () => {
+    try {
+      const bodyLen = (document.body && document.body.innerText) ? document.body.innerText.length : 0;
+      const cont = q('.renderTargetContent');
+      const contLen = cont ? ((cont.innerText || '').length) : 0;
+      let iframeText = 0;
+      qa('iframe').forEach(f => {
+        try {
+          const d = f.contentDocument || f.contentWindow?.document;
+          if (d && d.body && d.body.innerText) iframeText += d.body.innerText.length;
+        } catch (_e) {}
+      });
+      const hasText = (contLen > 100) || (bodyLen > 500) || (iframeText > 300);
+      return {hasText, bodyLen, contLen, iframeText};
+    } catch (e) { return {error:String(e)}; }
+  };
+
+  rt.iframeFix = () => {
+    try {
+      const cont = q('.renderTargetContent');
+      if (cont) {
+        cont.style.minHeight = '100vh';
+        cont.style.width = '100%';
+        cont.style.display = 'block';
+        cont.style.opacity = '1';
+        cont.style.visibility = 'visible';
+        cont.style.background = '#fff';
+      }
+      const iframes = qa('iframe');
+      iframes.forEach(f => {
+        f.style.display = 'block';
+        f.style.minHeight = '100vh';
+        f.style.width = '100%';
+        try {
+          const d = f.contentDocument || (f.contentWindow && f.contentWindow.document);
+          if (d && d.body) {
+            d.body.style.background = '#fff';
+            d.body.style.color = '#000';
+            d.body.style.opacity = '1';
+            d.documentElement && (d.documentElement.style.background = '#fff');
+          }
+        } catch (_) {}
+      });
+      window.scrollBy(0, 1);
+      setTimeout(() => window.scrollBy(0, -1), 30);
+      return {ok:true, iframes: iframes.length};
+    } catch (e) { return {ok:false, error:String(e)}; }
+  };
+
+  rt.lowPowerCss = () => {
+    try {
+      if (document.getElementById('weread-low-power-style')) return {ok:true, existed:true};
+      const style = document.createElement('style');
+      style.id = 'weread-low-power-style';
+      style.textContent = `
+        * {
+          animation-duration: 0.001s !important;
+          animation-iteration-count: 1 !important;
+          transition-duration: 0s !important;
+          scroll-behavior: auto !important;
+        }
+        html, body, .readerChapterContent, .renderTargetContent, .readerContent {
+          scroll-behavior: auto !important;
+          transition: none !important;
+          animation: none !important;
+        }
+        .loading, .mask, .reader_loading {
+          transition: none !important;
+          animation: none !important;
+        }
+      `;
+      document.head.appendChild(style);
+      return {ok:true, injected:true};
+    } catch (e) { return {ok:false, error:String(e)}; }
+  };
+
+  // ---- font ----
+  // WeRead: bump fontSizeLevel in local settings and reload, keeping scrollY
+  rt.weReadFontStep = (delta) => {
+    invalidateGeom();
+    let setting = {};
+    try { setting = JSON.parse(localStorage.getItem('wrLocalSetting') || '{}'); } catch (e) { setting = {}; }
+    const raw = setting.fontSizeLevel;
+    let before = parseInt(raw, 10);
+    if (Number.isNaN(before)) before = 4;
+    const after = Math.max(1, Math.min(7, before + delta));
+    setting.fontSizeLevel = after;
+    if (!setting.fontFamily) setting.fontFamily = 'TsangerYunHei-W05';
+    try { localStorage.setItem('wrFontLevelUserSet', '1'); } catch (e) {}
+    try { localStorage.setItem('wrLocalSetting', JSON.stringify(setting)); } catch (e) {}
+    try { sessionStorage.setItem('wr_scrollY', window.scrollY || 0); } catch (e) {}
+    setTimeout(() => location.reload(), 50);
+    return {ok:true, before, after, raw, method:'reload'};
+  };
+
+  rt.dedaoOpenSetting = () => {
+    const settingBtn = q('.reader-tool-button.tool-margin-right');
+    if (settingBtn && typeof settingBtn.click === 'function') {
+      settingBtn.click();
+      return {ok:true, action:'open-setting'};
+    }
+    return {ok:false, reason:'no-setting-btn'};
+  };
+
+  rt.dedaoFontStep = (inc) => {
+    const buttons = qa('.set-tool-box-change-font button');
+    if (buttons.length === 0) return {ok:false, reason:'no-font-buttons'};
+    const btn = inc > 0 ? buttons[buttons.length - 1] : buttons[0];
+    if (btn && btn.click) {
+      btn.click();
+      const fontNum = q('.set-tool-box-font-number');
+      const num = fontNum ? fontNum.textContent.trim() : '';
+      return {ok:true, mode:'dedao', inc, font:num};
+    }
+    return {ok:false, reason:'btn-no-click', mode:'dedao'};
+  };
+
+  // ---- menu actions ----
+  rt.fontPanelOpen = () => {
+    const selectors = [
+      'button.readerControls_item.fontSizeButton',
+      '.readerControls_item.fontSizeButton',
+      '.readerControls .fontSizeButton',
+      'button[title*="字体"]',
+      'button[aria-label*="字体"]'
+    ];
+    let btn = null;
+    for (const sel of selectors) {
+      const el = q(sel);
+      if (el) { btn = el; break; }
+    }
+    if (!btn) return {ok:false, reason:'no-font-button', selectors};
+    const style = window.getComputedStyle ? getComputedStyle(btn) : null;
+    const visible = style ? (style.display !== 'none' && style.visibility !== 'hidden' && style.opacity !== '0') : true;
+    if (btn.click) btn.click();
+    return {ok:true, visible, cls: btn.className || '', tag: btn.tagName || ''};
+  };
+
+  // picks targetKey in the open font panel, retrying while it renders;
+  // a changed wrLocalSetting.fontFamily reloads the page
+  rt.fontSelect = (targetKey, targetName) => {
+    const maxTries = 8;
+    const delayMs = 150;
+    const squash = (s) => (s || '').replace(/\s+/g, '').replace(/["']/g, '').toLowerCase();
+    const firstFamily = (fam) => {
+      if (!fam) return '';
+      const parts = String(fam).split(',');
+      if (!parts.length) return '';
+      return parts[0].trim().replace(/^["']|["']$/g, '');
+    };
+    const collectMeta = (el) => {
+      const styleAttr = el.getAttribute('style') || '';
+      const famInline = (el.style && el.style.fontFamily) || '';
+      const famComp = (window.getComputedStyle ? getComputedStyle(el).fontFamily : '') || '';
+      const text = (el.innerText || el.textContent || '');
+      const dataFont = el.getAttribute('data-font') || el.getAttribute('data-id') || el.getAttribute('data-key') || el.getAttribute('data-name') || '';
+      const dataset = el.dataset ? Object.values(el.dataset).join(' ') : '';
+      const key = (dataFont || dataset || '').trim();
+      const family = firstFamily(famInline || famComp || styleAttr);
+      return {styleAttr, famInline, famComp, text, dataFont, dataset, key, family};
+    };
+    const isTarget = (el) => {
+      const meta = collectMeta(el);
+      const hay = squash(meta.styleAttr + ' ' + meta.famInline + ' ' + meta.famComp + ' ' + meta.text + ' ' + meta.dataFont + ' ' + meta.dataset);
+      const hasName = hay.includes(squash(targetName)) || hay.includes('tsangeryunhei') || hay.includes(squash(targetKey));
+      const hasW05 = hay.includes('05') || hay.includes('w05');
+      return hasName && hasW05;
+    };
+    const fire = (el) => {
+      if (!el) return;
+      const rect = el.getBoundingClientRect ? el.getBoundingClientRect() : {left:0, top:0, width:0, height:0};
+      const opts = {bubbles:true, cancelable:true, clientX: rect.left + rect.width / 2, clientY: rect.top + rect.height / 2};
+      try { el.dispatchEvent(new PointerEvent('pointerdown', opts)); } catch (e) {}
+      try { el.dispatchEvent(new PointerEvent('pointerup', opts)); } catch (e) {}
+      try { el.dispatchEvent(new MouseEvent('click', opts)); } catch (e) {}
+      try { if (el.click) el.click(); } catch (e) {}
+    };
+    const applySetting = (meta) => {
+      const key = 'wrLocalSetting';
+      let setting = {};
+      try { setting = JSON.parse(localStorage.getItem(key) || '{}'); } catch (e) { setting = {}; }
+      const before = setting.fontFamily || '';
+      const preferred = meta.key || targetKey;
+      if (preferred && setting.fontFamily !== preferred) {
+        setting.fontFamily = preferred;
+        if (!setting.fontSizeLevel) setting.fontSizeLevel = 4;
+        try { localStorage.setItem(key, JSON.stringify(setting)); } catch (e) {}
+      }
+      return {before, after: setting.fontFamily || '', applied: setting.fontFamily !== before};
+    };
+    const trySelect = (tryIdx) => {
+      const items = qa('.font-panel-content-fonts-item');
+      if (!items.length) {
+        if (tryIdx < maxTries) return setTimeout(() => trySelect(tryIdx + 1), delayMs);
+        console.log('[FONT_SELECT] no-font-items');
+        return;
+      }
+      const target = items.find(isTarget);
+      if (!target) {
+        if (tryIdx < maxTries) return setTimeout(() => trySelect(tryIdx + 1), delayMs);
+        const sample = items.slice(0, 3).map(el => (el.getAttribute('style') || '')).join(' | ');
+        console.log('[FONT_SELECT] target-not-found', items.length, sample);
+        return;
+      }
+      if (target.scrollIntoView) target.scrollIntoView({block:'center', inline:'nearest'});
+      fire(target);
+      fire(target.querySelector('div, svg, span'));
+      const meta = collectMeta(target);
+      setTimeout(() => {
+        const setting = applySetting(meta);
+        const cls = target.className || '';
+        const selected = cls.includes('selected') || cls.includes('active');
+        console.log('[FONT_SELECT]' + JSON.stringify({
+          try: tryIdx, selected, cls, key: meta.key, family: meta.family,
+          before: setting.before, after: setting.after, applied: setting.applied
+        }));
+        if (setting.applied) {
+          invalidateGeom();
+          setTimeout(() => location.reload(), 150);
+        } else if (!selected && tryIdx < maxTries) {
+          setTimeout(() => trySelect(tryIdx + 1), delayMs);
+        }
+      }, 120);
+    };
+    trySelect(0);
+    return {ok:true, scheduled:true, targetKey};
+  };
+
+  // WeRead: flip wr_theme (cookie + localStorage) and reload
+  rt.weReadToggleTheme = () => {
+    const getCookie = (name) => document.cookie.split(';').map(s => s.trim())
+      .filter(s => s.startsWith(name + '=')).map(s => s.substring(name.length + 1))[0] || '';
+    const cookieTheme = getCookie('wr_theme');
+    const lsTheme = (localStorage && localStorage.getItem('wr_theme')) || '';
+    const current = (cookieTheme || lsTheme || 'dark').toLowerCase();
+    const next = current === 'white' ? 'dark' : 'white';
+    try { document.cookie = 'wr_theme=' + next + '; domain=.weread.qq.com; path=/; max-age=31536000'; } catch (e) {}
+    try { localStorage && localStorage.setItem('wr_theme', next); } catch (e) {}
+    const delay = 300;
+    console.log('[THEME] reload scheduled in', delay, 'ms');
+    setTimeout(() => { console.log('[THEME] reloading now'); location.reload(); }, delay);
+    return {ok:true, before:current, after:next, cookieAfter:getCookie('wr_theme'),
+            lsAfter:(localStorage && localStorage.getItem('wr_theme')) || ''};
+  };
+
+  // Dedao: cycle to the next theme button of the open setting panel
+  rt.dedaoToggleTheme = () => {
+    const list = qa('.tool-box-theme-group .reader-tool-theme-button');
+    if (list.length === 0) return {ok:false, reason:'no-theme-buttons'};
+    const curIdx = list.findIndex(el => el.classList.contains('reader-tool-theme-button-selected'));
+    const nextIdx = curIdx >= 0 ? (curIdx + 1) % list.length : 0;
+    if (list[nextIdx] && list[nextIdx].click) {
+      list[nextIdx].click();
+      const sel = list[nextIdx].querySelector('.reader-tool-theme-button-text');
+      const text = sel ? sel.textContent.trim() : '';
+      return {ok:true, cur:curIdx, next:nextIdx, count:list.length, mode:'dedao', text};
+    }
+    return {ok:false, reason:'no-theme-btn', count:list.length, mode:'dedao'};
+  };
+
+  // WeRead: toggle between the bundled font and a local Noto Sans override
+  rt.toggleFontFamily = () => {
+    const key = 'wrLocalSetting';
+    let setting = {};
+    try { setting = JSON.parse(localStorage.getItem(key) || '{}'); } catch (e) { setting = {}; }
+    const cur = (setting.fontFamily || 'TsangerYunHei-W05').toLowerCase();
+    const custom = 'custom_noto_sans';
+    const next = (cur === custom) ? 'TsangerYunHei-W05' : custom;
+    setting.fontFamily = next;
+    if (!setting.fontSizeLevel) setting.fontSizeLevel = 4;
+    try { localStorage.setItem(key, JSON.stringify(setting)); } catch (e) {}
+    const cssId = 'wr-font-override';
+    const exist = document.getElementById(cssId);
+    if (exist) exist.remove();
+    if (next === custom) {
+      const style = document.createElement('style');
+      style.id = cssId;
+      style.textContent = "@font-face{font-family:'CustomNotoSans';src:url('file:///home/root/.fonts/NotoSansCJKsc-Regular.otf') format('opentype');}" +
+        ".renderTargetContent, .renderTargetContent * { font-family:'CustomNotoSans', 'Noto Sans CJK SC', 'Noto Sans SC', sans-serif !important; }";
+      try { (document.documentElement || document.body).appendChild(style); } catch (e) {}
+    }
+    invalidateGeom();
+    setTimeout(() => location.reload(), 200);
+    return {ok:true, next};
+  };
+
+  // Dedao: open the toolbar settings and force the panel on screen
+  rt.dedaoOpenMenu = () => {
+    try {
+      window.scrollTo(0, 0);
+      const toolbar = q('.iget-reader-toolbar');
+      const btn = toolbar ? qa('button,[role=button]', toolbar).find(b =>
+        ((b.innerText || '').includes('设置')) || String(b.className || '').includes('iget-icon-font')) : null;
+      if (!btn || !btn.click) return {ok:false, reason:'no-btn'};
+      btn.click();
+      setTimeout(() => {
+        const panel = q('.set-tool-box');
+        if (panel) {
+          panel.style.cssText += '; display:block !important; visibility:visible !important; opacity:1 !important;'
+            + ' z-index:99999 !important; position:fixed !important; top:15% !important; left:10% !important; width:80% !important;'
+            + ' min-width:300px !important; min-height:150px !important; background:#fff !important; border:2px solid #000 !important;';
+          console.log('[MENU_FIX] Styles forced');
+        }
+      }, 50);
+      return {ok:true, action:'clicked'};
+    } catch (e) { return {ok:false, error:String(e)}; }
+  };
+
+  // stalled chapter: click the next-page pager, else reload
+  rt.stalledRescue = () => {
+    const btn = q('.renderTarget_pager_button_right');
+    if (btn && btn.click) { btn.click(); return {ok:true, action:'click-next'}; }
+    location.reload();
+    return {ok:true, action:'reload'};
+  };
+
+  // ---- WeRead catalog ----
+  rt.catalogOpen = () => {
+    const list = q('.readerCatalog_list');
+    const panel = q('.readerCatalog');
+    const panelVisible = panel ? (getComputedStyle(panel).display !== 'none') : false;
+    if (list && list.children.length > 0) {
+      return {ok:true, action:'already-open', count: list.children.length, panelVisible};
+    }
+    const selectors = [
+      '.readerControls_item.catalog',
+      '.readerControls .catalog',
+      'button[title*="目录"]',
+      '[data-action="catalog"]'
+    ];
+    const found = [];
+    let picked = null;
+    for (const sel of selectors) {
+      const el = q(sel);
+      if (el) {
+        const info = {sel, tag: el.tagName, cls: el.className || '', visible: isVisible(el)};
+        found.push(info);
+        if (!picked) picked = {el, sel, visible: info.visible};
+      }
+    }
+    if (picked && picked.el) {
+      if (picked.el.click) picked.el.click();
+      return {ok:true, action:'clicked', selector: picked.sel, visible: picked.visible,
+              panelVisible, found};
+    }
+    return {ok:false, error:'no-btn', panelVisible, found};
+  };
+
+  rt.catalogScrape = () => {
+    const items = qa('.readerCatalog_list_item');
+    console.log('[CATALOG_DEBUG] Found ' + items.length + ' DOM items');
+    if (items.length === 0) return {ok:false, error:'no-items'};
+    const data = items.map((item, idx) => {
+      const titleEl = item.querySelector('.readerCatalog_list_item_title_text');
+      let title = titleEl ? titleEl.innerText : '';
+      if (!title) title = item.innerText || '';
+      title = normalize(title);
+      const isCurrent = item.classList.contains('readerCatalog_list_item_selected');
+      let level = 1;
+      const inner = item.querySelector('.readerCatalog_list_item_inner');
+      const className = inner ? inner.className : item.className;
+      const m = String(className || '').match(/readerCatalog_list_item_level_(\d+)/);
+      if (m) {
+        const parsed = parseInt(m[1], 10);
+        level = Number.isFinite(parsed) && parsed > 0 ? parsed : 1;
+      }
+      return {index: idx, title, level, isCurrent, matchKey: title, chapterUid: title};
+    }).filter((item) => item && item.title);
+    return {ok:true, chapters: data, source:'dom-only'};
+  };
+
+  // ---- Dedao catalog ----
+  const dedao = {};
+  dedao.open = () => {
+    const hideClass = '__dedao_catalog_hide';
+    if (document.body && document.body.classList.contains(hideClass)) {
+      document.body.classList.remove(hideClass);
+    }
+    const list = q('.iget-reader-catalog-content');
+    const items = list ? list.querySelectorAll('li') : null;
+    const listCount = items ? items.length : 0;
+    const wrapper = q('.iget-reader-catalog-wrapper');
+    const panelVisible = (() => {
+      if (!wrapper || !window.getComputedStyle) return false;
+      const style = getComputedStyle(wrapper);
+      return style.display !== 'none' && style.visibility !== 'hidden' && style.opacity !== '0';
+    })();
+    if (listCount > 0) return {ok:true, action:'already-open', listCount, panelVisible};
+    let btn = null;
+    const icon = q('.iget-icon-list');
+    if (icon && icon.closest) btn = icon.closest('button');
+    if (!btn) btn = qa('button, [role=button]').find(b => textMatch(b, '目录')) || null;
+    const tab = qa('.slide-tags-item').find(t => textMatch(t, '目录')) || null;
+    if (tab && tab.click) tab.click();
+    if (btn && btn.click) {
+      btn.click();
+      return {ok:true, action:'clicked', listCount, panelVisible, hasTab: !!tab};
+    }
+    if (tab) return {ok:true, action:'tab-clicked', listCount, panelVisible, hasTab: true};
+    return {ok:false, reason:'no-btn', listCount, panelVisible};
+  };
+
+  dedao.hide = () => {
+    const hideClass = '__dedao_catalog_hide';
+    const styleId = '__dedao_catalog_hide_style';
+    if (!document.getElementById(styleId)) {
+      const style = document.createElement('style');
+      style.id = styleId;
+      style.textContent =
+        'body.' + hideClass + ' .iget-reader-catalog-wrapper{display:none !important;visibility:hidden !important;opacity:0 !important;pointer-events:none !important;}' +
+        'body.' + hideClass + ' .slide-wrapper-tags{display:none !important;visibility:hidden !important;opacity:0 !important;pointer-events:none !important;}';
+      (document.head || document.documentElement).appendChild(style);
+    }
+    if (document.body) {
+      document.body.classList.add(hideClass);
+      return {ok:true};
+    }
+    return {ok:false, reason:'no-body'};
+  };
+
+  dedao.current = () => {
+    const selected =
+      q('.iget-reader-catalog-item-selected .iget-reader-catalog-item-text') ||
+      q('.iget-reader-catalog-item-selected');
+    if (!selected) return {ok:false, reason:'no-selected'};
+    const title = normalize(selected.innerText || '');
+    if (!title) return {ok:false, reason:'empty-title'};
+    return {ok:true, title};
+  };
+
+  const activateCatalogTab = () => {
+    const tab = qa('.slide-tags-item').find(t => normalize(t.innerText) === '目录');
+    if (tab && tab.classList && !tab.classList.contains('slide-tags-item-active') && tab.click) {
+      tab.click();
+    }
+  };
+
+  dedao.scrollStep = (stepPx, reset) => {
+    activateCatalogTab();
+    const list = q('.iget-reader-catalog-content');
+    if (!list) return {ok:false, reason:'no-list'};
+    const findScroller = (el) => {
+      let cur = el;
+      for (let i = 0; i < 6 && cur; i++) {
+        if (cur.scrollHeight > cur.clientHeight + 10) return cur;
+        cur = cur.parentElement;
+      }
+      return document.scrollingElement || document.documentElement || null;
+    };
+    const scroller = findScroller(list);
+    if (!scroller) return {ok:false, reason:'no-scroller'};
+    if (reset) {
+      scroller.scrollTop = 0;
+    } else if (stepPx > 0) {
+      const maxTop = Math.max(0, scroller.scrollHeight - scroller.clientHeight);
+      scroller.scrollTop = Math.min(scroller.scrollTop + stepPx, maxTop);
+    }
+    let expanded = 0;
+    qa('li', list).forEach((item) => {
+      const icon = item.querySelector('.iget-icon-play');
+      if (!icon) return;
+      if (icon.classList.contains('catalog-item-icon-actived')) return;
+      try { if (icon.click) icon.click(); expanded++; } catch (e) {}
+    });
+    return {
+      ok:true,
+      scrollTop: scroller.scrollTop || 0,
+      scrollHeight: scroller.scrollHeight || 0,
+      clientHeight: scroller.clientHeight || 0,
+      expanded,
+      stepPx
+    };
+  };
+
+  const dedaoItems = () => {
+    const list = q('.iget-reader-catalog-content');
+    return list ? qa('li', list) : [];
+  };
+  const dedaoItemTitle = (item) => {
+    const titleEl = item.querySelector('.iget-reader-catalog-item-text');
+    let title = titleEl ? titleEl.innerText : '';
+    if (!title) title = item.innerText || '';
+    return normalize(title);
+  };
+
+  dedao.scrape = () => {
+    const items = dedaoItems();
+    if (!items.length) return {ok:false, reason:'no-items'};
+    let minPad = null;
+    const padList = items.map((item) => {
+      let pad = NaN;
+      if (item.style && item.style.paddingLeft) pad = parseInt(item.style.paddingLeft, 10);
+      if (!Number.isFinite(pad) && window.getComputedStyle) {
+        pad = parseInt(getComputedStyle(item).paddingLeft, 10);
+      }
+      if (!Number.isFinite(pad)) pad = 0;
+      if (minPad === null || pad < minPad) minPad = pad;
+      return pad;
+    });
+    if (!Number.isFinite(minPad)) minPad = 0;
+    const step = 20;
+    const toLevel = (pad) => {
+      const level = Math.round((pad - minPad) / step) + 1;
+      return level > 0 ? level : 1;
+    };
+    const chapters = items.map((item, idx) => {
+      const title = dedaoItemTitle(item);
+      const isCurrent = item.classList.contains('iget-reader-catalog-item-selected');
+      return {index: idx, title, level: toLevel(padList[idx] || 0), isCurrent,
+              matchKey: title, chapterUid: title};
+    }).filter(ch => ch && ch.title);
+    return {ok:true, chapters, count: chapters.length, source:'dedao-dom'};
+  };
+
+  dedao.click = (matchTitleRaw, targetIdx) => {
+    matchTitleRaw = matchTitleRaw || '';
+    const items = dedaoItems();
+    if (!items.length) return {ok:false, reason:'no-items'};
+    const matchTitle = normalize(matchTitleRaw);
+    let target = null;
+    let method = '';
+    let matchCount = 0;
+    if (matchTitle) {
+      items.forEach((item, idx) => {
+        const t = dedaoItemTitle(item);
+        if (t && t === matchTitle) {
+          matchCount++;
+          if (!target || idx === targetIdx) {
+            target = item;
+            method = idx === targetIdx ? 'title+index' : 'title';
+          }
+        }
+      });
+    }
+    if (!target && targetIdx >= 0 && targetIdx < items.length) {
+      target = items[targetIdx];
+      method = 'index';
+    }
+    if (!target) {
+      return {ok:false, reason:'no-target', matchTitleRaw, targetIdx, matchCount, count: items.length};
+    }
+    activateCatalogTab();
+    try { if (target.scrollIntoView) target.scrollIntoView({block:'center'}); } catch (e) {}
+    const clickable = target.querySelector('.iget-reader-catalog-item-text') || target;
+    if (!clickable || !clickable.getBoundingClientRect) {
+      return {ok:false, reason:'no-rect', matchTitleRaw, targetIdx, matchCount};
+    }
+    const r = clickable.getBoundingClientRect();
+    const rect = {x: r.left + r.width / 2, y: r.top + r.height / 2, w: r.width, h: r.height};
+    if (!(rect.w > 1 && rect.h > 1)) {
+      return {ok:false, reason:'rect-empty', rect, matchTitleRaw, targetIdx, matchCount};
+    }
+    try { clickable.dispatchEvent(new PointerEvent('pointerdown', {bubbles:true,cancelable:true})); } catch (e) {}
+    try { clickable.dispatchEvent(new PointerEvent('pointerup', {bubbles:true,cancelable:true})); } catch (e) {}
+    try { clickable.dispatchEvent(new MouseEvent('click', {bubbles:true,cancelable:true})); } catch (e) {}
+    try { if (clickable.click) clickable.click(); } catch (e) {}
+    return {ok:true, method, rect, matchCount, targetIdx};
+  };
+  rt.dedaoCatalog = Object.freeze(dedao);
+  // read back by the jsparse query next to the compile cost
+  rt.installMs = Math.round((performance.now() - installStart) * 1000) / 1000;
+
+  // Non-writable so page code cannot clobber it; a newer VERSION still
+  // installs because the check above compares versions first.
+  try {
+    Object.defineProperty(window, '__wr', {value: Object.freeze(rt), configurable: true});
+  } catch (e) {
+    window.__wr = rt;
+  }
+})();
+)WR";
+
+const QString &pageRuntimeScriptSource() {
+  static const QString js = QString::fromUtf8(kPageRuntimeScript);
+  return js;
+}
 } // namespace
 
 // Provide access to script sources for WereadBrowser
@@ -719,3 +2125,7 @@ const QString &WereadBrowser::getDefaultSettingsScript() {
 const QString &WereadBrowser::getDedaoDefaultSettingsScript() {
   return dedaoDefaultSettingsScriptSource();
 }
+
+const QString &WereadBrowser::getPageRuntimeScript() {
+  return pageRuntimeScriptSource();
+}
@@ -0,0 +1,269 @@
+// Evdev input backend check: replays a raw input_event capture through
+// EvdevInputThread (reader thread -> recognizer -> SPSC ring -> GUI loop)
+// and reports the recognized gestures plus recognition and ring latency as
+// JSON. Without --input it synthesizes a scripted session (tap, swipes,
+// long swipe, pan, hold-drag, a stray second finger) and checks that the
+// expected gesture sequence comes out; --write keeps that capture so it can
+// be fed to the browser as WEREAD_EVDEV_INPUT on a machine without a touch
+// panel.
+//
+// Usage: WereadEvdevBench [--input FILE] [--write FILE] [--fast]
+//                         [--out FILE]
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QStringList>
+#include <QSysInfo>
+#include <algorithm>
+#include <cstdio>
+#include <linux/input.h>
+
+#include "evdev_input.h"
+
+namespace {
+constexpr int kWidth = 954;
+constexpr int kHeight = 1696;
+
+// Builds a protocol-B multitouch capture in window coordinates.
+class CaptureWriter {
+public:
+  void down(int slot, int id, int x, int y) {
+    put(EV_ABS, ABS_MT_SLOT, slot);
+    put(EV_ABS, ABS_MT_TRACKING_ID, id);
+    put(EV_ABS, ABS_MT_POSITION_X, x);
+    put(EV_ABS, ABS_MT_POSITION_Y, y);
+    put(EV_KEY, BTN_TOUCH, 1);
+  }
+  void move(int slot, int x, int y) {
+    put(EV_ABS, ABS_MT_SLOT, slot);
+    put(EV_ABS, ABS_MT_POSITION_X, x);
+    put(EV_ABS, ABS_MT_POSITION_Y, y);
+  }
+  void up(int slot, bool last = true) {
+    put(EV_ABS, ABS_MT_SLOT, slot);
+    put(EV_ABS, ABS_MT_TRACKING_ID, -1);
+    if (last)
+      put(EV_KEY, BTN_TOUCH, 0);
+  }
+  // Ends the frame and advances the clock.
+  void frame(int advanceMs) {
+    put(EV_SYN, SYN_REPORT, 0);
+    m_us += qint64(advanceMs) * 1000;
+  }
+  // Straight-line drag from the current point, one frame per stepMs.
+  void drag(int slot, int x0, int y0, int x1, int y1, int steps, int stepMs) {
+    for (int i = 1; i <= steps; ++i) {
+      move(slot, x0 + (x1 - x0) * i / steps, y0 + (y1 - y0) * i / steps);
+      frame(stepMs);
+    }
+  }
+  bool save(const QString &path) const {
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+      return false;
+    const qint64 bytes = qint64(m_events.size() * sizeof(input_event));
+    return f.write(reinterpret_cast<const char *>(m_events.constData()),
+                   bytes) == bytes;
+  }
+
+private:
+  void put(int type, int code, int value) {
+    input_event ev{};
+    ev.input_event_sec = m_us / 1000000;
+    ev.input_event_usec = m_us % 1000000;
+    ev.type = quint16(type);
+    ev.code = quint16(code);
+    ev.value = value;
+    m_events.append(ev);
+  }
+
+  QList<input_event> m_events;
+  qint64 m_us = 1000000;
+};
+
+// Writes the scripted session and returns the gesture kinds it should
+// produce (pan/hold-drag steps collapsed to one entry each).
+QStringList writeScript(const QString &path) {
+  CaptureWriter w;
+  QStringList expected;
+  // tap
+  w.down(0, 1, 480, 900);
+  w.frame(60);
+  w.up(0);
+  w.frame(400);
+  expected << QStringLiteral("tap");
+  // swipe west: next page
+  w.down(0, 2, 800, 900);
+  w.frame(16);
+  w.drag(0, 800, 900, 500, 905, 10, 16);
+  w.up(0);
+  w.frame(400);
+  expected << QStringLiteral("swipe");
+  // long swipe east: multi-page jump back
+  w.down(0, 3, 100, 1000);
+  w.frame(16);
+  w.drag(0, 100, 1000, 850, 990, 12, 16);
+  w.up(0);
+  w.frame(400);
+  expected << QStringLiteral("swipe");
+  // slow vertical pan
+  w.down(0, 4, 480, 600);
+  w.frame(16);
+  w.drag(0, 480, 600, 480, 1000, 40, 30);
+  w.up(0);
+  w.frame(400);
+  expected << QStringLiteral("pan_move") << QStringLiteral("pan_release");
+  // hold, then drag left three pages' worth
+  w.down(0, 5, 600, 1200);
+  w.frame(650);
+  w.drag(0, 600, 1200, 400, 1200, 8, 40);
+  w.up(0);
+  w.frame(400);
+  expected << QStringLiteral("hold") << QStringLiteral("hold_drag")
+           << QStringLiteral("hold_release");
+  // a second finger lands and lifts during a tap: ignored
+  w.down(0, 6, 300, 500);
+  w.frame(30);
+  w.down(1, 7, 700, 1400);
+  w.frame(30);
+  w.up(1, false);
+  w.frame(20);
+  w.up(0);
+  w.frame(100);
+  expected << QStringLiteral("tap");
+  return w.save(path) ? expected : QStringList();
+}
+
+QJsonObject percentiles(QList<qint64> v) {
+  QJsonObject o;
+  if (v.isEmpty())
+    return o;
+  std::sort(v.begin(), v.end());
+  auto at = [&](double q) {
+    return v.at(qMin<qsizetype>(v.size() - 1, qsizetype(q * v.size())));
+  };
+  o.insert(QStringLiteral("p50"), at(0.50));
+  o.insert(QStringLiteral("p95"), at(0.95));
+  o.insert(QStringLiteral("max"), v.last());
+  return o;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName(QStringLiteral("WereadEvdevBench"));
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      QStringLiteral("Evdev input backend replay (JSON on stdout)"));
+  parser.addHelpOption();
+  QCommandLineOption inputOpt(QStringLiteral("input"),
+                              QStringLiteral("Raw input_event capture"),
+                              QStringLiteral("file"));
+  QCommandLineOption writeOpt(QStringLiteral("write"),
+                              QStringLiteral("Keep the synthesized capture"),
+                              QStringLiteral("file"));
+  QCommandLineOption fastOpt(QStringLiteral("fast"),
+                             QStringLiteral("Replay without recorded pacing"));
+  QCommandLineOption outOpt(QStringLiteral("out"),
+                            QStringLiteral("Write JSON to file"),
+                            QStringLiteral("file"));
+  parser.addOption(inputOpt);
+  parser.addOption(writeOpt);
+  parser.addOption(fastOpt);
+  parser.addOption(outOpt);
+  parser.process(app);
+
+  QString input = parser.value(inputOpt);
+  QStringList expected;
+  if (input.isEmpty()) {
+    input = parser.isSet(writeOpt)
+                ? parser.value(writeOpt)
+                : QDir::tempPath() + QStringLiteral("/weread_evdev_bench.bin");
+    expected = writeScript(input);
+    if (expected.isEmpty()) {
+      fprintf(stderr, "[BENCH] cannot write %s\n", qPrintable(input));
+      return 1;
+    }
+  }
+
+  EvdevInputThread reader(input, kWidth, kHeight);
+  reader.setPaced(!parser.isSet(fastOpt));
+  QJsonArray gestures;
+  QStringList kinds;
+  QList<qint64> recognizeMs, ringMs;
+  QObject::connect(&reader, &EvdevInputThread::gesture,
+                   [&](const InputGesture &g) {
+                     const qint64 now = EvdevInputThread::monotonicMs();
+                     recognizeMs.append(g.postedMs - g.eventMs);
+                     ringMs.append(now - g.postedMs);
+                     const QString kind =
+                         QString::fromLatin1(InputGesture::kindName(g.kind));
+                     if (kinds.isEmpty() || kinds.last() != kind ||
+                         (g.kind != InputGesture::PanMove &&
+                          g.kind != InputGesture::HoldDrag)) {
+                       kinds << kind;
+                     }
+                     QJsonObject o;
+                     o.insert(QStringLiteral("kind"), kind);
+                     o.insert(QStringLiteral("x"), qRound(g.pos.x()));
+                     o.insert(QStringLiteral("y"), qRound(g.pos.y()));
+                     o.insert(QStringLiteral("dx"),
+                              qRound(g.pos.x() - g.start.x()));
+                     o.insert(QStringLiteral("dy"),
+                              qRound(g.pos.y() - g.start.y()));
+                     o.insert(QStringLiteral("ms"), g.durationMs);
+                     gestures.append(o);
+                   });
+  QObject::connect(&reader, &EvdevInputThread::sourceFinished, &app,
+                   &QCoreApplication::quit);
+  if (!reader.start()) {
+    fprintf(stderr, "[BENCH] cannot read %s\n", qPrintable(input));
+    return 1;
+  }
+  app.exec();
+  reader.stop();
+
+  const EvdevInputThread::Stats s = reader.stats();
+  QJsonObject stats;
+  stats.insert(QStringLiteral("events"), qint64(s.events));
+  stats.insert(QStringLiteral("gestures"), qint64(s.gestures));
+  stats.insert(QStringLiteral("dropped"), qint64(s.dropped));
+  stats.insert(QStringLiteral("max_ring_depth"), qint64(s.maxDepth));
+
+  QJsonObject root;
+  root.insert(QStringLiteral("bench"), QStringLiteral("evdev_input"));
+  root.insert(QStringLiteral("qt_version"), QString::fromLatin1(qVersion()));
+  root.insert(QStringLiteral("cpu_arch"), QSysInfo::currentCpuArchitecture());
+  root.insert(QStringLiteral("input"), input);
+  root.insert(QStringLiteral("paced"), !parser.isSet(fastOpt));
+  root.insert(QStringLiteral("stats"), stats);
+  // recognition latency is only meaningful when paced
+  root.insert(QStringLiteral("recognize_ms"), percentiles(recognizeMs));
+  root.insert(QStringLiteral("ring_ms"), percentiles(ringMs));
+  root.insert(QStringLiteral("sequence"), QJsonArray::fromStringList(kinds));
+  const bool matches = expected.isEmpty() || kinds == expected;
+  if (!expected.isEmpty())
+    root.insert(QStringLiteral("matches_script"), matches);
+  root.insert(QStringLiteral("gestures"), gestures);
+  const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+
+  const QString outPath = parser.value(outOpt);
+  if (!outPath.isEmpty()) {
+    QFile file(outPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+      fprintf(stderr, "[BENCH] cannot write %s\n", qPrintable(outPath));
+      return 1;
+    }
+    file.write(json);
+  } else {
+    fwrite(json.constData(), 1, static_cast<size_t>(json.size()), stdout);
+  }
+  return matches ? 0 : 2;
+}
@@ -0,0 +1,364 @@
+// Frame pipeline benchmark: ShmFrameWriter::publish across source formats
+// and sizes, plus the e-ink classification/quantization kernels. Emits a single JSON document so
+// results can be diffed between releases (x86 dev box or on device).
+//
+// Usage: WereadFrameBench [--iterations N] [--shm PATH] [--out FILE]
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+#include "eink_quantize.h"
+#include "shm_writer.h"
+
+// ---------------------------------------------------------------------------
+// Allocation counting: interpose the glibc allocator entry points so both
+// operator new and QImage's malloc'd pixel buffers are counted.
+// ---------------------------------------------------------------------------
+namespace {
+std::atomic<bool> g_countAllocs{false};
+std::atomic<unsigned long long> g_allocCount{0};
+std::atomic<unsigned long long> g_allocBytes{0};
+
+inline void noteAlloc(size_t bytes) {
+  if (g_countAllocs.load(std::memory_order_relaxed)) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    g_allocBytes.fetch_add(bytes, std::memory_order_relaxed);
+  }
+}
+} // namespace
+
+#if defined(__GLIBC__)
+#define WEREAD_BENCH_COUNT_ALLOCS 1
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+
+extern "C" void *malloc(size_t size) __THROW {
+  noteAlloc(size);
+  return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size) __THROW {
+  noteAlloc(count * size);
+  return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size) __THROW {
+  noteAlloc(size);
+  return __libc_realloc(ptr, size);
+}
+#else
+#define WEREAD_BENCH_COUNT_ALLOCS 0
+#endif
+
+namespace {
+constexpr int kFrameWidth = 954;
+constexpr int kFrameHeight = 1696;
+
+struct BenchResult {
+  QString group;
+  QString name;
+  int iterations = 0;
+  double nsPerFrame = 0.0;
+  double mbPerSec = 0.0;
+  double allocsPerFrame = -1.0;
+  double allocBytesPerFrame = -1.0;
+  QJsonObject params;
+};
+
+BenchResult runCase(const QString &group, const QString &name, int iterations,
+                    qint64 bytesPerFrame, const QJsonObject &params,
+                    const std::function<void()> &body) {
+  body(); // warm-up: first-touch of shm pages, lazily built tables
+  g_allocCount.store(0);
+  g_allocBytes.store(0);
+  g_countAllocs.store(true);
+  QElapsedTimer timer;
+  timer.start();
+  for (int i = 0; i < iterations; ++i)
+    body();
+  const qint64 ns = timer.nsecsElapsed();
+  g_countAllocs.store(false);
+
+  BenchResult r;
+  r.group = group;
+  r.name = name;
+  r.iterations = iterations;
+  r.params = params;
+  r.nsPerFrame = static_cast<double>(ns) / iterations;
+  r.mbPerSec = r.nsPerFrame > 0.0
+                   ? (static_cast<double>(bytesPerFrame) / (1024.0 * 1024.0)) /
+                         (r.nsPerFrame / 1e9)
+                   : 0.0;
+  if (WEREAD_BENCH_COUNT_ALLOCS) {
+    r.allocsPerFrame = static_cast<double>(g_allocCount.load()) / iterations;
+    r.allocBytesPerFrame =
+        static_cast<double>(g_allocBytes.load()) / iterations;
+  }
+  fprintf(stderr, "[BENCH] %s/%s %.0f ns/frame %.1f MB/s\n",
+          qPrintable(group), qPrintable(name), r.nsPerFrame, r.mbPerSec);
+  return r;
+}
+
+QJsonObject toJson(const BenchResult &r) {
+  QJsonObject o;
+  o.insert(QStringLiteral("group"), r.group);
+  o.insert(QStringLiteral("name"), r.name);
+  o.insert(QStringLiteral("iterations"), r.iterations);
+  o.insert(QStringLiteral("ns_per_frame"), r.nsPerFrame);
+  o.insert(QStringLiteral("mb_per_s"), r.mbPerSec);
+  if (r.allocsPerFrame >= 0.0) {
+    o.insert(QStringLiteral("allocs_per_frame"), r.allocsPerFrame);
+    o.insert(QStringLiteral("alloc_bytes_per_frame"), r.allocBytesPerFrame);
+  } else {
+    o.insert(QStringLiteral("allocs_per_frame"), QJsonValue());
+    o.insert(QStringLiteral("alloc_bytes_per_frame"), QJsonValue());
+  }
+  o.insert(QStringLiteral("params"), r.params);
+  return o;
+}
+
+// Reader page: white background, black glyph-like runs, one gray AA pixel
+// on each run edge. Deterministic so runs are comparable.
+QImage makeTextFrame(int w, int h, bool antiAliased) {
+  QImage img(w, h, QImage::Format_RGB32);
+  img.fill(0xffffffffu);
+  const int lineHeight = 48;
+  const int glyphHeight = 30;
+  for (int y = 80; y + glyphHeight < h - 80; y += lineHeight) {
+    for (int row = 0; row < glyphHeight; ++row) {
+      QRgb *line = reinterpret_cast<QRgb *>(img.scanLine(y + row));
+      unsigned seed = static_cast<unsigned>(y * 131 + row / 6);
+      for (int x = 60; x < w - 60;) {
+        seed = seed * 1103515245u + 12345u;
+        const int run = 4 + static_cast<int>((seed >> 16) % 14);
+        const int gap = 3 + static_cast<int>((seed >> 8) % 9);
+        for (int i = 0; i < run && x + i < w - 60; ++i)
+          line[x + i] = 0xff000000u;
+        if (antiAliased && x + run < w - 60)
+          line[x + run] = 0xff808080u;
+        x += run + gap;
+      }
+    }
+  }
+  return img;
+}
+
+// Photo-like frame: gradient with low-amplitude noise
+QImage makePhotoFrame(int w, int h) {
+  QImage img(w, h, QImage::Format_RGB32);
+  unsigned seed = 7;
+  for (int y = 0; y < h; ++y) {
+    QRgb *line = reinterpret_cast<QRgb *>(img.scanLine(y));
+    for (int x = 0; x < w; ++x) {
+      seed = seed * 1664525u + 1013904223u;
+      const int base =
+          (x * 255 / qMax(1, w - 1) + y * 255 / qMax(1, h - 1)) / 2;
+      const int v = qBound(0, base + static_cast<int>((seed >> 24) % 17) - 8,
+                           255);
+      line[x] = qRgb(v, (v * 3) / 4, v / 2);
+    }
+  }
+  return img;
+}
+
+QString formatName(QImage::Format format) {
+  switch (format) {
+  case QImage::Format_ARGB32:
+    return QStringLiteral("argb32");
+  case QImage::Format_RGB32:
+    return QStringLiteral("rgb32");
+  case QImage::Format_ARGB32_Premultiplied:
+    return QStringLiteral("argb32_pm");
+  case QImage::Format_RGB16:
+    return QStringLiteral("rgb16");
+  case QImage::Format_Grayscale8:
+    return QStringLiteral("gray8");
+  default:
+    return QStringLiteral("fmt%1").arg(static_cast<int>(format));
+  }
+}
+
+QString defaultShmPath() {
+  const QString dir = QFileInfo(QStringLiteral("/dev/shm")).isDir()
+                          ? QStringLiteral("/dev/shm")
+                          : QDir::tempPath();
+  return dir + QStringLiteral("/weread_frame_bench");
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName(QStringLiteral("WereadFrameBench"));
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      QStringLiteral("Frame pipeline benchmark (JSON on stdout)"));
+  parser.addHelpOption();
+  QCommandLineOption iterOpt(QStringLiteral("iterations"),
+                             QStringLiteral("Iterations per native-size case"),
+                             QStringLiteral("n"), QStringLiteral("50"));
+  QCommandLineOption shmOpt(QStringLiteral("shm"),
+                            QStringLiteral("SHM file used by the writer"),
+                            QStringLiteral("path"), defaultShmPath());
+  QCommandLineOption outOpt(QStringLiteral("out"),
+                            QStringLiteral("Write JSON to file"),
+                            QStringLiteral("file"));
+  parser.addOption(iterOpt);
+  parser.addOption(shmOpt);
+  parser.addOption(outOpt);
+  parser.process(app);
+
+  const int iterations = qMax(1, parser.value(iterOpt).toInt());
+  const QString shmPath = parser.value(shmOpt);
+  QList<BenchResult> results;
+
+  const QImage text = makeTextFrame(kFrameWidth, kFrameHeight, true);
+  const QImage textBilevel = makeTextFrame(kFrameWidth, kFrameHeight, false);
+  const QImage photo = makePhotoFrame(kFrameWidth, kFrameHeight);
+
+  // --- publish: source format x source size -------------------------------
+  const QList<QImage::Format> sourceFormats = {
+      QImage::Format_RGB32, QImage::Format_ARGB32,
+      QImage::Format_ARGB32_Premultiplied, QImage::Format_RGB16,
+      QImage::Format_Grayscale8};
+  const QList<QSize> sourceSizes = {QSize(kFrameWidth, kFrameHeight),
+                                    QSize(kFrameWidth / 2, kFrameHeight / 2),
+                                    QSize(kFrameWidth * 2, kFrameHeight * 2)};
+  {
+    ShmFrameWriter writer;
+    if (!writer.init(shmPath)) {
+      fprintf(stderr, "[BENCH] shm init failed at %s\n", qPrintable(shmPath));
+      return 1;
+    }
+    // the writer publishes ARGB32 frames
+    const qint64 outBytes =
+        static_cast<qint64>(writer.width()) * writer.height() * 4;
+    const QRect fullDamage(0, 0, writer.width(), writer.height());
+
+    for (const QSize &size : sourceSizes) {
+      const bool native = size == QSize(kFrameWidth, kFrameHeight);
+      const QImage base =
+          native ? text
+                 : text.scaled(size, Qt::IgnoreAspectRatio,
+                               Qt::FastTransformation);
+      // scaling cases are an order of magnitude slower; keep runs short
+      const int caseIterations = native ? iterations : qMax(3, iterations / 10);
+      for (QImage::Format format : sourceFormats) {
+        const QImage src = base.convertToFormat(format);
+        const bool direct = native && (src.format() == QImage::Format_ARGB32 ||
+                                       src.format() == QImage::Format_RGB32);
+        const QString path = !native ? QStringLiteral("convert+scale")
+                             : direct ? QStringLiteral("direct")
+                                      : QStringLiteral("convert");
+        QJsonObject params;
+        params.insert(QStringLiteral("source_format"), formatName(format));
+        params.insert(QStringLiteral("source_width"), size.width());
+        params.insert(QStringLiteral("source_height"), size.height());
+        params.insert(QStringLiteral("path"), path);
+        results.append(runCase(
+            QStringLiteral("publish"),
+            QStringLiteral("%1_%2x%3")
+                .arg(formatName(format))
+                .arg(size.width())
+                .arg(size.height()),
+            caseIterations, outBytes, params,
+            [&]() { writer.publish(src, fullDamage); }));
+      }
+    }
+  }
+  QFile::remove(shmPath);
+
+  // --- pixel classification / quantization kernels -------------------------
+  {
+    const qint64 frameBytes = static_cast<qint64>(text.sizeInBytes());
+    EinkQuantizer::Options snapOnly;
+    snapOnly.enabled = true;
+    snapOnly.dither = false;
+    EinkQuantizer::Options withDither;
+    withDither.enabled = true;
+    withDither.dither = true;
+    EinkQuantizer snapQuantizer(snapOnly);
+    EinkQuantizer ditherQuantizer(withDither);
+
+    struct KernelCase {
+      QString name;
+      QImage frame;
+    };
+    const QList<KernelCase> classifyCases = {
+        {QStringLiteral("classify_bilevel_page"), textBilevel},
+        {QStringLiteral("classify_aa_text_page"), text},
+        {QStringLiteral("classify_photo"), photo}};
+    for (const KernelCase &c : classifyCases) {
+      volatile int sink = 0;
+      results.append(runCase(
+          QStringLiteral("classify"), c.name, iterations, frameBytes,
+          QJsonObject(), [&]() {
+            sink = sink + static_cast<int>(
+                              EinkQuantizer::classify(c.frame, QRect()));
+          }));
+    }
+
+    struct QuantCase {
+      QString name;
+      QImage frame;
+      EinkQuantizer *quantizer;
+    };
+    const QList<QuantCase> quantCases = {
+        {QStringLiteral("quantize_snap_text"), text, &snapQuantizer},
+        {QStringLiteral("quantize_dither_text"), text, &ditherQuantizer},
+        {QStringLiteral("quantize_dither_photo"), photo, &ditherQuantizer}};
+    for (const QuantCase &c : quantCases) {
+      QImage work = c.frame.copy();
+      QJsonObject params;
+      params.insert(QStringLiteral("dither"), c.quantizer->options().dither);
+      params.insert(QStringLiteral("snap_margin"),
+                    c.quantizer->options().snapMargin);
+      // quantizing is idempotent, so reusing the output as input is stable
+      results.append(runCase(QStringLiteral("quantize"), c.name, iterations,
+                             frameBytes, params,
+                             [&]() { c.quantizer->process(work); }));
+    }
+  }
+
+  QJsonArray resultArray;
+  for (const BenchResult &r : results)
+    resultArray.append(toJson(r));
+  QJsonObject root;
+  root.insert(QStringLiteral("bench"), QStringLiteral("frame_pipeline"));
+  root.insert(QStringLiteral("qt_version"), QString::fromLatin1(qVersion()));
+  root.insert(QStringLiteral("cpu_arch"), QSysInfo::currentCpuArchitecture());
+  root.insert(QStringLiteral("kernel"), QSysInfo::kernelVersion());
+  root.insert(QStringLiteral("frame_width"), kFrameWidth);
+  root.insert(QStringLiteral("frame_height"), kFrameHeight);
+  root.insert(QStringLiteral("alloc_counting"),
+              static_cast<bool>(WEREAD_BENCH_COUNT_ALLOCS));
+  root.insert(QStringLiteral("results"), resultArray);
+  const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+
+  const QString outPath = parser.value(outOpt);
+  if (!outPath.isEmpty()) {
+    QFile file(outPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+      fprintf(stderr, "[BENCH] cannot write %s\n", qPrintable(outPath));
+      return 1;
+    }
+    file.write(json);
+  } else {
+    fwrite(json.constData(), 1, static_cast<size_t>(json.size()), stdout);
+  }
+  return 0;
+}
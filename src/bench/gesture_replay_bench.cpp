@@ -0,0 +1,574 @@
+// Gesture replay benchmark: feeds touch traces (recorded with
+// WEREAD_TOUCH_TRACE, or the built-in scenarios) through a real
+// GestureFilter attached to a stub browser on a virtual clock. It checks
+// the browser calls and the per-event consume/pass verdicts against the
+// expected ones, and measures per-event processing cost. Emits a single
+// JSON document; the exit status is non-zero on any mismatch.
+//
+// Usage: WereadGestureReplay [--trace FILE [--expect FILE] [--update]]
+//                            [--write-dir DIR] [--iterations N]
+//                            [--verbose] [--out FILE]
+//
+// Expectation files are text: a "verdicts <C|P per event>" line followed
+// by one "call <browser call>" line per call, in order.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QStringList>
+#include <QSysInfo>
+#include <QTextStream>
+#include <algorithm>
+#include <cstdio>
+
+#include "common.h"
+#include "gesture_filter.h"
+#include "touch_trace.h"
+
+namespace {
+constexpr int kWidth = 954;
+constexpr int kHeight = 1696;
+
+// Answers page-state and injection queries from the flags recorded with
+// each event and logs every action as a short string.
+class StubBrowser : public GestureTarget {
+public:
+  quint16 flags = 0;
+  QStringList calls;
+
+  bool isWeReadBook() const override {
+    return flags & TouchTraceEvent::WeReadBook;
+  }
+  bool isKindleUA() const override { return flags & TouchTraceEvent::KindleUA; }
+  bool isWeReadKindleMode() const override {
+    return flags & TouchTraceEvent::WeReadKindle;
+  }
+  bool isDedaoBook() const override {
+    return flags & TouchTraceEvent::DedaoBook;
+  }
+  int viewWidth() const override { return kWidth; }
+  QRect catalogRect() const override {
+    return (flags & TouchTraceEvent::CatalogHit)
+               ? QRect(-1, -1, 1 << 20, 1 << 20)
+               : QRect();
+  }
+  QRect menuRect() const override {
+    return (flags & TouchTraceEvent::MenuHit) ? QRect(-1, -1, 1 << 20, 1 << 20)
+                                              : QRect();
+  }
+
+  void injectMouse(Qt::MouseButton, QEvent::Type type,
+                   const QPointF &pos) override {
+    log(type == QEvent::MouseButtonPress ? "injectMouse press"
+                                         : "injectMouse release",
+        pos);
+  }
+  void injectTouch(QEvent::Type type, const QPointF &pos, int) override {
+    log(type == QEvent::TouchBegin ? "injectTouch begin"
+        : type == QEvent::TouchEnd ? "injectTouch end"
+                                   : "injectTouch update",
+        pos);
+  }
+  void armInjectedTouchPassThrough(const QPointF &pos, int) override {
+    log("armTouch", pos);
+  }
+  bool shouldReplayInjectedMouse(const QPointF &, qint64) const override {
+    return flags & TouchTraceEvent::InjectedReplay;
+  }
+  void noteInjectedMouseReplayed(const QPointF &, qint64) override {}
+  bool shouldBypassGestureForInjectedMouse(const QPointF &,
+                                           qint64) const override {
+    return flags & TouchTraceEvent::InjectedBypass;
+  }
+  bool shouldBypassGestureForInjectedTouch(const QPointF &,
+                                           qint64) const override {
+    return flags & TouchTraceEvent::InjectedBypass;
+  }
+
+  void scrollByJs(int dy) override {
+    calls << QStringLiteral("scroll %1").arg(dy);
+  }
+  void panScrollBy(int dy) override {
+    calls << QStringLiteral("pan %1").arg(dy);
+  }
+  void endPanScroll() override { calls << QStringLiteral("panEnd"); }
+  void goNextPage(const QPointF &) override { calls << QStringLiteral("next"); }
+  void goPrevPage(const QPointF &) override { calls << QStringLiteral("prev"); }
+  void previewPageJump(int pages) override {
+    calls << QStringLiteral("preview %1").arg(pages);
+  }
+  void jumpPages(int pages) override {
+    calls << QStringLiteral("jump %1").arg(pages);
+  }
+  void cancelPageJump() override { calls << QStringLiteral("cancelJump"); }
+  bool beginSpeculativeTurn() override {
+    calls << QStringLiteral("specBegin");
+    return true;
+  }
+  void commitSpeculativeTurn() override {
+    calls << QStringLiteral("specCommit");
+  }
+  void revertSpeculativeTurn() override {
+    calls << QStringLiteral("specRevert");
+  }
+  bool handleMenuTap(const QPointF &) override {
+    if (!(flags & TouchTraceEvent::MenuHit))
+      return false;
+    calls << QStringLiteral("menuTap");
+    return true;
+  }
+  void goBack() override { calls << QStringLiteral("back"); }
+  void goWeReadHome() override { calls << QStringLiteral("home"); }
+  void showMenu() override { calls << QStringLiteral("menu"); }
+  void scheduleBookCaptures(bool) override {
+    calls << QStringLiteral("captures");
+  }
+  void saveSessionState() const override {}
+  void exitToXochitl(const QString &reason) override {
+    calls << QStringLiteral("exit ") + reason;
+  }
+  void triggerFullRefresh() override { calls << QStringLiteral("fullRefresh"); }
+
+private:
+  void log(const char *what, const QPointF &pos) {
+    calls << QStringLiteral("%1 %2,%3")
+                 .arg(QLatin1String(what))
+                 .arg(qRound(pos.x()))
+                 .arg(qRound(pos.y()));
+  }
+};
+
+struct ReplayResult {
+  QStringList calls;
+  QString verdicts; // 'C' consumed / 'P' passed, one per event
+  QList<qint64> costNs;
+};
+
+ReplayResult replay(const QList<TouchTraceEvent> &events, bool speculative) {
+  StubBrowser browser;
+  qint64 now = 0;
+  GestureFilter filter(&browser);
+  filter.setWindowHeight(kHeight);
+  filter.setSpeculativeTurns(speculative);
+  filter.setClock([&now]() { return now; });
+  ReplayResult out;
+  out.costNs.reserve(events.size());
+  QElapsedTimer timer;
+  for (const TouchTraceEvent &ev : events) {
+    now = ev.tMs;
+    browser.flags = ev.flags;
+    filter.pollHoldTimer();
+    timer.start();
+    const bool consumed = filter.replayEvent(ev);
+    out.costNs.append(timer.nsecsElapsed());
+    out.verdicts.append(QLatin1Char(consumed ? 'C' : 'P'));
+  }
+  now += 1000;
+  filter.pollHoldTimer();
+  out.calls = browser.calls;
+  return out;
+}
+
+// ---------------------------------------------------------------------------
+// Built-in scenarios: the deliveries Qt makes for one gesture, including the
+// duplicates the dedup guards exist for.
+// ---------------------------------------------------------------------------
+class TraceBuilder {
+public:
+  explicit TraceBuilder(quint16 pageFlags) : m_page(pageFlags) {}
+
+  TraceBuilder &at(quint32 tMs) {
+    m_t = tMs;
+    return *this;
+  }
+  TraceBuilder &touch(QEvent::Type type, qreal x, qreal y, quint16 extra = 0) {
+    return add(type, 0, x, y, extra);
+  }
+  TraceBuilder &mouse(QEvent::Type type, Qt::MouseEventSource source, qreal x,
+                      qreal y, quint16 extra = 0) {
+    return add(type, quint8(source), x, y, extra);
+  }
+  // Straight touch drag, one TouchUpdate per stepMs.
+  TraceBuilder &drag(qreal x0, qreal y0, qreal x1, qreal y1, int steps,
+                     int stepMs) {
+    for (int i = 1; i <= steps; ++i) {
+      m_t += stepMs;
+      touch(QEvent::TouchUpdate, x0 + (x1 - x0) * i / steps,
+            y0 + (y1 - y0) * i / steps);
+    }
+    return *this;
+  }
+  quint32 now() const { return m_t; }
+  QList<TouchTraceEvent> events() const { return m_events; }
+
+private:
+  TraceBuilder &add(QEvent::Type type, quint8 source, qreal x, qreal y,
+                    quint16 extra) {
+    TouchTraceEvent ev;
+    ev.tMs = m_t;
+    ev.type = quint8(type);
+    ev.source = source;
+    ev.flags = m_page | extra;
+    ev.setPos(QPointF(x, y), QPointF(x, y));
+    m_events.append(ev);
+    return *this;
+  }
+
+  quint16 m_page;
+  quint32 m_t = 0;
+  QList<TouchTraceEvent> m_events;
+};
+
+struct Scenario {
+  QString name;
+  QList<TouchTraceEvent> events;
+  QStringList calls;
+  QString verdicts; // empty: not checked
+  bool speculative = false;
+};
+
+QList<Scenario> builtinScenarios() {
+  const quint16 kindle =
+      TouchTraceEvent::WeReadBook | TouchTraceEvent::WeReadKindle;
+  const quint16 weread = TouchTraceEvent::WeReadBook;
+  QList<Scenario> list;
+
+  {
+    // tap in kindle mode turns the page; Qt's synthesized mouse pair and
+    // the second delivery to the view widget must all be swallowed
+    TraceBuilder b(kindle);
+    b.at(0).touch(QEvent::TouchBegin, 200, 1300);
+    b.at(0).touch(QEvent::TouchBegin, 200, 1300,
+                  TouchTraceEvent::TargetWidget);
+    b.at(2).mouse(QEvent::MouseButtonPress, Qt::MouseEventSynthesizedByQt,
+                  201, 1301);
+    b.at(80).touch(QEvent::TouchEnd, 202, 1302);
+    b.at(80).touch(QEvent::TouchEnd, 202, 1302, TouchTraceEvent::TargetWidget);
+    b.at(82).mouse(QEvent::MouseButtonRelease, Qt::MouseEventSynthesizedByQt,
+                   202, 1302);
+    list.append({QStringLiteral("kindle_tap_dedup"), b.events(),
+                 {QStringLiteral("next")}, QStringLiteral("CCCCCC")});
+  }
+  {
+    // center tap in mobile mode is re-injected as a click; the injected
+    // mouse pair comes back through the filter and is let through
+    TraceBuilder b(weread);
+    b.at(0).touch(QEvent::TouchBegin, 477, 848);
+    b.at(60).touch(QEvent::TouchEnd, 477, 848);
+    b.at(61).mouse(QEvent::MouseButtonPress,
+                   Qt::MouseEventSynthesizedByApplication, 477, 848);
+    b.at(61).mouse(QEvent::MouseButtonRelease,
+                   Qt::MouseEventSynthesizedByApplication, 477, 848);
+    list.append({QStringLiteral("center_tap_inject"), b.events(),
+                 {QStringLiteral("injectMouse press 477,848"),
+                  QStringLiteral("injectMouse release 477,848")},
+                 QStringLiteral("CCPP")});
+  }
+  {
+    TraceBuilder b(weread);
+    b.at(0).touch(QEvent::TouchBegin, 800, 900);
+    b.drag(800, 900, 500, 905, 10, 16);
+    b.at(b.now() + 10).touch(QEvent::TouchEnd, 500, 905);
+    list.append({QStringLiteral("swipe_west_next"), b.events(),
+                 {QStringLiteral("next")}, QString()});
+  }
+  {
+    // 750 px: past LONG_SWIPE_MIN_DISTANCE, 2 + 150/100 pages
+    TraceBuilder b(weread);
+    b.at(0).touch(QEvent::TouchBegin, 100, 1000);
+    b.drag(100, 1000, 850, 990, 12, 16);
+    b.at(b.now() + 10).touch(QEvent::TouchEnd, 850, 990);
+    list.append({QStringLiteral("long_swipe_east_jump"), b.events(),
+                 {QStringLiteral("jump -3")}, QString()});
+  }
+  {
+    // pan starts at the first move past PAN_THRESHOLD, then scrolls each
+    // step
+    TraceBuilder b(weread);
+    b.at(0).touch(QEvent::TouchBegin, 480, 600);
+    b.drag(480, 600, 480, 1000, 10, 30);
+    b.at(b.now() + 10).touch(QEvent::TouchEnd, 480, 1000);
+    QStringList calls{QStringLiteral("pan 80")};
+    for (int i = 0; i < 8; ++i)
+      calls << QStringLiteral("pan 40");
+    calls << QStringLiteral("panEnd");
+    list.append({QStringLiteral("pan_scroll"), b.events(), calls, QString()});
+  }
+  {
+    // hold, then drag left: preview updates only when the page count
+    // changes, release jumps
+    TraceBuilder b(weread);
+    b.at(0).touch(QEvent::TouchBegin, 600, 1200);
+    b.at(700).touch(QEvent::TouchUpdate, 600, 1200);
+    b.drag(600, 1200, 400, 1200, 8, 40);
+    b.at(b.now() + 10).touch(QEvent::TouchEnd, 400, 1200);
+    list.append({QStringLiteral("hold_drag_jump"), b.events(),
+                 {QStringLiteral("preview 1"), QStringLiteral("preview 2"),
+                  QStringLiteral("preview 3"), QStringLiteral("jump 3")},
+                 QString()});
+  }
+  {
+    // menu band on a book page: passed through to the menu untouched
+    TraceBuilder b(weread);
+    b.at(0).touch(QEvent::TouchBegin, 300, 120);
+    b.at(50).touch(QEvent::TouchEnd, 300, 120);
+    list.append({QStringLiteral("menu_band_pass"), b.events(), {},
+                 QStringLiteral("PP")});
+  }
+  {
+    // bottom-edge swipe up exits from any page; off book pages the other
+    // events go to WebEngine
+    TraceBuilder b(0);
+    b.at(0).touch(QEvent::TouchBegin, 480, 1690);
+    b.drag(480, 1690, 480, 1300, 6, 20);
+    b.at(b.now() + 10).touch(QEvent::TouchEnd, 480, 1300);
+    list.append({QStringLiteral("bottom_swipe_exit"), b.events(),
+                 {QStringLiteral("exit swipe_up")},
+                 QStringLiteral("PPPPPPPC")});
+  }
+  {
+    // speculative turn: scrolled on contact down, the tap only commits
+    TraceBuilder b(kindle);
+    b.at(0).touch(QEvent::TouchBegin, 200, 1300);
+    b.at(80).touch(QEvent::TouchEnd, 202, 1302);
+    list.append({QStringLiteral("speculative_tap_commit"), b.events(),
+                 {QStringLiteral("specBegin"), QStringLiteral("specCommit")},
+                 QStringLiteral("CC"), true});
+  }
+  {
+    // speculative turn that turns into a pan is reverted before scrolling
+    TraceBuilder b(kindle);
+    b.at(0).touch(QEvent::TouchBegin, 200, 1300);
+    b.drag(200, 1300, 200, 900, 10, 30);
+    b.at(b.now() + 10).touch(QEvent::TouchEnd, 200, 900);
+    QStringList calls{QStringLiteral("specBegin"), QStringLiteral("specRevert"),
+                      QStringLiteral("pan -80")};
+    for (int i = 0; i < 8; ++i)
+      calls << QStringLiteral("pan -40");
+    calls << QStringLiteral("panEnd");
+    list.append({QStringLiteral("speculative_pan_revert"), b.events(), calls,
+                 QString(), true});
+  }
+  return list;
+}
+
+bool readExpect(const QString &path, QStringList *calls, QString *verdicts) {
+  QFile f(path);
+  if (!f.open(QIODevice::ReadOnly | QIODevice::Text))
+    return false;
+  QTextStream in(&f);
+  while (!in.atEnd()) {
+    const QString line = in.readLine();
+    if (line.startsWith(QStringLiteral("verdicts ")))
+      *verdicts = line.mid(9);
+    else if (line.startsWith(QStringLiteral("call ")))
+      *calls << line.mid(5);
+  }
+  return true;
+}
+
+bool writeExpect(const QString &path, const ReplayResult &r) {
+  QFile f(path);
+  if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    return false;
+  QTextStream out(&f);
+  out << "verdicts " << r.verdicts << "\n";
+  for (const QString &call : r.calls)
+    out << "call " << call << "\n";
+  return true;
+}
+
+bool writeTrace(const QString &path, const QList<TouchTraceEvent> &events) {
+  TouchTraceWriter writer;
+  if (!writer.open(path))
+    return false;
+  for (const TouchTraceEvent &ev : events)
+    writer.append(ev);
+  writer.close();
+  return true;
+}
+
+QJsonObject percentiles(QList<qint64> v) {
+  QJsonObject o;
+  if (v.isEmpty())
+    return o;
+  std::sort(v.begin(), v.end());
+  auto at = [&](double q) {
+    return v.at(qMin<qsizetype>(v.size() - 1, qsizetype(q * v.size())));
+  };
+  o.insert(QStringLiteral("p50"), at(0.50));
+  o.insert(QStringLiteral("p95"), at(0.95));
+  o.insert(QStringLiteral("max"), v.last());
+  return o;
+}
+
+// Replays `iterations` times; the first run is the one checked.
+QJsonObject runCase(const QString &name, const QList<TouchTraceEvent> &events,
+                    const QStringList *calls, const QString &verdicts,
+                    bool speculative, int iterations, bool *ok,
+                    ReplayResult *first) {
+  *first = replay(events, speculative);
+  QList<qint64> cost = first->costNs;
+  for (int i = 1; i < iterations; ++i)
+    cost += replay(events, speculative).costNs;
+  const bool callsOk = !calls || first->calls == *calls;
+  const bool verdictsOk = verdicts.isEmpty() || first->verdicts == verdicts;
+  *ok = callsOk && verdictsOk;
+
+  QJsonObject o;
+  o.insert(QStringLiteral("name"), name);
+  o.insert(QStringLiteral("events"), events.size());
+  o.insert(QStringLiteral("pass"), *ok);
+  o.insert(QStringLiteral("verdicts"), first->verdicts);
+  o.insert(QStringLiteral("calls"), QJsonArray::fromStringList(first->calls));
+  if (!callsOk)
+    o.insert(QStringLiteral("expected_calls"),
+             QJsonArray::fromStringList(*calls));
+  if (!verdictsOk)
+    o.insert(QStringLiteral("expected_verdicts"), verdicts);
+  o.insert(QStringLiteral("ns_per_event"), percentiles(cost));
+  fprintf(stderr, "[REPLAY] %s %s (%lld events)\n", qPrintable(name),
+          *ok ? "ok" : "MISMATCH", static_cast<long long>(events.size()));
+  return o;
+}
+
+bool g_verbose = false;
+void quietHandler(QtMsgType type, const QMessageLogContext &,
+                  const QString &msg) {
+  if (g_verbose || type >= QtCriticalMsg)
+    fprintf(stderr, "%s\n", qPrintable(msg));
+}
+} // namespace
+
+// main.cpp defines this in the app; --verbose raises it to Info so
+// GestureFilter logs every decision.
+LogLevel g_logLevel = LogLevel::Warning;
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName(QStringLiteral("WereadGestureReplay"));
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      QStringLiteral("GestureFilter trace replay (JSON on stdout)"));
+  parser.addHelpOption();
+  QCommandLineOption traceOpt(QStringLiteral("trace"),
+                              QStringLiteral("Recorded touch trace"),
+                              QStringLiteral("file"));
+  QCommandLineOption expectOpt(
+      QStringLiteral("expect"),
+      QStringLiteral("Expectations (default: <trace>.expect)"),
+      QStringLiteral("file"));
+  QCommandLineOption updateOpt(QStringLiteral("update"),
+                               QStringLiteral("Rewrite the expectations"));
+  QCommandLineOption writeDirOpt(
+      QStringLiteral("write-dir"),
+      QStringLiteral("Save built-in scenarios as trace + expect files"),
+      QStringLiteral("dir"));
+  QCommandLineOption iterOpt(QStringLiteral("iterations"),
+                             QStringLiteral("Replays per case for timing"),
+                             QStringLiteral("n"), QStringLiteral("200"));
+  QCommandLineOption speculativeOpt(
+      QStringLiteral("speculative"),
+      QStringLiteral("Replay --trace with speculative page turns on"));
+  QCommandLineOption verboseOpt(QStringLiteral("verbose"),
+                                QStringLiteral("Keep GestureFilter logs"));
+  QCommandLineOption outOpt(QStringLiteral("out"),
+                            QStringLiteral("Write JSON to file"),
+                            QStringLiteral("file"));
+  parser.addOption(traceOpt);
+  parser.addOption(expectOpt);
+  parser.addOption(updateOpt);
+  parser.addOption(writeDirOpt);
+  parser.addOption(iterOpt);
+  parser.addOption(speculativeOpt);
+  parser.addOption(verboseOpt);
+  parser.addOption(outOpt);
+  parser.process(app);
+
+  g_verbose = parser.isSet(verboseOpt);
+  if (g_verbose)
+    g_logLevel = LogLevel::Info;
+  qInstallMessageHandler(quietHandler);
+  const int iterations = qMax(1, parser.value(iterOpt).toInt());
+  QJsonArray cases;
+  bool allOk = true;
+
+  if (parser.isSet(traceOpt)) {
+    const QString tracePath = parser.value(traceOpt);
+    QList<TouchTraceEvent> events;
+    QString error;
+    if (!readTouchTrace(tracePath, &events, &error)) {
+      fprintf(stderr, "[REPLAY] %s: %s\n", qPrintable(tracePath),
+              qPrintable(error));
+      return 1;
+    }
+    const QString expectPath = parser.isSet(expectOpt)
+                                   ? parser.value(expectOpt)
+                                   : tracePath + QStringLiteral(".expect");
+    QStringList calls;
+    QString verdicts;
+    const bool haveExpect =
+        !parser.isSet(updateOpt) && readExpect(expectPath, &calls, &verdicts);
+    bool ok = true;
+    ReplayResult first;
+    cases.append(runCase(QFileInfo(tracePath).fileName(), events,
+                         haveExpect ? &calls : nullptr, verdicts,
+                         parser.isSet(speculativeOpt), iterations, &ok,
+                         &first));
+    allOk = ok;
+    if (parser.isSet(updateOpt) && !writeExpect(expectPath, first)) {
+      fprintf(stderr, "[REPLAY] cannot write %s\n", qPrintable(expectPath));
+      return 1;
+    }
+  } else {
+    const QString writeDir = parser.value(writeDirOpt);
+    if (!writeDir.isEmpty())
+      QDir().mkpath(writeDir);
+    for (const Scenario &s : builtinScenarios()) {
+      bool ok = true;
+      ReplayResult first;
+      cases.append(runCase(s.name, s.events, &s.calls, s.verdicts,
+                           s.speculative, iterations, &ok, &first));
+      allOk = allOk && ok;
+      if (!writeDir.isEmpty()) {
+        const QString base = writeDir + QLatin1Char('/') + s.name;
+        if (!writeTrace(base + QStringLiteral(".wrtt"), s.events) ||
+            !writeExpect(base + QStringLiteral(".wrtt.expect"), first)) {
+          fprintf(stderr, "[REPLAY] cannot write %s\n", qPrintable(base));
+          return 1;
+        }
+      }
+    }
+  }
+
+  QJsonObject root;
+  root.insert(QStringLiteral("bench"), QStringLiteral("gesture_replay"));
+  root.insert(QStringLiteral("qt_version"), QString::fromLatin1(qVersion()));
+  root.insert(QStringLiteral("cpu_arch"), QSysInfo::currentCpuArchitecture());
+  root.insert(QStringLiteral("iterations"), iterations);
+  root.insert(QStringLiteral("logs"), g_verbose);
+  root.insert(QStringLiteral("pass"), allOk);
+  root.insert(QStringLiteral("cases"), cases);
+  const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+
+  const QString outPath = parser.value(outOpt);
+  if (!outPath.isEmpty()) {
+    QFile file(outPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+      fprintf(stderr, "[BENCH] cannot write %s\n", qPrintable(outPath));
+      return 1;
+    }
+    file.write(json);
+  } else {
+    fwrite(json.constData(), 1, static_cast<size_t>(json.size()), stdout);
+  }
+  return allOk ? 0 : 2;
+}
@@ -0,0 +1,369 @@
+// URL rule engine benchmark: runs a URL corpus through the compiled
+// UrlRuleSet and through the QString::contains chain ResourceInterceptor
+// used before it, reporting ns and heap allocations per URL for each and
+// checking that both reach the same verdicts. The corpus is one
+// "<type> <url>" line per request as recorded with WEREAD_URL_CORPUS (a
+// bare URL counts as type other); without --corpus a synthetic reader
+// session is used. Emits a single JSON document.
+//
+// Usage: WereadUrlRuleBench [--corpus FILE] [--rules FILE]
+//                           [--iterations N] [--out FILE]
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QStringList>
+#include <QSysInfo>
+#include <QUrl>
+#include <atomic>
+#include <cstdio>
+#include <functional>
+
+#include "url_rules.h"
+
+namespace {
+std::atomic<bool> g_countAllocs{false};
+std::atomic<unsigned long long> g_allocCount{0};
+
+inline void noteAlloc() {
+  if (g_countAllocs.load(std::memory_order_relaxed))
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+}
+} // namespace
+
+#if defined(__GLIBC__)
+#define WEREAD_BENCH_COUNT_ALLOCS 1
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+
+extern "C" void *malloc(size_t size) __THROW {
+  noteAlloc();
+  return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size) __THROW {
+  noteAlloc();
+  return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size) __THROW {
+  noteAlloc();
+  return __libc_realloc(ptr, size);
+}
+#else
+#define WEREAD_BENCH_COUNT_ALLOCS 0
+#endif
+
+namespace {
+// the form ResourceInterceptor matches: "//host/path?query"
+constexpr QUrl::FormattingOptions kMatchForm =
+    QUrl::RemoveScheme | QUrl::RemoveUserInfo | QUrl::RemovePort |
+    QUrl::RemoveFragment;
+
+struct Request {
+  QUrl url;
+  QByteArray matchUrl;
+  UrlRuleSet::Kind kind = UrlRuleSet::KindOther;
+};
+
+UrlRuleSet::Kind parseKind(const QByteArray &name) {
+  for (int k = 0; k < UrlRuleSet::KindCount; ++k)
+    if (name == UrlRuleSet::kindName(k))
+      return UrlRuleSet::Kind(k);
+  return UrlRuleSet::KindOther;
+}
+
+void addRequest(QList<Request> *out, UrlRuleSet::Kind kind,
+                const QByteArray &encoded) {
+  Request r;
+  r.url = QUrl::fromEncoded(encoded);
+  if (!r.url.isValid())
+    return;
+  r.matchUrl = r.url.toEncoded(kMatchForm);
+  r.kind = kind;
+  out->append(r);
+}
+
+bool readCorpus(const QString &path, QList<Request> *out) {
+  QFile f(path);
+  if (!f.open(QIODevice::ReadOnly))
+    return false;
+  while (!f.atEnd()) {
+    const QByteArray line = f.readLine().trimmed();
+    if (line.isEmpty() || line.startsWith('#'))
+      continue;
+    const qsizetype sp = line.indexOf(' ');
+    if (sp < 0)
+      addRequest(out, UrlRuleSet::KindOther, line);
+    else
+      addRequest(out, parseKind(line.left(sp)), line.mid(sp + 1).trimmed());
+  }
+  return true;
+}
+
+// One reader session's worth of traffic: shell, scripts, chapter text,
+// fonts (some blocked, two only by a family named in the query string),
+// images and the progress/chapter APIs.
+QList<Request> syntheticCorpus() {
+  QList<Request> out;
+  auto add = [&out](UrlRuleSet::Kind kind, const QString &url) {
+    addRequest(&out, kind, url.toUtf8());
+  };
+  const QString book = QStringLiteral("3b5320a0813ab8df9g018ff4");
+  add(UrlRuleSet::KindMainFrame,
+      QStringLiteral("https://weread.qq.com/web/reader/%1").arg(book));
+  for (int i = 0; i < 40; ++i) {
+    add(UrlRuleSet::KindScript,
+        QStringLiteral("https://cdn.weread.qq.com/web/wrwebnjlogic/js/"
+                       "%1.%2.js")
+            .arg(i)
+            .arg(0x3f2a1c0 + i * 977, 0, 16));
+    add(UrlRuleSet::KindStylesheet,
+        QStringLiteral("https://cdn.weread.qq.com/web/wrwebnjlogic/css/"
+                       "%1.%2.css")
+            .arg(i)
+            .arg(0x1b77e00 + i * 131, 0, 16));
+  }
+  for (int ch = 0; ch < 120; ++ch) {
+    add(UrlRuleSet::KindXhr,
+        QStringLiteral("https://weread.qq.com/web/book/chapter/e_%1").arg(ch));
+    add(UrlRuleSet::KindXhr,
+        QStringLiteral("https://weread.qq.com/web/book/read?bookId=%1&c=%2")
+            .arg(book)
+            .arg(ch));
+    add(UrlRuleSet::KindImage,
+        QStringLiteral("https://res.weread.qq.com/wrepub/CB_%1_%2.jpg")
+            .arg(book)
+            .arg(ch));
+    if (ch % 10 == 0) {
+      add(UrlRuleSet::KindXhr,
+          QStringLiteral("https://weread.qq.com/web/book/chapterInfos"));
+      add(UrlRuleSet::KindXhr,
+          QStringLiteral("https://weread.qq.com/web/book/getProgress?"
+                         "bookId=%1")
+              .arg(book));
+      add(UrlRuleSet::KindImage,
+          QStringLiteral("https://weread.qq.com/api/winktemplaterendersvr/"
+                         "img/%1.png")
+              .arg(ch));
+    }
+    if (ch % 30 == 0) {
+      add(UrlRuleSet::KindFont,
+          QStringLiteral("https://cdn.weread.qq.com/app/assets/fonts/"
+                         "SourceHanSerifCN-Bold.woff2"));
+      add(UrlRuleSet::KindFont,
+          QStringLiteral("https://cdn.weread.qq.com/app/assets/fonts/"
+                         "TsangerYunHei-W05.woff2"));
+      add(UrlRuleSet::KindFont,
+          QStringLiteral("https://weread.qq.com/api/winktemplaterendersvr/"
+                         "fonts/KaTeX_Main-Regular.woff2"));
+      add(UrlRuleSet::KindFont,
+          QStringLiteral("https://cdn.weread.qq.com/app/assets/fonts/"
+                         "FZSongKeBenXiuKai.woff2"));
+      // blocked family named only in the query string
+      add(UrlRuleSet::KindStylesheet,
+          QStringLiteral("https://cdn.weread.qq.com/web/fontface?"
+                         "family=SourceHanSerifCN&weight=700"));
+      add(UrlRuleSet::KindFont,
+          QStringLiteral("https://cdn.weread.qq.com/web/font?"
+                         "name=SourceHanSerifCN-Medium&fmt=woff2"));
+    }
+  }
+  return out;
+}
+
+// The checks ResourceInterceptor made before the rule engine, in order;
+// bit i set = the i-th default rule would have logged/blocked.
+struct LegacyResult {
+  quint64 matched = 0;
+  bool block = false;
+};
+
+LegacyResult legacyMatch(const QUrl &u, UrlRuleSet::Kind kind) {
+  const QString url = u.toString();
+  LegacyResult r;
+  const bool fontOrMedia =
+      kind == UrlRuleSet::KindFont || kind == UrlRuleSet::KindMedia;
+  if (url.contains(QStringLiteral("/winktemplaterendersvr/")) && fontOrMedia) {
+    r.matched |= 1u << 0;
+    r.block = true;
+    return r;
+  }
+  if (url.contains(QStringLiteral("SourceHanSerif"))) {
+    r.matched |= 1u << 1;
+    r.block = true;
+    return r;
+  }
+  if (url.contains(QStringLiteral("TsangerYunHei-W05")) &&
+      kind == UrlRuleSet::KindFont)
+    r.matched |= 1u << 2;
+  if (url.contains(QStringLiteral("chapterInfos"), Qt::CaseInsensitive))
+    r.matched |= 1u << 3;
+  if (url.contains(QStringLiteral("/web/book/read")))
+    r.matched |= 1u << 4;
+  if (url.contains(QStringLiteral("getProgress")))
+    r.matched |= 1u << 5;
+  return r;
+}
+
+QJsonObject runCase(const QString &name, int iterations, qsizetype urls,
+                    const std::function<void()> &pass) {
+  pass(); // warm-up
+  g_allocCount.store(0);
+  g_countAllocs.store(true);
+  QElapsedTimer timer;
+  timer.start();
+  for (int i = 0; i < iterations; ++i)
+    pass();
+  const qint64 ns = timer.nsecsElapsed();
+  g_countAllocs.store(false);
+
+  const double perUrl = double(iterations) * double(qMax<qsizetype>(1, urls));
+  QJsonObject o;
+  o.insert(QStringLiteral("name"), name);
+  o.insert(QStringLiteral("ns_per_url"), double(ns) / perUrl);
+  if (WEREAD_BENCH_COUNT_ALLOCS)
+    o.insert(QStringLiteral("allocs_per_url"),
+             double(g_allocCount.load()) / perUrl);
+  fprintf(stderr, "[BENCH] %-16s %8.1f ns/url\n", qPrintable(name),
+          double(ns) / perUrl);
+  return o;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName(QStringLiteral("WereadUrlRuleBench"));
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      QStringLiteral("URL rule engine benchmark (JSON on stdout)"));
+  parser.addHelpOption();
+  QCommandLineOption corpusOpt(
+      QStringLiteral("corpus"),
+      QStringLiteral("Recorded URL corpus (WEREAD_URL_CORPUS)"),
+      QStringLiteral("file"));
+  QCommandLineOption rulesOpt(QStringLiteral("rules"),
+                              QStringLiteral("Rule file (default: built-in)"),
+                              QStringLiteral("file"));
+  QCommandLineOption iterOpt(QStringLiteral("iterations"),
+                             QStringLiteral("Passes over the corpus"),
+                             QStringLiteral("n"), QStringLiteral("200"));
+  QCommandLineOption outOpt(QStringLiteral("out"),
+                            QStringLiteral("Write JSON to file"),
+                            QStringLiteral("file"));
+  parser.addOption(corpusOpt);
+  parser.addOption(rulesOpt);
+  parser.addOption(iterOpt);
+  parser.addOption(outOpt);
+  parser.process(app);
+
+  const int iterations = qMax(1, parser.value(iterOpt).toInt());
+  QList<Request> corpus;
+  if (parser.isSet(corpusOpt)) {
+    if (!readCorpus(parser.value(corpusOpt), &corpus)) {
+      fprintf(stderr, "[BENCH] cannot read %s\n",
+              qPrintable(parser.value(corpusOpt)));
+      return 1;
+    }
+  } else {
+    corpus = syntheticCorpus();
+  }
+
+  UrlRuleSet rules;
+  QString error;
+  const bool customRules = parser.isSet(rulesOpt);
+  if (customRules ? !rules.loadFile(parser.value(rulesOpt), &error)
+                  : !rules.load(UrlRuleSet::defaultRules(), &error)) {
+    fprintf(stderr, "[BENCH] rules: %s\n", qPrintable(error));
+    return 1;
+  }
+
+  // Verdicts first, on a fresh rule set, so the hit counters in the JSON
+  // are for exactly one pass over the corpus.
+  int mismatches = 0;
+  int blocked = 0;
+  QJsonArray mismatchSamples;
+  for (const Request &r : corpus) {
+    const UrlRuleSet::Result res = rules.match(r.matchUrl, r.kind);
+    blocked += res.block ? 1 : 0;
+    if (customRules)
+      continue;
+    const LegacyResult legacy = legacyMatch(r.url, r.kind);
+    // the old chain stopped at the first block, so a blocked URL only has
+    // to agree on the rules it got to
+    const bool same =
+        legacy.block == res.block &&
+        (legacy.block ? (res.matched & legacy.matched) == legacy.matched
+                      : res.matched == legacy.matched);
+    if (!same) {
+      ++mismatches;
+      if (mismatchSamples.size() < 10)
+        mismatchSamples.append(QString::fromUtf8(r.url.toEncoded()));
+    }
+  }
+  const QJsonObject hits = rules.snapshot();
+
+  QJsonArray cases;
+  volatile quint64 sink = 0;
+  if (!customRules) {
+    cases.append(runCase(QStringLiteral("legacy_contains"), iterations,
+                         corpus.size(), [&]() {
+                           for (const Request &r : corpus)
+                             sink = sink + legacyMatch(r.url, r.kind).matched;
+                         }));
+  }
+  cases.append(runCase(QStringLiteral("encode_match"), iterations,
+                       corpus.size(), [&]() {
+                         for (const Request &r : corpus)
+                           sink = sink + rules
+                                             .match(r.url.toEncoded(kMatchForm),
+                                                    r.kind)
+                                             .matched;
+                       }));
+  cases.append(runCase(QStringLiteral("match_only"), iterations, corpus.size(),
+                       [&]() {
+                         for (const Request &r : corpus)
+                           sink = sink + rules.match(r.matchUrl, r.kind).matched;
+                       }));
+
+  QJsonObject root;
+  root.insert(QStringLiteral("bench"), QStringLiteral("url_rules"));
+  root.insert(QStringLiteral("qt_version"), QString::fromLatin1(qVersion()));
+  root.insert(QStringLiteral("cpu_arch"), QSysInfo::currentCpuArchitecture());
+  root.insert(QStringLiteral("corpus"),
+              parser.isSet(corpusOpt) ? parser.value(corpusOpt)
+                                      : QStringLiteral("synthetic"));
+  root.insert(QStringLiteral("urls"), corpus.size());
+  root.insert(QStringLiteral("blocked"), blocked);
+  root.insert(QStringLiteral("iterations"), iterations);
+  root.insert(QStringLiteral("alloc_counting"),
+              bool(WEREAD_BENCH_COUNT_ALLOCS));
+  if (!customRules) {
+    root.insert(QStringLiteral("verdict_mismatches"), mismatches);
+    if (!mismatchSamples.isEmpty())
+      root.insert(QStringLiteral("mismatch_samples"), mismatchSamples);
+  }
+  root.insert(QStringLiteral("rules"), hits);
+  root.insert(QStringLiteral("cases"), cases);
+  const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+
+  const QString outPath = parser.value(outOpt);
+  if (!outPath.isEmpty()) {
+    QFile file(outPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+      fprintf(stderr, "[BENCH] cannot write %s\n", qPrintable(outPath));
+      return 1;
+    }
+    file.write(json);
+  } else {
+    fwrite(json.constData(), 1, static_cast<size_t>(json.size()), stdout);
+  }
+  return mismatches == 0 ? 0 : 2;
+}
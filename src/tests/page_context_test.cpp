@@ -0,0 +1,90 @@
+// PageContext::classify: site and page kind for the URLs the browser sees.
+
+#include <QTest>
+#include <QUrl>
+
+#include "page_context.h"
+
+using Site = PageContext::Site;
+using Kind = PageContext::Kind;
+Q_DECLARE_METATYPE(PageContext::Site)
+Q_DECLARE_METATYPE(PageContext::Kind)
+
+class PageContextTest : public QObject {
+  Q_OBJECT
+
+private slots:
+  void classify_data();
+  void classify();
+  void classifyLeavesCallerFields();
+};
+
+void PageContextTest::classify_data() {
+  QTest::addColumn<QString>("url");
+  QTest::addColumn<Site>("site");
+  QTest::addColumn<Kind>("kind");
+
+  QTest::newRow("weread reader")
+      << "https://weread.qq.com/web/reader/3a8321c0813ab6f4bg0127d0"
+      << Site::WeRead << Kind::Reader;
+  QTest::newRow("weread reader chapter")
+      << "https://weread.qq.com/web/reader/3a8321c0813ab6f4bg0127d0"
+         "k8f132430178f14e45fce0f7?from=shelf"
+      << Site::WeRead << Kind::Reader;
+  QTest::newRow("weread shelf")
+      << "https://weread.qq.com/web/shelf" << Site::WeRead << Kind::Other;
+  QTest::newRow("weread home")
+      << "https://weread.qq.com/" << Site::WeRead << Kind::Other;
+  QTest::newRow("weread book detail")
+      << "https://weread.qq.com/web/bookDetail/3a8321c0813ab6f4bg0127d0"
+      << Site::WeRead << Kind::Other;
+  QTest::newRow("weread local copy")
+      << "file:///home/root/weread.qq.com/web/reader/abc.html"
+      << Site::WeRead << Kind::Reader;
+  QTest::newRow("dedao reader")
+      << "https://www.dedao.cn/ebook/reader?id=Vm7Bz5Kjv1"
+      << Site::Dedao << Kind::Reader;
+  QTest::newRow("dedao detail")
+      << "https://www.dedao.cn/ebook/detail?id=Vm7Bz5Kjv1" << Site::Dedao
+      << Kind::Detail;
+  QTest::newRow("dedao home")
+      << "https://www.dedao.cn/" << Site::Dedao << Kind::Other;
+  QTest::newRow("other")
+      << "https://example.com/web/reader/abc" << Site::Other << Kind::Other;
+  QTest::newRow("about blank") << "about:blank" << Site::Other << Kind::Other;
+  QTest::newRow("empty") << "" << Site::Other << Kind::Other;
+}
+
+void PageContextTest::classify() {
+  QFETCH(QString, url);
+  QFETCH(Site, site);
+  QFETCH(Kind, kind);
+
+  const PageContext ctx = PageContext::classify(QUrl(url));
+  QCOMPARE(PageContext::siteName(ctx.site), PageContext::siteName(site));
+  QCOMPARE(PageContext::kindName(ctx.kind), PageContext::kindName(kind));
+  QCOMPARE(ctx.isWeReadBook(), site == Site::WeRead && kind == Kind::Reader);
+  QCOMPARE(ctx.isDedaoBook(), site == Site::Dedao && kind == Kind::Reader);
+  QCOMPARE(ctx.isDedaoSite(), site == Site::Dedao);
+  QCOMPARE(ctx.isBookPage(), kind == Kind::Reader);
+}
+
+void PageContextTest::classifyLeavesCallerFields() {
+  const PageContext ctx = PageContext::classify(
+      QUrl(QStringLiteral("https://weread.qq.com/web/reader/abc")));
+  QVERIFY(!ctx.kindleUA);
+  QVERIFY(!ctx.isWeReadKindleMode());
+  QVERIFY(!ctx.refresh);
+
+  PageContext kindle = ctx;
+  kindle.kindleUA = true;
+  QVERIFY(kindle.isWeReadKindleMode());
+  QVERIFY(kindle != ctx);
+}
+
+int runPageContextTests(int argc, char **argv) {
+  PageContextTest test;
+  return QTest::qExec(&test, argc, argv);
+}
+
+#include "page_context_test.moc"
@@ -0,0 +1,186 @@
+// PageTurnController: folding requests into net deltas, tap/jump limits,
+// partial completion and the watchdog.
+
+#include <QSignalSpy>
+#include <QTest>
+
+#include "page_turn_controller.h"
+
+class PageTurnControllerTest : public QObject {
+  Q_OBJECT
+
+private slots:
+  void requestStartsWhenIdle();
+  void requestWhileBusyIsFolded();
+  void oppositeRequestsCancel();
+  void tapsAreBoundedPerTurn();
+  void jumpUsesJumpLimit();
+  void tapsDoNotShrinkQueuedJump();
+  void partialCompletionRequeues();
+  void staleCompletionIsIgnored();
+  void watchdogCompletesTurn();
+  void watchdogRequeuesRemainingPages();
+
+private:
+  static int lastPages(const QSignalSpy &spy) {
+    return spy.last().at(1).toInt();
+  }
+  static int lastSeq(const QSignalSpy &spy) {
+    return spy.last().at(0).toInt();
+  }
+};
+
+void PageTurnControllerTest::requestStartsWhenIdle() {
+  PageTurnController c;
+  QSignalSpy exec(&c, &PageTurnController::execute);
+  QVERIFY(!c.request(0));
+  QCOMPARE(exec.count(), 0);
+  QVERIFY(c.request(1));
+  QCOMPARE(exec.count(), 1);
+  QCOMPARE(lastPages(exec), 1);
+  QVERIFY(c.busy());
+  QCOMPARE(c.inFlightSeq(), lastSeq(exec));
+}
+
+void PageTurnControllerTest::requestWhileBusyIsFolded() {
+  PageTurnController c;
+  QSignalSpy exec(&c, &PageTurnController::execute);
+  QSignalSpy idle(&c, &PageTurnController::idle);
+  c.request(1);
+  QVERIFY(!c.request(1));
+  QVERIFY(!c.request(1));
+  QCOMPARE(c.queuedPages(), 2);
+  QCOMPARE(exec.count(), 1);
+
+  c.complete(lastSeq(exec), 1);
+  QCOMPARE(exec.count(), 2);
+  QCOMPARE(lastPages(exec), 2);
+  QCOMPARE(c.queuedPages(), 0);
+  QCOMPARE(idle.count(), 0);
+
+  c.complete(lastSeq(exec), 2);
+  QVERIFY(!c.busy());
+  QCOMPARE(idle.count(), 1);
+}
+
+void PageTurnControllerTest::oppositeRequestsCancel() {
+  PageTurnController c;
+  QSignalSpy exec(&c, &PageTurnController::execute);
+  QSignalSpy idle(&c, &PageTurnController::idle);
+  c.request(1);
+  c.request(1);
+  c.request(-1);
+  QCOMPARE(c.queuedPages(), 0);
+  c.complete(lastSeq(exec), 1);
+  QCOMPARE(exec.count(), 1);
+  QCOMPARE(idle.count(), 1);
+}
+
+void PageTurnControllerTest::tapsAreBoundedPerTurn() {
+  PageTurnController c;
+  QSignalSpy exec(&c, &PageTurnController::execute);
+  c.request(9);
+  QCOMPARE(lastPages(exec), PageTurnController::kMaxPagesPerTurn);
+  for (int i = 0; i < 9; ++i)
+    c.request(-1);
+  QCOMPARE(c.queuedPages(), -PageTurnController::kMaxPagesPerTurn);
+}
+
+void PageTurnControllerTest::jumpUsesJumpLimit() {
+  PageTurnController c;
+  QSignalSpy exec(&c, &PageTurnController::execute);
+  c.jump(12);
+  QCOMPARE(lastPages(exec), 12);
+  c.complete(lastSeq(exec), 12);
+  c.jump(-30);
+  QCOMPARE(lastPages(exec), -PageTurnController::kMaxPagesPerJump);
+}
+
+void PageTurnControllerTest::tapsDoNotShrinkQueuedJump() {
+  PageTurnController c;
+  QSignalSpy exec(&c, &PageTurnController::execute);
+  c.request(1);
+  c.jump(12);
+  QCOMPARE(c.queuedPages(), 12);
+  // a tap on top neither cuts the jump to the tap limit nor extends it
+  c.request(1);
+  QCOMPARE(c.queuedPages(), 12);
+  c.request(-1);
+  QCOMPARE(c.queuedPages(), 11);
+  c.complete(lastSeq(exec), 1);
+  QCOMPARE(lastPages(exec), 11);
+}
+
+void PageTurnControllerTest::partialCompletionRequeues() {
+  PageTurnController c;
+  QSignalSpy exec(&c, &PageTurnController::execute);
+  c.request(3);
+  const int first = lastSeq(exec);
+  // executor moved one page (e.g. the pager button) and a tap arrived
+  c.request(1);
+  c.complete(first, 1);
+  QCOMPARE(exec.count(), 2);
+  QVERIFY(lastSeq(exec) != first);
+  QCOMPARE(lastPages(exec), 3);
+
+  // backwards: one of -2 done
+  PageTurnController back;
+  QSignalSpy backExec(&back, &PageTurnController::execute);
+  back.request(-2);
+  back.complete(lastSeq(backExec), -1);
+  QCOMPARE(lastPages(backExec), -1);
+}
+
+void PageTurnControllerTest::staleCompletionIsIgnored() {
+  PageTurnController c;
+  QSignalSpy exec(&c, &PageTurnController::execute);
+  QSignalSpy idle(&c, &PageTurnController::idle);
+  c.request(1);
+  const int seq = lastSeq(exec);
+  c.complete(0, 1);
+  c.complete(seq + 1, 1);
+  QVERIFY(c.busy());
+  c.complete(seq, 1);
+  QVERIFY(!c.busy());
+  c.complete(seq, 1); // second report of the same turn
+  QCOMPARE(idle.count(), 1);
+}
+
+void PageTurnControllerTest::watchdogCompletesTurn() {
+  PageTurnController c;
+  c.setWatchdogMs(20);
+  QSignalSpy exec(&c, &PageTurnController::execute);
+  QSignalSpy expired(&c, &PageTurnController::watchdogExpired);
+  QSignalSpy idle(&c, &PageTurnController::idle);
+  c.request(1);
+  c.request(1);
+  const int seq = lastSeq(exec);
+  QVERIFY(expired.wait(1000));
+  QCOMPARE(expired.first().at(0).toInt(), seq);
+  // the silent turn counts as done; the queued tap still runs
+  QCOMPARE(exec.count(), 2);
+  QCOMPARE(lastPages(exec), 1);
+  c.complete(lastSeq(exec), 1);
+  QCOMPARE(idle.count(), 1);
+}
+
+void PageTurnControllerTest::watchdogRequeuesRemainingPages() {
+  PageTurnController c;
+  c.setWatchdogMs(20);
+  QSignalSpy exec(&c, &PageTurnController::execute);
+  QSignalSpy expired(&c, &PageTurnController::watchdogExpired);
+  c.jump(-4);
+  QCOMPARE(lastPages(exec), -4);
+  QVERIFY(expired.wait(1000));
+  // one page is assumed moved, the other three run as the next turn
+  QCOMPARE(exec.count(), 2);
+  QCOMPARE(lastPages(exec), -3);
+  QVERIFY(c.busy());
+}
+
+int runPageTurnControllerTests(int argc, char **argv) {
+  PageTurnControllerTest test;
+  return QTest::qExec(&test, argc, argv);
+}
+
+#include "page_turn_controller_test.moc"
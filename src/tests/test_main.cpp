@@ -0,0 +1,15 @@
+// Unit tests of the browser's Qt-only building blocks, one QObject test
+// class per source file. Exit status is non-zero if any class failed.
+
+#include <QCoreApplication>
+
+int runPageContextTests(int argc, char **argv);
+int runPageTurnControllerTests(int argc, char **argv);
+
+int main(int argc, char **argv) {
+  QCoreApplication app(argc, argv);
+  int failed = 0;
+  failed += runPageContextTests(argc, argv) != 0;
+  failed += runPageTurnControllerTests(argc, argv) != 0;
+  return failed;
+}